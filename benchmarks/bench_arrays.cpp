@@ -0,0 +1,76 @@
+// Array benchmark: a dot product over int and double arrays on the
+// tree-walking interpreter, the bytecode VM and the VM with its baseline
+// JIT, reported as nanoseconds per element. Each kernel runs twice: once
+// indexing by the loop variable, which the compiler proves in bounds, and
+// once through a copy of it, which keeps every bounds check.
+//
+// Usage: bench_arrays [length] [rounds]
+
+#include "bench_common.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace myndra;
+using namespace myndra::bench;
+
+namespace {
+
+// A program filling two arrays with `one`-scaled values and summing their
+// products `rounds` times; `index` is the expression the loop indexes by
+std::string dotProduct(int64_t length, int64_t rounds, const std::string& one, const std::string& type,
+                       bool proven) {
+    std::string index = proven ? "i" : "j";
+    return "fn dot(a: [" + type + "], b: [" + type + "], n: int) -> " + type + " {\n"
+           "    let s = 0" + (type == "float" ? ".0" : "") + ";\n"
+           "    for i in 0..n {\n"
+           "        let j = i;\n"
+           "        s = s + a[" + index + "] * b[" + index + "];\n"
+           "    }\n"
+           "    return s;\n"
+           "}\n"
+           "let a = [];\n"
+           "let b = [];\n"
+           "for i in 0.." + std::to_string(length) + " { a.push(" + one + "); b.push(" + one + " + " + one + "); }\n"
+           "let total = 0" + (type == "float" ? ".0" : "") + ";\n"
+           "for r in 0.." + std::to_string(rounds) + " { total = total + dot(a, b, " + std::to_string(length) + "); }\n"
+           "print(total);\n";
+}
+
+void report(const std::string& name, const std::string& source, int64_t elements) {
+    std::string interpreted, compiled, native;
+    double interpreterSeconds = timeRun(source, Engine::Interpreter, interpreted);
+    double vmSeconds = timeRun(source, Engine::VM, compiled);
+    double jitSeconds = timeRun(source, Engine::JIT, native);
+
+    std::cout << name << " (result " << compiled.substr(0, compiled.find('\n')) << ")\n";
+    std::cout << std::fixed << std::setprecision(2)
+              << "  interpreter: " << std::setw(8) << interpreterSeconds * 1e9 / elements << " ns/element\n"
+              << "  vm:          " << std::setw(8) << vmSeconds * 1e9 / elements << " ns/element\n";
+    if (Jit::supported()) {
+        std::cout << "  vm + jit:    " << std::setw(8) << jitSeconds * 1e9 / elements << " ns/element\n";
+    }
+    if (interpreted != compiled || interpreted != native) {
+        std::cout << "  warning: engines disagree (" << interpreted << " vs " << compiled << " vs " << native << ")\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int64_t length = argc > 1 ? std::atoll(argv[1]) : 10000;
+    int64_t rounds = argc > 2 ? std::atoll(argv[2]) : 100;
+
+    std::cout << "Myndra array benchmark" << std::endl;
+    std::cout << "======================" << std::endl;
+
+    for (bool proven : {true, false}) {
+        const char* checks = proven ? "proven in bounds" : "checked";
+        report(std::string("int dot product, ") + checks, dotProduct(length, rounds, "i", "int", proven),
+               length * rounds);
+        report(std::string("float dot product, ") + checks, dotProduct(length, rounds, "0.5", "float", proven),
+               length * rounds);
+    }
+    return 0;
+}
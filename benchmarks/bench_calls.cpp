@@ -0,0 +1,78 @@
+// Function call benchmark: recursive fib and ackermann on the tree-walking
+// interpreter, the bytecode VM and the VM with its baseline JIT, reported as
+// nanoseconds per call.
+//
+// Usage: bench_calls [fib_n] [ack_m] [ack_n]
+
+#include "bench_common.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace myndra;
+using namespace myndra::bench;
+
+namespace {
+
+// Calls made by the reference implementations, so results are per call
+int64_t fibCalls(int64_t n) {
+    return n < 2 ? 1 : 1 + fibCalls(n - 1) + fibCalls(n - 2);
+}
+
+int64_t ackCalls(int64_t m, int64_t n, int64_t& calls) {
+    ++calls;
+    if (m == 0) return n + 1;
+    if (n == 0) return ackCalls(m - 1, 1, calls);
+    return ackCalls(m - 1, ackCalls(m, n - 1, calls), calls);
+}
+
+void report(const std::string& name, const std::string& source, int64_t calls) {
+    std::string interpreted, compiled, native;
+    double interpreterSeconds = timeRun(source, Engine::Interpreter, interpreted);
+    double vmSeconds = timeRun(source, Engine::VM, compiled);
+    double jitSeconds = timeRun(source, Engine::JIT, native);
+
+    std::cout << name << " (" << calls << " calls, result " << compiled.substr(0, compiled.find('\n')) << ")\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "  interpreter: " << std::setw(8) << interpreterSeconds * 1e9 / calls << " ns/call\n"
+              << "  vm:          " << std::setw(8) << vmSeconds * 1e9 / calls << " ns/call\n";
+    if (Jit::supported()) {
+        std::cout << "  vm + jit:    " << std::setw(8) << jitSeconds * 1e9 / calls << " ns/call\n";
+    }
+    if (interpreted != compiled || interpreted != native) {
+        std::cout << "  warning: engines disagree (" << interpreted << " vs " << compiled << " vs " << native << ")\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int64_t fibN = argc > 1 ? std::atoll(argv[1]) : 25;
+    int64_t ackM = argc > 2 ? std::atoll(argv[2]) : 2;
+    int64_t ackN = argc > 3 ? std::atoll(argv[3]) : 300;
+
+    std::cout << "Myndra call benchmark" << std::endl;
+    std::cout << "=====================" << std::endl;
+
+    report("fib(" + std::to_string(fibN) + ")",
+           "fn fib(n: int) -> int {\n"
+           "    if n < 2 { return n; }\n"
+           "    return fib(n - 1) + fib(n - 2);\n"
+           "}\n"
+           "print(fib(" + std::to_string(fibN) + "));\n",
+           fibCalls(fibN));
+
+    int64_t calls = 0;
+    ackCalls(ackM, ackN, calls);
+    report("ackermann(" + std::to_string(ackM) + ", " + std::to_string(ackN) + ")",
+           "fn ack(m: int, n: int) -> int {\n"
+           "    if m == 0 { return n + 1; }\n"
+           "    if n == 0 { return ack(m - 1, 1); }\n"
+           "    return ack(m - 1, ack(m, n - 1));\n"
+           "}\n"
+           "print(ack(" + std::to_string(ackM) + ", " + std::to_string(ackN) + "));\n",
+           calls);
+
+    return 0;
+}
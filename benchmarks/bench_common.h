@@ -0,0 +1,68 @@
+#ifndef MYNDRA_BENCH_COMMON_H
+#define MYNDRA_BENCH_COMMON_H
+
+// Helpers shared by the benchmarks that time whole programs: parsing the
+// generated source and running it on one execution engine.
+
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "interpreter/interpreter.h"
+#include "codegen/bytecode_compiler.h"
+#include "runtime/vm.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace myndra::bench {
+
+// Parses `source`; a benchmark whose source does not parse exits
+inline std::unique_ptr<Program> parse(const std::string& source) {
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    if (lexer.has_errors() || parser.hasErrors()) {
+        std::cerr << "benchmark source failed to parse" << std::endl;
+        std::exit(1);
+    }
+    return program;
+}
+
+enum class Engine { Interpreter, VM, JIT };
+
+// Runs `source` on one engine and returns the elapsed seconds. The JIT
+// engine uses the JIT's default threshold; the VM runs with it off.
+inline double timeRun(const std::string& source, Engine engine, std::string& output) {
+    auto program = parse(source);
+    std::ostringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (engine != Engine::Interpreter) {
+            Jit::Options jit;
+            jit.threshold = engine == Engine::JIT ? jit.threshold : 0;
+            jit.perfMap = false;
+            BytecodeCompiler compiler;
+            VM vm(NativeRegistry::builtins(), 1 << 18, jit);
+            vm.execute(compiler.compile(*program));
+        } else {
+            Interpreter interpreter;
+            interpreter.execute(*program);
+        }
+    } catch (const std::exception& e) {
+        captured << "error: " << e.what();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout.rdbuf(original);
+    output = captured.str();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace myndra::bench
+
+#endif // MYNDRA_BENCH_COMMON_H
@@ -0,0 +1,169 @@
+// Interpreter benchmark: arithmetic-heavy loops (a while loop and the
+// equivalent counted for loop among them) and string building on the
+// tree-walking
+// interpreter with and without quickened binary expressions, and under
+// tiered execution (hot loops and functions promoted to the bytecode VM
+// and its JIT), each also after type checking unboxes proven arithmetic,
+// reported as nanoseconds per loop iteration.
+//
+// Usage: bench_interpreter [iterations]
+
+#include "bench_common.h"
+#include "semantics/type_checker.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace myndra;
+using namespace myndra::bench;
+
+namespace {
+
+// Runs `source` and returns the elapsed seconds
+double timeRun(const std::string& source, bool quicken, uint32_t tierThreshold, bool typed, std::string& output) {
+    auto program = parse(source);
+    if (typed) {
+        TypeChecker(true).check(*program);
+    }
+    std::ostringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        TieringOptions tiering;
+        tiering.threshold = tierThreshold;
+        tiering.perfMap = false;
+        Interpreter interpreter(NativeRegistry::builtins(), quicken, tiering);
+        interpreter.execute(*program);
+    } catch (const std::exception& e) {
+        captured << "error: " << e.what();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout.rdbuf(original);
+    output = captured.str();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void report(const std::string& name, const std::string& source, int64_t iterations) {
+    // Best of three, the loops are short enough to be noisy
+    struct Variant {
+        const char* label;
+        bool quicken;
+        uint32_t tierThreshold;
+        bool typed;
+        double seconds = 1e30;
+        std::string output{};
+    };
+    Variant variants[] = {
+        {"generic:      ", false, 0, false},
+        {"quickened:    ", true, 0, false},
+        {"typed:        ", true, 0, true},
+        {"tiered:       ", true, 500, false},
+        {"typed tiered: ", true, 500, true},
+    };
+    for (int run = 0; run < 3; ++run) {
+        for (Variant& variant : variants) {
+            variant.seconds = std::min(variant.seconds, timeRun(source, variant.quicken, variant.tierThreshold,
+                                                                variant.typed, variant.output));
+        }
+    }
+
+    const Variant& generic = variants[0];
+    std::cout << name << " (" << iterations << " iterations)\n";
+    for (const Variant& variant : variants) {
+        std::cout << std::fixed << std::setprecision(1) << "  " << variant.label << std::setw(8)
+                  << variant.seconds * 1e9 / iterations << " ns/iteration";
+        if (&variant != &generic) {
+            std::cout << " (" << std::setprecision(2) << generic.seconds / variant.seconds << "x)";
+        }
+        std::cout << "\n";
+    }
+    for (const Variant& variant : variants) {
+        if (variant.output != generic.output) {
+            std::cout << "  warning: " << variant.label << "result differs (" << generic.output << " vs "
+                      << variant.output << ")\n";
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int64_t n = argc > 1 ? std::atoll(argv[1]) : 1000000;
+    std::string count = std::to_string(n);
+
+    std::cout << "Myndra interpreter benchmark" << std::endl;
+    std::cout << "============================" << std::endl;
+
+    report("int sum",
+           "let i = 0;\n"
+           "let total = 0;\n"
+           "while i < " + count + " {\n"
+           "    total = total + i * 3 - i / 2;\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print(total);\n",
+           n);
+
+    // The same loop counted by a for range
+    report("int sum, for loop",
+           "let total = 0;\n"
+           "for i in 0.." + count + " {\n"
+           "    total = total + i * 3 - i / 2;\n"
+           "}\n"
+           "print(total);\n",
+           n);
+
+    report("float polynomial",
+           "let i = 0;\n"
+           "let x = 0.0;\n"
+           "let acc = 0.0;\n"
+           "while i < " + count + " {\n"
+           "    acc = acc + x * x * 0.5 - x / 3.0;\n"
+           "    x = x + 0.001;\n"
+           "    if acc > 1000000.0 { acc = acc - 1000000.0; }\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print(acc);\n",
+           n);
+
+    report("string compare",
+           "let i = 0;\n"
+           "let hits = 0;\n"
+           "let key = \"needle\";\n"
+           "while i < " + count + " {\n"
+           "    if key == \"needle\" { hits = hits + 1; }\n"
+           "    if key != \"haystack\" { hits = hits + 1; }\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print(hits);\n",
+           n);
+
+    // Appending to a string; each iteration used to copy the whole log
+    report("string log",
+           "let log = \"\";\n"
+           "for i in 0.." + count + " {\n"
+           "    log = log + \"entry\\n\";\n"
+           "}\n"
+           "print(length(log));\n",
+           n);
+
+    report("calls",
+           "fn step(x: int, y: int) -> int {\n"
+           "    return x + y * 2;\n"
+           "}\n"
+           "let i = 0;\n"
+           "let total = 0;\n"
+           "while i < " + count + " {\n"
+           "    total = step(total, i);\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print(total);\n",
+           n);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Lexer throughput benchmark: tokenizes a corpus with every scan kernel set
+// the CPU supports and reports MB/s.
+//
+// Usage: bench_lexer [file.myn]   (default: a generated multi-MB corpus)
+
+#include "lexer/lexer.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace myndra;
+
+namespace {
+
+// Representative mix of the constructs the scan kernels accelerate: long
+// identifiers, indentation, comments and string literals
+std::string generateCorpus(size_t targetBytes) {
+    std::ostringstream out;
+    for (size_t i = 0; out.tellp() < static_cast<std::streamoff>(targetBytes); ++i) {
+        out << "// Update the simulation state for entity number " << i << " of the scene graph\n"
+            << "fn update_entity_transform_" << i << "(position_x: float, velocity_x: float) -> float {\n"
+            << "    /* integrate with a fixed timestep; the renderer interpolates\n"
+            << "       between the previous and the current state */\n"
+            << "    let accumulated_delta_time = 0.016;\n"
+            << "    let debug_label = \"entity " << i << " transform update \\\"fixed step\\\"\";\n"
+            << "    if (velocity_x > 0.0) { print(debug_label); }\n"
+            << "    return position_x + velocity_x * accumulated_delta_time;\n"
+            << "}\n\n";
+    }
+    return out.str();
+}
+
+double measure(const std::shared_ptr<const SourceBuffer>& source, const ScanKernels& kernels, size_t& tokenCount) {
+    // Repeat until the sample is long enough to time reliably
+    size_t iterations = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        Lexer lexer(source, kernels);
+        tokenCount = lexer.tokenize().size();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.5);
+    return static_cast<double>(source->size()) * iterations / elapsed / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string text;
+    std::string label = "generated corpus";
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open file: " << argv[1] << std::endl;
+            return 1;
+        }
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        label = argv[1];
+    } else {
+        text = generateCorpus(4 * 1024 * 1024);
+    }
+    auto source = SourceBuffer::create(std::move(text));
+
+    std::cout << "Myndra lexer benchmark" << std::endl;
+    std::cout << "======================" << std::endl;
+    std::cout << label << ": " << std::fixed << std::setprecision(2)
+              << source->size() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    double scalarRate = 0.0;
+    for (const ScanKernels* kernels : availableScanKernels()) {
+        size_t tokens = 0;
+        double rate = measure(source, *kernels, tokens);
+        if (scalarRate == 0.0) scalarRate = rate;
+        std::cout << "  " << std::left << std::setw(8) << kernels->name << std::right
+                  << std::setw(9) << std::setprecision(1) << rate << " MB/s  "
+                  << std::setprecision(2) << rate / scalarRate << "x  (" << tokens << " tokens)" << std::endl;
+    }
+    std::cout << "Dispatched kernels: " << scanKernels().name << std::endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Allocator benchmark: the runtime MemoryManager against the system
+// allocator on a churn of runtime-sized objects, single-threaded and with
+// several threads at once. Reports nanoseconds per allocate/free pair and
+// the pool's fragmentation afterwards.
+//
+// Usage: bench_memory [threads] [operations per thread]
+
+#include "runtime/memory.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace myndra;
+
+namespace {
+
+constexpr size_t kWorkingSet = 10000;   // Objects each thread keeps alive
+
+struct SystemAllocator {
+    static void* allocate(size_t size) { return ::operator new(size); }
+    static void deallocate(void* pointer, size_t size) { ::operator delete(pointer, size); }
+};
+
+struct PoolAllocator {
+    static inline MemoryManager* memory = nullptr;
+    static void* allocate(size_t size) { return memory->allocate(size); }
+    static void deallocate(void* pointer, size_t size) { MemoryManager::deallocate(pointer, size); }
+};
+
+// Mostly small sizes, like strings, boxed ints and environments, with an
+// occasional larger block
+size_t nextSize(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t r = state >> 33;
+    return (r & 15) == 0 ? 64 + r % 448 : 16 + r % 64;
+}
+
+// Replaces random members of a working set
+template <typename Allocator>
+void churn(size_t operations, uint64_t seed) {
+    std::vector<std::pair<void*, size_t>> live(kWorkingSet);
+    uint64_t state = seed;
+    for (auto& slot : live) {
+        size_t size = nextSize(state);
+        slot = {Allocator::allocate(size), size};
+        static_cast<unsigned char*>(slot.first)[0] = 1;
+    }
+    for (size_t i = 0; i < operations; ++i) {
+        auto& slot = live[(state >> 40) % kWorkingSet];
+        Allocator::deallocate(slot.first, slot.second);
+        size_t size = nextSize(state);
+        slot = {Allocator::allocate(size), size};
+        static_cast<unsigned char*>(slot.first)[0] = 1;
+    }
+    for (auto& slot : live) {
+        Allocator::deallocate(slot.first, slot.second);
+    }
+}
+
+// Nanoseconds per allocate/free pair with `threads` threads churning at once
+template <typename Allocator>
+double measure(unsigned threads, size_t operations) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(churn<Allocator>, operations, 0x9E3779B97F4A7C15ULL * (t + 1));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (static_cast<double>(operations + kWorkingSet) * threads);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : std::min(hardware, 8u);
+    size_t operations = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 5000000;
+
+    MemoryManager memory;
+    PoolAllocator::memory = &memory;
+
+    std::cout << "Myndra allocator benchmark" << std::endl;
+    std::cout << "==========================" << std::endl;
+    std::cout << operations << " allocate/free pairs per thread, " << kWorkingSet
+              << " live objects per thread" << std::endl;
+
+    for (unsigned count : {1u, threads}) {
+        double system = measure<SystemAllocator>(count, operations);
+        double pool = measure<PoolAllocator>(count, operations);
+        std::cout << "  " << count << (count == 1 ? " thread:  " : " threads: ")
+                  << std::fixed << std::setprecision(1)
+                  << "system " << std::setw(6) << system << " ns/op   "
+                  << "pool " << std::setw(6) << pool << " ns/op   "
+                  << std::setprecision(2) << system / pool << "x" << std::endl;
+        if (threads == 1) break;
+    }
+
+    // Everything was freed, so fragmentation here is all free capacity
+    MemoryManager::Stats stats = memory.stats();
+    std::cout << "Pool: " << stats.allocations << " allocations, " << stats.slabs << " slabs ("
+              << stats.reservedBytes / 1024 << " KB reserved), fragmentation after churn "
+              << std::setprecision(3) << stats.fragmentation() << std::endl;
+
+    // Bulk release hands every slab back at once
+    auto start = std::chrono::steady_clock::now();
+    memory.releaseAll();
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "releaseAll: " << std::setprecision(1) << micros << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Object benchmark: a function summing two properties over an array of
+// objects on the tree-walking interpreter, the bytecode VM and the VM with
+// its baseline JIT, reported as nanoseconds per property read. The objects
+// come in 1, 3 or 8 interleaved shapes, so the two read sites run
+// monomorphic, polymorphic and megamorphic.
+//
+// Usage: bench_objects [objects] [rounds]
+
+#include "bench_common.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace myndra;
+using namespace myndra::bench;
+
+namespace {
+
+// A program building `count` objects of `shapes` shapes, each with x and
+// y, and summing x + y over them `rounds` times
+std::string propertySum(int64_t count, int64_t rounds, int shapes) {
+    std::string push;
+    for (int shape = 0; shape < shapes; ++shape) {
+        std::string extra = shape == 0 ? "" : "p" + std::to_string(shape) + ": 0, ";
+        push += " ps.push({ " + extra + "x: i, y: 1 });";
+    }
+    return "fn total(ps: [Point], n: int) -> int {\n"
+           "    let s = 0;\n"
+           "    for i in 0..n {\n"
+           "        let p = ps[i];\n"
+           "        s = s + p.x + p.y;\n"
+           "    }\n"
+           "    return s;\n"
+           "}\n"
+           "let ps = [];\n"
+           "for i in 0.." + std::to_string(count / shapes) + " {" + push + " }\n"
+           "let n = ps.length();\n"
+           "let sum = 0;\n"
+           "for r in 0.." + std::to_string(rounds) + " { sum = sum + total(ps, n); }\n"
+           "print(sum);\n";
+}
+
+void report(const std::string& name, const std::string& source, int64_t reads) {
+    std::string interpreted, compiled, native;
+    double interpreterSeconds = timeRun(source, Engine::Interpreter, interpreted);
+    double vmSeconds = timeRun(source, Engine::VM, compiled);
+    double jitSeconds = timeRun(source, Engine::JIT, native);
+
+    std::cout << name << " (result " << compiled.substr(0, compiled.find('\n')) << ")\n";
+    std::cout << std::fixed << std::setprecision(2)
+              << "  interpreter: " << std::setw(8) << interpreterSeconds * 1e9 / reads << " ns/read\n"
+              << "  vm:          " << std::setw(8) << vmSeconds * 1e9 / reads << " ns/read\n";
+    if (Jit::supported()) {
+        std::cout << "  vm + jit:    " << std::setw(8) << jitSeconds * 1e9 / reads << " ns/read\n";
+    }
+    if (interpreted != compiled || interpreted != native) {
+        std::cout << "  warning: engines disagree (" << interpreted << " vs " << compiled << " vs " << native << ")\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int64_t count = argc > 1 ? std::atoll(argv[1]) : 24000;
+    int64_t rounds = argc > 2 ? std::atoll(argv[2]) : 50;
+
+    std::cout << "Myndra object benchmark" << std::endl;
+    std::cout << "=======================" << std::endl;
+
+    for (int shapes : {1, 3, 8}) {
+        const char* site = shapes == 1 ? "monomorphic" : shapes == 3 ? "polymorphic" : "megamorphic";
+        int64_t objects = count / shapes * shapes;
+        report(std::string("x + y, ") + std::to_string(shapes) + " shapes (" + site + ")",
+               propertySum(count, rounds, shapes), objects * rounds * 2);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Parser throughput benchmark: parses a generated corpus of expression
+// statements (operators of every precedence level, unary operators,
+// parentheses, calls) and reports tokens/s. The corpus is lexed once; only
+// parsing is timed.
+//
+// Usage: bench_parser [expressions]   (default: 1000000)
+
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace myndra;
+
+namespace {
+
+// Deterministic expressions of up to `depth` nested binary operators
+class ExpressionGenerator {
+public:
+    void expression(std::ostringstream& out, int depth) {
+        static const char* const kOperators[] = {
+            " + ", " - ", " * ", " / ", " % ", " == ", " != ", " < ", " <= ", " > ", " >= ", " and ", " or ",
+        };
+        if (depth == 0 || next() % 4 == 0) {
+            operand(out, depth);
+            return;
+        }
+        bool parenthesized = next() % 3 == 0;
+        if (parenthesized) out << '(';
+        expression(out, depth - 1);
+        out << kOperators[next() % std::size(kOperators)];
+        expression(out, depth - 1);
+        if (parenthesized) out << ')';
+    }
+
+private:
+    uint64_t state_ = 0x9E3779B97F4A7C15ull;
+
+    uint32_t next() {
+        state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(state_ >> 33);
+    }
+
+    void operand(std::ostringstream& out, int depth) {
+        static const char* const kNames[] = {"alpha", "beta", "count", "total", "x", "y", "limit", "done"};
+        switch (next() % 8) {
+            case 0: out << next() % 1000; break;
+            case 1: out << next() % 100 << '.' << next() % 100; break;
+            case 2: out << "\"s" << next() % 10 << '"'; break;
+            case 3: out << (next() % 2 ? "not " : "-") << kNames[next() % std::size(kNames)]; break;
+            case 4:
+                out << "f" << next() % 4 << '(';
+                expression(out, std::max(depth - 2, 0));
+                out << ", " << kNames[next() % std::size(kNames)] << ')';
+                break;
+            default: out << kNames[next() % std::size(kNames)]; break;
+        }
+    }
+};
+
+std::string generateCorpus(size_t expressions) {
+    ExpressionGenerator generator;
+    std::ostringstream out;
+    for (size_t i = 0; i < expressions; ++i) {
+        out << "result = ";
+        generator.expression(out, 3);
+        out << ";\n";
+    }
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t expressions = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "Myndra parser benchmark" << std::endl;
+    std::cout << "=======================" << std::endl;
+
+    Lexer lexer(generateCorpus(expressions));
+    TokenStream tokens = lexer.tokenize();
+    if (lexer.has_errors()) {
+        std::cerr << "benchmark corpus failed to lex" << std::endl;
+        return 1;
+    }
+    std::cout << expressions << " expressions, " << tokens.size() << " tokens, " << std::fixed
+              << std::setprecision(2) << tokens.source().size() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    // Best of three
+    double best = 1e30;
+    size_t nodes = 0;
+    for (int run = 0; run < 3; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        Parser parser(tokens);
+        auto program = parser.parseProgram();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (parser.hasErrors() || program->statements().size() != expressions) {
+            std::cerr << "benchmark corpus failed to parse" << std::endl;
+            return 1;
+        }
+        nodes = program->nodeCount();
+        best = std::min(best, elapsed);
+    }
+
+    std::cout << "  parse:  " << std::setprecision(1) << std::setw(8) << best * 1e3 << " ms  ("
+              << nodes << " nodes)" << std::endl;
+    std::cout << "  rate:   " << std::setprecision(2) << std::setw(8) << tokens.size() / best / 1e6
+              << " M tokens/s, " << expressions / best / 1e6 << " M expressions/s" << std::endl;
+    return 0;
+}
@@ -146,6 +146,55 @@ enum class ExecutionModel {
     TEMPORAL
 };
 
+// Execution engine used to run compiled programs
+enum class ExecutionEngine {
+    INTERPRETER,   // AST-walking reference interpreter
+    BYTECODE_VM,   // Register-based bytecode virtual machine
+    TIERED         // Interpreter that promotes hot functions and loops to the VM
+};
+
+// Artifact written by the native (LLVM) backend
+enum class NativeOutput {
+    OBJECT,       // Object file defining main(), to link with myndra_runtime
+    EXECUTABLE    // Standalone executable
+};
+
+// Module cache activity of one Compiler
+struct ModuleCacheStats {
+    size_t hits = 0;     // Programs mapped from the cache, skipping lexing and parsing
+    size_t misses = 0;   // Programs parsed from source
+    size_t writes = 0;   // Entries written after a miss
+};
+
+// Garbage collector activity of one Compiler
+struct GcStats {
+    // Pause histogram: bucket i counts pauses shorter than
+    // kPauseBucketLimitsUs[i] microseconds, the last bucket the rest
+    static constexpr size_t kPauseBuckets = 8;
+    static constexpr size_t kPauseBucketLimitsUs[kPauseBuckets - 1] = {10, 50, 100, 500, 1000, 5000, 10000};
+    
+    size_t minor_collections = 0;
+    size_t major_collections = 0;      // Completed incremental old-generation cycles
+    size_t incremental_slices = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_promoted = 0;         // Survived the nursery
+    size_t objects_collected = 0;      // Freed as garbage cycles
+    size_t live_bytes = 0;
+    size_t reserved_bytes = 0;         // Chunk memory held from the system
+    double total_pause_ms = 0.0;
+    double max_pause_ms = 0.0;
+    size_t pause_histogram[kPauseBuckets] = {};
+};
+
+// Runtime memory of one Compiler
+struct MemoryStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t live_bytes = 0;       // Requested by live objects
+    size_t reserved_bytes = 0;   // Held from the system
+    double fragmentation = 0.0;  // Share of reserved bytes not holding live data
+};
+
 // DSL block
 struct DSLBlock {
     std::string language; // "shader", "query", "markup", etc.
@@ -153,6 +202,9 @@ struct DSLBlock {
     std::unordered_map<std::string, Value> bindings;
 };
 
+// Host (C++) function callable from Myndra code
+using NativeFunction = std::function<Value(const std::vector<Value>& args)>;
+
 // Main compiler interface
 class Compiler {
 public:
@@ -163,21 +215,42 @@ public:
         bool enable_temporal = true;
         bool enable_did = true;
         std::vector<std::string> capability_whitelist;
+        ExecutionEngine engine = ExecutionEngine::TIERED;
+        std::string module_cache_dir;      // Parsed programs are cached here when set
+        bool report_module_cache = false;  // Print each cache hit and miss
+        size_t gc_nursery_bytes = 1 << 20;  // Allocation between minor collections
+        size_t gc_pause_budget_us = 1000;   // Longest incremental collector slice
+        uint32_t jit_threshold = 1000;      // Calls plus loop iterations before a VM function is compiled; 0 disables the JIT
+        bool jit_perf_map = true;           // Name compiled functions in /tmp/perf-<pid>.map
+        uint32_t tier_threshold = 500;      // Calls, or loop iterations, before the tiered engine moves code to the VM
+        bool trace_tiering = false;         // Log every tier transition to stderr
+        bool fold_constants = true;         // Fold constants and simplify identities before running
+        bool check_types = true;            // Infer types, report type errors and unbox proven arithmetic
+        bool whole_program = false;         // Only one program is compiled, so its functions can be typed by their calls
     };
     
-    explicit Compiler(const Options& opts = {});
+    Compiler();
+    explicit Compiler(const Options& opts);
     ~Compiler();
     
     // Core compilation pipeline
     bool compile_file(const std::string& filename);
     bool compile_string(const std::string& source);
     
+    // Compiles a file ahead of time to native code instead of running it;
+    // fails with an error when the build has no LLVM backend
+    bool emit_native(const std::string& filename, NativeOutput kind, const std::string& output_path);
+    
     // Runtime execution
     Value execute();
     Value execute_capsule(const std::string& name, const std::vector<Value>& args);
     
     // Live features
     bool reload_capsule(const std::string& name, const std::string& new_code);
+    // Switches the context `expr if context == "..."` tests against. Code
+    // compiled since is built for the new context; functions defined
+    // earlier are re-specialized as they are next called (under the
+    // bytecode VM engine they keep the context they were compiled for)
     bool update_context(const ExecutionContext& new_context);
     
     // Package management
@@ -188,6 +261,18 @@ public:
     std::shared_ptr<Observable> create_observable(const Value& initial_value);
     bool bind_reactive(const std::string& var_name, std::shared_ptr<Observable> observable);
     
+    // Native functions; registering an existing name replaces it
+    bool register_native(const std::string& name, NativeFunction function);
+    
+    // Module cache
+    ModuleCacheStats get_module_cache_stats() const;
+    
+    // Garbage collection
+    GcStats get_gc_stats() const;
+    
+    // Memory
+    MemoryStats get_memory_stats() const;
+    
     // Error handling
     void set_global_fallback(const FallbackStrategy& strategy);
     std::vector<std::string> get_errors() const;
@@ -0,0 +1,214 @@
+#include "module_cache.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace myndra {
+
+namespace {
+
+// Bump whenever a node struct, ProgramLayout or the entry layout changes
+constexpr uint32_t kFormatVersion = 10;
+constexpr char kMagic[8] = {'M', 'Y', 'N', 'D', 'R', 'A', 'M', '\0'};
+
+// Precedes the program block in an entry file. 64 bytes, so the block
+// that follows keeps the 8-byte alignment of the mapping. The source the
+// block was parsed from follows the block, and a load only hits if it
+// matches byte for byte; the hash just picks the file. The block itself
+// must match its checksum, so damage that still passes adopt()'s checks
+// (a flipped literal or identifier byte) is a miss as well.
+struct ModuleHeader {
+    char magic[8];
+    uint32_t format;
+    uint32_t layoutBytes;          // sizeof(ProgramLayout) of the writer
+    char compilerVersion[16];
+    uint64_t sourceHash;
+    uint64_t sourceBytes;
+    uint64_t blockBytes;
+    uint64_t blockHash;            // contentHash() of the block
+};
+static_assert(sizeof(ModuleHeader) == 64);
+
+ModuleHeader expectedHeader(std::string_view source) {
+    ModuleHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.format = kFormatVersion;
+    header.layoutBytes = sizeof(ProgramLayout);
+    std::strncpy(header.compilerVersion, MYNDRA_VERSION, sizeof(header.compilerVersion) - 1);
+    header.sourceHash = contentHash(source);
+    header.sourceBytes = source.size();
+    return header;
+}
+
+long long processId() {
+#ifdef _WIN32
+    return static_cast<long long>(GetCurrentProcessId());
+#else
+    return static_cast<long long>(getpid());
+#endif
+}
+
+// Checks a mapped entry against `source`; the block is only adopted if
+// this passes
+bool matches(const unsigned char* bytes, size_t length, std::string_view source) {
+    if (length < sizeof(ModuleHeader) || length - sizeof(ModuleHeader) < source.size()) {
+        return false;
+    }
+    ModuleHeader expected = expectedHeader(source);
+    expected.blockBytes = length - sizeof(ModuleHeader) - source.size();
+    // The checksum is compared last, since it reads the whole block
+    std::memcpy(&expected.blockHash, bytes + offsetof(ModuleHeader, blockHash), sizeof(expected.blockHash));
+    const unsigned char* block = bytes + sizeof(ModuleHeader);
+    return std::memcmp(bytes, &expected, sizeof(expected)) == 0 &&
+           std::memcmp(block + expected.blockBytes, source.data(), source.size()) == 0 &&
+           contentHash({reinterpret_cast<const char*>(block), expected.blockBytes}) == expected.blockHash;
+}
+
+// The mapping starts at the entry header, just before the block, and ends
+// with the source
+void releaseMapping(unsigned char* block, size_t size) {
+    unsigned char* start = block - sizeof(ModuleHeader);
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(start);
+#else
+    ModuleHeader header;
+    std::memcpy(&header, start, sizeof(header));
+    munmap(start, sizeof(ModuleHeader) + size + header.sourceBytes);
+#endif
+}
+
+} // namespace
+
+uint64_t contentHash(std::string_view content) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : content) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+ModuleCache::ModuleCache(std::string directory) : directory_(std::move(directory)) {}
+
+std::string ModuleCache::entryPath(std::string_view source) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%s.mynm",
+                  static_cast<unsigned long long>(contentHash(source)), MYNDRA_VERSION);
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+std::unique_ptr<Program> ModuleCache::load(std::string_view source) const {
+    // Private and writable: the resolver annotates nodes in place, and
+    // those writes must never reach the file
+#ifdef _WIN32
+    HANDLE file = CreateFileA(entryPath(source).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) < sizeof(ModuleHeader)) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    size_t length = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE section = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!section) {
+        return nullptr;
+    }
+    void* mapping = MapViewOfFile(section, FILE_MAP_COPY, 0, 0, length);
+    CloseHandle(section);  // The view keeps the section alive
+    if (!mapping) {
+        return nullptr;
+    }
+    auto unmap = [mapping] { UnmapViewOfFile(mapping); };
+#else
+    int fd = open(entryPath(source).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ModuleHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto unmap = [mapping, length] { munmap(mapping, length); };
+#endif
+
+    auto* bytes = static_cast<unsigned char*>(mapping);
+    if (!matches(bytes, length, source)) {
+        unmap();
+        return nullptr;
+    }
+    try {
+        return Program::adopt(bytes + sizeof(ModuleHeader), length - sizeof(ModuleHeader) - source.size(),
+                              releaseMapping);
+    } catch (const std::runtime_error&) {
+        // adopt() already handed the mapping back
+        return nullptr;
+    }
+}
+
+bool ModuleCache::store(std::string_view source, const Program& program) const {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        return false;
+    }
+
+    ModuleHeader header = expectedHeader(source);
+    auto block = program.bytes();
+    header.blockBytes = block.size();
+    header.blockHash = contentHash({reinterpret_cast<const char*>(block.data()), block.size()});
+
+    // Write under a name private to this store (several Compilers in one
+    // process may store the same entry at once), then rename over the entry
+    static std::atomic<uint64_t> sequence{0};
+    std::string path = entryPath(source);
+    std::string temporary = path + ".tmp" + std::to_string(processId()) + "-" + std::to_string(sequence++);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+        out.write(source.data(), static_cast<std::streamsize>(source.size()));
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace myndra
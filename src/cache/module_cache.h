@@ -0,0 +1,49 @@
+#ifndef MYNDRA_MODULE_CACHE_H
+#define MYNDRA_MODULE_CACHE_H
+
+#include "parser/ast.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace myndra {
+
+// Stable 64-bit content hash (FNV-1a); the same bytes hash the same way on
+// every run and platform
+uint64_t contentHash(std::string_view content);
+
+// On-disk cache of parsed programs.
+//
+// An entry is a small header, the program block exactly as the parser laid
+// it out (see ProgramLayout) and the source it came from, stored under a
+// name derived from the source hash and the compiler version. A hash
+// collision therefore only costs a miss. Loading an entry maps the file
+// copy-on-write and adopts the block in place, so an unchanged script skips
+// lexing and parsing entirely. Programs are stored before resolution, since
+// slot addresses and native ids depend on the session that resolves them.
+class ModuleCache {
+public:
+    // Entries are written to, and looked up in, `directory`
+    explicit ModuleCache(std::string directory);
+
+    // File holding the entry for `source`
+    std::string entryPath(std::string_view source) const;
+
+    // Maps the entry for `source`, or returns null on a miss. Entries with a
+    // different version, source or layout, or a block that fails its
+    // checksum, count as misses.
+    std::unique_ptr<Program> load(std::string_view source) const;
+
+    // Writes `program`, freshly parsed from `source`, as its entry. The file
+    // is renamed into place so readers never see a partial entry. Returns
+    // false if the entry could not be written.
+    bool store(std::string_view source, const Program& program) const;
+
+private:
+    std::string directory_;
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_MODULE_CACHE_H
@@ -0,0 +1,1142 @@
+#include "bytecode_compiler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace myndra {
+
+namespace {
+
+// True if evaluating `expr` can write a variable or call out, which means a
+// left operand cannot be read straight from its local register.
+bool hasSideEffects(const Program& program, NodeRef expr) {
+    switch (expr.kind()) {
+        case NodeKind::BinaryExpression: {
+            const auto& binary = program.node<BinaryExpression>(expr);
+            return binary.op == BinaryOperator::Assign ||
+                   hasSideEffects(program, binary.left) || hasSideEffects(program, binary.right);
+        }
+        case NodeKind::UnaryExpression:
+            return hasSideEffects(program, program.node<UnaryExpression>(expr).operand);
+        case NodeKind::FunctionCall:
+            return true;
+        case NodeKind::ArrayAccess: {
+            const auto& access = program.node<ArrayAccess>(expr);
+            return hasSideEffects(program, access.array) || hasSideEffects(program, access.index);
+        }
+        case NodeKind::ArrayLiteral:
+            for (NodeRef element : program.list(program.node<ArrayLiteral>(expr).elements)) {
+                if (hasSideEffects(program, element)) {
+                    return true;
+                }
+            }
+            return false;
+        case NodeKind::ObjectLiteral:
+            for (NodeRef property : program.list(program.node<ObjectLiteral>(expr).properties)) {
+                if (hasSideEffects(program, program.node<ObjectProperty>(property).value)) {
+                    return true;
+                }
+            }
+            return false;
+        case NodeKind::MemberAccess:
+            return hasSideEffects(program, program.node<MemberAccess>(expr).object);
+        default:
+            return false;
+    }
+}
+
+OpCode binaryOpCode(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::Add: return OpCode::ADD;
+        case BinaryOperator::Sub: return OpCode::SUB;
+        case BinaryOperator::Mul: return OpCode::MUL;
+        case BinaryOperator::Div: return OpCode::DIV;
+        case BinaryOperator::Eq: return OpCode::EQ;
+        case BinaryOperator::Ne: return OpCode::NE;
+        case BinaryOperator::Lt: return OpCode::LT;
+        case BinaryOperator::Le: return OpCode::LE;
+        case BinaryOperator::Gt: return OpCode::GT;
+        case BinaryOperator::Ge: return OpCode::GE;
+        case BinaryOperator::And: return OpCode::AND;
+        case BinaryOperator::Or: return OpCode::OR;
+        default: return OpCode::COUNT;
+    }
+}
+
+// Unguarded variant for operands proven to be doubles, or COUNT if none
+OpCode floatOpCode(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::Add: return OpCode::ADD_FLOAT;
+        case BinaryOperator::Sub: return OpCode::SUB_FLOAT;
+        case BinaryOperator::Mul: return OpCode::MUL_FLOAT;
+        case BinaryOperator::Div: return OpCode::DIV_FLOAT;
+        case BinaryOperator::Lt: return OpCode::LT_FLOAT;
+        case BinaryOperator::Le: return OpCode::LE_FLOAT;
+        case BinaryOperator::Gt: return OpCode::GT_FLOAT;
+        case BinaryOperator::Ge: return OpCode::GE_FLOAT;
+        default: return OpCode::COUNT;
+    }
+}
+
+// Facts about a loop body that decide whether its array indexes can skip
+// their bounds checks
+struct LoopScan {
+    const Program& program;
+    Atom variable;                            // The loop's variable
+    std::vector<Atom> bound{};                // Names assigned or declared
+    std::vector<const Identifier*> indexed{}; // Arrays indexed by `variable`
+    std::vector<const Identifier*> callees{}; // Called by name; must be safe natives
+    bool opaque = false;                      // Can do anything to any array
+
+    void statement(NodeRef stmt) {
+        switch (stmt.kind()) {
+            case NodeKind::ExpressionStatement:
+                expression(program.node<ExpressionStatement>(stmt).expression);
+                break;
+            case NodeKind::VariableDeclaration: {
+                const auto& declaration = program.node<VariableDeclaration>(stmt);
+                bound.push_back(declaration.name);
+                expression(declaration.initializer);
+                break;
+            }
+            case NodeKind::Block:
+                for (NodeRef inner : program.list(program.node<Block>(stmt).statements)) {
+                    statement(inner);
+                }
+                break;
+            case NodeKind::ReturnStatement:
+                expression(program.node<ReturnStatement>(stmt).value);
+                break;
+            case NodeKind::IfStatement: {
+                const auto& branch = program.node<IfStatement>(stmt);
+                expression(branch.condition);
+                statement(branch.then_branch);
+                statement(branch.else_branch);
+                break;
+            }
+            case NodeKind::WhileStatement: {
+                const auto& loop = program.node<WhileStatement>(stmt);
+                expression(loop.condition);
+                statement(loop.body);
+                break;
+            }
+            case NodeKind::ForStatement: {
+                const auto& loop = program.node<ForStatement>(stmt);
+                bound.push_back(loop.variable);
+                expression(loop.start);
+                expression(loop.end);
+                statement(loop.body);
+                break;
+            }
+            default:
+                // Function definitions, and anything else, are not looked into
+                if (stmt) {
+                    opaque = true;
+                }
+                break;
+        }
+    }
+
+    void expression(NodeRef expr) {
+        switch (expr.kind()) {
+            case NodeKind::BinaryExpression: {
+                const auto& binary = program.node<BinaryExpression>(expr);
+                if (binary.op == BinaryOperator::Assign && binary.left.kind() == NodeKind::Identifier) {
+                    bound.push_back(program.node<Identifier>(binary.left).name);
+                } else {
+                    expression(binary.left);
+                }
+                expression(binary.right);
+                break;
+            }
+            case NodeKind::UnaryExpression:
+                expression(program.node<UnaryExpression>(expr).operand);
+                break;
+            case NodeKind::ArrayAccess: {
+                const auto& access = program.node<ArrayAccess>(expr);
+                if (access.array.kind() == NodeKind::Identifier && access.index.kind() == NodeKind::Identifier &&
+                    program.node<Identifier>(access.index).name == variable) {
+                    indexed.push_back(&program.node<Identifier>(access.array));
+                }
+                expression(access.array);
+                expression(access.index);
+                break;
+            }
+            case NodeKind::ArrayLiteral:
+                for (NodeRef element : program.list(program.node<ArrayLiteral>(expr).elements)) {
+                    expression(element);
+                }
+                break;
+            case NodeKind::ObjectLiteral:
+                for (NodeRef property : program.list(program.node<ObjectLiteral>(expr).properties)) {
+                    expression(program.node<ObjectProperty>(property).value);
+                }
+                break;
+            case NodeKind::MemberAccess:
+                expression(program.node<MemberAccess>(expr).object);
+                break;
+            case NodeKind::ContextConditional:
+                expression(program.node<ContextConditional>(expr).expression);
+                break;
+            case NodeKind::FunctionCall: {
+                const auto& call = program.node<FunctionCall>(expr);
+                if (call.function.kind() == NodeKind::Identifier) {
+                    callees.push_back(&program.node<Identifier>(call.function));
+                } else if (call.function.kind() == NodeKind::MemberAccess) {
+                    const auto& method = program.node<MemberAccess>(call.function);
+                    if (shrinks(program.text(method.member))) {
+                        opaque = true;
+                    }
+                    expression(method.object);
+                } else {
+                    opaque = true;
+                }
+                for (NodeRef argument : program.list(call.arguments)) {
+                    expression(argument);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Natives that remove elements
+    static bool shrinks(std::string_view name) { return name == "pop" || name == "shift"; }
+};
+
+bool contains(const std::vector<Atom>& names, Atom name) {
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+// Deepest nesting of loops compiled twice, which doubles the code each level
+constexpr uint32_t kMaxVersionedLoops = 3;
+// Most arrays one loop guards
+constexpr size_t kMaxProvenArrays = 4;
+
+} // namespace
+
+BytecodeCompiler::BytecodeCompiler(const NativeRegistry& natives)
+    : natives_(natives), functions_(1), program_(nullptr), chunk_(nullptr) {}
+
+Chunk BytecodeCompiler::compile(Program& program) {
+    Chunk chunk;
+    functions_.resize(1); // Drop state left behind by a failed compile
+    chunk_ = functions_[0].chunk = &chunk;
+    chunk.register_count = functions_[0].nextRegister;
+    program_ = &program;
+
+    // Top-level locals are never released so they persist between compiles
+    compileStatements(program.statements());
+    emit(Instruction(OpCode::HALT, 0));
+
+    chunk_ = functions_[0].chunk = nullptr;
+    program_ = nullptr;
+    return chunk;
+}
+
+std::unique_ptr<FunctionProto> BytecodeCompiler::compileHotFunction(Program& program,
+                                                                   const FunctionDefinition& function) {
+    auto proto = std::make_unique<FunctionProto>();
+    proto->name = std::string(program.text(function.name));
+    proto->arity = function.parameters.count;
+
+    // The frame is the register window: parameters at the bottom, then the
+    // other slots, which start out as 0 like a tree-walker frame
+    beginResolved(program, &proto->chunk, function.frame_size, false);
+    for (uint32_t slot = proto->arity; slot < function.frame_size; ++slot) {
+        emitConstant(static_cast<uint16_t>(slot), int64_t(0));
+    }
+    if (function.body) {
+        compileStatement(function.body);
+    }
+    uint16_t result = allocateRegister();
+    emitConstant(result, int64_t(0));
+    emit(Instruction(OpCode::RETURN, result));
+    return endResolved() ? std::move(proto) : nullptr;
+}
+
+std::unique_ptr<Chunk> BytecodeCompiler::compileHotLoop(Program& program, NodeRef loop,
+                                                        const FunctionDefinition* function) {
+    // The top-level frame is the globals, so the loop gets no frame slots
+    auto chunk = std::make_unique<Chunk>();
+    beginResolved(program, chunk.get(), function ? function->frame_size : 0, function == nullptr);
+    if (loop.kind() == NodeKind::ForStatement) {
+        compileFor(program.node<ForStatement>(loop), true);
+    } else {
+        compileWhile(program.node<WhileStatement>(loop));
+    }
+    emit(Instruction(OpCode::HALT, 0));
+    return endResolved() ? std::move(chunk) : nullptr;
+}
+
+void BytecodeCompiler::beginResolved(Program& program, Chunk* chunk, uint32_t frameSize, bool topLevel) {
+    // A function body is compiled one level down, so returns leave its frame
+    functions_.assign(topLevel ? 1 : 2, FunctionState());
+    unsupported_ = frameSize >= UINT16_MAX;
+    current().nextRegister = static_cast<uint16_t>(unsupported_ ? 0 : frameSize);
+    chunk_ = current().chunk = chunk;
+    chunk->register_count = current().nextRegister;
+    program_ = &program;
+    resolved_ = true;
+    topLevel_ = topLevel;
+}
+
+bool BytecodeCompiler::endResolved() {
+    functions_.assign(1, FunctionState());
+    chunk_ = nullptr;
+    program_ = nullptr;
+    resolved_ = false;
+    return !unsupported_;
+}
+
+// Register management
+uint16_t BytecodeCompiler::allocateRegister() {
+    FunctionState& state = current();
+    if (state.nextRegister == UINT16_MAX) {
+        throw std::runtime_error("Too many registers required by a single chunk");
+    }
+    uint16_t reg = state.nextRegister++;
+    if (state.nextRegister > chunk_->register_count) {
+        chunk_->register_count = state.nextRegister;
+    }
+    return reg;
+}
+
+void BytecodeCompiler::releaseRegisters(uint16_t mark) {
+    current().nextRegister = mark;
+}
+
+// Scopes
+void BytecodeCompiler::beginScope() {
+    current().scopeStarts.push_back(current().locals.size());
+}
+
+void BytecodeCompiler::endScope() {
+    FunctionState& state = current();
+    size_t start = state.scopeStarts.back();
+    state.scopeStarts.pop_back();
+
+    if (start < state.locals.size()) {
+        releaseRegisters(state.locals[start].reg);
+    }
+    state.locals.resize(start);
+}
+
+bool BytecodeCompiler::findLocal(const std::vector<Local>& locals, Atom name, uint16_t& reg) {
+    for (auto it = locals.rbegin(); it != locals.rend(); ++it) {
+        if (it->name == name) {
+            reg = it->reg;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BytecodeCompiler::resolveLocal(Atom name, uint16_t& reg) const {
+    return findLocal(current().locals, name, reg);
+}
+
+BytecodeCompiler::VariableKind BytecodeCompiler::resolveVariable(Atom name, uint16_t& reg) const {
+    if (resolveLocal(name, reg)) {
+        return VariableKind::Local;
+    }
+    // Functions do not capture, so locals of an enclosing function are out
+    // of reach; only the top level is addressable from a nested frame.
+    for (size_t level = functions_.size() - 1; level-- > 1;) {
+        if (findLocal(functions_[level].locals, name, reg)) {
+            return VariableKind::Enclosing;
+        }
+    }
+    if (functions_.size() > 1 && findLocal(functions_[0].locals, name, reg)) {
+        return VariableKind::Global;
+    }
+    return VariableKind::Unresolved;
+}
+
+BytecodeCompiler::VariableKind BytecodeCompiler::resolveIdentifier(const Identifier& node, uint16_t& reg) {
+    if (resolved_) {
+        return resolveSlot(node.address, reg);
+    }
+    return resolveVariable(node.name, reg);
+}
+
+BytecodeCompiler::VariableKind BytecodeCompiler::resolveSlot(const SlotAddress& address, uint16_t& reg) {
+    if (!address.isResolved()) {
+        return VariableKind::Unresolved;
+    }
+    if (address.slot >= UINT16_MAX) {
+        unsupported_ = true;
+    }
+    reg = static_cast<uint16_t>(address.slot);
+    // The tree walker keeps top-level variables in the global frame
+    if (address.isGlobal() || (address.depth == 0 && topLevel_)) {
+        return VariableKind::Global;
+    }
+    return address.depth == 0 ? VariableKind::Local : VariableKind::Enclosing;
+}
+
+void BytecodeCompiler::hoistFunctions(std::span<const NodeRef> statements) {
+    // Reserve a register for every function of the block up front so bodies
+    // can call functions defined later (and themselves)
+    for (NodeRef stmt : statements) {
+        if (stmt.kind() == NodeKind::FunctionDefinition) {
+            const auto& function = program_->node<FunctionDefinition>(stmt);
+            uint16_t reg = allocateRegister();
+            emitConstant(reg, int64_t(0));
+            current().locals.push_back({function.name, reg});
+            hoisted_[&function] = reg;
+        }
+    }
+}
+
+// Emission helpers
+size_t BytecodeCompiler::emit(const Instruction& instruction) {
+    return chunk_->emit(instruction);
+}
+
+size_t BytecodeCompiler::emitJump(OpCode op, uint16_t reg) {
+    return emit(Instruction::wide(op, reg, 0));
+}
+
+void BytecodeCompiler::patchJump(size_t at) {
+    chunk_->code[at].setBx(static_cast<uint32_t>(chunk_->code.size()));
+}
+
+void BytecodeCompiler::emitConstant(uint16_t dest, const RuntimeValue& value) {
+    emit(Instruction::wide(OpCode::LOAD_CONST, dest, chunk_->addConstant(value)));
+}
+
+void BytecodeCompiler::emitRaise(const std::string& message) {
+    emit(Instruction::wide(OpCode::RAISE, 0, chunk_->addConstant(message)));
+}
+
+// Expressions
+void BytecodeCompiler::compileExpression(NodeRef expr, uint16_t dest) {
+    const Program& program = *program_;
+    switch (expr.kind()) {
+        case NodeKind::IntegerLiteral:
+            emitConstant(dest, program.node<IntegerLiteral>(expr).value);
+            break;
+        case NodeKind::FloatLiteral:
+            emitConstant(dest, program.node<FloatLiteral>(expr).value);
+            break;
+        case NodeKind::StringLiteral:
+            emitConstant(dest, std::string(program.text(program.node<StringLiteral>(expr).value)));
+            break;
+        case NodeKind::BooleanLiteral:
+            emitConstant(dest, program.node<BooleanLiteral>(expr).value);
+            break;
+        case NodeKind::Identifier:
+            compileIdentifier(program.node<Identifier>(expr), dest);
+            break;
+        case NodeKind::BinaryExpression:
+            compileBinary(program.node<BinaryExpression>(expr), dest);
+            break;
+        case NodeKind::UnaryExpression:
+            compileUnary(program.node<UnaryExpression>(expr), dest);
+            break;
+        case NodeKind::FunctionCall:
+            compileCall(program.node<FunctionCall>(expr), dest);
+            break;
+        case NodeKind::ArrayAccess:
+            compileArrayAccess(program.node<ArrayAccess>(expr), dest);
+            break;
+        case NodeKind::ArrayLiteral:
+            compileArrayLiteral(program.node<ArrayLiteral>(expr), dest);
+            break;
+        case NodeKind::ObjectLiteral:
+            compileObjectLiteral(program.node<ObjectLiteral>(expr), dest);
+            break;
+        case NodeKind::MemberAccess: {
+            const auto& access = program.node<MemberAccess>(expr);
+            uint16_t mark = current().nextRegister;
+            uint16_t object = compileOperand(access.object);
+            emit(Instruction(OpCode::GET_MEMBER, dest, object, addPropertySite(access.member)));
+            releaseRegisters(mark);
+            break;
+        }
+        case NodeKind::ContextConditional: {
+            const auto& conditional = program.node<ContextConditional>(expr);
+            if (contextMatches(conditional)) {
+                compileExpression(conditional.expression, dest);
+            } else {
+                emitConstant(dest, RuntimeValue());
+            }
+            break;
+        }
+        default:
+            emitRaise("Invalid expression");
+            break;
+    }
+}
+
+bool BytecodeCompiler::contextMatches(const ContextConditional& node) const {
+    return program_->text(node.context) == context_;
+}
+
+uint16_t BytecodeCompiler::compileOperand(NodeRef expr) {
+    // Locals are read in place; everything else lands in a fresh temporary
+    if (expr.kind() == NodeKind::Identifier) {
+        uint16_t reg;
+        if (resolveIdentifier(program_->node<Identifier>(expr), reg) == VariableKind::Local) {
+            return reg;
+        }
+    }
+    uint16_t temp = allocateRegister();
+    compileExpression(expr, temp);
+    return temp;
+}
+
+void BytecodeCompiler::compileOperands(NodeRef left, NodeRef right, uint16_t& leftReg, uint16_t& rightReg) {
+    // The tree walker evaluates the left operand before the right one; only
+    // read a local in place if the right side cannot overwrite it.
+    if (hasSideEffects(*program_, right)) {
+        leftReg = allocateRegister();
+        compileExpression(left, leftReg);
+    } else {
+        leftReg = compileOperand(left);
+    }
+    rightReg = compileOperand(right);
+}
+
+void BytecodeCompiler::compileIdentifier(const Identifier& node, uint16_t dest) {
+    uint16_t reg;
+    switch (resolveIdentifier(node, reg)) {
+        case VariableKind::Local:
+            if (reg != dest) {
+                emit(Instruction(OpCode::MOVE, dest, reg));
+            }
+            break;
+        case VariableKind::Global:
+            emit(Instruction::wide(OpCode::GET_GLOBAL, dest, reg));
+            break;
+        default:
+            emitRaise("Undefined variable '" + std::string(program_->text(node.name)) + "'");
+            break;
+    }
+}
+
+void BytecodeCompiler::compileBinary(const BinaryExpression& node, uint16_t dest) {
+    uint16_t mark = current().nextRegister;
+
+    if (node.op == BinaryOperator::Assign) {
+        if (node.left.kind() == NodeKind::ArrayAccess) {
+            compileIndexStore(program_->node<ArrayAccess>(node.left), node.right, dest);
+            return;
+        }
+        if (node.left.kind() == NodeKind::MemberAccess) {
+            compileMemberStore(program_->node<MemberAccess>(node.left), node.right, dest);
+            return;
+        }
+        if (node.left.kind() != NodeKind::Identifier) {
+            emitRaise("Invalid assignment target");
+            releaseRegisters(mark);
+            return;
+        }
+        const auto& target = program_->node<Identifier>(node.left);
+        std::string_view name = program_->text(target.name);
+        uint16_t reg;
+        VariableKind kind = resolveIdentifier(target, reg);
+        if (kind == VariableKind::Local) {
+            compileExpression(node.right, reg);
+            if (reg != dest) {
+                emit(Instruction(OpCode::MOVE, dest, reg));
+            }
+        } else if (kind == VariableKind::Global) {
+            compileExpression(node.right, dest);
+            emit(Instruction::wide(OpCode::SET_GLOBAL, dest, reg));
+        } else {
+            compileExpression(node.right, dest);
+            emitRaise("Undefined variable '" + std::string(name) + "'");
+        }
+        releaseRegisters(mark);
+        return;
+    }
+
+    uint16_t left, right;
+    compileOperands(node.left, node.right, left, right);
+
+    OpCode op = node.operands == ValueType::Float ? floatOpCode(node.op) : OpCode::COUNT;
+    if (op == OpCode::COUNT) {
+        op = binaryOpCode(node.op);
+    }
+    if (op == OpCode::COUNT) {
+        emitRaise("Unsupported binary operator");
+    } else {
+        emit(Instruction(op, dest, left, right));
+    }
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileUnary(const UnaryExpression& node, uint16_t dest) {
+    uint16_t mark = current().nextRegister;
+    uint16_t operand = compileOperand(node.operand);
+
+    switch (node.op) {
+        case UnaryOperator::Neg:
+            emit(Instruction(OpCode::NEG, dest, operand));
+            break;
+        case UnaryOperator::Not:
+            emit(Instruction(OpCode::NOT, dest, operand));
+            break;
+        default:
+            emitRaise("Unsupported unary operator");
+            break;
+    }
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileArrayAccess(const ArrayAccess& node, uint16_t dest) {
+    uint16_t mark = current().nextRegister;
+    uint16_t array, index;
+    compileOperands(node.array, node.index, array, index);
+    emit(Instruction(provenInBounds(node) ? OpCode::GET_INDEX_UNCHECKED : OpCode::GET_INDEX, dest, array, index));
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileArrayLiteral(const ArrayLiteral& node, uint16_t dest) {
+    // Elements go into consecutive temporaries, like native arguments
+    auto elements = program_->list(node.elements);
+    if (elements.size() > UINT16_MAX) {
+        emitRaise("Too many elements in an array literal");
+        return;
+    }
+    uint16_t mark = current().nextRegister;
+    uint16_t base = mark;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        allocateRegister();
+    }
+    for (size_t i = 0; i < elements.size(); ++i) {
+        compileExpression(elements[i], static_cast<uint16_t>(base + i));
+    }
+    emit(Instruction(OpCode::NEW_ARRAY, dest, base, static_cast<uint16_t>(elements.size())));
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileIndexStore(const ArrayAccess& target, NodeRef value, uint16_t dest) {
+    // Array, index, then value, as in the tree walker; the first two are
+    // copied out if the value could change the variables they read
+    uint16_t mark = current().nextRegister;
+    uint16_t array, index;
+    if (hasSideEffects(*program_, value)) {
+        array = allocateRegister();
+        compileExpression(target.array, array);
+        index = allocateRegister();
+        compileExpression(target.index, index);
+    } else {
+        compileOperands(target.array, target.index, array, index);
+    }
+    uint16_t stored = compileOperand(value);
+    emit(Instruction(provenInBounds(target) ? OpCode::SET_INDEX_UNCHECKED : OpCode::SET_INDEX, array, index,
+                     stored));
+    if (stored != dest) {
+        emit(Instruction(OpCode::MOVE, dest, stored));
+    }
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileObjectLiteral(const ObjectLiteral& node, uint16_t dest) {
+    // Values go into consecutive temporaries in slot order; the shape is
+    // found once, here
+    auto properties = program_->list(node.properties);
+    if (properties.size() > UINT16_MAX) {
+        emitRaise("Too many properties in an object literal");
+        return;
+    }
+    if (chunk_->shapes.size() > UINT16_MAX) {
+        throw std::runtime_error("Too many object literals in a single chunk");
+    }
+    uint16_t mark = current().nextRegister;
+    uint16_t base = mark;
+    for (size_t i = 0; i < properties.size(); ++i) {
+        allocateRegister();
+    }
+    const Shape* shape = Shape::empty();
+    for (size_t i = 0; i < properties.size(); ++i) {
+        const auto& property = program_->node<ObjectProperty>(properties[i]);
+        compileExpression(property.value, static_cast<uint16_t>(base + i));
+        shape = shape->add(property.key);
+    }
+    chunk_->shapes.push_back(shape);
+    emit(Instruction(OpCode::NEW_OBJECT, dest, base, static_cast<uint16_t>(chunk_->shapes.size() - 1)));
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileMemberStore(const MemberAccess& target, NodeRef value, uint16_t dest) {
+    // Object, then value; the object is copied out if the value could
+    // change the variable it reads
+    uint16_t mark = current().nextRegister;
+    uint16_t object;
+    if (hasSideEffects(*program_, value)) {
+        object = allocateRegister();
+        compileExpression(target.object, object);
+    } else {
+        object = compileOperand(target.object);
+    }
+    uint16_t stored = compileOperand(value);
+    emit(Instruction(OpCode::SET_MEMBER, object, stored, addPropertySite(target.member)));
+    if (stored != dest) {
+        emit(Instruction(OpCode::MOVE, dest, stored));
+    }
+    releaseRegisters(mark);
+}
+
+uint16_t BytecodeCompiler::addPropertySite(Atom key) {
+    // Every site gets its own cache, so each sees only its own shapes
+    if (chunk_->properties.size() > UINT16_MAX) {
+        throw std::runtime_error("Too many property accesses in a single chunk");
+    }
+    chunk_->properties.emplace_back(key);
+    return static_cast<uint16_t>(chunk_->properties.size() - 1);
+}
+
+bool BytecodeCompiler::provenInBounds(const ArrayAccess& node) const {
+    if (node.array.kind() != NodeKind::Identifier || node.index.kind() != NodeKind::Identifier) {
+        return false;
+    }
+    Atom array = program_->node<Identifier>(node.array).name;
+    Atom index = program_->node<Identifier>(node.index).name;
+    return std::any_of(proofs_.begin(), proofs_.end(), [&](const BoundsProof& proof) {
+        return proof.array == array && proof.index == index;
+    });
+}
+
+void BytecodeCompiler::compileCall(const FunctionCall& node, uint16_t dest) {
+    // `x.f(args)` calls native f with x as its first argument
+    NodeRef receiver;
+    uint16_t native;
+    if (node.function.kind() == NodeKind::MemberAccess) {
+        const auto& method = program_->node<MemberAccess>(node.function);
+        native = natives_.lookup(method.member);
+        if (native == NativeRegistry::kNone) {
+            emitRaise("Method '" + std::string(program_->text(method.member)) + "' is not defined");
+            return;
+        }
+        receiver = method.object;
+    } else if (node.function.kind() != NodeKind::Identifier) {
+        emitRaise("Function calls with complex expressions not yet supported");
+        return;
+    } else {
+        const auto& callee = program_->node<Identifier>(node.function);
+
+        // Variables shadow natives; a function value is called like any other
+        uint16_t reg;
+        VariableKind kind = resolveIdentifier(callee, reg);
+        if (kind != VariableKind::Unresolved) {
+            compileUserCall(node, OpCode::CALL, kind, reg, dest);
+            return;
+        }
+
+        native = natives_.lookup(callee.name);
+        if (native == NativeRegistry::kNone) {
+            emitRaise("Function '" + std::string(program_->text(callee.name)) + "' is not defined");
+            return;
+        }
+    }
+
+    // Arguments go into consecutive registers starting at `base`; the
+    // result comes back in `base`.
+    auto arguments = program_->list(node.arguments);
+    size_t count = arguments.size() + (receiver ? 1 : 0);
+    uint16_t mark = current().nextRegister;
+    uint16_t base = allocateRegister();
+    for (size_t i = 1; i < count; ++i) {
+        allocateRegister();
+    }
+    if (receiver) {
+        compileExpression(receiver, base);
+    }
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        compileExpression(arguments[i], static_cast<uint16_t>(base + count - arguments.size() + i));
+    }
+
+    emit(Instruction(OpCode::CALL_NATIVE, base, native, static_cast<uint16_t>(count)));
+    if (base != dest) {
+        emit(Instruction(OpCode::MOVE, dest, base));
+    }
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileUserCall(const FunctionCall& node, OpCode op, VariableKind kind, uint16_t callee,
+                                       uint16_t dest) {
+    // The callee goes in `base` and the arguments right above it, where they
+    // become the first registers of the new frame
+    auto arguments = program_->list(node.arguments);
+    uint16_t mark = current().nextRegister;
+    uint16_t base = allocateRegister();
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        allocateRegister();
+    }
+
+    if (kind == VariableKind::Local) {
+        emit(Instruction(OpCode::MOVE, base, callee));
+    } else if (kind == VariableKind::Global) {
+        emit(Instruction::wide(OpCode::GET_GLOBAL, base, callee));
+    } else {
+        std::string_view name = program_->text(program_->node<Identifier>(node.function).name);
+        emitRaise("Undefined variable '" + std::string(name) + "'");
+    }
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        compileExpression(arguments[i], static_cast<uint16_t>(base + 1 + i));
+    }
+
+    emit(Instruction(op, base, 0, static_cast<uint16_t>(arguments.size())));
+    if (op == OpCode::CALL && base != dest) {
+        emit(Instruction(OpCode::MOVE, dest, base));
+    }
+    releaseRegisters(mark);
+}
+
+// Statements
+void BytecodeCompiler::compileStatements(std::span<const NodeRef> statements) {
+    if (!resolved_) {
+        hoistFunctions(statements);
+    }
+    for (NodeRef stmt : statements) {
+        compileStatement(stmt);
+    }
+}
+
+void BytecodeCompiler::compileStatement(NodeRef stmt) {
+    const Program& program = *program_;
+    uint16_t mark = current().nextRegister;
+
+    switch (stmt.kind()) {
+        case NodeKind::ExpressionStatement:
+            compileExpressionStatement(program.node<ExpressionStatement>(stmt));
+            break;
+        case NodeKind::VariableDeclaration: {
+            const auto& declaration = program.node<VariableDeclaration>(stmt);
+            if (resolved_) {
+                compileResolvedDeclaration(declaration);
+                break;
+            }
+            uint16_t reg = allocateRegister();
+            if (declaration.initializer) {
+                compileExpression(declaration.initializer, reg);
+            } else {
+                emitConstant(reg, int64_t(0)); // Default to 0 for now
+            }
+            // Redeclaring in the same scope rebinds the name to the new register
+            current().locals.push_back({declaration.name, reg});
+            return;  // The register stays live for the rest of the scope
+        }
+        case NodeKind::Block:
+            beginScope();
+            compileStatements(program.list(program.node<Block>(stmt).statements));
+            endScope();
+            break;
+        case NodeKind::FunctionDefinition:
+            if (resolved_) {
+                unsupported_ = true;  // Would need the tree walker's function objects
+                break;
+            }
+            compileFunction(program.node<FunctionDefinition>(stmt));
+            return;
+        case NodeKind::ReturnStatement:
+            compileReturn(program.node<ReturnStatement>(stmt));
+            break;
+        case NodeKind::IfStatement:
+            compileIf(program.node<IfStatement>(stmt));
+            break;
+        case NodeKind::WhileStatement:
+            compileWhile(program.node<WhileStatement>(stmt));
+            break;
+        case NodeKind::ForStatement:
+            compileFor(program.node<ForStatement>(stmt), false);
+            break;
+        default:
+            emitRaise("Invalid statement");
+            break;
+    }
+
+    if (current().nextRegister > mark) {
+        releaseRegisters(mark);
+    }
+}
+
+void BytecodeCompiler::compileExpressionStatement(const ExpressionStatement& node) {
+    // Code for another context leaves nothing behind
+    if (node.expression.kind() == NodeKind::ContextConditional &&
+        !contextMatches(program_->node<ContextConditional>(node.expression))) {
+        return;
+    }
+    // Assignments write straight into the variable's register
+    if (node.expression.kind() == NodeKind::BinaryExpression) {
+        const auto& binary = program_->node<BinaryExpression>(node.expression);
+        if (binary.op == BinaryOperator::Assign && binary.left.kind() == NodeKind::Identifier) {
+            uint16_t reg;
+            if (resolveIdentifier(program_->node<Identifier>(binary.left), reg) == VariableKind::Local) {
+                compileExpression(binary.right, reg);
+                return;
+            }
+        }
+    }
+    compileOperand(node.expression);
+}
+
+void BytecodeCompiler::compileResolvedDeclaration(const VariableDeclaration& node) {
+    // The Resolver already gave the variable its slot
+    uint16_t reg;
+    VariableKind kind = resolveSlot(node.address, reg);
+    uint16_t value = kind == VariableKind::Local ? reg : allocateRegister();
+    if (node.initializer) {
+        compileExpression(node.initializer, value);
+    } else {
+        emitConstant(value, int64_t(0));
+    }
+    if (kind == VariableKind::Global) {
+        emit(Instruction::wide(OpCode::SET_GLOBAL, value, reg));
+    } else if (kind != VariableKind::Local) {
+        emitRaise("Undefined variable '" + std::string(program_->text(node.name)) + "'");
+    }
+}
+
+void BytecodeCompiler::compileFunction(const FunctionDefinition& node) {
+    std::string name(program_->text(node.name));
+    uint16_t reg;
+    auto hoisted = hoisted_.find(&node);
+    if (hoisted != hoisted_.end()) {
+        reg = hoisted->second;
+        hoisted_.erase(hoisted);
+    } else {
+        reg = allocateRegister();
+        current().locals.push_back({node.name, reg});
+    }
+
+    uint32_t arity = node.parameters.count;
+    auto* function = new FunctionObject(name, arity);
+    RuntimeValue value(function);
+    function->proto = std::make_unique<FunctionProto>();
+    function->proto->name = name;
+    function->proto->arity = arity;
+
+    // The body gets a fresh register window with the parameters at the bottom
+    Chunk* enclosing = chunk_;
+    functions_.emplace_back();
+    chunk_ = current().chunk = &function->proto->chunk;
+    for (const auto& param : program_->parameters(node.parameters)) {
+        current().locals.push_back({param.name, allocateRegister()});
+    }
+    if (node.body) {
+        compileStatement(node.body);
+    }
+
+    // Falling off the end returns 0, like the tree walker
+    uint16_t result = allocateRegister();
+    emitConstant(result, int64_t(0));
+    emit(Instruction(OpCode::RETURN, result));
+
+    functions_.pop_back();
+    chunk_ = enclosing;
+
+    emitConstant(reg, value);
+}
+
+void BytecodeCompiler::compileReturn(const ReturnStatement& node) {
+    uint16_t mark = current().nextRegister;
+
+    // A top-level return ends the program; a loop the tree walker handed
+    // over reports it through RETURN instead
+    if (functions_.size() == 1 && !resolved_) {
+        if (node.value) {
+            compileOperand(node.value);
+        }
+        emit(Instruction(OpCode::HALT, 0));
+        releaseRegisters(mark);
+        return;
+    }
+
+    // Returning the result of a user function call reuses this frame
+    if (node.value && node.value.kind() == NodeKind::FunctionCall) {
+        const auto& call = program_->node<FunctionCall>(node.value);
+        if (call.function.kind() == NodeKind::Identifier) {
+            uint16_t reg;
+            VariableKind kind = resolveIdentifier(program_->node<Identifier>(call.function), reg);
+            if (kind != VariableKind::Unresolved && functions_.size() > 1) {
+                compileUserCall(call, OpCode::TAIL_CALL, kind, reg, 0);
+                return;
+            }
+        }
+    }
+
+    uint16_t result;
+    if (node.value) {
+        result = compileOperand(node.value);
+    } else {
+        result = allocateRegister();
+        emitConstant(result, int64_t(0));
+    }
+    emit(Instruction(OpCode::RETURN, result));
+    releaseRegisters(mark);
+}
+
+void BytecodeCompiler::compileIf(const IfStatement& node) {
+    uint16_t mark = current().nextRegister;
+    uint16_t condition = compileOperand(node.condition);
+    releaseRegisters(mark);
+
+    size_t elseJump = emitJump(OpCode::JUMP_IF_FALSE, condition);
+    compileStatement(node.then_branch);
+
+    if (node.else_branch) {
+        size_t endJump = emitJump(OpCode::JUMP);
+        patchJump(elseJump);
+        compileStatement(node.else_branch);
+        patchJump(endJump);
+    } else {
+        patchJump(elseJump);
+    }
+}
+
+void BytecodeCompiler::compileWhile(const WhileStatement& node) {
+    size_t loopStart = chunk_->code.size();
+
+    uint16_t mark = current().nextRegister;
+    uint16_t condition = compileOperand(node.condition);
+    releaseRegisters(mark);
+
+    size_t exitJump = emitJump(OpCode::JUMP_IF_FALSE, condition);
+    compileStatement(node.body);
+    emit(Instruction::wide(OpCode::JUMP, 0, static_cast<uint32_t>(loopStart)));
+    patchJump(exitJump);
+}
+
+void BytecodeCompiler::compileFor(const ForStatement& node, bool resume) {
+    // Counter, end bound and variable take three consecutive registers:
+    // the Resolver's slots when they are in the register window, fresh
+    // registers otherwise
+    uint16_t range = 0;
+    VariableKind kind = resolved_ ? resolveSlot(node.address, range) : VariableKind::Unresolved;
+    if (kind == VariableKind::Enclosing) {
+        emitRaise("Undefined variable '" + std::string(program_->text(node.variable)) + "'");
+        return;
+    }
+    bool global = kind == VariableKind::Global;
+    uint32_t slot = range;
+    if (kind != VariableKind::Local) {
+        range = allocateRegister();
+        allocateRegister();
+        allocateRegister();
+    }
+    // Each copy's body allocates from here, above the counter, bound and
+    // variable (Resolver slots are below the frame's first free register)
+    uint16_t bodyMark = current().nextRegister;
+
+    // Resuming a loop the tree walker started continues with its next step
+    if (resume) {
+        if (global) {
+            emit(Instruction::wide(OpCode::GET_GLOBAL, range, slot));
+            emit(Instruction::wide(OpCode::GET_GLOBAL, range + 1, slot + 1));
+        }
+    } else {
+        compileExpression(node.start, range);
+        compileExpression(node.end, static_cast<uint16_t>(range + 1));
+    }
+
+    std::vector<const Identifier*> arrays = provenArrays(node);
+    if (arrays.empty()) {
+        compileLoop(node, range, slot, global, resume, bodyMark);
+        return;
+    }
+
+    // Every index the loop can still take is in [counter, end): a resumed
+    // loop steps before it runs the body again. If an array does not hold
+    // the whole range, or a bound is not an integer, the checked copy runs
+    // and raises where the tree walker would.
+    std::vector<size_t> fallbacks;
+    uint16_t mark = current().nextRegister;
+    uint16_t holds = allocateRegister();
+    for (const Identifier* array : arrays) {
+        uint16_t reg;
+        if (resolveIdentifier(*array, reg) != VariableKind::Local) {
+            reg = allocateRegister();
+            compileIdentifier(*array, reg);
+        }
+        emit(Instruction(OpCode::IN_BOUNDS, holds, reg, range));
+        fallbacks.push_back(emitJump(OpCode::JUMP_IF_FALSE, holds));
+        releaseRegisters(static_cast<uint16_t>(holds + 1));
+    }
+    releaseRegisters(mark);
+
+    ++versionedLoops_;
+    for (const Identifier* array : arrays) {
+        proofs_.push_back({array->name, node.variable});
+    }
+    compileLoop(node, range, slot, global, resume, bodyMark);
+    proofs_.resize(proofs_.size() - arrays.size());
+    --versionedLoops_;
+
+    size_t end = emitJump(OpCode::JUMP);
+    for (size_t fallback : fallbacks) {
+        patchJump(fallback);
+    }
+    compileLoop(node, range, slot, global, resume, bodyMark);
+    patchJump(end);
+}
+
+void BytecodeCompiler::compileLoop(const ForStatement& node, uint16_t range, uint32_t slot, bool global,
+                                   bool resume, uint16_t bodyMark) {
+    size_t skip = emitJump(resume ? OpCode::JUMP : OpCode::FOR_PREP, range);
+    size_t body = chunk_->code.size();
+    uint16_t variable = static_cast<uint16_t>(range + 2);
+    if (global) {
+        emit(Instruction::wide(OpCode::SET_GLOBAL, variable, slot + 2));
+    }
+    releaseRegisters(bodyMark);
+    beginScope();
+    if (!resolved_) {
+        current().locals.push_back({node.variable, variable});
+    }
+    compileStatement(node.body);
+    endScope();
+    // endScope() released down to the variable, which is not the body's
+    releaseRegisters(bodyMark);
+
+    if (resume) {
+        patchJump(skip);
+    }
+    emit(Instruction::wide(OpCode::FOR_LOOP, range, static_cast<uint32_t>(body)));
+    if (!resume) {
+        patchJump(skip);
+    }
+}
+
+std::vector<const Identifier*> BytecodeCompiler::provenArrays(const ForStatement& node) {
+    std::vector<const Identifier*> arrays;
+    if (versionedLoops_ >= kMaxVersionedLoops) {
+        return arrays;
+    }
+    LoopScan scan{*program_, node.variable};
+    scan.statement(node.body);
+    if (scan.opaque || scan.indexed.empty() || contains(scan.bound, node.variable)) {
+        return arrays;
+    }
+    // Only natives called by name leave the arrays alone, and only if the
+    // body cannot rebind the name to something else
+    for (const Identifier* callee : scan.callees) {
+        uint16_t reg;
+        uint16_t native = natives_.lookup(callee->name);
+        if (resolveIdentifier(*callee, reg) != VariableKind::Unresolved || native == NativeRegistry::kNone ||
+            LoopScan::shrinks(program_->text(callee->name)) || contains(scan.bound, callee->name)) {
+            return arrays;
+        }
+    }
+    for (const Identifier* array : scan.indexed) {
+        uint16_t reg;
+        VariableKind kind = resolveIdentifier(*array, reg);
+        bool seen = std::any_of(arrays.begin(), arrays.end(),
+                                [&](const Identifier* other) { return other->name == array->name; });
+        if (seen || array->name == node.variable || contains(scan.bound, array->name) ||
+            (kind != VariableKind::Local && kind != VariableKind::Global)) {
+            continue;
+        }
+        arrays.push_back(array);
+        if (arrays.size() == kMaxProvenArrays) {
+            break;
+        }
+    }
+    return arrays;
+}
+
+} // namespace myndra
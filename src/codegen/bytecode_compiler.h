@@ -0,0 +1,153 @@
+#ifndef MYNDRA_BYTECODE_COMPILER_H
+#define MYNDRA_BYTECODE_COMPILER_H
+
+#include "../parser/ast.h"
+#include "../runtime/bytecode.h"
+#include "../runtime/natives.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace myndra {
+
+// Lowers a Program into register-based bytecode for the VM.
+//
+// Every local variable is pinned to a register for its whole scope and
+// expression temporaries are allocated above the live locals, stack style.
+// Top-level bindings survive across compile() calls so a REPL session keeps
+// its globals in the same registers. Each function body is compiled into
+// its own FunctionProto with a private register window; it reaches the
+// top-level registers through GET_GLOBAL/SET_GLOBAL.
+//
+// For tiered execution it also compiles single functions and loops the
+// tree walker has been running. Those keep the Resolver's layout instead
+// of scoping names themselves: frame slot i is register i, temporaries go
+// above the frame, and globals are the tree walker's global slots.
+//
+// Context conditionals are resolved at compile time against the context
+// set here: code for any other context is not emitted at all.
+//
+// A for loop whose body indexes arrays with the loop variable is compiled
+// twice when the body can neither rebind those arrays nor shrink them: one
+// copy indexes without bounds checks and runs if IN_BOUNDS holds for each
+// array over the whole range, the other keeps the checks.
+class BytecodeCompiler {
+public:
+    explicit BytecodeCompiler(const NativeRegistry& natives = NativeRegistry::builtins());
+
+    Chunk compile(Program& program);
+
+    // Context for code compiled from now on
+    void setContext(std::string context) { context_ = std::move(context); }
+
+    // A resolved function, for the tree walker to promote; null if it needs
+    // something only the tree walker does (nested function definitions)
+    std::unique_ptr<FunctionProto> compileHotFunction(Program& program, const FunctionDefinition& function);
+    // A resolved loop of `function` (null at the top level), entered where
+    // the tree walker leaves it for on-stack replacement: a while loop at
+    // its condition, a for loop at its step. Halts when the loop exits, and
+    // returns if the code returns from the function; null like above.
+    std::unique_ptr<Chunk> compileHotLoop(Program& program, NodeRef loop, const FunctionDefinition* function);
+
+private:
+    struct Local {
+        Atom name;
+        uint16_t reg;
+    };
+
+    // Per-function compilation state; functions_[0] is the top level
+    struct FunctionState {
+        Chunk* chunk = nullptr;
+        std::vector<Local> locals;          // Innermost binding last
+        std::vector<size_t> scopeStarts;    // locals size at each scope entry
+        uint16_t nextRegister = 0;          // First free register
+    };
+
+    enum class VariableKind { Local, Global, Enclosing, Unresolved };
+
+    // Indexes `array[index]` known to be in bounds in the code being emitted
+    struct BoundsProof {
+        Atom array;
+        Atom index;
+    };
+
+    const NativeRegistry& natives_;
+    std::vector<FunctionState> functions_;
+    std::unordered_map<const FunctionDefinition*, uint16_t> hoisted_;  // Registers reserved for functions
+    Program* program_;                   // Program being compiled
+    Chunk* chunk_;
+    bool resolved_ = false;              // Compiling against Resolver slots (tiering)
+    bool topLevel_ = false;              // Resolved code runs in the global frame
+    bool unsupported_ = false;           // Resolved code hit a construct it cannot compile
+    std::string context_{kDefaultContext};
+    std::vector<BoundsProof> proofs_;
+    uint32_t versionedLoops_ = 0;        // Enclosing loops compiled twice
+
+    FunctionState& current() { return functions_.back(); }
+    const FunctionState& current() const { return functions_.back(); }
+
+    // Register management
+    uint16_t allocateRegister();
+    void releaseRegisters(uint16_t mark);
+
+    // Scopes
+    void beginScope();
+    void endScope();
+    static bool findLocal(const std::vector<Local>& locals, Atom name, uint16_t& reg);
+    bool resolveLocal(Atom name, uint16_t& reg) const;
+    VariableKind resolveVariable(Atom name, uint16_t& reg) const;
+    VariableKind resolveIdentifier(const Identifier& node, uint16_t& reg);
+    VariableKind resolveSlot(const SlotAddress& address, uint16_t& reg);
+    void beginResolved(Program& program, Chunk* chunk, uint32_t frameSize, bool topLevel);
+    bool endResolved();
+    void hoistFunctions(std::span<const NodeRef> statements);
+
+    // Expressions; the result is written to `dest`
+    void compileExpression(NodeRef expr, uint16_t dest);
+    uint16_t compileOperand(NodeRef expr);
+    void compileOperands(NodeRef left, NodeRef right, uint16_t& leftReg, uint16_t& rightReg);
+    void compileIdentifier(const Identifier& node, uint16_t dest);
+    void compileBinary(const BinaryExpression& node, uint16_t dest);
+    void compileUnary(const UnaryExpression& node, uint16_t dest);
+    void compileArrayAccess(const ArrayAccess& node, uint16_t dest);
+    void compileArrayLiteral(const ArrayLiteral& node, uint16_t dest);
+    void compileIndexStore(const ArrayAccess& target, NodeRef value, uint16_t dest);
+    bool provenInBounds(const ArrayAccess& node) const;
+    void compileObjectLiteral(const ObjectLiteral& node, uint16_t dest);
+    void compileMemberStore(const MemberAccess& target, NodeRef value, uint16_t dest);
+    uint16_t addPropertySite(Atom key);
+    bool contextMatches(const ContextConditional& node) const;
+    void compileCall(const FunctionCall& node, uint16_t dest);
+    void compileUserCall(const FunctionCall& node, OpCode op, VariableKind kind, uint16_t callee, uint16_t dest);
+
+    // Statements
+    void compileStatement(NodeRef stmt);
+    void compileStatements(std::span<const NodeRef> statements);
+    void compileExpressionStatement(const ExpressionStatement& node);
+    void compileFunction(const FunctionDefinition& node);
+    void compileResolvedDeclaration(const VariableDeclaration& node);
+    void compileReturn(const ReturnStatement& node);
+    void compileIf(const IfStatement& node);
+    void compileWhile(const WhileStatement& node);
+    void compileFor(const ForStatement& node, bool resume);
+    // `bodyMark`: first register the body may use, the same for both
+    // copies of a versioned loop
+    void compileLoop(const ForStatement& node, uint16_t range, uint32_t slot, bool global, bool resume,
+                     uint16_t bodyMark);
+    std::vector<const Identifier*> provenArrays(const ForStatement& node);
+
+    // Emission helpers
+    size_t emit(const Instruction& instruction);
+    size_t emitJump(OpCode op, uint16_t reg = 0);
+    void patchJump(size_t at);
+    void emitConstant(uint16_t dest, const RuntimeValue& value);
+    void emitRaise(const std::string& message);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_BYTECODE_COMPILER_H
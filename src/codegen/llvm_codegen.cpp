@@ -0,0 +1,1203 @@
+#include "llvm_codegen.h"
+#include "../interpreter/interpreter.h"
+#include "../semantics/resolver.h"
+#include <llvm/ADT/Optional.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#ifndef MYNDRA_AOT_LINKER
+#define MYNDRA_AOT_LINKER "c++"
+#endif
+#ifndef MYNDRA_RUNTIME_LIBRARY
+#define MYNDRA_RUNTIME_LIBRARY "libmyndra_runtime.a"
+#endif
+
+namespace myndra {
+
+namespace {
+
+constexpr uint64_t kIntTag16 = RuntimeValue::kIntTag >> RuntimeValue::kTagShift;
+constexpr uint64_t kObjectTag16 = RuntimeValue::kObjectTag >> RuntimeValue::kTagShift;
+
+// Writes one program into an LLVM module
+class Lowering {
+public:
+    Lowering(llvm::LLVMContext& context, llvm::Module& module, Program& program, const NativeRegistry& natives,
+             uint32_t globalCount, std::string_view deployment)
+        : context_(context), module_(module), program_(program), natives_(natives), deployment_(deployment),
+          b_(context) {
+        i1_ = b_.getInt1Ty();
+        i32_ = b_.getInt32Ty();
+        i64_ = b_.getInt64Ty();
+        f64_ = b_.getDoubleTy();
+        i8ptr_ = b_.getInt8PtrTy();
+        i64ptr_ = llvm::Type::getInt64PtrTy(context);
+
+        globalsType_ = llvm::ArrayType::get(i64_, std::max<uint32_t>(globalCount, 1));
+        globals_ = new llvm::GlobalVariable(
+            module_, globalsType_, false, llvm::GlobalValue::InternalLinkage,
+            llvm::ConstantArray::get(globalsType_,
+                                     std::vector<llvm::Constant*>(globalsType_->getNumElements(), value(RuntimeValue::kIntTag))),
+            "myndra.globals");
+        depth_ = new llvm::GlobalVariable(module_, i32_, false, llvm::GlobalValue::InternalLinkage,
+                                          llvm::ConstantInt::get(i32_, 0), "myndra.depth");
+        declareRuntime();
+        defineHelpers();
+    }
+
+    void run() {
+        for (NodeRef stmt : program_.statements()) {
+            scan(stmt);
+        }
+        for (auto& [index, target] : functions_) {
+            lowerFunction(index, target);
+        }
+        lowerMain();
+    }
+
+private:
+    // A Myndra function: its body takes the arguments by value, `entry`
+    // takes them as an array (the FunctionObject's native entry point)
+    struct Target {
+        llvm::Function* body;
+        llvm::Function* entry;
+    };
+
+    // Function being emitted
+    struct FunctionState {
+        llvm::Function* function = nullptr;
+        llvm::Value* frame = nullptr;       // Slot array; the globals at the top level
+        llvm::ArrayType* frameType = nullptr;
+        uint32_t frameSize = 0;
+        bool top = false;
+    };
+
+    llvm::LLVMContext& context_;
+    llvm::Module& module_;
+    Program& program_;
+    const NativeRegistry& natives_;
+    std::string_view deployment_;  // Context the conditionals are built for
+    llvm::IRBuilder<> b_;
+
+    llvm::Type* i1_;
+    llvm::IntegerType* i32_;
+    llvm::IntegerType* i64_;
+    llvm::Type* f64_;
+    llvm::PointerType* i8ptr_;
+    llvm::PointerType* i64ptr_;
+
+    llvm::ArrayType* globalsType_;
+    llvm::GlobalVariable* globals_;
+    llvm::GlobalVariable* depth_;   // Active calls, against kMaxCallDepth
+
+    // Runtime library
+    llvm::FunctionCallee rtMain_, rtString_, rtInt_, rtFunction_, rtBinary_, rtUnary_, rtTruthy_;
+    llvm::FunctionCallee rtCall_, rtNative_, rtDestroy_, rtRaise_, rtRangeBound_;
+    llvm::FunctionCallee rtArray_, rtIndex_, rtStoreIndex_;
+    llvm::FunctionCallee rtObject_, rtGetMember_, rtSetMember_;
+
+    // Inline helpers
+    llvm::Function* retain_;
+    llvm::Function* release_;
+    llvm::Function* truthy_;
+    std::unordered_map<uint8_t, llvm::Function*> binaryHelpers_;
+    std::unordered_map<uint8_t, llvm::Function*> floatHelpers_;
+
+    std::vector<std::pair<uint32_t, Target>> functions_;   // By FunctionDefinition index, in source order
+    std::unordered_map<uint32_t, Target> targets_;
+    // Global slots written exactly once, by a function definition: calls
+    // through them can go straight to the function
+    std::unordered_map<uint32_t, uint32_t> globalWriters_;
+    std::unordered_map<uint32_t, uint32_t> globalFunctions_;
+    std::unordered_map<uint32_t, llvm::GlobalVariable*> strings_;   // StringLiteral index -> cached value
+
+    FunctionState state_;
+
+    llvm::Constant* value(uint64_t bits) { return llvm::ConstantInt::get(i64_, bits); }
+    llvm::Constant* u32(uint32_t n) { return llvm::ConstantInt::get(i32_, n); }
+
+    // --- Setup ---
+
+    void declareRuntime() {
+        auto fn = [&](const char* name, llvm::Type* result, std::vector<llvm::Type*> params) {
+            return module_.getOrInsertFunction(name, llvm::FunctionType::get(result, params, false));
+        };
+        llvm::Type* voidTy = b_.getVoidTy();
+        llvm::Type* bodyPtr = llvm::FunctionType::get(voidTy, false)->getPointerTo();
+        llvm::Type* entryPtr = llvm::FunctionType::get(i64_, {i64ptr_}, false)->getPointerTo();
+        rtMain_ = fn("myndra_rt_main", i32_, {bodyPtr});
+        rtString_ = fn("myndra_rt_string", i64_, {i8ptr_, i64_});
+        rtInt_ = fn("myndra_rt_int", i64_, {i64_});
+        rtFunction_ = fn("myndra_rt_function", i64_, {i8ptr_, i64_, i32_, entryPtr});
+        rtBinary_ = fn("myndra_rt_binary", i64_, {i32_, i64_, i64_});
+        rtUnary_ = fn("myndra_rt_unary", i64_, {i32_, i64_});
+        rtTruthy_ = fn("myndra_rt_truthy", i32_, {i64_});
+        rtRangeBound_ = fn("myndra_rt_range_bound", i64_, {i64_});
+        rtCall_ = fn("myndra_rt_call", i64_, {i64_, i64ptr_, i32_});
+        rtNative_ = fn("myndra_rt_native", i64_, {i32_, i64ptr_, i32_});
+        rtArray_ = fn("myndra_rt_array", i64_, {i64ptr_, i32_});
+        rtIndex_ = fn("myndra_rt_index", i64_, {i64_, i64_});
+        rtStoreIndex_ = fn("myndra_rt_store_index", voidTy, {i64_, i64_, i64_});
+        llvm::Type* sitePtr = i8ptr_->getPointerTo();
+        rtObject_ = fn("myndra_rt_object", i64_, {sitePtr, i8ptr_, i64ptr_, i32_});
+        rtGetMember_ = fn("myndra_rt_get_member", i64_, {i64_, sitePtr, i8ptr_, i64_});
+        rtSetMember_ = fn("myndra_rt_set_member", voidTy, {i64_, i64_, sitePtr, i8ptr_, i64_});
+        rtDestroy_ = fn("myndra_rt_destroy", voidTy, {i8ptr_});
+        rtRaise_ = fn("myndra_rt_raise", voidTy, {i8ptr_});
+        llvm::cast<llvm::Function>(rtRaise_.getCallee())->addFnAttr(llvm::Attribute::NoReturn);
+    }
+
+    llvm::Function* helper(const char* name, llvm::Type* result, std::vector<llvm::Type*> params) {
+        auto* function = llvm::Function::Create(llvm::FunctionType::get(result, params, false),
+                                                llvm::GlobalValue::InternalLinkage, name, module_);
+        function->addFnAttr(llvm::Attribute::AlwaysInline);
+        function->addFnAttr(llvm::Attribute::UWTable);
+        return function;
+    }
+
+    llvm::BasicBlock* block(const char* name, llvm::Function* function = nullptr) {
+        return llvm::BasicBlock::Create(context_, name, function ? function : b_.GetInsertBlock()->getParent());
+    }
+
+    llvm::Value* hasTag(llvm::Value* v, uint64_t tag16) {
+        return b_.CreateICmpEQ(b_.CreateLShr(v, RuntimeValue::kTagShift), value(tag16));
+    }
+    llvm::Value* isDouble(llvm::Value* v) { return b_.CreateICmpULT(v, value(RuntimeValue::kIntTag)); }
+    llvm::Value* payloadInt(llvm::Value* v) { return b_.CreateAShr(b_.CreateShl(v, 16), 16); }
+    llvm::Value* fitsSmallInt(llvm::Value* x) { return b_.CreateICmpEQ(payloadInt(x), x); }
+    llvm::Value* boxSmallInt(llvm::Value* x) {
+        return b_.CreateOr(b_.CreateAnd(x, value(RuntimeValue::kPayloadMask)), value(RuntimeValue::kIntTag));
+    }
+    llvm::Value* boxBool(llvm::Value* flag) {
+        return b_.CreateOr(b_.CreateZExt(flag, i64_), value(RuntimeValue::kBoolTag));
+    }
+    llvm::Value* boxDouble(llvm::Value* d) {
+        llvm::Value* isNaN = b_.CreateFCmpUNO(d, d);
+        return b_.CreateSelect(isNaN, value(RuntimeValue::kCanonicalNaN), b_.CreateBitCast(d, i64_));
+    }
+    llvm::Value* objectPointer(llvm::Value* v, llvm::Type* type) {
+        return b_.CreateIntToPtr(b_.CreateAnd(v, value(RuntimeValue::kPayloadMask)), type);
+    }
+
+    void defineHelpers() {
+        llvm::IRBuilderBase::InsertPointGuard guard(b_);
+        llvm::Type* voidTy = b_.getVoidTy();
+        llvm::Type* countPtr = llvm::Type::getInt32PtrTy(context_);
+        static_assert(offsetof(HeapObject, refcount) == 0, "compiled code counts references at offset 0");
+
+        // Counts a new reference
+        retain_ = helper("myndra.retain", voidTy, {i64_});
+        {
+            llvm::Value* v = retain_->getArg(0);
+            llvm::BasicBlock* entry = block("entry", retain_);
+            llvm::BasicBlock* object = block("object", retain_);
+            llvm::BasicBlock* done = block("done", retain_);
+            b_.SetInsertPoint(entry);
+            b_.CreateCondBr(hasTag(v, kObjectTag16), object, done);
+            b_.SetInsertPoint(object);
+            llvm::Value* count = objectPointer(v, countPtr);
+            b_.CreateStore(b_.CreateAdd(b_.CreateLoad(i32_, count), u32(1)), count);
+            b_.CreateBr(done);
+            b_.SetInsertPoint(done);
+            b_.CreateRetVoid();
+        }
+
+        // Drops a reference, freeing the object with the last one
+        release_ = helper("myndra.release", voidTy, {i64_});
+        {
+            llvm::Value* v = release_->getArg(0);
+            llvm::BasicBlock* entry = block("entry", release_);
+            llvm::BasicBlock* object = block("object", release_);
+            llvm::BasicBlock* free = block("free", release_);
+            llvm::BasicBlock* done = block("done", release_);
+            b_.SetInsertPoint(entry);
+            b_.CreateCondBr(hasTag(v, kObjectTag16), object, done);
+            b_.SetInsertPoint(object);
+            llvm::Value* count = objectPointer(v, countPtr);
+            llvm::Value* remaining = b_.CreateSub(b_.CreateLoad(i32_, count), u32(1));
+            b_.CreateStore(remaining, count);
+            b_.CreateCondBr(b_.CreateICmpEQ(remaining, u32(0)), free, done);
+            b_.SetInsertPoint(free);
+            b_.CreateCall(rtDestroy_, {objectPointer(v, i8ptr_)});
+            b_.CreateBr(done);
+            b_.SetInsertPoint(done);
+            b_.CreateRetVoid();
+        }
+
+        // Truthiness of a value it consumes; immediates inline
+        truthy_ = helper("myndra.truthy", i1_, {i64_});
+        {
+            llvm::Value* v = truthy_->getArg(0);
+            llvm::BasicBlock* entry = block("entry", truthy_);
+            llvm::BasicBlock* notBool = block("not_bool", truthy_);
+            llvm::BasicBlock* integer = block("int", truthy_);
+            llvm::BasicBlock* notInt = block("not_int", truthy_);
+            llvm::BasicBlock* real = block("double", truthy_);
+            llvm::BasicBlock* other = block("other", truthy_);
+            llvm::BasicBlock* boolean = block("bool", truthy_);
+            b_.SetInsertPoint(entry);
+            b_.CreateCondBr(hasTag(v, RuntimeValue::kBoolTag >> RuntimeValue::kTagShift), boolean, notBool);
+            b_.SetInsertPoint(boolean);
+            b_.CreateRet(b_.CreateTrunc(v, i1_));
+            b_.SetInsertPoint(notBool);
+            b_.CreateCondBr(hasTag(v, kIntTag16), integer, notInt);
+            b_.SetInsertPoint(integer);
+            b_.CreateRet(b_.CreateICmpNE(v, value(RuntimeValue::kIntTag)));
+            b_.SetInsertPoint(notInt);
+            b_.CreateCondBr(isDouble(v), real, other);
+            b_.SetInsertPoint(real);
+            b_.CreateRet(b_.CreateFCmpUNE(b_.CreateBitCast(v, f64_), llvm::ConstantFP::get(f64_, 0.0)));
+            b_.SetInsertPoint(other);
+            b_.CreateRet(b_.CreateICmpNE(b_.CreateCall(rtTruthy_, {v}), u32(0)));
+        }
+    }
+
+    static bool isComparison(BinaryOperator op) {
+        return op == BinaryOperator::Eq || op == BinaryOperator::Ne || op == BinaryOperator::Lt ||
+               op == BinaryOperator::Le || op == BinaryOperator::Gt || op == BinaryOperator::Ge;
+    }
+
+    // Boxed l op r for two doubles; division by zero branches to `slow`
+    llvm::Value* doubleBinary(BinaryOperator op, llvm::Value* l, llvm::Value* r, llvm::BasicBlock* slow) {
+        llvm::Value* x = b_.CreateBitCast(l, f64_);
+        llvm::Value* y = b_.CreateBitCast(r, f64_);
+        switch (op) {
+            case BinaryOperator::Add: return boxDouble(b_.CreateFAdd(x, y));
+            case BinaryOperator::Sub: return boxDouble(b_.CreateFSub(x, y));
+            case BinaryOperator::Mul: return boxDouble(b_.CreateFMul(x, y));
+            case BinaryOperator::Div: {
+                // Division by zero raises
+                llvm::BasicBlock* divide = block("fdivide");
+                b_.CreateCondBr(b_.CreateFCmpOEQ(y, llvm::ConstantFP::get(f64_, 0.0)), slow, divide);
+                b_.SetInsertPoint(divide);
+                return boxDouble(b_.CreateFDiv(x, y));
+            }
+            // Ordered predicates are false for NaN, like the evaluator
+            case BinaryOperator::Eq: return boxBool(b_.CreateFCmpOEQ(x, y));
+            case BinaryOperator::Ne: return boxBool(b_.CreateFCmpUNE(x, y));
+            case BinaryOperator::Lt: return boxBool(b_.CreateFCmpOLT(x, y));
+            case BinaryOperator::Le: return boxBool(b_.CreateFCmpOLE(x, y));
+            case BinaryOperator::Gt: return boxBool(b_.CreateFCmpOGT(x, y));
+            default: return boxBool(b_.CreateFCmpOGE(x, y));
+        }
+    }
+
+    // left op right for two values the TypeChecker proved to be doubles: no
+    // tag checks, only division by zero reaches the runtime evaluator
+    llvm::Function* floatHelper(BinaryOperator op) {
+        auto found = floatHelpers_.find(static_cast<uint8_t>(op));
+        if (found != floatHelpers_.end()) {
+            return found->second;
+        }
+        llvm::IRBuilderBase::InsertPointGuard guard(b_);
+        llvm::Function* function =
+            helper((std::string("myndra.float.") + binaryOperatorText(op)).c_str(), i64_, {i64_, i64_});
+        floatHelpers_[static_cast<uint8_t>(op)] = function;
+        llvm::Value* l = function->getArg(0);
+        llvm::Value* r = function->getArg(1);
+        llvm::BasicBlock* entry = block("entry", function);
+        llvm::BasicBlock* slow = block("slow", function);
+
+        b_.SetInsertPoint(entry);
+        b_.CreateRet(doubleBinary(op, l, r, slow));
+
+        b_.SetInsertPoint(slow);
+        b_.CreateRet(b_.CreateCall(rtBinary_, {u32(static_cast<uint32_t>(op)), l, r}));
+        return function;
+    }
+
+    // left op right for two values it consumes: small ints and doubles
+    // inline, the runtime evaluator for the rest
+    llvm::Function* binaryHelper(BinaryOperator op) {
+        auto found = binaryHelpers_.find(static_cast<uint8_t>(op));
+        if (found != binaryHelpers_.end()) {
+            return found->second;
+        }
+        llvm::IRBuilderBase::InsertPointGuard guard(b_);
+        llvm::Function* function =
+            helper((std::string("myndra.binary.") + binaryOperatorText(op)).c_str(), i64_, {i64_, i64_});
+        binaryHelpers_[static_cast<uint8_t>(op)] = function;
+        llvm::Value* l = function->getArg(0);
+        llvm::Value* r = function->getArg(1);
+        llvm::BasicBlock* entry = block("entry", function);
+        llvm::BasicBlock* ints = block("ints", function);
+        llvm::BasicBlock* notInts = block("not_ints", function);
+        llvm::BasicBlock* doubles = block("doubles", function);
+        llvm::BasicBlock* slow = block("slow", function);
+
+        b_.SetInsertPoint(entry);
+        b_.CreateCondBr(b_.CreateAnd(hasTag(l, kIntTag16), hasTag(r, kIntTag16)), ints, notInts);
+
+        // 48-bit operands: + and - cannot overflow int64, * is checked
+        b_.SetInsertPoint(ints);
+        llvm::Value* a = payloadInt(l);
+        llvm::Value* c = payloadInt(r);
+        if (isComparison(op)) {
+            llvm::CmpInst::Predicate predicate;
+            switch (op) {
+                case BinaryOperator::Eq: predicate = llvm::CmpInst::ICMP_EQ; break;
+                case BinaryOperator::Ne: predicate = llvm::CmpInst::ICMP_NE; break;
+                case BinaryOperator::Lt: predicate = llvm::CmpInst::ICMP_SLT; break;
+                case BinaryOperator::Le: predicate = llvm::CmpInst::ICMP_SLE; break;
+                case BinaryOperator::Gt: predicate = llvm::CmpInst::ICMP_SGT; break;
+                default: predicate = llvm::CmpInst::ICMP_SGE; break;
+            }
+            b_.CreateRet(boxBool(b_.CreateICmp(predicate, a, c)));
+        } else {
+            llvm::Value* result;
+            llvm::Value* ok;
+            if (op == BinaryOperator::Mul) {
+                llvm::Function* smul = llvm::Intrinsic::getDeclaration(&module_, llvm::Intrinsic::smul_with_overflow, {i64_});
+                llvm::Value* product = b_.CreateCall(smul, {a, c});
+                result = b_.CreateExtractValue(product, 0);
+                ok = b_.CreateAnd(b_.CreateNot(b_.CreateExtractValue(product, 1)), fitsSmallInt(result));
+            } else if (op == BinaryOperator::Div) {
+                llvm::BasicBlock* divide = block("divide", function);
+                b_.CreateCondBr(b_.CreateICmpEQ(c, value(0)), slow, divide);
+                b_.SetInsertPoint(divide);
+                result = b_.CreateSDiv(a, c);
+                ok = fitsSmallInt(result);
+            } else {
+                result = op == BinaryOperator::Add ? b_.CreateAdd(a, c) : b_.CreateSub(a, c);
+                ok = fitsSmallInt(result);
+            }
+            llvm::BasicBlock* boxed = block("boxed", function);
+            b_.CreateCondBr(ok, boxed, slow);
+            b_.SetInsertPoint(boxed);
+            b_.CreateRet(boxSmallInt(result));
+        }
+
+        b_.SetInsertPoint(notInts);
+        b_.CreateCondBr(b_.CreateAnd(isDouble(l), isDouble(r)), doubles, slow);
+
+        b_.SetInsertPoint(doubles);
+        b_.CreateRet(doubleBinary(op, l, r, slow));
+
+        b_.SetInsertPoint(slow);
+        b_.CreateRet(b_.CreateCall(rtBinary_, {u32(static_cast<uint32_t>(op)), l, r}));
+        return function;
+    }
+
+    // --- Program structure ---
+
+    // Declares every function and finds the global slots that only ever
+    // hold one of them
+    void scan(NodeRef ref) {
+        if (ref.isNull()) {
+            return;
+        }
+        switch (ref.kind()) {
+            case NodeKind::BinaryExpression: {
+                const auto& node = program_.node<BinaryExpression>(ref);
+                if (node.op == BinaryOperator::Assign && node.left.kind() == NodeKind::Identifier) {
+                    const auto& target = program_.node<Identifier>(node.left);
+                    if (target.address.isGlobal()) {
+                        ++globalWriters_[target.address.slot];
+                    }
+                }
+                scan(node.left);
+                scan(node.right);
+                break;
+            }
+            case NodeKind::UnaryExpression:
+                scan(program_.node<UnaryExpression>(ref).operand);
+                break;
+            case NodeKind::ContextConditional:
+                scan(program_.node<ContextConditional>(ref).expression);
+                break;
+            case NodeKind::ArrayAccess: {
+                const auto& node = program_.node<ArrayAccess>(ref);
+                scan(node.array);
+                scan(node.index);
+                break;
+            }
+            case NodeKind::ArrayLiteral:
+                for (NodeRef element : program_.list(program_.node<ArrayLiteral>(ref).elements)) {
+                    scan(element);
+                }
+                break;
+            case NodeKind::ObjectLiteral:
+                for (NodeRef property : program_.list(program_.node<ObjectLiteral>(ref).properties)) {
+                    scan(program_.node<ObjectProperty>(property).value);
+                }
+                break;
+            case NodeKind::MemberAccess:
+                scan(program_.node<MemberAccess>(ref).object);
+                break;
+            case NodeKind::FunctionCall: {
+                const auto& node = program_.node<FunctionCall>(ref);
+                scan(node.function);
+                for (NodeRef arg : program_.list(node.arguments)) {
+                    scan(arg);
+                }
+                break;
+            }
+            case NodeKind::ExpressionStatement:
+                scan(program_.node<ExpressionStatement>(ref).expression);
+                break;
+            case NodeKind::VariableDeclaration: {
+                const auto& node = program_.node<VariableDeclaration>(ref);
+                if (node.address.isGlobal()) {
+                    ++globalWriters_[node.address.slot];
+                }
+                scan(node.initializer);
+                break;
+            }
+            case NodeKind::Block:
+                for (NodeRef stmt : program_.list(program_.node<Block>(ref).statements)) {
+                    scan(stmt);
+                }
+                break;
+            case NodeKind::FunctionDefinition: {
+                const auto& node = program_.node<FunctionDefinition>(ref);
+                declareFunction(ref.index(), node);
+                if (node.address.isGlobal()) {
+                    ++globalWriters_[node.address.slot];
+                    globalFunctions_[node.address.slot] = ref.index();
+                }
+                scan(node.body);
+                break;
+            }
+            case NodeKind::ReturnStatement:
+                scan(program_.node<ReturnStatement>(ref).value);
+                break;
+            case NodeKind::IfStatement: {
+                const auto& node = program_.node<IfStatement>(ref);
+                scan(node.condition);
+                scan(node.then_branch);
+                scan(node.else_branch);
+                break;
+            }
+            case NodeKind::WhileStatement: {
+                const auto& node = program_.node<WhileStatement>(ref);
+                scan(node.condition);
+                scan(node.body);
+                break;
+            }
+            case NodeKind::ForStatement: {
+                const auto& node = program_.node<ForStatement>(ref);
+                if (node.address.isGlobal()) {
+                    ++globalWriters_[node.address.slot + 2];
+                }
+                scan(node.start);
+                scan(node.end);
+                scan(node.body);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void declareFunction(uint32_t index, const FunctionDefinition& node) {
+        std::string name = "myndra." + std::string(program_.text(node.name));
+        std::vector<llvm::Type*> params(node.parameters.count, i64_);
+        Target target;
+        target.body = llvm::Function::Create(llvm::FunctionType::get(i64_, params, false),
+                                             llvm::GlobalValue::InternalLinkage, name, module_);
+        target.entry = llvm::Function::Create(llvm::FunctionType::get(i64_, {i64ptr_}, false),
+                                              llvm::GlobalValue::InternalLinkage, name + ".entry", module_);
+        target.body->addFnAttr(llvm::Attribute::UWTable);
+        target.entry->addFnAttr(llvm::Attribute::UWTable);
+        functions_.emplace_back(index, target);
+        targets_[index] = target;
+    }
+
+    // Function a call through `callee` with `count` arguments can jump to
+    // directly, or null
+    const Target* directTarget(const Identifier& callee, size_t count) {
+        if (!callee.address.isGlobal()) {
+            return nullptr;
+        }
+        auto function = globalFunctions_.find(callee.address.slot);
+        if (function == globalFunctions_.end() || globalWriters_[callee.address.slot] != 1) {
+            return nullptr;
+        }
+        const Target& target = targets_.at(function->second);
+        return target.body->arg_size() == count ? &target : nullptr;
+    }
+
+    void lowerMain() {
+        auto* body = llvm::Function::Create(llvm::FunctionType::get(b_.getVoidTy(), false),
+                                            llvm::GlobalValue::InternalLinkage, "myndra.main", module_);
+        body->addFnAttr(llvm::Attribute::UWTable);
+        state_ = FunctionState();
+        state_.function = body;
+        state_.frame = globals_;
+        state_.frameType = globalsType_;
+        state_.top = true;
+        b_.SetInsertPoint(block("entry", body));
+        lowerStatements(program_.statements());
+        if (!b_.GetInsertBlock()->getTerminator()) {
+            b_.CreateRetVoid();
+        }
+
+        auto* main = llvm::Function::Create(llvm::FunctionType::get(i32_, false), llvm::GlobalValue::ExternalLinkage,
+                                            "main", module_);
+        b_.SetInsertPoint(block("entry", main));
+        b_.CreateRet(b_.CreateCall(rtMain_, {body}));
+    }
+
+    void lowerFunction(uint32_t index, const Target& target) {
+        const auto& node = program_.node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, index));
+
+        // The array entry point, for calls through the function value
+        b_.SetInsertPoint(block("entry", target.entry));
+        std::vector<llvm::Value*> args;
+        for (uint32_t i = 0; i < node.parameters.count; ++i) {
+            args.push_back(b_.CreateLoad(i64_, b_.CreateConstInBoundsGEP1_64(i64_, target.entry->getArg(0), i)));
+        }
+        b_.CreateRet(b_.CreateCall(target.body, args));
+
+        state_ = FunctionState();
+        state_.function = target.body;
+        state_.frameSize = std::max(node.frame_size, node.parameters.count);
+        b_.SetInsertPoint(block("entry", target.body));
+        if (state_.frameSize > 0) {
+            state_.frameType = llvm::ArrayType::get(i64_, state_.frameSize);
+            state_.frame = b_.CreateAlloca(state_.frameType, nullptr, "frame");
+            for (uint32_t i = 0; i < state_.frameSize; ++i) {
+                llvm::Value* initial = i < node.parameters.count ? static_cast<llvm::Value*>(target.body->getArg(i))
+                                                                 : value(RuntimeValue::kIntTag);
+                b_.CreateStore(initial, framePointer(i));
+            }
+        }
+
+        // Same depth limit as the other engines
+        llvm::Value* depth = b_.CreateLoad(i32_, depth_);
+        llvm::BasicBlock* overflow = block("overflow");
+        llvm::BasicBlock* body = block("body");
+        b_.CreateCondBr(b_.CreateICmpUGE(depth, u32(static_cast<uint32_t>(kMaxCallDepth))), overflow, body);
+        b_.SetInsertPoint(overflow);
+        b_.CreateCall(rtRaise_, {b_.CreateGlobalStringPtr("Stack overflow")});
+        b_.CreateUnreachable();
+        b_.SetInsertPoint(body);
+        b_.CreateStore(b_.CreateAdd(depth, u32(1)), depth_);
+
+        lowerStatement(node.body);
+        if (!b_.GetInsertBlock()->getTerminator()) {
+            emitReturn(value(RuntimeValue::kIntTag));
+        }
+    }
+
+    llvm::Value* framePointer(uint32_t slot) {
+        return b_.CreateConstInBoundsGEP2_64(state_.frameType, state_.frame, 0, slot);
+    }
+
+    // Leaves the current function: drops its frame's references first
+    void leaveFunction() {
+        for (uint32_t i = 0; i < state_.frameSize; ++i) {
+            b_.CreateCall(release_, {b_.CreateLoad(i64_, framePointer(i))});
+        }
+        b_.CreateStore(b_.CreateSub(b_.CreateLoad(i32_, depth_), u32(1)), depth_);
+    }
+
+    void emitReturn(llvm::Value* result) {
+        leaveFunction();
+        b_.CreateRet(result);
+    }
+
+    // Code after a return or raise goes to an unreachable block
+    void startDeadBlock() {
+        b_.SetInsertPoint(block("dead"));
+    }
+
+    llvm::Value* raise(const std::string& message) {
+        b_.CreateCall(rtRaise_, {b_.CreateGlobalStringPtr(message)});
+        b_.CreateUnreachable();
+        startDeadBlock();
+        return value(RuntimeValue::kIntTag);
+    }
+
+    // Address of the slot `address` names, or null after raising the
+    // interpreter's error for it
+    llvm::Value* slotPointer(const SlotAddress& address, Atom name) {
+        if (address.isGlobal() || (state_.top && address.depth == 0)) {
+            return b_.CreateConstInBoundsGEP2_64(globalsType_, globals_, 0, address.slot);
+        }
+        if (address.depth == 0) {
+            return framePointer(address.slot);
+        }
+        raise("Undefined variable '" + std::string(program_.text(name)) + "'");
+        return nullptr;
+    }
+
+    // Stores an owned value, dropping the reference the slot held
+    void storeOwned(llvm::Value* pointer, llvm::Value* v) {
+        llvm::Value* old = b_.CreateLoad(i64_, pointer);
+        b_.CreateStore(v, pointer);
+        b_.CreateCall(release_, {old});
+    }
+
+    llvm::AllocaInst* entryArray(uint32_t count) {
+        llvm::IRBuilder<> entry(&state_.function->getEntryBlock(), state_.function->getEntryBlock().begin());
+        return entry.CreateAlloca(llvm::ArrayType::get(i64_, std::max<uint32_t>(count, 1)), nullptr, "args");
+    }
+
+    // --- Statements ---
+
+    void lowerStatements(std::span<const NodeRef> statements) {
+        for (NodeRef stmt : statements) {
+            lowerStatement(stmt);
+        }
+    }
+
+    void lowerStatement(NodeRef stmt) {
+        switch (stmt.kind()) {
+            case NodeKind::ExpressionStatement: {
+                // Code for another context leaves nothing behind
+                NodeRef expression = program_.node<ExpressionStatement>(stmt).expression;
+                if (expression.kind() == NodeKind::ContextConditional &&
+                    !contextMatches(program_.node<ContextConditional>(expression))) {
+                    break;
+                }
+                b_.CreateCall(release_, {lowerExpression(expression)});
+                break;
+            }
+            case NodeKind::VariableDeclaration: {
+                const auto& node = program_.node<VariableDeclaration>(stmt);
+                llvm::Value* v = node.initializer ? lowerExpression(node.initializer) : value(RuntimeValue::kIntTag);
+                if (llvm::Value* pointer = slotPointer(node.address, node.name)) {
+                    storeOwned(pointer, v);
+                }
+                break;
+            }
+            case NodeKind::Block:
+                lowerStatements(program_.list(program_.node<Block>(stmt).statements));
+                break;
+            case NodeKind::FunctionDefinition: {
+                const auto& node = program_.node<FunctionDefinition>(stmt);
+                std::string_view name = program_.text(node.name);
+                llvm::Value* function = b_.CreateCall(
+                    rtFunction_, {b_.CreateGlobalStringPtr(name), value(name.size()), u32(node.parameters.count),
+                                  targets_.at(stmt.index()).entry});
+                if (llvm::Value* pointer = slotPointer(node.address, node.name)) {
+                    storeOwned(pointer, function);
+                }
+                break;
+            }
+            case NodeKind::ReturnStatement:
+                lowerReturn(program_.node<ReturnStatement>(stmt));
+                break;
+            case NodeKind::IfStatement: {
+                const auto& node = program_.node<IfStatement>(stmt);
+                llvm::Value* condition = b_.CreateCall(truthy_, {lowerExpression(node.condition)});
+                llvm::BasicBlock* then = block("then");
+                llvm::BasicBlock* otherwise = block("else");
+                llvm::BasicBlock* merge = block("endif");
+                b_.CreateCondBr(condition, then, otherwise);
+                b_.SetInsertPoint(then);
+                lowerStatement(node.then_branch);
+                b_.CreateBr(merge);
+                b_.SetInsertPoint(otherwise);
+                if (node.else_branch) {
+                    lowerStatement(node.else_branch);
+                }
+                b_.CreateBr(merge);
+                b_.SetInsertPoint(merge);
+                break;
+            }
+            case NodeKind::WhileStatement: {
+                const auto& node = program_.node<WhileStatement>(stmt);
+                llvm::BasicBlock* test = block("while");
+                llvm::BasicBlock* body = block("do");
+                llvm::BasicBlock* exit = block("endwhile");
+                b_.CreateBr(test);
+                b_.SetInsertPoint(test);
+                b_.CreateCondBr(b_.CreateCall(truthy_, {lowerExpression(node.condition)}), body, exit);
+                b_.SetInsertPoint(body);
+                lowerStatement(node.body);
+                b_.CreateBr(test);
+                b_.SetInsertPoint(exit);
+                break;
+            }
+            case NodeKind::ForStatement:
+                lowerFor(program_.node<ForStatement>(stmt));
+                break;
+            default:
+                raise("Invalid statement");
+                break;
+        }
+    }
+
+    // The counter is an i64 phi rather than a slot; only the variable's
+    // slot is written, with a boxed copy for the body
+    void lowerFor(const ForStatement& node) {
+        llvm::Value* start = lowerExpression(node.start);
+        llvm::Value* end = lowerExpression(node.end);
+        llvm::Value* first = rangeBound(start);
+        llvm::Value* limit = rangeBound(end);
+        SlotAddress address = node.address;
+        address.slot += 2;
+        llvm::Value* pointer = slotPointer(address, node.variable);
+        if (!pointer) {
+            return;
+        }
+
+        llvm::BasicBlock* entry = b_.GetInsertBlock();
+        llvm::BasicBlock* test = block("for");
+        llvm::BasicBlock* body = block("for_body");
+        llvm::BasicBlock* exit = block("endfor");
+        b_.CreateBr(test);
+        b_.SetInsertPoint(test);
+        llvm::PHINode* counter = b_.CreatePHI(i64_, 2, "counter");
+        counter->addIncoming(first, entry);
+        b_.CreateCondBr(b_.CreateICmpSLT(counter, limit), body, exit);
+        b_.SetInsertPoint(body);
+        storeOwned(pointer, boxInt(counter));
+        lowerStatement(node.body);
+        // Below the limit, so the step cannot overflow
+        counter->addIncoming(b_.CreateNSWAdd(counter, value(1)), b_.GetInsertBlock());
+        b_.CreateBr(test);
+        b_.SetInsertPoint(exit);
+    }
+
+    // Integer value of a for loop bound, which it consumes
+    llvm::Value* rangeBound(llvm::Value* v) {
+        llvm::BasicBlock* immediate = block("bound_int");
+        llvm::BasicBlock* other = block("bound_other");
+        llvm::BasicBlock* done = block("bound");
+        b_.CreateCondBr(hasTag(v, kIntTag16), immediate, other);
+        b_.SetInsertPoint(immediate);
+        llvm::Value* small = payloadInt(v);
+        b_.CreateBr(done);
+        b_.SetInsertPoint(other);
+        llvm::Value* large = b_.CreateCall(rtRangeBound_, {v});
+        b_.CreateBr(done);
+        b_.SetInsertPoint(done);
+        llvm::PHINode* bound = b_.CreatePHI(i64_, 2);
+        bound->addIncoming(small, immediate);
+        bound->addIncoming(large, other);
+        return bound;
+    }
+
+    // Boxed int64, on the heap if it needs more than 48 bits
+    llvm::Value* boxInt(llvm::Value* x) {
+        llvm::BasicBlock* immediate = block("box_int");
+        llvm::BasicBlock* heap = block("box_heap");
+        llvm::BasicBlock* done = block("boxed");
+        b_.CreateCondBr(fitsSmallInt(x), immediate, heap);
+        b_.SetInsertPoint(immediate);
+        llvm::Value* small = boxSmallInt(x);
+        b_.CreateBr(done);
+        b_.SetInsertPoint(heap);
+        llvm::Value* large = b_.CreateCall(rtInt_, {x});
+        b_.CreateBr(done);
+        b_.SetInsertPoint(done);
+        llvm::PHINode* boxed = b_.CreatePHI(i64_, 2);
+        boxed->addIncoming(small, immediate);
+        boxed->addIncoming(large, heap);
+        return boxed;
+    }
+
+    void lowerReturn(const ReturnStatement& node) {
+        // A top-level return ends the program
+        if (state_.top) {
+            if (node.value) {
+                b_.CreateCall(release_, {lowerExpression(node.value)});
+            }
+            b_.CreateRetVoid();
+            startDeadBlock();
+            return;
+        }
+
+        // A tail call to a known function becomes a jump once this frame is
+        // gone
+        if (node.tail_call) {
+            const auto& call = program_.node<FunctionCall>(node.value);
+            if (call.function.kind() == NodeKind::Identifier) {
+                const auto& callee = program_.node<Identifier>(call.function);
+                auto arguments = program_.list(call.arguments);
+                if (const Target* target = directTarget(callee, arguments.size())) {
+                    std::vector<llvm::Value*> args;
+                    for (NodeRef arg : arguments) {
+                        args.push_back(lowerExpression(arg));
+                    }
+                    guardDefined(callee);
+                    leaveFunction();
+                    llvm::CallInst* result = b_.CreateCall(target->body, args);
+                    result->setTailCall();
+                    b_.CreateRet(result);
+                    startDeadBlock();
+                    return;
+                }
+            }
+        }
+
+        emitReturn(node.value ? lowerExpression(node.value) : value(RuntimeValue::kIntTag));
+        startDeadBlock();
+    }
+
+    // A directly called function may not be defined yet when the call runs
+    void guardDefined(const Identifier& callee) {
+        llvm::Value* current = b_.CreateLoad(i64_, b_.CreateConstInBoundsGEP2_64(globalsType_, globals_, 0, callee.address.slot));
+        llvm::BasicBlock* undefined = block("undefined");
+        llvm::BasicBlock* defined = block("defined");
+        b_.CreateCondBr(hasTag(current, kObjectTag16), defined, undefined);
+        b_.SetInsertPoint(undefined);
+        b_.CreateCall(rtRaise_, {b_.CreateGlobalStringPtr("Value is not callable")});
+        b_.CreateUnreachable();
+        b_.SetInsertPoint(defined);
+    }
+
+    // --- Expressions (each yields an owned value) ---
+
+    llvm::Value* lowerExpression(NodeRef expr) {
+        switch (expr.kind()) {
+            case NodeKind::IntegerLiteral: {
+                int64_t n = program_.node<IntegerLiteral>(expr).value;
+                if (n >= RuntimeValue::kSmallIntMin && n <= RuntimeValue::kSmallIntMax) {
+                    return value(RuntimeValue(n).bits());
+                }
+                return b_.CreateCall(rtInt_, {llvm::ConstantInt::get(i64_, static_cast<uint64_t>(n))});
+            }
+            case NodeKind::FloatLiteral:
+                return value(RuntimeValue(program_.node<FloatLiteral>(expr).value).bits());
+            case NodeKind::BooleanLiteral:
+                return value(RuntimeValue(program_.node<BooleanLiteral>(expr).value).bits());
+            case NodeKind::StringLiteral:
+                return lowerString(expr);
+            case NodeKind::Identifier: {
+                const auto& node = program_.node<Identifier>(expr);
+                llvm::Value* pointer = slotPointer(node.address, node.name);
+                if (!pointer) {
+                    return value(RuntimeValue::kIntTag);
+                }
+                llvm::Value* v = b_.CreateLoad(i64_, pointer);
+                b_.CreateCall(retain_, {v});
+                return v;
+            }
+            case NodeKind::BinaryExpression:
+                return lowerBinary(program_.node<BinaryExpression>(expr));
+            case NodeKind::UnaryExpression:
+                return lowerUnary(program_.node<UnaryExpression>(expr));
+            case NodeKind::FunctionCall:
+                return lowerCall(program_.node<FunctionCall>(expr));
+            case NodeKind::ArrayAccess: {
+                const auto& node = program_.node<ArrayAccess>(expr);
+                llvm::Value* array = lowerExpression(node.array);
+                llvm::Value* index = lowerExpression(node.index);
+                return b_.CreateCall(rtIndex_, {array, index});
+            }
+            case NodeKind::ArrayLiteral: {
+                auto elements = program_.list(program_.node<ArrayLiteral>(expr).elements);
+                llvm::Value* values = lowerArguments(elements);
+                return b_.CreateCall(rtArray_, {values, u32(static_cast<uint32_t>(elements.size()))});
+            }
+            case NodeKind::ObjectLiteral:
+                return lowerObjectLiteral(program_.node<ObjectLiteral>(expr));
+            case NodeKind::MemberAccess: {
+                const auto& node = program_.node<MemberAccess>(expr);
+                llvm::Value* object = lowerExpression(node.object);
+                std::string_view key = node.member.text();
+                return b_.CreateCall(rtGetMember_, {object, newSite(), bytesConstant(key), value(key.size())});
+            }
+            case NodeKind::ContextConditional: {
+                const auto& node = program_.node<ContextConditional>(expr);
+                return contextMatches(node) ? lowerExpression(node.expression) : value(RuntimeValue::kIntTag);
+            }
+            default:
+                return raise("Invalid expression");
+        }
+    }
+
+    bool contextMatches(const ContextConditional& node) const {
+        return program_.text(node.context) == deployment_;
+    }
+
+    // Literal strings are created on first use and kept for the program's
+    // lifetime
+    llvm::Value* lowerString(NodeRef expr) {
+        StringRef text = program_.node<StringLiteral>(expr).value;
+        llvm::GlobalVariable*& cache = strings_[expr.index()];
+        if (!cache) {
+            cache = new llvm::GlobalVariable(module_, i64_, false, llvm::GlobalValue::InternalLinkage, value(0),
+                                             "myndra.string");
+        }
+        llvm::BasicBlock* create = block("string_new");
+        llvm::BasicBlock* ready = block("string_ready");
+        llvm::BasicBlock* from = b_.GetInsertBlock();
+        llvm::Value* cached = b_.CreateLoad(i64_, cache);
+        b_.CreateCondBr(b_.CreateICmpEQ(cached, value(0)), create, ready);
+        b_.SetInsertPoint(create);
+        std::string_view bytes = program_.text(text);
+        llvm::Value* created = b_.CreateCall(rtString_, {bytesConstant(bytes), value(bytes.size())});
+        b_.CreateStore(created, cache);
+        llvm::BasicBlock* createdEnd = b_.GetInsertBlock();
+        b_.CreateBr(ready);
+        b_.SetInsertPoint(ready);
+        llvm::PHINode* v = b_.CreatePHI(i64_, 2);
+        v->addIncoming(cached, from);
+        v->addIncoming(created, createdEnd);
+        b_.CreateCall(retain_, {v});
+        return v;
+    }
+
+    // Constant bytes, not NUL-terminated
+    llvm::Value* bytesConstant(std::string_view bytes) {
+        auto* data = new llvm::GlobalVariable(
+            module_, llvm::ArrayType::get(b_.getInt8Ty(), bytes.size()), true, llvm::GlobalValue::PrivateLinkage,
+            llvm::ConstantDataArray::getString(context_, llvm::StringRef(bytes.data(), bytes.size()), false), "myndra.text");
+        return b_.CreateBitCast(data, i8ptr_);
+    }
+
+    // Slot where the runtime keeps a literal's shape or a site's inline cache
+    llvm::Value* newSite() {
+        return new llvm::GlobalVariable(module_, i8ptr_, false, llvm::GlobalValue::InternalLinkage,
+                                        llvm::ConstantPointerNull::get(i8ptr_), "myndra.site");
+    }
+
+    llvm::Value* lowerObjectLiteral(const ObjectLiteral& node) {
+        // The runtime builds the shape from the keys on the first run
+        std::string keys;
+        std::vector<NodeRef> values;
+        for (NodeRef ref : program_.list(node.properties)) {
+            const auto& property = program_.node<ObjectProperty>(ref);
+            std::string_view key = property.key.text();
+            uint32_t length = static_cast<uint32_t>(key.size());
+            keys.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            keys.append(key);
+            values.push_back(property.value);
+        }
+        llvm::Value* slots = lowerArguments(values);
+        return b_.CreateCall(rtObject_, {newSite(), bytesConstant(keys), slots, u32(static_cast<uint32_t>(values.size()))});
+    }
+
+    llvm::Value* lowerBinary(const BinaryExpression& node) {
+        if (node.op == BinaryOperator::Assign) {
+            if (node.left.kind() == NodeKind::ArrayAccess) {
+                // Array, index, then value; the store takes one reference
+                // to the value and the expression's result is the other
+                const auto& target = program_.node<ArrayAccess>(node.left);
+                llvm::Value* array = lowerExpression(target.array);
+                llvm::Value* index = lowerExpression(target.index);
+                llvm::Value* v = lowerExpression(node.right);
+                b_.CreateCall(retain_, {v});
+                b_.CreateCall(rtStoreIndex_, {array, index, v});
+                return v;
+            }
+            if (node.left.kind() == NodeKind::MemberAccess) {
+                const auto& target = program_.node<MemberAccess>(node.left);
+                llvm::Value* object = lowerExpression(target.object);
+                llvm::Value* v = lowerExpression(node.right);
+                b_.CreateCall(retain_, {v});
+                std::string_view key = target.member.text();
+                b_.CreateCall(rtSetMember_, {object, v, newSite(), bytesConstant(key), value(key.size())});
+                return v;
+            }
+            if (node.left.kind() != NodeKind::Identifier) {
+                return raise("Invalid assignment target");
+            }
+            llvm::Value* v = lowerExpression(node.right);
+            const auto& target = program_.node<Identifier>(node.left);
+            llvm::Value* pointer = slotPointer(target.address, target.name);
+            if (!pointer) {
+                return value(RuntimeValue::kIntTag);
+            }
+            // One reference for the slot, one for the expression's result
+            b_.CreateCall(retain_, {v});
+            storeOwned(pointer, v);
+            return v;
+        }
+        llvm::Value* left = lowerExpression(node.left);
+        llvm::Value* right = lowerExpression(node.right);
+        switch (node.op) {
+            case BinaryOperator::Add:
+            case BinaryOperator::Sub:
+            case BinaryOperator::Mul:
+            case BinaryOperator::Div:
+            case BinaryOperator::Eq:
+            case BinaryOperator::Ne:
+            case BinaryOperator::Lt:
+            case BinaryOperator::Le:
+            case BinaryOperator::Gt:
+            case BinaryOperator::Ge:
+                // Proven ints may still be boxed, so they keep the tag check
+                if (node.operands == ValueType::Float) {
+                    return b_.CreateCall(floatHelper(node.op), {left, right});
+                }
+                return b_.CreateCall(binaryHelper(node.op), {left, right});
+            default:
+                return b_.CreateCall(rtBinary_, {u32(static_cast<uint32_t>(node.op)), left, right});
+        }
+    }
+
+    llvm::Value* lowerUnary(const UnaryExpression& node) {
+        llvm::Value* operand = lowerExpression(node.operand);
+        if (node.op == UnaryOperator::Not) {
+            return boxBool(b_.CreateNot(b_.CreateCall(truthy_, {operand})));
+        }
+        return b_.CreateCall(rtUnary_, {u32(static_cast<uint32_t>(node.op)), operand});
+    }
+
+    llvm::Value* lowerCall(const FunctionCall& node) {
+        if (node.function.kind() == NodeKind::MemberAccess) {
+            return lowerMethodCall(node);
+        }
+        if (node.function.kind() != NodeKind::Identifier) {
+            return raise("Function calls with complex expressions not yet supported");
+        }
+        const auto& callee = program_.node<Identifier>(node.function);
+        auto arguments = program_.list(node.arguments);
+        uint32_t count = static_cast<uint32_t>(arguments.size());
+
+        if (callee.address.isResolved()) {
+            if (const Target* target = directTarget(callee, count)) {
+                std::vector<llvm::Value*> args;
+                for (NodeRef arg : arguments) {
+                    args.push_back(lowerExpression(arg));
+                }
+                guardDefined(callee);
+                return b_.CreateCall(target->body, args);
+            }
+
+            llvm::Value* pointer = slotPointer(callee.address, callee.name);
+            if (!pointer) {
+                return value(RuntimeValue::kIntTag);
+            }
+            llvm::Value* function = b_.CreateLoad(i64_, pointer);
+            b_.CreateCall(retain_, {function});
+            llvm::Value* args = lowerArguments(arguments);
+            return b_.CreateCall(rtCall_, {function, args, u32(count)});
+        }
+
+        if (node.native_id != FunctionCall::kNoNative) {
+            // Only the builtins exist in a standalone program
+            if (node.native_id >= NativeRegistry::builtins().size()) {
+                return raise("Native function '" + natives_.entries()[node.native_id].name +
+                             "' is not available in compiled programs");
+            }
+            llvm::Value* args = lowerArguments(arguments);
+            return b_.CreateCall(rtNative_, {u32(node.native_id), args, u32(count)});
+        }
+        return raise("Function '" + std::string(program_.text(callee.name)) + "' is not defined");
+    }
+
+    // `x.f(args)` calls native f with x first
+    llvm::Value* lowerMethodCall(const FunctionCall& node) {
+        const auto& method = program_.node<MemberAccess>(node.function);
+        if (node.native_id == FunctionCall::kNoNative) {
+            return raise("Method '" + std::string(program_.text(method.member)) + "' is not defined");
+        }
+        if (node.native_id >= NativeRegistry::builtins().size()) {
+            return raise("Native function '" + natives_.entries()[node.native_id].name +
+                         "' is not available in compiled programs");
+        }
+        auto arguments = program_.list(node.arguments);
+        uint32_t count = static_cast<uint32_t>(arguments.size()) + 1;
+        llvm::AllocaInst* array = entryArray(count);
+        b_.CreateStore(lowerExpression(method.object), b_.CreateConstInBoundsGEP2_64(array->getAllocatedType(), array, 0, 0));
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            llvm::Value* v = lowerExpression(arguments[i]);
+            b_.CreateStore(v, b_.CreateConstInBoundsGEP2_64(array->getAllocatedType(), array, 0, i + 1));
+        }
+        llvm::Value* args = b_.CreateConstInBoundsGEP2_64(array->getAllocatedType(), array, 0, 0);
+        return b_.CreateCall(rtNative_, {u32(node.native_id), args, u32(count)});
+    }
+
+    // Evaluates arguments into an array the callee takes over
+    llvm::Value* lowerArguments(std::span<const NodeRef> arguments) {
+        llvm::AllocaInst* array = entryArray(static_cast<uint32_t>(arguments.size()));
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            llvm::Value* v = lowerExpression(arguments[i]);
+            b_.CreateStore(v, b_.CreateConstInBoundsGEP2_64(array->getAllocatedType(), array, 0, i));
+        }
+        return b_.CreateConstInBoundsGEP2_64(array->getAllocatedType(), array, 0, 0);
+    }
+};
+
+} // namespace
+
+LlvmCodegen::LlvmCodegen(const NativeRegistry& natives) : natives_(natives) {}
+
+void LlvmCodegen::emitObject(Program& program, const std::string& path) {
+    Resolver resolver(natives_);
+    resolver.resolve(program);
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    llvm::LLVMContext context;
+    llvm::Module module("myndra", context);
+    Lowering(context, module, program, natives_, resolver.globalSlotCount(), context_).run();
+
+    std::string verifyErrors;
+    llvm::raw_string_ostream verifyStream(verifyErrors);
+    if (llvm::verifyModule(module, &verifyStream)) {
+        throw std::runtime_error("Invalid LLVM IR generated: " + verifyStream.str());
+    }
+
+    std::string triple = llvm::sys::getDefaultTargetTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        throw std::runtime_error("Cannot target " + triple + ": " + error);
+    }
+    std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
+        triple, llvm::sys::getHostCPUName(), "", llvm::TargetOptions(), llvm::Optional<llvm::Reloc::Model>(llvm::Reloc::PIC_)));
+    module.setTargetTriple(triple);
+    module.setDataLayout(machine->createDataLayout());
+
+    // Standard O2 pipeline
+    llvm::LoopAnalysisManager loops;
+    llvm::FunctionAnalysisManager functions;
+    llvm::CGSCCAnalysisManager cgscc;
+    llvm::ModuleAnalysisManager modules;
+    llvm::PassBuilder passes(machine.get());
+    passes.registerModuleAnalyses(modules);
+    passes.registerCGSCCAnalyses(cgscc);
+    passes.registerFunctionAnalyses(functions);
+    passes.registerLoopAnalyses(loops);
+    passes.crossRegisterProxies(loops, functions, cgscc, modules);
+    passes.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2).run(module, modules);
+
+    std::error_code ec;
+    llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_None);
+    if (ec) {
+        throw std::runtime_error("Cannot write " + path + ": " + ec.message());
+    }
+    llvm::legacy::PassManager emit;
+    if (machine->addPassesToEmitFile(emit, out, nullptr, llvm::CGFT_ObjectFile)) {
+        throw std::runtime_error("LLVM cannot emit object files for " + triple);
+    }
+    emit.run(module);
+    out.flush();
+}
+
+void LlvmCodegen::linkExecutable(const std::string& object, const std::string& output) {
+    // Both can be overridden, e.g. for an installed compiler
+    const char* linker = std::getenv("MYNDRA_CXX");
+    const char* runtime = std::getenv("MYNDRA_RUNTIME_LIBRARY");
+    auto quote = [](const std::string& text) {
+        std::string quoted = "'";
+        for (char c : text) {
+            quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+        }
+        return quoted + "'";
+    };
+    std::string command = quote(linker ? linker : MYNDRA_AOT_LINKER) + " " + quote(object) + " " +
+                          quote(runtime ? runtime : MYNDRA_RUNTIME_LIBRARY) + " -lpthread -o " + quote(output);
+    if (std::system(command.c_str()) != 0) {
+        throw std::runtime_error("Linking failed: " + command);
+    }
+}
+
+} // namespace myndra
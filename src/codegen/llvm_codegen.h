@@ -0,0 +1,49 @@
+#ifndef MYNDRA_LLVM_CODEGEN_H
+#define MYNDRA_LLVM_CODEGEN_H
+
+#include "../parser/ast.h"
+#include "../runtime/natives.h"
+#include <string>
+
+namespace myndra {
+
+// Ahead-of-time native backend (built only when LLVM is available).
+//
+// Lowers a whole program to LLVM IR, runs the standard O2 pipeline and
+// writes an object file that defines main(); linking it against the
+// myndra_runtime library gives a standalone executable.
+//
+// Values stay NaN-boxed 64-bit words, so the generated code keeps the
+// dynamic semantics of the interpreter. Arithmetic and comparisons on
+// small ints and doubles, truthiness tests and reference counting are
+// inlined; everything else calls the runtime library, which shares its
+// evaluator with the interpreter. Top-level functions that are never
+// reassigned are called directly (and tail calls between them become
+// jumps); other calls go through the function value. Each function gets
+// an LLVM frame of its resolved size; globals live in one static array.
+// Context conditionals are resolved for the context set here, once and
+// for all.
+class LlvmCodegen {
+public:
+    explicit LlvmCodegen(const NativeRegistry& natives = NativeRegistry::builtins());
+
+    // Resolves `program` and writes the optimized object file to `path`.
+    // Throws std::runtime_error if the host cannot be targeted or the
+    // file cannot be written.
+    void emitObject(Program& program, const std::string& path);
+
+    // Context the executable is built for
+    void setContext(std::string context) { context_ = std::move(context); }
+
+    // Links an object written by emitObject with the runtime library into
+    // the executable `output`; throws if the link fails
+    static void linkExecutable(const std::string& object, const std::string& output);
+
+private:
+    const NativeRegistry& natives_;
+    std::string context_{kDefaultContext};
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_LLVM_CODEGEN_H
@@ -2,25 +2,182 @@
 #include "lexer/lexer.h"
 #include "parser/parser.h"
 #include "interpreter/interpreter.h"
+#include "semantics/constant_folder.h"
+#include "semantics/type_checker.h"
+#include "codegen/bytecode_compiler.h"
+#include "runtime/vm.h"
+#include "runtime/natives.h"
+#include "runtime/gc.h"
+#include "runtime/memory.h"
+#include "runtime/object.h"
+#include "cache/module_cache.h"
+#ifdef MYNDRA_HAVE_LLVM
+#include "codegen/llvm_codegen.h"
+#endif
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
 namespace myndra {
 
+namespace {
+
+GcHeap::Config gcConfig(const Compiler::Options& options) {
+    GcHeap::Config config;
+    config.nurseryBytes = options.gc_nursery_bytes;
+    config.pauseBudget = std::chrono::microseconds(options.gc_pause_budget_us);
+    return config;
+}
+
+Jit::Options jitOptions(const Compiler::Options& options) {
+    Jit::Options jit;
+    jit.threshold = options.jit_threshold;
+    jit.perfMap = options.jit_perf_map;
+    jit.trace = options.trace_tiering;
+    return jit;
+}
+
+TieringOptions tieringOptions(const Compiler::Options& options) {
+    TieringOptions tiering;
+    if (options.engine == ExecutionEngine::TIERED) {
+        tiering.threshold = options.tier_threshold;
+    }
+    tiering.jitThreshold = options.jit_threshold;
+    tiering.perfMap = options.jit_perf_map;
+    tiering.trace = options.trace_tiering;
+    return tiering;
+}
+
+} // namespace
+
 // Implementation details
 class Compiler::Impl {
 public:
+    // Runtime objects of this compiler; declared first so it goes last and
+    // takes back their slabs in one step
+    MemoryManager memory;
     Options options;
     std::vector<std::string> errors;
     std::string current_source;
+    NativeRegistry natives;
+    GcHeap heap;  // Outlives the engines, whose values may point into it
+    std::vector<std::unique_ptr<NativeFunction>> host_natives;  // Targets of registered natives
     std::unique_ptr<Program> ast;
+    // Earlier programs of the session; functions they defined still point
+    // into their AST
+    std::vector<std::unique_ptr<Program>> retained_programs;
     std::unique_ptr<Interpreter> interpreter;
+    std::unique_ptr<BytecodeCompiler> bytecode_compiler;
+    std::unique_ptr<VM> vm;
+    std::unique_ptr<ModuleCache> module_cache;  // Null unless a cache directory is set
+    ModuleCacheStats cache_stats;
+    
+    explicit Impl(const Options& opts) : options(opts), heap(gcConfig(opts)), interpreter(std::make_unique<Interpreter>(natives, true, tieringOptions(opts))),
+        bytecode_compiler(std::make_unique<BytecodeCompiler>(natives)), vm(std::make_unique<VM>(natives, size_t(1) << 18, jitOptions(opts))) {
+        if (!opts.module_cache_dir.empty()) {
+            module_cache = std::make_unique<ModuleCache>(opts.module_cache_dir);
+        }
+        interpreter->setContext(opts.target_context);
+        bytecode_compiler->setContext(opts.target_context);
+    }
     
-    explicit Impl(const Options& opts) : options(opts), interpreter(std::make_unique<Interpreter>()) {}
+    // Maps a cached parse of `source`, or returns null
+    std::unique_ptr<Program> loadCached(const std::string& source);
+    // Lexes and parses `source`, caching the result when it parsed cleanly
+    std::unique_ptr<Program> parse(const std::string& source);
 };
 
+namespace {
+
+// Folds `program` again now that `checker` has proven its operand types,
+// which identities such as x + 0 need, and checks the result afresh since
+// folding drops annotations. Returns the nodes folded; when there are none
+// the program is kept as it is.
+size_t refold(ConstantFolder& folder, TypeChecker& checker, std::unique_ptr<Program>& program) {
+    auto folded = folder.fold(*program);
+    if (folder.foldedNodes() == 0) {
+        return 0;
+    }
+    program = std::move(folded);
+    checker.check(*program);
+    return folder.foldedNodes();
+}
+
+// `open` holds the objects being converted, so a cycle ends in nil
+Value toHostValue(const RuntimeValue& value, std::vector<const ShapedObject*>& open) {
+    if (value.isBool()) return Value(value.asBool());
+    if (value.isInt()) return Value(value.asInt());
+    if (value.isDouble()) return Value(value.asDouble());
+    if (value.isString()) return Value(std::string(value.asString()));
+    if (isShapedObject(value)) {
+        const ShapedObject* object = asShapedObject(value);
+        if (std::find(open.begin(), open.end(), object) != open.end()) {
+            return Value();
+        }
+        open.push_back(object);
+        std::unordered_map<std::string, Value> properties;
+        for (uint32_t slot = 0; slot < object->shape->size(); ++slot) {
+            properties.emplace(object->shape->key(slot).text(), toHostValue(object->slots[slot], open));
+        }
+        open.pop_back();
+        Value host;
+        host.type = Value::OBJECT;
+        host.data = std::move(properties);
+        return host;
+    }
+    return Value();
+}
+
+Value toHostValue(const RuntimeValue& value) {
+    std::vector<const ShapedObject*> open;
+    return toHostValue(value, open);
+}
+
+RuntimeValue fromHostValue(const Value& value) {
+    switch (value.type) {
+        case Value::NIL: return RuntimeValue();
+        case Value::BOOL: return std::get<bool>(value.data);
+        case Value::INT: return std::get<int64_t>(value.data);
+        case Value::FLOAT: return std::get<double>(value.data);
+        case Value::STRING: return std::get<std::string>(value.data);
+        case Value::OBJECT: {
+            // Keys in sorted order, so equal maps give objects of one shape
+            const auto& properties = std::get<std::unordered_map<std::string, Value>>(value.data);
+            std::vector<const std::pair<const std::string, Value>*> sorted;
+            for (const auto& property : properties) {
+                sorted.push_back(&property);
+            }
+            std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->first < b->first; });
+            const Shape* shape = Shape::empty();
+            std::vector<RuntimeValue> slots;
+            for (const auto* property : sorted) {
+                shape = shape->add(Atom::intern(property->first));
+                slots.push_back(fromHostValue(property->second));
+            }
+            return ShapedObject::make(shape, slots.data());
+        }
+        default:
+            throw std::runtime_error("Native function returned an unsupported value");
+    }
+}
+
+// Adapts a registered NativeFunction to the internal calling convention
+RuntimeValue callHostNative(NativeArgs args, void* data) {
+    std::vector<Value> hostArgs;
+    hostArgs.reserve(args.size());
+    for (const auto& arg : args) {
+        hostArgs.push_back(toHostValue(arg));
+    }
+    return fromHostValue((*static_cast<NativeFunction*>(data))(hostArgs));
+}
+
+} // namespace
+
 // Constructor
+Compiler::Compiler() : Compiler(Options()) {}
+
 Compiler::Compiler(const Options& opts) : pimpl(std::make_unique<Impl>(opts)) {
     std::cout << "Myndra Compiler initialized with context: " 
               << opts.target_context << std::endl;
@@ -37,6 +194,12 @@ Compiler::Compiler(const Options& opts) : pimpl(std::make_unique<Impl>(opts)) {
     if (opts.enable_did) {
         std::cout << "✓ Decentralized identity enabled" << std::endl;
     }
+    if (opts.engine == ExecutionEngine::BYTECODE_VM) {
+        std::cout << "✓ Bytecode VM execution enabled" << std::endl;
+    }
+    if (opts.engine == ExecutionEngine::TIERED && opts.tier_threshold > 0) {
+        std::cout << "✓ Tiered execution enabled" << std::endl;
+    }
 }
 
 // Destructor
@@ -60,48 +223,75 @@ bool Compiler::compile_file(const std::string& filename) {
 }
 
 bool Compiler::compile_string(const std::string& source) {
+    MemoryManager::Scope memory_scope(pimpl->memory);
+    GcHeap::Scope heap_scope(pimpl->heap);
     pimpl->current_source = source;
     pimpl->errors.clear();
     
     std::cout << "Compiling source code..." << std::endl;
     
-    // Lexical analysis
-    Lexer lexer(source);
-    auto tokens = lexer.tokenize();
-    
-    if (lexer.has_errors()) {
-        for (const auto& error : lexer.get_errors()) {
-            pimpl->errors.push_back("Lexer error: " + error);
-        }
+    // Functions of a whole program were typed assuming nothing else calls them
+    if (pimpl->options.whole_program && pimpl->ast) {
+        pimpl->errors.push_back("A whole-program compiler runs a single program");
         return false;
     }
     
-    std::cout << "✓ Lexical analysis completed (" << tokens.size() << " tokens)" << std::endl;
-    
-    // Parsing
-    Parser parser(tokens);
-    pimpl->ast = parser.parseProgram();
+    if (pimpl->ast) {
+        pimpl->retained_programs.push_back(std::move(pimpl->ast));
+    }
     
-    if (parser.hasErrors()) {
-        for (const auto& error : parser.getErrors()) {
-            pimpl->errors.push_back("Parse error: " + error);
+    // An unchanged script skips lexing and parsing entirely
+    pimpl->ast = pimpl->loadCached(source);
+    if (pimpl->ast) {
+        std::cout << "✓ Loaded from module cache (" << pimpl->ast->statements().size() << " statements)" << std::endl;
+    } else {
+        pimpl->ast = pimpl->parse(source);
+        if (!pimpl->ast) {
+            return false;
         }
-        return false;
+        std::cout << "✓ Parsing completed (" << pimpl->ast->statements().size() << " statements)" << std::endl;
     }
     
-    std::cout << "✓ Parsing completed (" << pimpl->ast->statements.size() << " statements)" << std::endl;
+    ConstantFolder folder(pimpl->options.target_context);
+    size_t folded = 0;
+    if (pimpl->options.fold_constants) {
+        pimpl->ast = folder.fold(*pimpl->ast);
+        folded = folder.foldedNodes();
+    }
+    
+    // Type errors are reported but left for the runtime to raise, if reached
+    if (pimpl->options.check_types) {
+        TypeChecker checker(pimpl->options.whole_program, pimpl->natives);
+        checker.check(*pimpl->ast);
+        for (const auto& error : checker.errors()) {
+            std::cout << "⚠ " << error << std::endl;
+        }
+        if (pimpl->options.fold_constants) {
+            folded += refold(folder, checker, pimpl->ast);
+        }
+        std::cout << "✓ Type checking completed (" << checker.typedOperations() << " operations typed)" << std::endl;
+    }
+    if (pimpl->options.fold_constants) {
+        std::cout << "✓ Constant folding completed (" << folded << " nodes folded)" << std::endl;
+    }
     
     // For now, print the AST for debugging
     if (pimpl->options.target_context == "dev") {
         std::cout << "AST:\n" << pimpl->ast->to_string() << std::endl;
     }
     
-    // Execute the AST with the interpreter
-    std::cout << "✓ Semantic analysis completed (stub)" << std::endl;
     std::cout << "✓ Executing..." << std::endl;
     
     try {
-        pimpl->interpreter->execute(*pimpl->ast);
+        if (pimpl->options.engine == ExecutionEngine::BYTECODE_VM) {
+            Chunk chunk = pimpl->bytecode_compiler->compile(*pimpl->ast);
+            if (pimpl->options.target_context == "dev") {
+                std::cout << "Bytecode:\n" << chunk.disassemble() << std::endl;
+            }
+            pimpl->vm->execute(chunk);
+        } else {
+            pimpl->interpreter->execute(*pimpl->ast);
+        }
         std::cout << "✓ Execution completed" << std::endl;
     } catch (const std::exception& e) {
         pimpl->errors.push_back("Runtime error: " + std::string(e.what()));
@@ -111,6 +301,118 @@ bool Compiler::compile_string(const std::string& source) {
     return true;
 }
 
+bool Compiler::emit_native(const std::string& filename, NativeOutput kind, const std::string& output_path) {
+    pimpl->errors.clear();
+#ifdef MYNDRA_HAVE_LLVM
+    std::ifstream file(filename);
+    if (!file.good()) {
+        pimpl->errors.push_back("Cannot open file: " + filename);
+        return false;
+    }
+    std::string source((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+    
+    auto program = pimpl->parse(source);
+    if (!program) {
+        return false;
+    }
+    // An executable never changes context
+    ConstantFolder folder(pimpl->options.target_context, true);
+    if (pimpl->options.fold_constants) {
+        program = folder.fold(*program);
+    }
+    if (pimpl->options.check_types) {
+        // Nothing else links against the executable's functions
+        TypeChecker checker(true, pimpl->natives);
+        checker.check(*program);
+        for (const auto& error : checker.errors()) {
+            std::cout << "⚠ " << error << std::endl;
+        }
+        if (pimpl->options.fold_constants) {
+            refold(folder, checker, program);
+        }
+    }
+    
+    try {
+        LlvmCodegen codegen(pimpl->natives);
+        codegen.setContext(pimpl->options.target_context);
+        if (kind == NativeOutput::OBJECT) {
+            codegen.emitObject(*program, output_path);
+        } else {
+            // The object only lives until it is linked
+            std::string object = output_path + ".o";
+            codegen.emitObject(*program, object);
+            try {
+                LlvmCodegen::linkExecutable(object, output_path);
+            } catch (...) {
+                std::remove(object.c_str());
+                throw;
+            }
+            std::remove(object.c_str());
+        }
+    } catch (const std::exception& e) {
+        pimpl->errors.push_back("Native code generation failed: " + std::string(e.what()));
+        return false;
+    }
+    std::cout << "✓ Wrote " << output_path << std::endl;
+    return true;
+#else
+    (void)filename;
+    (void)kind;
+    (void)output_path;
+    pimpl->errors.push_back("This build has no LLVM backend");
+    return false;
+#endif
+}
+
+std::unique_ptr<Program> Compiler::Impl::loadCached(const std::string& source) {
+    if (!module_cache) {
+        return nullptr;
+    }
+    auto program = module_cache->load(source);
+    if (program) {
+        ++cache_stats.hits;
+    } else {
+        ++cache_stats.misses;
+    }
+    if (options.report_module_cache) {
+        std::cout << "Module cache " << (program ? "hit: " : "miss: ") << module_cache->entryPath(source) << std::endl;
+    }
+    return program;
+}
+
+std::unique_ptr<Program> Compiler::Impl::parse(const std::string& source) {
+    // Lexical analysis
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    
+    if (lexer.has_errors()) {
+        for (const auto& error : lexer.get_errors()) {
+            errors.push_back("Lexer error: " + error);
+        }
+        return nullptr;
+    }
+    
+    std::cout << "✓ Lexical analysis completed (" << tokens.size() << " tokens)" << std::endl;
+    
+    // Parsing
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    
+    if (parser.hasErrors()) {
+        for (const auto& error : parser.getErrors()) {
+            errors.push_back("Parse error: " + error);
+        }
+        return nullptr;
+    }
+    
+    // Cached before the resolver annotates it in place
+    if (module_cache && module_cache->store(source, *program)) {
+        ++cache_stats.writes;
+    }
+    return program;
+}
+
 // Runtime execution
 Value Compiler::execute() {
     std::cout << "Executing compiled code..." << std::endl;
@@ -133,7 +435,15 @@ bool Compiler::reload_capsule(const std::string& name, const std::string& new_co
 
 bool Compiler::update_context(const ExecutionContext& new_context) {
     std::cout << "Updating execution context to: " << new_context.type << std::endl;
-    // TODO: Implement context switching
+    if (new_context.type.empty()) {
+        pimpl->errors.push_back("Execution context type cannot be empty");
+        return false;
+    }
+    // Nothing is recompiled here: code already loaded is specialized for
+    // the new context lazily, as it next runs
+    pimpl->options.target_context = new_context.type;
+    pimpl->interpreter->setContext(new_context.type);
+    pimpl->bytecode_compiler->setContext(new_context.type);
     return true;
 }
 
@@ -167,6 +477,55 @@ bool Compiler::bind_reactive(const std::string& var_name, std::shared_ptr<Observ
     return true;
 }
 
+// Native functions
+bool Compiler::register_native(const std::string& name, NativeFunction function) {
+    if (name.empty() || !function) {
+        pimpl->errors.push_back("Invalid native function registration: '" + name + "'");
+        return false;
+    }
+    pimpl->host_natives.push_back(std::make_unique<NativeFunction>(std::move(function)));
+    pimpl->natives.define(name, callHostNative, pimpl->host_natives.back().get());
+    return true;
+}
+
+// Module cache
+ModuleCacheStats Compiler::get_module_cache_stats() const {
+    return pimpl->cache_stats;
+}
+
+// Garbage collection
+GcStats Compiler::get_gc_stats() const {
+    static_assert(GcStats::kPauseBuckets == GcHeap::kPauseBuckets);
+    const GcHeap::Stats& heap = pimpl->heap.stats();
+    GcStats stats;
+    stats.minor_collections = heap.minorCollections;
+    stats.major_collections = heap.majorCollections;
+    stats.incremental_slices = heap.incrementalSlices;
+    stats.bytes_allocated = heap.bytesAllocated;
+    stats.bytes_promoted = heap.bytesPromoted;
+    stats.objects_collected = heap.objectsCollected;
+    stats.live_bytes = heap.liveBytes;
+    stats.reserved_bytes = heap.reservedBytes;
+    stats.total_pause_ms = std::chrono::duration<double, std::milli>(heap.totalPause).count();
+    stats.max_pause_ms = std::chrono::duration<double, std::milli>(heap.maxPause).count();
+    for (size_t i = 0; i < GcStats::kPauseBuckets; ++i) {
+        stats.pause_histogram[i] = heap.pauseHistogram[i];
+    }
+    return stats;
+}
+
+// Memory
+MemoryStats Compiler::get_memory_stats() const {
+    MemoryManager::Stats memory = pimpl->memory.stats();
+    MemoryStats stats;
+    stats.allocations = memory.allocations;
+    stats.deallocations = memory.deallocations;
+    stats.live_bytes = memory.requestedBytes;
+    stats.reserved_bytes = memory.reservedBytes;
+    stats.fragmentation = memory.fragmentation();
+    return stats;
+}
+
 // Error handling
 void Compiler::set_global_fallback(const FallbackStrategy& strategy) {
     std::cout << "Setting global fallback strategy" << std::endl;
@@ -191,9 +550,10 @@ bool DIDDocument::verify_proof(const std::string& claim) const {
 // Utility functions
 namespace utils {
     Hash calculate_hash(const std::string& content) {
-        // Simple hash implementation for demo
-        std::hash<std::string> hasher;
-        return std::to_string(hasher(content));
+        // Stable across runs and platforms, unlike std::hash
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(contentHash(content)));
+        return hex;
     }
     
     std::string format_error(const std::string& message, size_t line, size_t column) {
@@ -1,465 +1,970 @@
 #include "interpreter.h"
+#include "../codegen/bytecode_compiler.h"
+#include "../runtime/array.h"
+#include "../runtime/vm.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
 
 namespace myndra {
 
-// Environment implementation
-Environment::Environment(std::shared_ptr<Environment> parent) : parent_(parent) {}
+// FramePool implementation
+FramePool::FramePool(size_t capacity) : slots_(capacity), top_(0) {}
 
-void Environment::define(const std::string& name, const RuntimeValue& value) {
-    variables_[name] = value;
-}
-
-RuntimeValue Environment::get(const std::string& name) const {
-    auto it = variables_.find(name);
-    if (it != variables_.end()) {
-        return it->second;
+RuntimeValue* FramePool::push(uint32_t size) {
+    if (top_ + size > slots_.size()) {
+        throw std::runtime_error("Stack overflow");
     }
-    
-    if (parent_) {
-        return parent_->get(name);
+    RuntimeValue* frame = slots_.data() + top_;
+    for (uint32_t i = 0; i < size; ++i) {
+        frame[i] = RuntimeValue();
     }
-    
-    throw std::runtime_error("Undefined variable '" + name + "'");
+    top_ += size;
+    return frame;
 }
 
-void Environment::assign(const std::string& name, const RuntimeValue& value) {
-    auto it = variables_.find(name);
-    if (it != variables_.end()) {
-        it->second = value;
-        return;
+void FramePool::pop(RuntimeValue* frame) {
+    size_t base = static_cast<size_t>(frame - slots_.data());
+    for (size_t i = base; i < top_; ++i) {
+        slots_[i] = RuntimeValue(); // Drop references held by dead slots
     }
-    
-    if (parent_) {
-        parent_->assign(name, value);
-        return;
+    top_ = base;
+}
+
+void FramePool::growBase(uint32_t size) {
+    if (size > top_) {
+        push(static_cast<uint32_t>(size - top_));
     }
-    
-    throw std::runtime_error("Undefined variable '" + name + "'");
 }
 
 // Interpreter implementation
-Interpreter::Interpreter() : environment_(std::make_shared<Environment>()) {
-    setupBuiltins();
+namespace {
+
+FunctionDefinition& declarationOf(const FunctionObject* function) {
+    return function->program->node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, function->declaration));
 }
 
-void Interpreter::execute(Program& program) {
-    program.accept(*this);
+uint32_t nextContextEpoch() {
+    // Shared by every interpreter, since they may run the same program
+    static std::atomic<uint32_t> epoch{0};
+    return ++epoch;
 }
 
-void Interpreter::visit(IntegerLiteral& node) {
-    lastValue_ = node.value;
+} // namespace
+
+Interpreter::Interpreter(const NativeRegistry& natives, bool quicken, const TieringOptions& tiering)
+    : natives_(natives), resolver_(natives), program_(nullptr), globals_(nullptr), frame_(nullptr),
+      status_(ExecStatus::Normal), callDepth_(0), quicken_(quicken), tiering_(tiering), function_(nullptr),
+      context_(kDefaultContext), contextEpoch_(nextContextEpoch()) {
+    globals_ = frames_.push(0);
+    frame_ = globals_;
+
+    if (tiering.threshold > 0) {
+        Jit::Options jit;
+        jit.threshold = tiering.jitThreshold;
+        jit.perfMap = tiering.perfMap;
+        jit.trace = tiering.trace;
+        vm_ = std::make_unique<VM>(natives, size_t(1) << 18, jit);
+        // The global frame never moves: the pool is allocated up front
+        vm_->attachHost({&Interpreter::callFromVM, this, globals_, &callDepth_});
+        tierCompiler_ = std::make_unique<BytecodeCompiler>(natives);
+    }
 }
 
-void Interpreter::visit(FloatLiteral& node) {
-    lastValue_ = node.value;
+Interpreter::~Interpreter() = default;
+
+void Interpreter::execute(Program& program) {
+    // Keyed by program and node addresses, which a later program may reuse
+    // once an earlier one is freed. Functions already promoted keep their
+    // proto.
+    untiered_.clear();
+    loops_.clear();
+    untieredLoops_.clear();
+    resolver_.resolve(program);
+    frames_.growBase(resolver_.globalSlotCount());
+    program_ = &program;
+    // Programs may have been freed since the last run and their addresses reused
+    literals_.clear();
+    interned_.clear();
+    properties_.clear();
+    shapes_.clear();
+    // Top-level code runs only now, so it is specialized every time
+    specialize(program, ContextConditional::kTopLevel);
+    try {
+        executeStatements(program.statements());
+        // A top-level return ends the program
+        status_ = ExecStatus::Normal;
+    } catch (...) {
+        unwind();
+        throw;
+    }
+    program_ = nullptr;
 }
 
-void Interpreter::visit(StringLiteral& node) {
-    lastValue_ = node.value;
+void Interpreter::setContext(std::string context) {
+    context_ = std::move(context);
+    contextEpoch_ = nextContextEpoch();
+    if (!vm_) {
+        return;
+    }
+    // Compiled code with the old context built in goes; it is promoted
+    // again once it gets hot
+    tierCompiler_->setContext(context_);
+    for (const auto& callee : contextual_) {
+        FunctionObject* function = callee.asFunction();
+        function->proto.reset();
+        declarationOf(function).invocations = 0;
+    }
+    contextual_.clear();
+    loops_.clear();
+}
+
+bool Interpreter::specialize(Program& program, uint32_t function) {
+    // Sets the conditionals of one function (or of the top level) for the
+    // current context; true if it has any
+    bool found = false;
+    for (uint32_t i = 0; i < program.count(NodeKind::ContextConditional); ++i) {
+        auto& conditional = program.node<ContextConditional>(NodeRef(NodeKind::ContextConditional, i));
+        if (conditional.function == function) {
+            conditional.enabled = program.text(conditional.context) == context_;
+            found = true;
+        }
+    }
+    return found;
 }
 
-void Interpreter::visit(BooleanLiteral& node) {
-    lastValue_ = node.value;
+inline const FunctionDefinition* Interpreter::enter(const FunctionObject* function) {
+    // A function's body is specialized on its first call after a context change
+    FunctionDefinition& definition = declarationOf(function);
+    if (definition.context_epoch != contextEpoch_) {
+        specialize(*function->program, function->declaration);
+        definition.context_epoch = contextEpoch_;
+    }
+    return &definition;
+}
+
+void Interpreter::unwind() {
+    // Drop every frame a runtime error left behind, keeping the globals
+    frames_.pop(globals_ + resolver_.globalSlotCount());
+    frame_ = globals_;
+    program_ = nullptr;
+    function_ = nullptr;
+    callDepth_ = 0;
+    status_ = ExecStatus::Normal;
+    pendingCallee_ = RuntimeValue();
+    if (vm_) {
+        vm_->reset();
+    }
 }
 
-void Interpreter::visit(Identifier& node) {
-    lastValue_ = environment_->get(node.name);
+inline RuntimeValue& Interpreter::slot(const SlotAddress& address, Atom name) {
+    if (address.isGlobal()) {
+        return globals_[address.slot];
+    }
+    if (address.depth == 0) {
+        return frame_[address.slot];
+    }
+    undefinedVariable(name);
+}
+
+void Interpreter::undefinedVariable(Atom name) const {
+    throw std::runtime_error("Undefined variable '" + std::string(program_->text(name)) + "'");
+}
+
+// Expressions
+RuntimeValue Interpreter::evaluate(NodeRef expr) {
+    // Only the cheap, common cases are handled inline so this function
+    // needs no stack frame of its own for them
+    const Program& program = *program_;
+    switch (expr.kind()) {
+        case NodeKind::IntegerLiteral:
+            return program.node<IntegerLiteral>(expr).value;
+        case NodeKind::BooleanLiteral:
+            return program.node<BooleanLiteral>(expr).value;
+        case NodeKind::Identifier: {
+            const auto& identifier = program.node<Identifier>(expr);
+            return slot(identifier.address, identifier.name);
+        }
+        case NodeKind::BinaryExpression:
+            return evaluateBinaryExpression(program_->node<BinaryExpression>(expr));
+        case NodeKind::FunctionCall:
+            return evaluateCall(program.node<FunctionCall>(expr));
+        default:
+            return evaluateOther(expr);
+    }
 }
 
-void Interpreter::visit(BinaryExpression& node) {
-    // Evaluate left operand
-    node.left->accept(*this);
-    RuntimeValue left = lastValue_;
-    
-    // Evaluate right operand  
-    node.right->accept(*this);
-    RuntimeValue right = lastValue_;
-    
-    // Perform operation based on operator
-    switch (node.op) {
-        case BinaryOperator::Add: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) + std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) + std::get<double>(right);
-            } else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right)) {
-                lastValue_ = std::get<std::string>(left) + std::get<std::string>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for addition");
-            }
-            break;
+inline RuntimeValue Interpreter::evaluateOperand(NodeRef expr) {
+    // Variables and integer constants, the usual operands, are read in place
+    if (expr.kind() == NodeKind::Identifier) {
+        const auto& identifier = program_->node<Identifier>(expr);
+        return slot(identifier.address, identifier.name);
+    }
+    if (expr.kind() == NodeKind::IntegerLiteral) {
+        return program_->node<IntegerLiteral>(expr).value;
+    }
+    return evaluate(expr);
+}
+
+RuntimeValue Interpreter::evaluateOther(NodeRef expr) {
+    const Program& program = *program_;
+    switch (expr.kind()) {
+        case NodeKind::FloatLiteral:
+            return program.node<FloatLiteral>(expr).value;
+        case NodeKind::StringLiteral:
+            return literal(expr);
+        case NodeKind::UnaryExpression: {
+            const auto& unary = program.node<UnaryExpression>(expr);
+            return evaluateUnary(unary.op, evaluate(unary.operand));
         }
-        case BinaryOperator::Sub: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) - std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) - std::get<double>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for subtraction");
-            }
-            break;
+        case NodeKind::ArrayAccess: {
+            const auto& access = program.node<ArrayAccess>(expr);
+            RuntimeValue array = evaluate(access.array);
+            return indexArray(array, evaluate(access.index));
         }
-        case BinaryOperator::Mul: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) * std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) * std::get<double>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for multiplication");
+        case NodeKind::ArrayLiteral: {
+            // Elements are evaluated into scratch slots, like native arguments
+            auto elements = program.list(program.node<ArrayLiteral>(expr).elements);
+            uint32_t count = static_cast<uint32_t>(elements.size());
+            RuntimeValue* values = frames_.push(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                values[i] = evaluate(elements[i]);
             }
-            break;
+            RuntimeValue array = ArrayObject::make(values, count);
+            frames_.pop(values);
+            return array;
         }
-        case BinaryOperator::Div: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                int64_t r = std::get<int64_t>(right);
-                if (r == 0) throw std::runtime_error("Division by zero");
-                lastValue_ = std::get<int64_t>(left) / r;
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                double r = std::get<double>(right);
-                if (r == 0.0) throw std::runtime_error("Division by zero");
-                lastValue_ = std::get<double>(left) / r;
-            } else {
-                throw std::runtime_error("Invalid operands for division");
+        case NodeKind::ObjectLiteral: {
+            auto properties = program.list(program.node<ObjectLiteral>(expr).properties);
+            uint32_t count = static_cast<uint32_t>(properties.size());
+            RuntimeValue* values = frames_.push(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                values[i] = evaluate(program.node<ObjectProperty>(properties[i]).value);
             }
-            break;
+            RuntimeValue object = ShapedObject::make(literalShape(expr), values);
+            frames_.pop(values);
+            return object;
         }
-        case BinaryOperator::Eq: {
-            lastValue_ = (left == right);
-            break;
+        case NodeKind::MemberAccess: {
+            RuntimeValue object = evaluate(program.node<MemberAccess>(expr).object);
+            return getProperty(object, propertyCache(expr));
         }
-        case BinaryOperator::Ne: {
-            lastValue_ = (left != right);
-            break;
+        case NodeKind::ContextConditional: {
+            // Off, the expression is skipped and the result is 0, like a
+            // function that returns nothing
+            const auto& conditional = program.node<ContextConditional>(expr);
+            return conditional.enabled ? evaluate(conditional.expression) : RuntimeValue();
         }
-        case BinaryOperator::Lt: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) < std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) < std::get<double>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for comparison");
+        default:
+            throw std::runtime_error("Invalid expression");
+    }
+}
+
+namespace {
+
+// Specialization for the operand types an operator node has seen, or
+// Generic when it has none
+BinaryFeedback quicken(BinaryOperator op, const RuntimeValue& left, const RuntimeValue& right) {
+    bool arithmetic = op == BinaryOperator::Add || op == BinaryOperator::Sub ||
+                      op == BinaryOperator::Mul || op == BinaryOperator::Div;
+    bool comparison = op >= BinaryOperator::Eq && op <= BinaryOperator::Ge;
+    if (!arithmetic && !comparison) {
+        return BinaryFeedback::Generic;
+    }
+    if (RuntimeValue::bothSmallInts(left, right)) {
+        return BinaryFeedback::SmallInts;
+    }
+    if (left.isDouble() && right.isDouble()) {
+        return BinaryFeedback::Doubles;
+    }
+    if (left.isString() && right.isString() &&
+        (op == BinaryOperator::Add || op == BinaryOperator::Eq || op == BinaryOperator::Ne)) {
+        return BinaryFeedback::Strings;
+    }
+    return BinaryFeedback::Generic;
+}
+
+// The specialized variants; each matches evaluateBinary for its types
+
+inline RuntimeValue smallIntBinary(BinaryOperator op, int64_t l, int64_t r) {
+    switch (op) {
+        case BinaryOperator::Add: return l + r;
+        case BinaryOperator::Sub: return l - r;
+        case BinaryOperator::Mul: return static_cast<int64_t>(static_cast<uint64_t>(l) * static_cast<uint64_t>(r));
+        case BinaryOperator::Div:
+            if (r == 0) throw std::runtime_error("Division by zero");
+            return l / r;
+        case BinaryOperator::Eq: return l == r;
+        case BinaryOperator::Ne: return l != r;
+        case BinaryOperator::Lt: return l < r;
+        case BinaryOperator::Gt: return l > r;
+        case BinaryOperator::Le: return l <= r;
+        default: return l >= r;
+    }
+}
+
+inline RuntimeValue doubleBinary(BinaryOperator op, double l, double r) {
+    // Ordered comparisons are false for NaN
+    switch (op) {
+        case BinaryOperator::Add: return l + r;
+        case BinaryOperator::Sub: return l - r;
+        case BinaryOperator::Mul: return l * r;
+        case BinaryOperator::Div:
+            if (r == 0.0) throw std::runtime_error("Division by zero");
+            return l / r;
+        case BinaryOperator::Eq: return l == r;
+        case BinaryOperator::Ne: return !(l == r);
+        case BinaryOperator::Lt: return l < r;
+        case BinaryOperator::Gt: return l > r;
+        case BinaryOperator::Le: return l <= r;
+        default: return l >= r;
+    }
+}
+
+inline RuntimeValue stringBinary(BinaryOperator op, const RuntimeValue& l, const RuntimeValue& r) {
+    switch (op) {
+        case BinaryOperator::Add: return concatStrings(l, r);
+        case BinaryOperator::Eq: return l == r;
+        default: return l != r;
+    }
+}
+
+} // namespace
+
+RuntimeValue Interpreter::evaluateBinaryExpression(BinaryExpression& node) {
+    if (node.op == BinaryOperator::Assign) {
+        if (node.left.kind() == NodeKind::ArrayAccess) {
+            // Array, index, then value, left to right
+            const auto& access = program_->node<ArrayAccess>(node.left);
+            RuntimeValue array = evaluate(access.array);
+            RuntimeValue index = evaluate(access.index);
+            RuntimeValue value = evaluate(node.right);
+            storeIndex(array, index, value);
+            return value;
+        }
+        if (node.left.kind() == NodeKind::MemberAccess) {
+            RuntimeValue object = evaluate(program_->node<MemberAccess>(node.left).object);
+            RuntimeValue value = evaluate(node.right);
+            setProperty(object, value, propertyCache(node.left));
+            return value;
+        }
+        if (node.left.kind() != NodeKind::Identifier) {
+            throw std::runtime_error("Invalid assignment target");
+        }
+        RuntimeValue value = evaluate(node.right);
+        const auto& target = program_->node<Identifier>(node.left);
+        slot(target.address, target.name) = value;
+        return value;
+    }
+    RuntimeValue left = evaluateOperand(node.left);
+    RuntimeValue right = evaluateOperand(node.right);
+    switch (node.feedback) {
+        case BinaryFeedback::SmallInts:
+            if (RuntimeValue::bothSmallInts(left, right)) {
+                return smallIntBinary(node.op, left.asSmallInt(), right.asSmallInt());
             }
             break;
-        }
-        case BinaryOperator::Gt: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) > std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) > std::get<double>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for comparison");
+        case BinaryFeedback::Doubles:
+            if (left.isDouble() && right.isDouble()) {
+                return doubleBinary(node.op, left.asDouble(), right.asDouble());
             }
             break;
-        }
-        case BinaryOperator::Le: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) <= std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) <= std::get<double>(right);
-            } else {
-                throw std::runtime_error("Invalid operands for comparison");
+        case BinaryFeedback::Strings:
+            if (left.isString() && right.isString()) {
+                return stringBinary(node.op, left, right);
             }
             break;
-        }
-        case BinaryOperator::Ge: {
-            if (std::holds_alternative<int64_t>(left) && std::holds_alternative<int64_t>(right)) {
-                lastValue_ = std::get<int64_t>(left) >= std::get<int64_t>(right);
-            } else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-                lastValue_ = std::get<double>(left) >= std::get<double>(right);
+        case BinaryFeedback::ProvenDoubles:
+            return doubleBinary(node.op, left.asDouble(), right.asDouble());
+        case BinaryFeedback::Uninitialized:
+            if (!quicken_) {
+                node.feedback = BinaryFeedback::Generic;
+            } else if (node.operands == ValueType::Float) {
+                node.feedback = BinaryFeedback::ProvenDoubles;
             } else {
-                throw std::runtime_error("Invalid operands for comparison");
+                node.feedback = quicken(node.op, left, right);
             }
-            break;
-        }
-        case BinaryOperator::And: {
-            lastValue_ = isTruthy(left) && isTruthy(right);
-            break;
-        }
-        case BinaryOperator::Or: {
-            lastValue_ = isTruthy(left) || isTruthy(right);
-            break;
-        }
-        default:
-            throw std::runtime_error("Unsupported binary operator");
+            return evaluateBinary(node.op, left, right);
+        case BinaryFeedback::Generic:
+            return evaluateBinary(node.op, left, right);
     }
+    // The guess was wrong: the node stays on the generic path from now on
+    node.feedback = BinaryFeedback::Generic;
+    return evaluateBinary(node.op, left, right);
 }
 
-void Interpreter::visit(UnaryExpression& node) {
-    node.operand->accept(*this);
-    RuntimeValue operand = lastValue_;
-    
-    switch (node.op) {
-        case UnaryOperator::Neg: {
-            if (std::holds_alternative<int64_t>(operand)) {
-                lastValue_ = -std::get<int64_t>(operand);
-            } else if (std::holds_alternative<double>(operand)) {
-                lastValue_ = -std::get<double>(operand);
-            } else {
-                throw std::runtime_error("Invalid operand for negation");
-            }
-            break;
+const RuntimeValue& Interpreter::literal(NodeRef expr) {
+    if (expr.index() >= literals_.size()) {
+        literals_.resize(program_->count(NodeKind::StringLiteral));
+    }
+    Literal& entry = literals_[expr.index()];
+    if (entry.program != program_) {
+        std::string_view text = program_->text(program_->node<StringLiteral>(expr).value);
+        auto interned = interned_.find(text);
+        if (interned == interned_.end()) {
+            RuntimeValue value(StringObject::make(text));
+            interned = interned_.emplace(value.asString(), value).first;
         }
-        case UnaryOperator::Not: {
-            lastValue_ = !isTruthy(operand);
-            break;
+        entry.program = program_;
+        entry.value = interned->second;
+    }
+    return entry.value;
+}
+
+PropertyCache& Interpreter::propertyCache(NodeRef access) {
+    if (access.index() >= properties_.size()) {
+        properties_.resize(program_->count(NodeKind::MemberAccess));
+    }
+    PropertySite& site = properties_[access.index()];
+    if (site.program != program_) {
+        site.program = program_;
+        site.cache = PropertyCache(program_->node<MemberAccess>(access).member);
+    }
+    return site.cache;
+}
+
+const Shape* Interpreter::literalShape(NodeRef literal) {
+    if (literal.index() >= shapes_.size()) {
+        shapes_.resize(program_->count(NodeKind::ObjectLiteral));
+    }
+    LiteralShape& entry = shapes_[literal.index()];
+    if (entry.program != program_) {
+        const Shape* shape = Shape::empty();
+        for (NodeRef property : program_->list(program_->node<ObjectLiteral>(literal).properties)) {
+            shape = shape->add(program_->node<ObjectProperty>(property).key);
         }
-        default:
-            throw std::runtime_error("Unsupported unary operator");
+        entry.program = program_;
+        entry.shape = shape;
     }
+    return entry.shape;
 }
 
-void Interpreter::visit(FunctionCall& node) {
-    // Extract function name from the function expression (should be an Identifier)
-    auto* identifier = dynamic_cast<Identifier*>(node.function.get());
-    if (!identifier) {
+RuntimeValue Interpreter::evaluateCall(const FunctionCall& node) {
+    if (node.function.kind() != NodeKind::Identifier) {
+        if (node.function.kind() == NodeKind::MemberAccess) {
+            if (node.native_id != FunctionCall::kNoNative) {
+                return callNative(node);
+            }
+            Atom method = program_->node<MemberAccess>(node.function).member;
+            throw std::runtime_error("Method '" + std::string(program_->text(method)) + "' is not defined");
+        }
         throw std::runtime_error("Function calls with complex expressions not yet supported");
     }
-    
-    std::string functionName = identifier->name;
-    
-    // Handle built-in print function
-    if (functionName == "print") {
-        std::vector<RuntimeValue> args;
-        for (auto& arg : node.arguments) {
-            arg->accept(*this);
-            args.push_back(lastValue_);
-        }
-        lastValue_ = callPrint(args);
-        return;
+
+    // User functions are ordinary values bound to a slot
+    const auto& identifier = program_->node<Identifier>(node.function);
+    if (identifier.address.isResolved()) {
+        return callFunction(slot(identifier.address, identifier.name), node.arguments);
     }
-    
-    // Handle built-in input function
-    if (functionName == "input") {
-        std::vector<RuntimeValue> args;
-        for (auto& arg : node.arguments) {
-            arg->accept(*this);
-            args.push_back(lastValue_);
-        }
-        lastValue_ = callInput(args);
-        return;
+    if (node.native_id != FunctionCall::kNoNative) {
+        return callNative(node);
     }
-    
-    // Handle built-in length function
-    if (functionName == "length") {
-        std::vector<RuntimeValue> args;
-        for (auto& arg : node.arguments) {
-            arg->accept(*this);
-            args.push_back(lastValue_);
-        }
-        lastValue_ = callLength(args);
-        return;
+    throw std::runtime_error("Function '" + std::string(program_->text(identifier.name)) + "' is not defined");
+}
+
+RuntimeValue Interpreter::callNative(const FunctionCall& node) {
+    // Natives were bound to an id by the resolver; their arguments are
+    // evaluated into scratch slots on top of the frame stack. A method call
+    // `x.f(args)` passes x first.
+    auto arguments = program_->list(node.arguments);
+    uint32_t receiver = node.function.kind() == NodeKind::MemberAccess ? 1 : 0;
+    uint32_t count = static_cast<uint32_t>(arguments.size()) + receiver;
+    RuntimeValue* args = frames_.push(count);
+    if (receiver) {
+        args[0] = evaluate(program_->node<MemberAccess>(node.function).object);
     }
-    
-    // Handle built-in substring function
-    if (functionName == "substring") {
-        std::vector<RuntimeValue> args;
-        for (auto& arg : node.arguments) {
-            arg->accept(*this);
-            args.push_back(lastValue_);
-        }
-        lastValue_ = callSubstring(args);
-        return;
+    for (uint32_t i = receiver; i < count; ++i) {
+        args[i] = evaluate(arguments[i - receiver]);
+    }
+    RuntimeValue result = natives_.call(node.native_id, NativeArgs(args, count));
+    frames_.pop(args);
+    return result;
+}
+
+RuntimeValue Interpreter::callFunction(RuntimeValue callee, NodeList arguments) {
+    // Arguments are evaluated straight into the parameter slots of the new
+    // frame, before the callee is checked (same order as the VM)
+    auto args = program_->list(arguments);
+    uint32_t count = static_cast<uint32_t>(args.size());
+    RuntimeValue* frame = frames_.push(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        frame[i] = evaluate(args[i]);
     }
-    
-    // TODO: Handle user-defined functions
-    throw std::runtime_error("Function '" + functionName + "' is not defined");
-}
 
-void Interpreter::visit(ArrayAccess& node) {
-    // TODO: Implement array access
-    throw std::runtime_error("Array access not yet implemented");
+    checkCallable(callee, count);
+    return runFunction(std::move(callee), frame, count);
 }
 
-void Interpreter::visit(MemberAccess& node) {
-    // TODO: Implement member access
-    throw std::runtime_error("Member access not yet implemented");
-}
+RuntimeValue Interpreter::runFunction(RuntimeValue callee, RuntimeValue* frame, uint32_t count) {
+    // `frame` is the top of the frame stack and holds the arguments; it is
+    // popped on return
+    if (callDepth_ + (vm_ ? vm_->depth() : 0) >= kMaxCallDepth) {
+        throw std::runtime_error("Stack overflow");
+    }
+    if (vm_ && promote(callee)) {
+        RuntimeValue result = vm_->call(callee, NativeArgs(frame, count));
+        frames_.pop(frame);
+        return result;
+    }
+    const FunctionDefinition* function = enter(callee.asFunction());
+    frames_.push(function->frame_size - count);
+
+    // The body may belong to an earlier program of the session
+    Program* callerProgram = program_;
+    RuntimeValue* caller = frame_;
+    const FunctionDefinition* callerFunction = function_;
+    program_ = callee.asFunction()->program;
+    frame_ = frame;
+    function_ = function;
+    ++callDepth_;
+
+    // Tail calls reuse this frame and loop instead of recursing
+    RuntimeValue result;
+    for (;;) {
+        executeStatement(function->body);
+        if (status_ != ExecStatus::TailCall) {
+            if (status_ == ExecStatus::Return) {
+                result = std::move(lastValue_);
+                status_ = ExecStatus::Normal;
+            }
+            break;
+        }
+        status_ = ExecStatus::Normal;
+        callee = std::move(pendingCallee_);
+        if (vm_ && promote(callee)) {
+            // The rest of the chain runs in the VM
+            result = vm_->call(callee, NativeArgs(frame, callee.asFunction()->arity));
+            break;
+        }
+        program_ = callee.asFunction()->program;
+        function = enter(callee.asFunction());
+        function_ = function;
+    }
 
-void Interpreter::visit(ContextConditional& node) {
-    // TODO: Implement context conditionals
-    throw std::runtime_error("Context conditionals not yet implemented");
+    --callDepth_;
+    program_ = callerProgram;
+    frame_ = caller;
+    function_ = callerFunction;
+    frames_.pop(frame);
+    return result;
 }
 
-void Interpreter::visit(ExpressionStatement& node) {
-    node.expression->accept(*this);
+RuntimeValue Interpreter::callFromVM(void* self, const RuntimeValue& callee, NativeArgs args) {
+    // The VM has already checked the callee
+    auto* interpreter = static_cast<Interpreter*>(self);
+    uint32_t count = static_cast<uint32_t>(args.size());
+    RuntimeValue* frame = interpreter->frames_.push(count);
+    std::copy(args.begin(), args.end(), frame);
+    return interpreter->runFunction(callee, frame, count);
 }
 
-void Interpreter::visit(VariableDeclaration& node) {
-    RuntimeValue value;
-    if (node.initializer) {
-        node.initializer->accept(*this);
-        value = lastValue_;
-    } else {
-        // Default initialization based on type or use null/default value
-        value = int64_t(0); // Default to 0 for now
+bool Interpreter::promote(const RuntimeValue& callee) {
+    // True if `callee` runs in the VM, compiling it once it is hot
+    FunctionObject* function = callee.asFunction();
+    if (function->proto) {
+        return true;
+    }
+    FunctionDefinition& definition = declarationOf(function);
+    if (++definition.invocations < tiering_.threshold) {
+        return false;
+    }
+    uint32_t calls = definition.invocations;
+    definition.invocations = 0;
+    if (untiered_.count(&definition)) {
+        return false;
     }
-    
-    environment_->define(node.name, value);
-}
 
-void Interpreter::visit(Block& node) {
-    // Create new environment for block scope
-    auto previous = environment_;
-    environment_ = std::make_shared<Environment>(environment_);
-    
-    try {
-        for (auto& stmt : node.statements) {
-            stmt->accept(*this);
+    std::string_view name = function->program->text(definition.name);
+    auto proto = tierCompiler_->compileHotFunction(*function->program, definition);
+    if (!proto) {
+        untiered_.insert(&definition);
+        if (tiering_.trace) {
+            std::cerr << "[tiering] fn " << name << ": stays in the tree walker (not compilable)" << std::endl;
         }
-    } catch (...) {
-        environment_ = previous; // Restore environment
-        throw;
+        return false;
+    }
+    if (tiering_.trace) {
+        std::cerr << "[tiering] fn " << name << ": tree walker -> bytecode after " << calls << " calls" << std::endl;
+    }
+    function->proto = std::move(proto);
+    if (specialize(*function->program, function->declaration)) {
+        contextual_.push_back(callee);
+    }
+    return true;
+}
+
+bool Interpreter::replaceLoop(NodeRef stmt, uint32_t& backedges) {
+    // Runs the rest of a hot loop in the VM, compiling it the first time;
+    // false if the loop has to stay here
+    uint32_t iterations = backedges;
+    backedges = 0;
+    LoopSite loop{program_, stmt};
+    auto compiled = loops_.find(loop);
+    if (compiled == loops_.end()) {
+        if (untieredLoops_.count(loop)) {
+            return false;
+        }
+        std::string where = function_ ? "loop in fn " + std::string(program_->text(function_->name)) : "top-level loop";
+        auto chunk = tierCompiler_->compileHotLoop(*program_, stmt, function_);
+        if (!chunk) {
+            untieredLoops_.insert(loop);
+            if (tiering_.trace) {
+                std::cerr << "[tiering] " << where << ": stays in the tree walker (not compilable)" << std::endl;
+            }
+            return false;
+        }
+        if (tiering_.trace) {
+            std::cerr << "[tiering] " << where << ": tree walker -> bytecode (on-stack replacement) after "
+                      << iterations << " iterations" << std::endl;
+        }
+        compiled = loops_.emplace(loop, std::move(chunk)).first;
     }
-    
-    environment_ = previous; // Restore environment
-}
 
-void Interpreter::visit(FunctionDefinition& node) {
-    // TODO: Implement function definitions
-    // For now, just store the function in the environment
-    // We need to implement callable values for full function support
-    std::cout << "Function '" << node.name << "' defined (not yet executable)" << std::endl;
+    RuntimeValue result;
+    if (vm_->enterLoop(*compiled->second, frame_, function_ ? function_->frame_size : 0, result)) {
+        lastValue_ = std::move(result);
+        status_ = ExecStatus::Return;
+    }
+    return true;
 }
 
-void Interpreter::visit(ReturnStatement& node) {
-    // TODO: Implement return statements with exception-based control flow
-    throw std::runtime_error("Return statements not yet implemented");
-}
+void Interpreter::prepareTailCall(RuntimeValue callee, NodeList arguments) {
+    // Evaluate the arguments above the current frame while its locals are
+    // still live, then slide them down over it
+    auto args = program_->list(arguments);
+    uint32_t count = static_cast<uint32_t>(args.size());
+    RuntimeValue* scratch = frames_.push(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        scratch[i] = evaluate(args[i]);
+    }
+
+    checkCallable(callee, count);
 
-void Interpreter::visit(IfStatement& node) {
-    node.condition->accept(*this);
-    if (isTruthy(lastValue_)) {
-        node.then_branch->accept(*this);
-    } else if (node.else_branch) {
-        node.else_branch->accept(*this);
+    for (uint32_t i = 0; i < count; ++i) {
+        frame_[i] = std::move(scratch[i]);
     }
+    frames_.pop(frame_ + count);
+    frames_.push(declarationOf(callee.asFunction()).frame_size - count);
+
+    pendingCallee_ = std::move(callee);
+    status_ = ExecStatus::TailCall;
 }
 
-void Interpreter::visit(WhileStatement& node) {
-    while (true) {
-        node.condition->accept(*this);
-        if (!isTruthy(lastValue_)) {
-            break;
+// Statements
+void Interpreter::executeStatements(std::span<const NodeRef> statements) {
+    // Block variables live in slots of the enclosing frame
+    for (NodeRef stmt : statements) {
+        executeStatement(stmt);
+        if (status_ != ExecStatus::Normal) {
+            return;
         }
-        node.body->accept(*this);
     }
 }
 
-void Interpreter::visit(ForStatement& node) {
-    // TODO: Implement for loops
-    throw std::runtime_error("For loops not yet implemented");
+void Interpreter::executeStatement(NodeRef stmt) {
+    Program& program = *program_;
+    switch (stmt.kind()) {
+        case NodeKind::ExpressionStatement:
+            evaluate(program.node<ExpressionStatement>(stmt).expression);
+            break;
+        case NodeKind::VariableDeclaration: {
+            const auto& declaration = program.node<VariableDeclaration>(stmt);
+            // Default to 0 for now when there is no initializer
+            RuntimeValue value = declaration.initializer ? evaluate(declaration.initializer) : RuntimeValue(int64_t(0));
+            slot(declaration.address, declaration.name) = std::move(value);
+            break;
+        }
+        case NodeKind::Block:
+            executeStatements(program.list(program.node<Block>(stmt).statements));
+            break;
+        case NodeKind::ReturnStatement: {
+            const auto& ret = program.node<ReturnStatement>(stmt);
+            if (ret.tail_call && callDepth_ > 0) {
+                const auto& call = program.node<FunctionCall>(ret.value);
+                if (call.function.kind() == NodeKind::Identifier) {
+                    const auto& identifier = program.node<Identifier>(call.function);
+                    if (identifier.address.isResolved()) {
+                        prepareTailCall(slot(identifier.address, identifier.name), call.arguments);
+                        return;
+                    }
+                }
+            }
+            lastValue_ = ret.value ? evaluate(ret.value) : RuntimeValue();
+            status_ = ExecStatus::Return;
+            break;
+        }
+        case NodeKind::IfStatement: {
+            const auto& branch = program.node<IfStatement>(stmt);
+            if (isTruthy(evaluate(branch.condition))) {
+                executeStatement(branch.then_branch);
+            } else if (branch.else_branch) {
+                executeStatement(branch.else_branch);
+            }
+            break;
+        }
+        case NodeKind::WhileStatement: {
+            auto& loop = program.node<WhileStatement>(stmt);
+            while (isTruthy(evaluate(loop.condition))) {
+                executeStatement(loop.body);
+                if (status_ != ExecStatus::Normal) {
+                    return;
+                }
+                if (vm_ && ++loop.backedges >= tiering_.threshold && replaceLoop(stmt, loop.backedges)) {
+                    return;  // The VM finished the loop
+                }
+            }
+            break;
+        }
+        case NodeKind::ForStatement: {
+            // The counter is a plain int64 here rather than a slot; it is
+            // below the end bound, so stepping it can never overflow
+            auto& loop = program.node<ForStatement>(stmt);
+            RuntimeValue start = evaluate(loop.start);
+            RuntimeValue end = evaluate(loop.end);
+            checkRangeBounds(start, end);
+            RuntimeValue* range = &slot(loop.address, loop.variable);
+            int64_t limit = end.asInt();
+            for (int64_t counter = start.asInt(); counter < limit; ++counter) {
+                range[2] = RuntimeValue(counter);
+                executeStatement(loop.body);
+                if (status_ != ExecStatus::Normal) {
+                    return;
+                }
+                if (vm_ && ++loop.backedges >= tiering_.threshold) {
+                    // The VM resumes from the counter and bound slots
+                    range[0] = RuntimeValue(counter);
+                    range[1] = end;
+                    if (replaceLoop(stmt, loop.backedges)) {
+                        return;
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            executeOther(stmt);
+            break;
+    }
 }
 
-void Interpreter::visit(Program& node) {
-    for (auto& stmt : node.statements) {
-        stmt->accept(*this);
+void Interpreter::executeOther(NodeRef stmt) {
+    // Statements that run once per definition stay out of the hot switch
+    Program& program = *program_;
+    switch (stmt.kind()) {
+        case NodeKind::FunctionDefinition: {
+            const auto& definition = program.node<FunctionDefinition>(stmt);
+            auto* function = new FunctionObject(std::string(program.text(definition.name)), definition.parameters.count);
+            function->program = &program;
+            function->declaration = stmt.index();
+            slot(definition.address, definition.name) = RuntimeValue(function);
+            break;
+        }
+        default:
+            throw std::runtime_error("Invalid statement");
     }
 }
 
 std::string Interpreter::valueToString(const RuntimeValue& value) const {
-    return std::visit([](const auto& v) -> std::string {
-        using T = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<T, int64_t>) {
-            return std::to_string(v);
-        } else if constexpr (std::is_same_v<T, double>) {
-            return std::to_string(v);
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            return v;
-        } else if constexpr (std::is_same_v<T, bool>) {
-            return v ? "true" : "false";
-        }
-        return "unknown";
-    }, value);
+    return runtimeValueToString(value);
 }
 
 bool Interpreter::isTruthy(const RuntimeValue& value) const {
-    return std::visit([](const auto& v) -> bool {
-        using T = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<T, bool>) {
-            return v;
-        } else if constexpr (std::is_same_v<T, int64_t>) {
-            return v != 0;
-        } else if constexpr (std::is_same_v<T, double>) {
-            return v != 0.0;
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            return !v.empty();
-        }
-        return false;
-    }, value);
+    return runtimeValueTruthy(value);
 }
 
-void Interpreter::setupBuiltins() {
-    // Built-in functions are handled directly in visit(FunctionCall&)
-    // No need to store them in the environment for now
-}
+namespace {
 
-RuntimeValue Interpreter::callPrint(const std::vector<RuntimeValue>& args) {
-    for (size_t i = 0; i < args.size(); ++i) {
-        if (i > 0) std::cout << " ";
-        std::cout << valueToString(args[i]);
-    }
-    std::cout << std::endl;
-    return int64_t(0); // Return 0 as success indicator
-}
+// Wrapping int64 arithmetic (overflow is defined, unlike signed C++ ops)
+inline int64_t wrapAdd(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+inline int64_t wrapSub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t wrapMul(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }
 
-RuntimeValue Interpreter::callInput(const std::vector<RuntimeValue>& args) {
-    // Print prompt if provided
-    if (!args.empty()) {
-        std::cout << valueToString(args[0]);
-    }
-    
-    std::string input;
-    std::getline(std::cin, input);
-    return input;
-}
+} // namespace
 
-RuntimeValue Interpreter::callLength(const std::vector<RuntimeValue>& args) {
-    if (args.size() != 1) {
-        throw std::runtime_error("length() expects exactly 1 argument");
+RuntimeValue evaluateBinary(BinaryOperator op, const RuntimeValue& left, const RuntimeValue& right) {
+    // Fast path: both operands are integer immediates
+    if (RuntimeValue::bothSmallInts(left, right)) {
+        int64_t l = left.asSmallInt();
+        int64_t r = right.asSmallInt();
+        switch (op) {
+            case BinaryOperator::Add: return l + r;
+            case BinaryOperator::Sub: return l - r;
+            case BinaryOperator::Mul: return wrapMul(l, r);
+            case BinaryOperator::Div:
+                if (r == 0) throw std::runtime_error("Division by zero");
+                return l / r;
+            case BinaryOperator::Eq: return l == r;
+            case BinaryOperator::Ne: return l != r;
+            case BinaryOperator::Lt: return l < r;
+            case BinaryOperator::Gt: return l > r;
+            case BinaryOperator::Le: return l <= r;
+            case BinaryOperator::Ge: return l >= r;
+            default: break;
+        }
     }
     
-    const auto& value = args[0];
-    if (std::holds_alternative<std::string>(value)) {
-        return static_cast<int64_t>(std::get<std::string>(value).length());
-    } else {
-        throw std::runtime_error("length() can only be called on strings");
+    switch (op) {
+        case BinaryOperator::Add: {
+            if (left.isInt() && right.isInt()) {
+                return wrapAdd(left.asInt(), right.asInt());
+            } else if (left.isDouble() && right.isDouble()) {
+                return left.asDouble() + right.asDouble();
+            } else if (left.isString() && right.isString()) {
+                return concatStrings(left, right);
+            }
+            throw std::runtime_error("Invalid operands for addition");
+        }
+        case BinaryOperator::Sub: {
+            if (left.isInt() && right.isInt()) {
+                return wrapSub(left.asInt(), right.asInt());
+            } else if (left.isDouble() && right.isDouble()) {
+                return left.asDouble() - right.asDouble();
+            }
+            throw std::runtime_error("Invalid operands for subtraction");
+        }
+        case BinaryOperator::Mul: {
+            if (left.isInt() && right.isInt()) {
+                return wrapMul(left.asInt(), right.asInt());
+            } else if (left.isDouble() && right.isDouble()) {
+                return left.asDouble() * right.asDouble();
+            }
+            throw std::runtime_error("Invalid operands for multiplication");
+        }
+        case BinaryOperator::Div: {
+            if (left.isInt() && right.isInt()) {
+                int64_t r = right.asInt();
+                if (r == 0) throw std::runtime_error("Division by zero");
+                if (r == -1) return wrapSub(0, left.asInt()); // INT64_MIN / -1
+                return left.asInt() / r;
+            } else if (left.isDouble() && right.isDouble()) {
+                double r = right.asDouble();
+                if (r == 0.0) throw std::runtime_error("Division by zero");
+                return left.asDouble() / r;
+            }
+            throw std::runtime_error("Invalid operands for division");
+        }
+        case BinaryOperator::Eq:
+            return left == right;
+        case BinaryOperator::Ne:
+            return left != right;
+        case BinaryOperator::Lt:
+        case BinaryOperator::Gt:
+        case BinaryOperator::Le:
+        case BinaryOperator::Ge: {
+            int order;
+            if (left.isInt() && right.isInt()) {
+                int64_t l = left.asInt(), r = right.asInt();
+                order = (l > r) - (l < r);
+            } else if (left.isDouble() && right.isDouble()) {
+                double l = left.asDouble(), r = right.asDouble();
+                if (l != l || r != r) return false; // NaN is unordered
+                order = (l > r) - (l < r);
+            } else {
+                throw std::runtime_error("Invalid operands for comparison");
+            }
+            switch (op) {
+                case BinaryOperator::Lt: return order < 0;
+                case BinaryOperator::Gt: return order > 0;
+                case BinaryOperator::Le: return order <= 0;
+                default: return order >= 0;
+            }
+        }
+        case BinaryOperator::And:
+            return runtimeValueTruthy(left) && runtimeValueTruthy(right);
+        case BinaryOperator::Or:
+            return runtimeValueTruthy(left) || runtimeValueTruthy(right);
+        default:
+            throw std::runtime_error("Unsupported binary operator");
     }
 }
 
-RuntimeValue Interpreter::callSubstring(const std::vector<RuntimeValue>& args) {
-    if (args.size() < 2 || args.size() > 3) {
-        throw std::runtime_error("substring() expects 2 or 3 arguments: substring(string, start, [length])");
+RuntimeValue evaluateUnary(UnaryOperator op, const RuntimeValue& operand) {
+    switch (op) {
+        case UnaryOperator::Neg: {
+            if (operand.isInt()) {
+                return wrapSub(0, operand.asInt());
+            } else if (operand.isDouble()) {
+                return -operand.asDouble();
+            }
+            throw std::runtime_error("Invalid operand for negation");
+        }
+        case UnaryOperator::Not:
+            return !runtimeValueTruthy(operand);
+        default:
+            throw std::runtime_error("Unsupported unary operator");
     }
-    
-    if (!std::holds_alternative<std::string>(args[0])) {
-        throw std::runtime_error("substring() first argument must be a string");
+}
+
+std::string runtimeValueToString(const RuntimeValue& value) {
+    if (value.isSmallInt()) return std::to_string(value.asSmallInt());
+    if (value.isDouble()) return std::to_string(value.asDouble());
+    if (value.isBool()) return value.asBool() ? "true" : "false";
+    if (value.isString()) return std::string(value.asString());
+    if (value.isInt()) return std::to_string(value.asInt());
+    if (value.isFunction()) return "<fn " + value.asFunction()->name + ">";
+    if (isArray(value) || isShapedObject(value)) {
+        // A container that (indirectly) contains itself prints as [...] or
+        // {...} inside
+        thread_local std::vector<const GcObject*> printing;
+        const auto* container = static_cast<const GcObject*>(value.asObject());
+        bool array = isArray(value);
+        if (std::find(printing.begin(), printing.end(), container) != printing.end()) {
+            return array ? "[...]" : "{...}";
+        }
+        auto quoted = [](const RuntimeValue& element) {
+            return element.isString() ? "\"" + std::string(element.asString()) + "\"" : runtimeValueToString(element);
+        };
+        printing.push_back(container);
+        std::string text = array ? "[" : "{";
+        if (array) {
+            const ArrayObject* elements = asArray(value);
+            for (size_t i = 0; i < elements->length; ++i) {
+                if (i > 0) text += ", ";
+                text += quoted(elements->get(i));
+            }
+        } else {
+            const ShapedObject* object = asShapedObject(value);
+            for (uint32_t i = 0; i < object->shape->size(); ++i) {
+                if (i > 0) text += ", ";
+                text += std::string(object->shape->key(i).text()) + ": " + quoted(object->slots[i]);
+            }
+        }
+        printing.pop_back();
+        return text + (array ? "]" : "}");
     }
-    if (!std::holds_alternative<int64_t>(args[1])) {
-        throw std::runtime_error("substring() second argument must be an integer");
+    return "unknown";
+}
+
+bool runtimeValueTruthy(const RuntimeValue& value) {
+    if (value.isBool()) return value.asBool();
+    if (value.isSmallInt()) return value.asSmallInt() != 0;
+    if (value.isDouble()) return value.asDouble() != 0.0;
+    if (value.isString()) return value.asStringObject()->length != 0;
+    if (value.isInt()) return value.asInt() != 0;
+    if (value.isFunction()) return true;
+    if (isArray(value)) return asArray(value)->length != 0;
+    if (isShapedObject(value)) return true;
+    return false;
+}
+
+void checkCallable(const RuntimeValue& callee, size_t count) {
+    if (!callee.isFunction()) {
+        throw std::runtime_error("Value is not callable");
     }
-    
-    const std::string& str = std::get<std::string>(args[0]);
-    int64_t start = std::get<int64_t>(args[1]);
-    
-    if (start < 0 || start >= static_cast<int64_t>(str.length())) {
-        return std::string(""); // Return empty string for out-of-bounds
+    const FunctionObject* function = callee.asFunction();
+    if (function->arity != count) {
+        throw std::runtime_error("Function '" + function->name + "' expects " +
+                                 std::to_string(function->arity) + " arguments but got " +
+                                 std::to_string(count));
     }
-    
-    if (args.size() == 3) {
-        if (!std::holds_alternative<int64_t>(args[2])) {
-            throw std::runtime_error("substring() third argument must be an integer");
-        }
-        int64_t length = std::get<int64_t>(args[2]);
-        if (length < 0) {
-            return std::string("");
-        }
-        return str.substr(static_cast<size_t>(start), static_cast<size_t>(length));
-    } else {
-        return str.substr(static_cast<size_t>(start));
+}
+
+void checkRangeBounds(const RuntimeValue& start, const RuntimeValue& end) {
+    if (!start.isInt() || !end.isInt()) {
+        throw std::runtime_error("For loop range bounds must be integers");
     }
 }
 
-} // namespace myndra
\ No newline at end of file
+} // namespace myndra
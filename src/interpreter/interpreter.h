@@ -2,77 +2,196 @@
 #define MYNDRA_INTERPRETER_H
 
 #include "../parser/ast.h"
-#include <unordered_map>
-#include <variant>
+#include "../runtime/object.h"
+#include "../runtime/value.h"
+#include "../semantics/resolver.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace myndra {
 
-// Runtime value type (internal to interpreter)
-using RuntimeValue = std::variant<int64_t, double, std::string, bool>;
+// Value helpers shared by every execution engine
+std::string runtimeValueToString(const RuntimeValue& value);
+bool runtimeValueTruthy(const RuntimeValue& value);
+RuntimeValue evaluateBinary(BinaryOperator op, const RuntimeValue& left, const RuntimeValue& right);
+RuntimeValue evaluateUnary(UnaryOperator op, const RuntimeValue& operand);
+// Throws unless `callee` is a function taking exactly `count` arguments
+void checkCallable(const RuntimeValue& callee, size_t count);
+// Throws unless both bounds of a for loop's range are integers
+void checkRangeBounds(const RuntimeValue& start, const RuntimeValue& end);
 
-// Environment for variable storage
-class Environment {
+// Deepest allowed nesting of user function calls (both engines)
+constexpr size_t kMaxCallDepth = 2000;
+
+// Contiguous stack of variable slots. Frames are windows into one
+// preallocated array, so entering a scope never touches the allocator.
+class FramePool {
 public:
-    Environment(std::shared_ptr<Environment> parent = nullptr);
-    
-    void define(const std::string& name, const RuntimeValue& value);
-    RuntimeValue get(const std::string& name) const;
-    void assign(const std::string& name, const RuntimeValue& value);
+    explicit FramePool(size_t capacity = 1 << 16);
     
-    std::shared_ptr<Environment> getParent() const { return parent_; }
+    // Reserve `size` fresh slots on top of the stack
+    RuntimeValue* push(uint32_t size);
+    // Release every slot from `frame` upward
+    void pop(RuntimeValue* frame);
+    // Grow the bottom-most frame (globals) while nothing sits above it
+    void growBase(uint32_t size);
     
 private:
-    std::shared_ptr<Environment> parent_;
-    std::unordered_map<std::string, RuntimeValue> variables_;
+    std::vector<RuntimeValue> slots_;
+    size_t top_;
+};
+
+class VM;
+class BytecodeCompiler;
+struct Chunk;
+
+// Tiered execution: functions and loops that get hot in the tree walker
+// move to the bytecode VM, whose JIT takes its own hot functions further
+struct TieringOptions {
+    uint32_t threshold = 0;        // Calls, or loop iterations, before promotion; 0 disables tiering
+    uint32_t jitThreshold = 1000;  // Passed on to the VM's JIT; 0 disables it
+    bool perfMap = true;           // Passed on to the VM's JIT
+    bool trace = false;            // Log every promotion to stderr
 };
 
 // Interpreter that executes AST
-class Interpreter : public ASTVisitor {
+//
+// Walks the flat AST directly: expressions and statements are dispatched
+// on their NodeKind, and nodes are read from the Program's pools. Binary
+// expressions quicken: each records the operand types it first sees and
+// later takes a specialized path guarded on them.
+//
+// With tiering enabled, every function definition counts its calls and
+// every loop its iterations. A function past the threshold is
+// compiled to bytecode and called in the VM from then on; a loop past it
+// is compiled in place and entered mid-flight (on-stack replacement),
+// with the frame copied into VM registers and back. Both kinds of code
+// keep the Resolver's slot layout and share the global frame, and calls
+// cross between the tiers in either direction.
+//
+// Context conditionals (`expr if context == "prod"`) are specialized per
+// function: the first call after a context change sets every conditional
+// of the body to on or off, and evaluating one only reads that flag.
+// Bytecode for a promoted function has its context compiled in.
+class Interpreter {
 public:
-    Interpreter();
+    // `quicken` false keeps every binary expression on the generic path
+    explicit Interpreter(const NativeRegistry& natives = NativeRegistry::builtins(), bool quicken = true,
+                         const TieringOptions& tiering = TieringOptions());
+    ~Interpreter();
     
     // Execute a program
     void execute(Program& program);
     
-    // ASTVisitor implementation
-    void visit(IntegerLiteral& node) override;
-    void visit(FloatLiteral& node) override;
-    void visit(StringLiteral& node) override;
-    void visit(BooleanLiteral& node) override;
-    void visit(Identifier& node) override;
-    void visit(BinaryExpression& node) override;
-    void visit(UnaryExpression& node) override;
-    void visit(FunctionCall& node) override;
-    void visit(ArrayAccess& node) override;
-    void visit(MemberAccess& node) override;
-    void visit(ContextConditional& node) override;
-    void visit(ExpressionStatement& node) override;
-    void visit(VariableDeclaration& node) override;
-    void visit(Block& node) override;
-    void visit(FunctionDefinition& node) override;
-    void visit(ReturnStatement& node) override;
-    void visit(IfStatement& node) override;
-    void visit(WhileStatement& node) override;
-    void visit(ForStatement& node) override;
-    void visit(Program& node) override;
+    // Changes the context conditionals test against. Takes effect lazily,
+    // as each function is next entered; bytecode that depends on the old
+    // context is dropped. Call between executions.
+    void setContext(std::string context);
+    const std::string& context() const { return context_; }
     
     // Utility methods
     std::string valueToString(const RuntimeValue& value) const;
     bool isTruthy(const RuntimeValue& value) const;
     
 private:
-    std::shared_ptr<Environment> environment_;
-    RuntimeValue lastValue_; // For expression results
+    // Non-local control flow is signalled through status codes that every
+    // statement loop checks, never through C++ exceptions
+    enum class ExecStatus {
+        Normal,
+        Return,     // lastValue_ holds the return value
+        TailCall    // Frame already holds the arguments for pendingCallee_
+    };
+    
+    const NativeRegistry& natives_;
+    Resolver resolver_;
+    FramePool frames_;
+    Program* program_;        // Program that owns the code being run
+    RuntimeValue* globals_;   // Global frame (bottom of frames_)
+    RuntimeValue* frame_;     // Current frame
+    RuntimeValue lastValue_; // Return value
+    ExecStatus status_;
+    RuntimeValue pendingCallee_;
+    size_t callDepth_;
+    bool quicken_;
+    
+    // Tiered execution; all null or empty when it is disabled
+    TieringOptions tiering_;
+    std::unique_ptr<VM> vm_;
+    std::unique_ptr<BytecodeCompiler> tierCompiler_;
+    const FunctionDefinition* function_;  // Function running in frame_; null at the top level
+    // A while or for statement in one of the programs whose code is running
+    struct LoopSite {
+        const Program* program;
+        NodeRef loop;
+        bool operator==(const LoopSite& other) const { return program == other.program && loop == other.loop; }
+    };
+    struct LoopSiteHash {
+        size_t operator()(const LoopSite& site) const {
+            size_t node = (static_cast<size_t>(site.loop.kind()) << 32) | site.loop.index();
+            return std::hash<const Program*>()(site.program) ^ node * 0x9E3779B97F4A7C15ULL;
+        }
+    };
+    // Only valid while the programs they name are alive; execute() starts
+    // them afresh
+    std::unordered_set<const FunctionDefinition*> untiered_;  // Functions the compiler cannot handle
+    std::unordered_map<LoopSite, std::unique_ptr<Chunk>, LoopSiteHash> loops_;  // OSR code
+    std::unordered_set<LoopSite, LoopSiteHash> untieredLoops_;
+    std::vector<RuntimeValue> contextual_;  // Promoted functions with context conditionals
+    
+    std::string context_;
+    uint32_t contextEpoch_;  // Changes with context_; compared on function entry
+    
+    // String literals are created once per execute() and shared by every
+    // evaluation, and by every literal with the same text. Entries are
+    // indexed by StringLiteral and tagged with the program they belong to.
+    struct Literal {
+        const Program* program = nullptr;
+        RuntimeValue value;
+    };
+    std::vector<Literal> literals_;
+    std::unordered_map<std::string_view, RuntimeValue> interned_;  // Keys view their values
+
+    // Inline caches of MemberAccess sites and shapes of ObjectLiteral ones,
+    // indexed and tagged like literals_
+    struct PropertySite {
+        const Program* program = nullptr;
+        PropertyCache cache;
+    };
+    struct LiteralShape {
+        const Program* program = nullptr;
+        const Shape* shape = nullptr;
+    };
+    std::vector<PropertySite> properties_;
+    std::vector<LiteralShape> shapes_;
+    
+    RuntimeValue evaluate(NodeRef expr);
+    RuntimeValue evaluateOther(NodeRef expr);
+    RuntimeValue evaluateOperand(NodeRef expr);
+    RuntimeValue evaluateBinaryExpression(BinaryExpression& node);
+    RuntimeValue evaluateCall(const FunctionCall& node);
+    const RuntimeValue& literal(NodeRef expr);
+    PropertyCache& propertyCache(NodeRef access);
+    const Shape* literalShape(NodeRef literal);
+    void executeStatement(NodeRef stmt);
+    void executeOther(NodeRef stmt);
+    void executeStatements(std::span<const NodeRef> statements);
     
-    // Built-in functions
-    void setupBuiltins();
-    RuntimeValue callPrint(const std::vector<RuntimeValue>& args);
-    RuntimeValue callInput(const std::vector<RuntimeValue>& args);
-    RuntimeValue callLength(const std::vector<RuntimeValue>& args);
-    RuntimeValue callSubstring(const std::vector<RuntimeValue>& args);
+    RuntimeValue& slot(const SlotAddress& address, Atom name);
+    [[noreturn]] void undefinedVariable(Atom name) const;
+    RuntimeValue callFunction(RuntimeValue callee, NodeList arguments);
+    RuntimeValue runFunction(RuntimeValue callee, RuntimeValue* frame, uint32_t count);
+    const FunctionDefinition* enter(const FunctionObject* function);
+    bool specialize(Program& program, uint32_t function);
+    bool promote(const RuntimeValue& callee);
+    bool replaceLoop(NodeRef stmt, uint32_t& backedges);
+    static RuntimeValue callFromVM(void* self, const RuntimeValue& callee, NativeArgs args);
+    void prepareTailCall(RuntimeValue callee, NodeList arguments);
+    RuntimeValue callNative(const FunctionCall& node);
+    void unwind();
 };
 
 } // namespace myndra
@@ -0,0 +1,1055 @@
+#include "jit.h"
+#include "x64_assembler.h"
+#include "../interpreter/interpreter.h"
+#include "../runtime/array.h"
+#include "../runtime/object.h"
+#include "../runtime/vm.h"
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Code generation targets the System V x86-64 calling convention
+#if defined(__x86_64__) && defined(__unix__)
+#define MYNDRA_JIT_X64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define MYNDRA_JIT_X64 0
+#endif
+
+namespace myndra {
+
+#if MYNDRA_JIT_X64
+
+std::unique_ptr<JitCode> JitCode::create(const uint8_t* bytes, size_t size) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t mapped = (size + page - 1) / page * page;
+    void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, bytes, size);
+    // Never writable and executable at the same time
+    if (mprotect(memory, mapped, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mapped);
+        return nullptr;
+    }
+    return std::unique_ptr<JitCode>(new JitCode(memory, size, mapped));
+}
+
+JitCode::~JitCode() {
+    munmap(memory_, mapped_);
+}
+
+#else
+
+std::unique_ptr<JitCode> JitCode::create(const uint8_t*, size_t) {
+    return nullptr;
+}
+
+JitCode::~JitCode() = default;
+
+#endif
+
+Jit::Jit(const Options& options) : options_(options) {}
+
+bool Jit::supported() {
+    return MYNDRA_JIT_X64 != 0;
+}
+
+// Entry points called from compiled code. None of them lets an exception
+// escape into machine code: they park it in the VM and report kJitError.
+
+JitStatus Jit::binaryHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* left,
+                            const RuntimeValue* right, uint32_t op) {
+    try {
+        auto binop = static_cast<BinaryOperator>(op);
+        if (binop == BinaryOperator::And) {
+            *dest = runtimeValueTruthy(*left) && runtimeValueTruthy(*right);
+        } else if (binop == BinaryOperator::Or) {
+            *dest = runtimeValueTruthy(*left) || runtimeValueTruthy(*right);
+        } else {
+            *dest = evaluateBinary(binop, *left, *right);
+        }
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::unaryHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* operand, uint32_t op) {
+    try {
+        auto unop = static_cast<UnaryOperator>(op);
+        if (unop == UnaryOperator::Not) {
+            *dest = !runtimeValueTruthy(*operand);
+        } else {
+            *dest = evaluateUnary(unop, *operand);
+        }
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+uint32_t Jit::truthyHelper(const RuntimeValue* value) {
+    return runtimeValueTruthy(*value) ? 1 : 0;
+}
+
+void Jit::releaseHelper(HeapObject* object) {
+    destroyHeapObject(object);
+}
+
+JitStatus Jit::callHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t argc) {
+    try {
+        checkCallable(registers[a], argc);
+        context->vm->invoke(registers + a + 1);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::tailCallHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t argc) {
+    try {
+        checkCallable(registers[a], argc);
+        // The running function's code is still on the stack until it
+        // returns, so the VM keeps it alive until then
+        context->vm->jitPendingRelease_ = std::move(registers[-1]);
+        registers[-1] = std::move(registers[a]);
+        for (uint32_t i = 0; i < argc; ++i) {
+            registers[i] = std::move(registers[a + 1 + i]);
+        }
+        return kJitTailCall;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::nativeHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t id, uint32_t argc) {
+    try {
+        const NativeRegistry::Entry& native = context->vm->natives_.entries()[id];
+        registers[a] = native.fn(NativeArgs(&registers[a], argc), native.data);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::raiseHelper(JitContext* context, const RuntimeValue* message) {
+    context->vm->jitError_ = std::make_exception_ptr(std::runtime_error(std::string(message->asString())));
+    return kJitError;
+}
+
+JitStatus Jit::newArrayHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t b,
+                              uint32_t count) {
+    try {
+        registers[a] = ArrayObject::make(&registers[b], count);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::indexHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* array,
+                           const RuntimeValue* index) {
+    try {
+        *dest = indexArray(*array, *index);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::storeIndexHelper(JitContext* context, const RuntimeValue* array, const RuntimeValue* index,
+                                const RuntimeValue* value) {
+    try {
+        storeIndex(*array, *index, *value);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::newObjectHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t b,
+                               const Shape* shape) {
+    try {
+        registers[a] = ShapedObject::make(shape, &registers[b]);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::getMemberHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* object,
+                               PropertyCache* cache) {
+    try {
+        *dest = getProperty(*object, *cache);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+JitStatus Jit::setMemberHelper(JitContext* context, const RuntimeValue* object, const RuntimeValue* value,
+                               PropertyCache* cache) {
+    try {
+        setProperty(*object, *value, *cache);
+        return kJitOk;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kJitError;
+    }
+}
+
+uint32_t Jit::inBoundsHelper(const RuntimeValue* array, const RuntimeValue* range) {
+    return indexRangeInBounds(*array, range[0], range[1]) ? 1 : 0;
+}
+
+uint32_t Jit::rangeHelper(JitContext* context, RuntimeValue* range, uint32_t step) {
+    try {
+        checkRangeBounds(range[0], range[1]);
+        // Below the end bound, so adding the step cannot overflow
+        int64_t counter = range[0].asInt() + step;
+        if (counter >= range[1].asInt()) {
+            return kRangeDone;
+        }
+        range[0] = RuntimeValue(counter);
+        range[2] = range[0];
+        return kRangeBody;
+    } catch (...) {
+        context->vm->jitError_ = std::current_exception();
+        return kRangeError;
+    }
+}
+
+#if MYNDRA_JIT_X64
+
+// Emits one function. Pinned registers, all callee-saved so they survive
+// helper calls:
+//   rbx  register window (R)
+//   r13  globals (G)
+//   r14  constants (K)
+//   r15  JitContext
+// rax, rcx, rdx and xmm0-1 are scratch within a template.
+class Jit::Codegen {
+public:
+    using A = X64Assembler;
+
+    explicit Codegen(const Chunk& chunk) : chunk_(chunk), labels_(chunk.code.size()) {}
+
+    // False if some instruction has no template
+    bool generate() {
+        prologue();
+        for (size_t i = 0; i < chunk_.code.size(); ++i) {
+            as_.bind(labels_[i]);
+            if (!instruction(chunk_.code[i])) {
+                return false;
+            }
+        }
+        epilogue();
+        return true;
+    }
+
+    const std::vector<uint8_t>& code() const { return as_.code(); }
+
+private:
+    static constexpr A::Reg R = A::RBX;
+    static constexpr A::Reg G = A::R13;
+    static constexpr A::Reg K = A::R14;
+    static constexpr A::Reg CTX = A::R15;
+
+    static constexpr uint32_t kIntTag16 = RuntimeValue::kIntTag >> 48;
+    static constexpr uint32_t kObjectTag16 = RuntimeValue::kObjectTag >> 48;
+
+    // ArrayObject derives from GcObject, so it is not standard-layout and
+    // offsetof is only conditionally supported; GCC and Clang lay it out
+    // like any class without virtual bases
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+    static constexpr int32_t kArrayKind = offsetof(ArrayObject, kind);
+    static constexpr int32_t kArrayData = offsetof(ArrayObject, data);
+    static constexpr int32_t kGcClass = offsetof(GcObject, gcClass);
+    static constexpr int32_t kObjectShape = offsetof(ShapedObject, shape);
+    static constexpr int32_t kObjectSlots = offsetof(ShapedObject, slots);
+#pragma GCC diagnostic pop
+    static constexpr int32_t kHeapKind = offsetof(HeapObject, kind);
+    static constexpr uint32_t kContainerKind = static_cast<uint32_t>(HeapObject::Kind::Container);
+    static_assert(sizeof(PropertyCache::Entry::slot) == sizeof(uint64_t), "cached slots are loaded whole");
+    static constexpr uint32_t kIntElements = static_cast<uint32_t>(ArrayObject::ElementsKind::Int);
+    static constexpr uint32_t kDoubleElements = static_cast<uint32_t>(ArrayObject::ElementsKind::Double);
+    static_assert(sizeof(int64_t) == sizeof(RuntimeValue) && sizeof(double) == sizeof(RuntimeValue),
+                  "int and double elements are one register wide");
+
+    const Chunk& chunk_;
+    A as_;
+    std::vector<A::Label> labels_;   // One per instruction
+    A::Label exit_;                  // Returns eax as the JitStatus
+
+    static int32_t slot(uint32_t index) { return static_cast<int32_t>(index * sizeof(RuntimeValue)); }
+
+    void call(const void* function) {
+        as_.movImm64(A::RAX, reinterpret_cast<uint64_t>(function));
+        as_.callRax();
+    }
+
+    // A helper returned a JitStatus in eax; leave with it unless kJitOk
+    void exitOnError() {
+        as_.testEax();
+        as_.jcc(A::NotEqual, exit_);
+    }
+
+    // Jumps to `otherwise` unless the top 16 bits of `value` are `tag`
+    void checkTag(A::Reg value, uint32_t tag, A::Label& otherwise) {
+        as_.mov(A::RCX, value);
+        as_.shr(A::RCX, 48);
+        as_.cmp32(A::RCX, tag);
+        as_.jcc(A::NotEqual, otherwise);
+    }
+
+    // Counts a new reference to the value in rax
+    void retain() {
+        A::Label done;
+        checkTag(A::RAX, kObjectTag16, done);
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RCX, A::RAX);
+        as_.incMem32(A::RCX);
+        as_.bind(done);
+    }
+
+    // Stores rax (an owned reference) to [base + disp] and drops the
+    // reference the slot held before
+    void storeOwned(A::Reg base, int32_t disp) {
+        A::Label done;
+        as_.load(A::RDX, base, disp);
+        as_.store(base, disp, A::RAX);
+        checkTag(A::RDX, kObjectTag16, done);
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RDX, A::RCX);
+        as_.decMem32(A::RDX);
+        as_.jcc(A::NotEqual, done);
+        as_.mov(A::RDI, A::RDX);
+        call(reinterpret_cast<const void*>(&Jit::releaseHelper));
+        as_.bind(done);
+    }
+
+    void copy(A::Reg fromBase, int32_t fromDisp, A::Reg toBase, int32_t toDisp) {
+        as_.load(A::RAX, fromBase, fromDisp);
+        retain();
+        storeOwned(toBase, toDisp);
+    }
+
+    void prologue() {
+        // Six pushes including the return address keep rsp 16-byte aligned
+        // for helper calls
+        as_.push(A::RBP);
+        as_.mov(A::RBP, A::RSP);
+        as_.push(R);
+        as_.push(G);
+        as_.push(K);
+        as_.push(CTX);
+        as_.mov(CTX, A::RDI);
+        as_.mov(R, A::RSI);
+        static_assert(offsetof(JitContext, globals) == 0, "compiled code loads globals from offset 0");
+        as_.load(G, A::RDI, 0);
+        as_.movImm64(K, reinterpret_cast<uint64_t>(chunk_.constants.data()));
+    }
+
+    void epilogue() {
+        as_.bind(exit_);
+        as_.pop(CTX);
+        as_.pop(K);
+        as_.pop(G);
+        as_.pop(R);
+        as_.pop(A::RBP);
+        as_.ret();
+    }
+
+    void exitWith(JitStatus status) {
+        as_.movImm32(A::RAX, status);
+        as_.jmp(exit_);
+    }
+
+    bool instruction(const Instruction& ins) {
+        switch (ins.op) {
+        case OpCode::LOAD_CONST:
+            copy(K, slot(ins.bx()), R, slot(ins.a));
+            return true;
+        case OpCode::MOVE:
+            copy(R, slot(ins.b), R, slot(ins.a));
+            return true;
+        case OpCode::GET_GLOBAL:
+            copy(G, slot(ins.bx()), R, slot(ins.a));
+            return true;
+        case OpCode::SET_GLOBAL:
+            copy(R, slot(ins.a), G, slot(ins.bx()));
+            return true;
+        case OpCode::ADD:
+            arithmetic(ins, BinaryOperator::Add);
+            return true;
+        case OpCode::SUB:
+            arithmetic(ins, BinaryOperator::Sub);
+            return true;
+        case OpCode::MUL:
+            arithmetic(ins, BinaryOperator::Mul);
+            return true;
+        case OpCode::DIV:
+            arithmetic(ins, BinaryOperator::Div);
+            return true;
+        case OpCode::EQ:
+            arithmetic(ins, BinaryOperator::Eq);
+            return true;
+        case OpCode::NE:
+            arithmetic(ins, BinaryOperator::Ne);
+            return true;
+        case OpCode::LT:
+            arithmetic(ins, BinaryOperator::Lt);
+            return true;
+        case OpCode::LE:
+            arithmetic(ins, BinaryOperator::Le);
+            return true;
+        case OpCode::GT:
+            arithmetic(ins, BinaryOperator::Gt);
+            return true;
+        case OpCode::GE:
+            arithmetic(ins, BinaryOperator::Ge);
+            return true;
+        case OpCode::ADD_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Add);
+            return true;
+        case OpCode::SUB_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Sub);
+            return true;
+        case OpCode::MUL_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Mul);
+            return true;
+        case OpCode::DIV_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Div);
+            return true;
+        case OpCode::LT_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Lt);
+            return true;
+        case OpCode::LE_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Le);
+            return true;
+        case OpCode::GT_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Gt);
+            return true;
+        case OpCode::GE_FLOAT:
+            floatArithmetic(ins, BinaryOperator::Ge);
+            return true;
+        case OpCode::AND:
+            binaryCall(ins, BinaryOperator::And);
+            return true;
+        case OpCode::OR:
+            binaryCall(ins, BinaryOperator::Or);
+            return true;
+        case OpCode::NEG:
+            unaryCall(ins, UnaryOperator::Neg);
+            return true;
+        case OpCode::NOT:
+            unaryCall(ins, UnaryOperator::Not);
+            return true;
+        case OpCode::JUMP:
+            as_.jmp(labels_[ins.bx()]);
+            return true;
+        case OpCode::JUMP_IF_FALSE:
+            jumpIfFalse(ins);
+            return true;
+        case OpCode::FOR_PREP: {
+            A::Label body;
+            rangeStep(ins, 0, body, labels_[ins.bx()]);
+            as_.bind(body);
+            return true;
+        }
+        case OpCode::FOR_LOOP: {
+            A::Label done;
+            rangeStep(ins, 1, labels_[ins.bx()], done);
+            as_.bind(done);
+            return true;
+        }
+        case OpCode::CALL:
+            as_.mov(A::RDI, CTX);
+            as_.mov(A::RSI, R);
+            as_.movImm32(A::RDX, ins.a);
+            as_.movImm32(A::RCX, ins.c);
+            call(reinterpret_cast<const void*>(&Jit::callHelper));
+            exitOnError();
+            return true;
+        case OpCode::TAIL_CALL:
+            // Either way this function is done: the VM runs the new callee
+            // or raises the error
+            as_.mov(A::RDI, CTX);
+            as_.mov(A::RSI, R);
+            as_.movImm32(A::RDX, ins.a);
+            as_.movImm32(A::RCX, ins.c);
+            call(reinterpret_cast<const void*>(&Jit::tailCallHelper));
+            as_.jmp(exit_);
+            return true;
+        case OpCode::RETURN:
+            // Move R[A] over the callee in R[-1]
+            as_.load(A::RAX, R, slot(ins.a));
+            as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+            as_.store(R, slot(ins.a), A::RCX);
+            storeOwned(R, -static_cast<int32_t>(sizeof(RuntimeValue)));
+            exitWith(kJitOk);
+            return true;
+        case OpCode::CALL_NATIVE:
+            as_.mov(A::RDI, CTX);
+            as_.mov(A::RSI, R);
+            as_.movImm32(A::RDX, ins.a);
+            as_.movImm32(A::RCX, ins.b);
+            as_.movImm32(A::R8, ins.c);
+            call(reinterpret_cast<const void*>(&Jit::nativeHelper));
+            exitOnError();
+            return true;
+        case OpCode::RAISE:
+            as_.mov(A::RDI, CTX);
+            as_.lea(A::RSI, K, slot(ins.bx()));
+            call(reinterpret_cast<const void*>(&Jit::raiseHelper));
+            as_.jmp(exit_);
+            return true;
+        case OpCode::NEW_ARRAY:
+            as_.mov(A::RDI, CTX);
+            as_.mov(A::RSI, R);
+            as_.movImm32(A::RDX, ins.a);
+            as_.movImm32(A::RCX, ins.b);
+            as_.movImm32(A::R8, ins.c);
+            call(reinterpret_cast<const void*>(&Jit::newArrayHelper));
+            exitOnError();
+            return true;
+        case OpCode::GET_INDEX:
+            indexCall(ins);
+            return true;
+        case OpCode::SET_INDEX:
+            storeIndexCall(ins);
+            return true;
+        case OpCode::GET_INDEX_UNCHECKED:
+            getIndexUnchecked(ins);
+            return true;
+        case OpCode::SET_INDEX_UNCHECKED:
+            setIndexUnchecked(ins);
+            return true;
+        case OpCode::NEW_OBJECT:
+            as_.mov(A::RDI, CTX);
+            as_.mov(A::RSI, R);
+            as_.movImm32(A::RDX, ins.a);
+            as_.movImm32(A::RCX, ins.b);
+            as_.movImm64(A::R8, reinterpret_cast<uint64_t>(chunk_.shapes[ins.c]));
+            call(reinterpret_cast<const void*>(&Jit::newObjectHelper));
+            exitOnError();
+            return true;
+        case OpCode::GET_MEMBER:
+            getMember(ins);
+            return true;
+        case OpCode::SET_MEMBER:
+            as_.mov(A::RDI, CTX);
+            as_.lea(A::RSI, R, slot(ins.a));
+            as_.lea(A::RDX, R, slot(ins.b));
+            as_.movImm64(A::RCX, reinterpret_cast<uint64_t>(&chunk_.properties[ins.c]));
+            call(reinterpret_cast<const void*>(&Jit::setMemberHelper));
+            exitOnError();
+            return true;
+        case OpCode::IN_BOUNDS:
+            as_.lea(A::RDI, R, slot(ins.b));
+            as_.lea(A::RSI, R, slot(ins.c));
+            call(reinterpret_cast<const void*>(&Jit::inBoundsHelper));
+            as_.movzxByte(A::RAX, A::RAX);
+            boxBool();
+            storeOwned(R, slot(ins.a));
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // R[A] = R[B] op R[C] through the shared evaluator
+    void binaryCall(const Instruction& ins, BinaryOperator op) {
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.lea(A::RDX, R, slot(ins.b));
+        as_.lea(A::RCX, R, slot(ins.c));
+        as_.movImm32(A::R8, static_cast<uint32_t>(op));
+        call(reinterpret_cast<const void*>(&Jit::binaryHelper));
+        exitOnError();
+    }
+
+    void unaryCall(const Instruction& ins, UnaryOperator op) {
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.lea(A::RDX, R, slot(ins.b));
+        as_.movImm32(A::RCX, static_cast<uint32_t>(op));
+        call(reinterpret_cast<const void*>(&Jit::unaryHelper));
+        exitOnError();
+    }
+
+    // R[A] = R[B][R[C]] through the runtime
+    void indexCall(const Instruction& ins) {
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.lea(A::RDX, R, slot(ins.b));
+        as_.lea(A::RCX, R, slot(ins.c));
+        call(reinterpret_cast<const void*>(&Jit::indexHelper));
+        exitOnError();
+    }
+
+    // R[A][R[B]] = R[C] through the runtime
+    void storeIndexCall(const Instruction& ins) {
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.lea(A::RDX, R, slot(ins.b));
+        as_.lea(A::RCX, R, slot(ins.c));
+        call(reinterpret_cast<const void*>(&Jit::storeIndexHelper));
+        exitOnError();
+    }
+
+    // rdx = the ArrayObject in R[array], rax = its elements kind
+    void loadArrayKind(uint32_t array) {
+        as_.load(A::RDX, R, slot(array));
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RDX, A::RCX);
+        as_.load(A::RAX, A::RDX, kArrayKind);
+        as_.movzxByte(A::RAX, A::RAX);
+    }
+
+    // rcx = address of the int or double element R[index] of the array in
+    // rdx, for an index proven in bounds, so a small int. Clobbers rdx.
+    void elementAddress(uint32_t index) {
+        as_.load(A::RCX, R, slot(index));
+        as_.shl(A::RCX, 16);
+        as_.sar(A::RCX, 16);
+        as_.shl(A::RCX, 3);
+        as_.load(A::RDX, A::RDX, kArrayData);
+        as_.add(A::RCX, A::RDX);
+    }
+
+    // R[A] = R[B][R[C]] with the index proven in bounds: int and double
+    // elements are read inline, other kinds through the runtime
+    void getIndexUnchecked(const Instruction& ins) {
+        A::Label notInts, slow, store, next;
+        loadArrayKind(ins.b);
+        as_.cmp32(A::RAX, kIntElements);
+        as_.jcc(A::NotEqual, notInts);
+        elementAddress(ins.c);
+        as_.load(A::RAX, A::RCX, 0);
+        boxInt(slow);
+        as_.jmp(store);
+
+        // Doubles are stored canonical, as their boxed bits
+        as_.bind(notInts);
+        as_.cmp32(A::RAX, kDoubleElements);
+        as_.jcc(A::NotEqual, slow);
+        elementAddress(ins.c);
+        as_.load(A::RAX, A::RCX, 0);
+        as_.jmp(store);
+
+        as_.bind(slow);
+        indexCall(ins);
+        as_.jmp(next);
+
+        as_.bind(store);
+        storeOwned(R, slot(ins.a));
+        as_.bind(next);
+    }
+
+    // R[A][R[B]] = R[C] with the index proven in bounds: a small int into
+    // int elements or a double into double elements is stored inline;
+    // anything else may change the kind and goes through the runtime
+    void setIndexUnchecked(const Instruction& ins) {
+        A::Label notInts, slow, next;
+        loadArrayKind(ins.a);
+        as_.cmp32(A::RAX, kIntElements);
+        as_.jcc(A::NotEqual, notInts);
+        as_.load(A::RAX, R, slot(ins.c));
+        checkTag(A::RAX, kIntTag16, slow);
+        as_.shl(A::RAX, 16);
+        as_.sar(A::RAX, 16);
+        elementAddress(ins.b);
+        as_.store(A::RCX, 0, A::RAX);
+        as_.jmp(next);
+
+        as_.bind(notInts);
+        as_.cmp32(A::RAX, kDoubleElements);
+        as_.jcc(A::NotEqual, slow);
+        as_.load(A::RAX, R, slot(ins.c));
+        as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::AboveEqual, slow);
+        elementAddress(ins.b);
+        as_.store(A::RCX, 0, A::RAX);
+        as_.jmp(next);
+
+        as_.bind(slow);
+        storeIndexCall(ins);
+        as_.bind(next);
+    }
+
+    // R[A] = R[B].key. The site's cache is read where it lives, at run
+    // time: the object's shape is compared with each cached shape in turn
+    // and a match is one load from the slots. Anything else, including a
+    // shape the cache has yet to see, goes through the runtime, which
+    // fills the cache in for next time.
+    void getMember(const Instruction& ins) {
+        PropertyCache& cache = chunk_.properties[ins.c];
+        A::Label slow, store, next;
+        std::array<A::Label, PropertyCache::kEntries> hits;
+        as_.load(A::RDX, R, slot(ins.b));
+        checkTag(A::RDX, kObjectTag16, slow);
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RDX, A::RCX);
+        as_.load(A::RAX, A::RDX, kHeapKind);
+        as_.movzxByte(A::RAX, A::RAX);
+        as_.cmp32(A::RAX, kContainerKind);
+        as_.jcc(A::NotEqual, slow);
+        as_.load(A::RAX, A::RDX, kGcClass);
+        as_.movImm64(A::RCX, reinterpret_cast<uint64_t>(&ShapedObject::kClass));
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::NotEqual, slow);
+
+        // rcx = shape, rdx = slots
+        as_.load(A::RCX, A::RDX, kObjectShape);
+        as_.load(A::RDX, A::RDX, kObjectSlots);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            as_.movImm64(A::RAX, reinterpret_cast<uint64_t>(&cache.entries[i].shape));
+            as_.load(A::RAX, A::RAX, 0);
+            as_.cmp(A::RAX, A::RCX);
+            as_.jcc(A::Equal, hits[i]);
+        }
+        as_.jmp(slow);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            as_.bind(hits[i]);
+            as_.movImm64(A::RAX, reinterpret_cast<uint64_t>(&cache.entries[i].slot));
+            as_.load(A::RAX, A::RAX, 0);
+            as_.shl(A::RAX, 3);
+            as_.add(A::RAX, A::RDX);
+            as_.load(A::RAX, A::RAX, 0);
+            as_.jmp(store);
+        }
+
+        as_.bind(slow);
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.lea(A::RDX, R, slot(ins.b));
+        as_.movImm64(A::RCX, reinterpret_cast<uint64_t>(&cache));
+        call(reinterpret_cast<const void*>(&Jit::getMemberHelper));
+        exitOnError();
+        as_.jmp(next);
+
+        as_.bind(store);
+        retain();
+        storeOwned(R, slot(ins.a));
+        as_.bind(next);
+    }
+
+    static bool isComparison(BinaryOperator op) {
+        return op == BinaryOperator::Eq || op == BinaryOperator::Ne || op == BinaryOperator::Lt ||
+               op == BinaryOperator::Le || op == BinaryOperator::Gt || op == BinaryOperator::Ge;
+    }
+
+    // Re-boxes the int64 in rax, or takes `slow` if it needs more than 48 bits
+    void boxInt(A::Label& slow) {
+        as_.mov(A::RCX, A::RAX);
+        as_.shl(A::RCX, 16);
+        as_.sar(A::RCX, 16);
+        as_.cmp(A::RCX, A::RAX);
+        as_.jcc(A::NotEqual, slow);
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RAX, A::RCX);
+        as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+        as_.or_(A::RAX, A::RCX);
+    }
+
+    // Boxes the 0/1 in rax as a bool
+    void boxBool() {
+        as_.movImm64(A::RCX, RuntimeValue::kBoolTag);
+        as_.or_(A::RAX, A::RCX);
+    }
+
+    // Moves the double in xmm0 to rax, canonicalizing NaN like RuntimeValue
+    void boxDouble() {
+        A::Label done;
+        as_.movqFromXmm(A::RAX, A::XMM0);
+        as_.ucomisd(A::XMM0, A::XMM0);
+        as_.jcc(A::NoParity, done);
+        as_.movImm64(A::RAX, RuntimeValue::kCanonicalNaN);
+        as_.bind(done);
+    }
+
+    // rax = rax op rdx for two doubles, boxed; division by zero takes `slow`
+    void doubleOp(BinaryOperator op, A::Label& slow) {
+        as_.movqToXmm(A::XMM0, A::RAX);
+        as_.movqToXmm(A::XMM1, A::RDX);
+        switch (op) {
+        case BinaryOperator::Add:
+            as_.addsd(A::XMM0, A::XMM1);
+            boxDouble();
+            break;
+        case BinaryOperator::Sub:
+            as_.subsd(A::XMM0, A::XMM1);
+            boxDouble();
+            break;
+        case BinaryOperator::Mul:
+            as_.mulsd(A::XMM0, A::XMM1);
+            boxDouble();
+            break;
+        case BinaryOperator::Div:
+            // Division by (either) zero raises
+            as_.mov(A::RCX, A::RDX);
+            as_.shl(A::RCX, 1);
+            as_.jcc(A::Equal, slow);
+            as_.divsd(A::XMM0, A::XMM1);
+            boxDouble();
+            break;
+        case BinaryOperator::Eq:
+            // Equal and ordered
+            as_.ucomisd(A::XMM0, A::XMM1);
+            as_.setcc(A::Equal, A::RAX);
+            as_.setcc(A::NoParity, A::RCX);
+            as_.andByte(A::RAX, A::RCX);
+            as_.movzxByte(A::RAX, A::RAX);
+            boxBool();
+            break;
+        case BinaryOperator::Ne:
+            as_.ucomisd(A::XMM0, A::XMM1);
+            as_.setcc(A::NotEqual, A::RAX);
+            as_.setcc(A::Parity, A::RCX);
+            as_.orByte(A::RAX, A::RCX);
+            as_.movzxByte(A::RAX, A::RAX);
+            boxBool();
+            break;
+        default:
+            // ucomisd sets "above" only for ordered operands, so NaN
+            // compares false; < and <= swap the operands to use it
+            if (op == BinaryOperator::Lt || op == BinaryOperator::Le) {
+                as_.ucomisd(A::XMM1, A::XMM0);
+            } else {
+                as_.ucomisd(A::XMM0, A::XMM1);
+            }
+            as_.setcc(op == BinaryOperator::Lt || op == BinaryOperator::Gt ? A::Above : A::AboveEqual, A::RAX);
+            as_.movzxByte(A::RAX, A::RAX);
+            boxBool();
+            break;
+        }
+    }
+
+    // R[A] = R[B] op R[C] for operands the TypeChecker proved to be doubles:
+    // no tag checks; only division by zero leaves for the evaluator
+    void floatArithmetic(const Instruction& ins, BinaryOperator op) {
+        A::Label slow, next;
+        as_.load(A::RAX, R, slot(ins.b));
+        as_.load(A::RDX, R, slot(ins.c));
+        doubleOp(op, slow);
+        storeOwned(R, slot(ins.a));
+        as_.jmp(next);
+        as_.bind(slow);
+        binaryCall(ins, op);
+        as_.bind(next);
+    }
+
+    // R[A] = R[B] op R[C] with inline paths for two small ints and for two
+    // doubles; everything else (strings, bools, boxed ints, mixed types,
+    // overflow, division by zero) calls the shared evaluator.
+    void arithmetic(const Instruction& ins, BinaryOperator op) {
+        A::Label notInts, slow, store, next;
+        as_.load(A::RAX, R, slot(ins.b));
+        as_.load(A::RDX, R, slot(ins.c));
+
+        // Small ints: sign-extend both 48-bit payloads
+        checkTag(A::RAX, kIntTag16, notInts);
+        checkTag(A::RDX, kIntTag16, slow);
+        as_.shl(A::RAX, 16);
+        as_.sar(A::RAX, 16);
+        as_.shl(A::RDX, 16);
+        as_.sar(A::RDX, 16);
+        if (isComparison(op)) {
+            as_.cmp(A::RAX, A::RDX);
+            as_.setcc(intCondition(op), A::RAX);
+            as_.movzxByte(A::RAX, A::RAX);
+            boxBool();
+        } else {
+            switch (op) {
+            case BinaryOperator::Add:
+                as_.add(A::RAX, A::RDX);
+                break;
+            case BinaryOperator::Sub:
+                as_.sub(A::RAX, A::RDX);
+                break;
+            case BinaryOperator::Mul:
+                as_.imul(A::RAX, A::RDX);
+                as_.jcc(A::Overflow, slow);
+                break;
+            default:   // Div
+                as_.test(A::RDX, A::RDX);
+                as_.jcc(A::Equal, slow);
+                as_.mov(A::RCX, A::RDX);
+                as_.cqo();
+                as_.idiv(A::RCX);
+                break;
+            }
+            boxInt(slow);
+        }
+        as_.jmp(store);
+
+        // Doubles: every bit pattern below the int tag
+        as_.bind(notInts);
+        as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::AboveEqual, slow);
+        as_.cmp(A::RDX, A::RCX);
+        as_.jcc(A::AboveEqual, slow);
+        doubleOp(op, slow);
+        as_.jmp(store);
+
+        as_.bind(slow);
+        binaryCall(ins, op);
+        as_.jmp(next);
+
+        // Results built inline are never objects
+        as_.bind(store);
+        storeOwned(R, slot(ins.a));
+        as_.bind(next);
+    }
+
+    static A::Cond intCondition(BinaryOperator op) {
+        switch (op) {
+        case BinaryOperator::Eq: return A::Equal;
+        case BinaryOperator::Ne: return A::NotEqual;
+        case BinaryOperator::Lt: return A::Less;
+        case BinaryOperator::Le: return A::LessEqual;
+        case BinaryOperator::Gt: return A::Greater;
+        default: return A::GreaterEqual;
+        }
+    }
+
+    // Advances the counter in R[A] by `step` and goes to `body`, with the
+    // variable R[A + 2] set, while it is below the end bound R[A + 1], else
+    // to `done`. Small ints stay inline: the counter is below the bound,
+    // so neither the step nor re-boxing needs an overflow check.
+    void rangeStep(const Instruction& ins, uint32_t step, A::Label& body, A::Label& done) {
+        A::Label slow;
+        as_.load(A::RAX, R, slot(ins.a));
+        as_.load(A::RDX, R, slot(ins.a + 1));
+        checkTag(A::RAX, kIntTag16, slow);
+        checkTag(A::RDX, kIntTag16, slow);
+        as_.shl(A::RAX, 16);
+        as_.sar(A::RAX, 16);
+        as_.shl(A::RDX, 16);
+        as_.sar(A::RDX, 16);
+        if (step) {
+            as_.inc(A::RAX);
+        }
+        as_.cmp(A::RAX, A::RDX);
+        as_.jcc(A::GreaterEqual, done);
+        as_.movImm64(A::RCX, RuntimeValue::kPayloadMask);
+        as_.and_(A::RAX, A::RCX);
+        as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+        as_.or_(A::RAX, A::RCX);
+        if (step) {
+            as_.store(R, slot(ins.a), A::RAX);  // Replaces a small int: nothing to release
+        }
+        storeOwned(R, slot(ins.a + 2));
+        as_.jmp(body);
+
+        as_.bind(slow);
+        as_.mov(A::RDI, CTX);
+        as_.lea(A::RSI, R, slot(ins.a));
+        as_.movImm32(A::RDX, step);
+        call(reinterpret_cast<const void*>(&Jit::rangeHelper));
+        as_.cmp32(A::RAX, kRangeBody);
+        as_.jcc(A::Equal, body);
+        as_.cmp32(A::RAX, kRangeDone);
+        as_.jcc(A::Equal, done);
+        exitWith(kJitError);
+    }
+
+    void jumpIfFalse(const Instruction& ins) {
+        A::Label next;
+        A::Label& target = labels_[ins.bx()];
+        // false, true and 0 inline; anything else asks the runtime
+        as_.load(A::RAX, R, slot(ins.a));
+        as_.movImm64(A::RCX, RuntimeValue::kBoolTag);
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::Equal, target);
+        as_.movImm64(A::RCX, RuntimeValue::kBoolTag | 1);
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::Equal, next);
+        as_.movImm64(A::RCX, RuntimeValue::kIntTag);
+        as_.cmp(A::RAX, A::RCX);
+        as_.jcc(A::Equal, target);
+        as_.lea(A::RDI, R, slot(ins.a));
+        call(reinterpret_cast<const void*>(&Jit::truthyHelper));
+        as_.testEax();
+        as_.jcc(A::Equal, target);
+        as_.bind(next);
+    }
+};
+
+bool Jit::compile(FunctionProto& proto) {
+    Codegen codegen(proto.chunk);
+    std::unique_ptr<JitCode> code;
+    if (codegen.generate()) {
+        code = JitCode::create(codegen.code().data(), codegen.code().size());
+    }
+    if (!code) {
+        proto.jitFailed = true;
+        if (options_.trace) {
+            std::cerr << "[tiering] fn " << proto.name << ": stays in bytecode (not compilable)" << std::endl;
+        }
+        return false;
+    }
+    if (options_.trace) {
+        std::cerr << "[tiering] fn " << proto.name << ": bytecode -> native code after " << proto.hotness
+                  << " calls and iterations" << std::endl;
+    }
+    if (options_.perfMap) {
+        writePerfMap(*code, proto.name);
+    }
+    proto.jit = std::move(code);
+    ++compiled_;
+    return true;
+}
+
+void Jit::writePerfMap(const JitCode& code, const std::string& name) {
+    // One file per process, shared by every VM in it
+    static std::mutex mutex;
+    static FILE* file = nullptr;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/tmp/perf-%ld.map", static_cast<long>(getpid()));
+        file = std::fopen(path, "a");
+        if (!file) {
+            return;
+        }
+    }
+    std::fprintf(file, "%lx %lx myndra:%s\n", static_cast<unsigned long>(reinterpret_cast<uintptr_t>(code.start())),
+                 static_cast<unsigned long>(code.size()), name.c_str());
+    std::fflush(file);
+}
+
+#else
+
+bool Jit::compile(FunctionProto& proto) {
+    proto.jitFailed = true;
+    return false;
+}
+
+void Jit::writePerfMap(const JitCode&, const std::string&) {}
+
+#endif
+
+} // namespace myndra
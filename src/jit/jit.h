@@ -0,0 +1,136 @@
+#ifndef MYNDRA_JIT_H
+#define MYNDRA_JIT_H
+
+#include "../runtime/bytecode.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace myndra {
+
+class VM;
+
+// State JIT-compiled code reads on every call; shared by the nested calls
+// of one VM
+struct JitContext {
+    RuntimeValue* globals;   // Must stay first: compiled code loads it from offset 0
+    VM* vm;
+};
+
+// How a compiled function came back
+enum JitStatus : uint32_t {
+    kJitOk = 0,         // Returned (result in registers[-1]), or a helper succeeded
+    kJitError = 1,      // The VM holds the pending exception
+    kJitTailCall = 2    // Callee and arguments moved into the window; run it next
+};
+
+// Machine code of one function, in a mapping of its own
+class JitCode {
+public:
+    using Entry = JitStatus (*)(JitContext* context, RuntimeValue* registers);
+
+    // Copies `bytes` into fresh executable memory; null if mapping fails
+    static std::unique_ptr<JitCode> create(const uint8_t* bytes, size_t size);
+    ~JitCode();
+
+    JitCode(const JitCode&) = delete;
+    JitCode& operator=(const JitCode&) = delete;
+
+    Entry entry() const { return reinterpret_cast<Entry>(memory_); }
+    const void* start() const { return memory_; }
+    size_t size() const { return size_; }
+
+private:
+    JitCode(void* memory, size_t size, size_t mapped) : memory_(memory), size_(size), mapped_(mapped) {}
+
+    void* memory_;
+    size_t size_;
+    size_t mapped_;
+};
+
+struct JitOptions {
+    uint32_t threshold = 1000;   // Calls plus loop iterations before compiling; 0 disables
+    bool perfMap = true;         // Append compiled functions to /tmp/perf-<pid>.map
+    bool trace = false;          // Log each compiled function to stderr (--trace-tiering)
+};
+
+// Baseline (template) JIT for x86-64.
+//
+// Each bytecode instruction of a hot function becomes a fixed machine code
+// template. Arithmetic and comparisons run inline when both operands are
+// integer immediates or both are doubles, and so do element reads and
+// writes the compiler proved in bounds on int and double arrays; any other
+// operand types, and the instructions that need the runtime (calls,
+// natives, logical operators, raise), call back into the same C++ code the
+// VM uses. A function containing an instruction with no template is never
+// compiled and stays in the interpreter.
+//
+// Every compiled function is appended to /tmp/perf-<pid>.map, so perf can
+// name JIT frames.
+class Jit {
+public:
+    using Options = JitOptions;
+
+    explicit Jit(const Options& options = Options());
+
+    // True when this build can generate code for the host
+    static bool supported();
+    bool enabled() const { return supported() && options_.threshold > 0; }
+
+    // Counts a call or a loop back-edge of `proto`; compiles it once the
+    // threshold is crossed. True if compiled code is available.
+    bool tick(FunctionProto& proto) {
+        if (proto.jit) return true;
+        if (!enabled() || proto.jitFailed || ++proto.hotness < options_.threshold) return false;
+        return compile(proto);
+    }
+
+    // Compiles `proto` now; false (and never retried) if it cannot be
+    bool compile(FunctionProto& proto);
+
+    size_t compiledFunctions() const { return compiled_; }
+
+private:
+    Options options_;
+    size_t compiled_ = 0;
+
+    // Entry points called from compiled code
+    static JitStatus binaryHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* left,
+                                  const RuntimeValue* right, uint32_t op);
+    static JitStatus unaryHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* operand, uint32_t op);
+    static uint32_t truthyHelper(const RuntimeValue* value);
+    static void releaseHelper(HeapObject* object);
+    static JitStatus callHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t argc);
+    static JitStatus tailCallHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t argc);
+    static JitStatus nativeHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t id, uint32_t argc);
+    static JitStatus raiseHelper(JitContext* context, const RuntimeValue* message);
+    static JitStatus newArrayHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t b,
+                                    uint32_t count);
+    // Checked element access, and the slow path of the unchecked forms
+    static JitStatus indexHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* array,
+                                 const RuntimeValue* index);
+    static JitStatus storeIndexHelper(JitContext* context, const RuntimeValue* array, const RuntimeValue* index,
+                                      const RuntimeValue* value);
+    static JitStatus newObjectHelper(JitContext* context, RuntimeValue* registers, uint32_t a, uint32_t b,
+                                     const Shape* shape);
+    // Property access through the site's cache; GET_MEMBER's slow path
+    static JitStatus getMemberHelper(JitContext* context, RuntimeValue* dest, const RuntimeValue* object,
+                                     PropertyCache* cache);
+    static JitStatus setMemberHelper(JitContext* context, const RuntimeValue* object, const RuntimeValue* value,
+                                     PropertyCache* cache);
+    // IN_BOUNDS over range[0] .. range[1]; 1 if it holds
+    static uint32_t inBoundsHelper(const RuntimeValue* array, const RuntimeValue* range);
+    // FOR_PREP (step 0) or FOR_LOOP (step 1) for counters or bounds that
+    // are not small ints
+    enum RangeStep : uint32_t { kRangeDone, kRangeBody, kRangeError };
+    static uint32_t rangeHelper(JitContext* context, RuntimeValue* range, uint32_t step);
+
+    class Codegen;
+
+    void writePerfMap(const JitCode& code, const std::string& name);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_JIT_H
@@ -0,0 +1,152 @@
+#ifndef MYNDRA_X64_ASSEMBLER_H
+#define MYNDRA_X64_ASSEMBLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace myndra {
+
+// Minimal x86-64 encoder: just the instructions the baseline JIT's
+// templates use. Memory operands are always [base + disp32]; bases that
+// would need a SIB byte (rsp, r12) are not supported.
+class X64Assembler {
+public:
+    enum Reg : uint8_t {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8, R9, R10, R11, R12, R13, R14, R15
+    };
+    enum Xmm : uint8_t { XMM0, XMM1 };
+
+    enum Cond : uint8_t {
+        Overflow = 0x0, Below = 0x2, AboveEqual = 0x3, Equal = 0x4, NotEqual = 0x5,
+        Above = 0x7, Parity = 0xA, NoParity = 0xB,
+        Less = 0xC, GreaterEqual = 0xD, LessEqual = 0xE, Greater = 0xF
+    };
+
+    // Jump target. Jumps to an unbound label are patched when it is bound.
+    struct Label {
+        int64_t position = -1;
+        std::vector<size_t> fixups;   // Offsets of rel32 fields to patch
+    };
+
+    const std::vector<uint8_t>& code() const { return code_; }
+    size_t size() const { return code_.size(); }
+
+    void bind(Label& label) {
+        label.position = static_cast<int64_t>(code_.size());
+        for (size_t fixup : label.fixups) {
+            patchRel32(fixup, label.position);
+        }
+        label.fixups.clear();
+    }
+
+    // Stack and control flow
+    void push(Reg r) { rexB(r); byte(0x50 + (r & 7)); }
+    void pop(Reg r) { rexB(r); byte(0x58 + (r & 7)); }
+    void ret() { byte(0xC3); }
+    void callRax() { byte(0xFF); byte(0xD0); }
+    void jmp(Label& label) { byte(0xE9); rel32(label); }
+    void jcc(Cond cond, Label& label) { byte(0x0F); byte(0x80 + cond); rel32(label); }
+
+    // Moves
+    void movImm64(Reg dst, uint64_t value) {
+        rex(true, 0, dst);
+        byte(0xB8 + (dst & 7));
+        imm64(value);
+    }
+    void movImm32(Reg dst, uint32_t value) {   // Zero-extends
+        rexB(dst);
+        byte(0xB8 + (dst & 7));
+        imm32(value);
+    }
+    void mov(Reg dst, Reg src) { rex(true, src, dst); byte(0x89); modrmReg(src, dst); }
+    void load(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8B); modrmMem(dst, base, disp); }
+    void store(Reg base, int32_t disp, Reg src) { rex(true, src, base); byte(0x89); modrmMem(src, base, disp); }
+    void lea(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8D); modrmMem(dst, base, disp); }
+
+    // Integer arithmetic
+    void add(Reg dst, Reg src) { alu(0x01, dst, src); }
+    void sub(Reg dst, Reg src) { alu(0x29, dst, src); }
+    void and_(Reg dst, Reg src) { alu(0x21, dst, src); }
+    void or_(Reg dst, Reg src) { alu(0x09, dst, src); }
+    void cmp(Reg left, Reg right) { alu(0x39, left, right); }
+    void test(Reg left, Reg right) { alu(0x85, left, right); }
+    void imul(Reg dst, Reg src) { rex(true, dst, src); byte(0x0F); byte(0xAF); modrmReg(dst, src); }
+    void cqo() { byte(0x48); byte(0x99); }
+    void idiv(Reg divisor) { rex(true, 0, divisor); byte(0xF7); modrmReg(7, divisor); }
+    void inc(Reg r) { rex(true, 0, r); byte(0xFF); modrmReg(0, r); }
+    void shl(Reg r, uint8_t amount) { shift(4, r, amount); }
+    void shr(Reg r, uint8_t amount) { shift(5, r, amount); }
+    void sar(Reg r, uint8_t amount) { shift(7, r, amount); }
+    void cmp32(Reg r, uint32_t value) { rexB(r); byte(0x81); modrmReg(7, r); imm32(value); }
+    void testEax() { byte(0x85); byte(0xC0); }
+
+    // Reference counts (32-bit, at offset 0 of the object `r` points to)
+    void incMem32(Reg r) { rexB(r); byte(0xFF); modrmMem(0, r, 0); }
+    void decMem32(Reg r) { rexB(r); byte(0xFF); modrmMem(1, r, 0); }
+
+    // Flags to a byte register (al, cl, dl, bl only)
+    void setcc(Cond cond, Reg r) { byte(0x0F); byte(0x90 + cond); modrmReg(0, r); }
+    void andByte(Reg dst, Reg src) { byte(0x20); modrmReg(src, dst); }
+    void orByte(Reg dst, Reg src) { byte(0x08); modrmReg(src, dst); }
+    void movzxByte(Reg dst, Reg src) { byte(0x0F); byte(0xB6); modrmReg(dst, src); }
+
+    // Scalar doubles
+    void movqToXmm(Xmm dst, Reg src) { byte(0x66); rex(true, dst, src); byte(0x0F); byte(0x6E); modrmReg(dst, src); }
+    void movqFromXmm(Reg dst, Xmm src) { byte(0x66); rex(true, src, dst); byte(0x0F); byte(0x7E); modrmReg(src, dst); }
+    void addsd(Xmm dst, Xmm src) { sse(0xF2, 0x58, dst, src); }
+    void subsd(Xmm dst, Xmm src) { sse(0xF2, 0x5C, dst, src); }
+    void mulsd(Xmm dst, Xmm src) { sse(0xF2, 0x59, dst, src); }
+    void divsd(Xmm dst, Xmm src) { sse(0xF2, 0x5E, dst, src); }
+    void ucomisd(Xmm left, Xmm right) { sse(0x66, 0x2E, left, right); }
+
+private:
+    std::vector<uint8_t> code_;
+
+    void byte(uint8_t value) { code_.push_back(value); }
+    void imm32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void imm64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) byte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    // REX prefix for a ModRM `reg` field and `rm`/base register
+    void rex(bool wide, uint8_t reg, uint8_t rm) {
+        uint8_t prefix = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (prefix != 0x40) byte(prefix);
+    }
+    void rexB(uint8_t rm) { rex(false, 0, rm); }
+
+    void modrmReg(uint8_t reg, uint8_t rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+    void modrmMem(uint8_t reg, uint8_t base, int32_t disp) {
+        byte(0x80 | ((reg & 7) << 3) | (base & 7));
+        imm32(static_cast<uint32_t>(disp));
+    }
+
+    void alu(uint8_t opcode, Reg dst, Reg src) { rex(true, src, dst); byte(opcode); modrmReg(src, dst); }
+    void shift(uint8_t ext, Reg r, uint8_t amount) { rex(true, 0, r); byte(0xC1); modrmReg(ext, r); byte(amount); }
+    void sse(uint8_t prefix, uint8_t opcode, uint8_t dst, uint8_t src) {
+        byte(prefix); byte(0x0F); byte(opcode); modrmReg(dst, src);
+    }
+
+    void rel32(Label& label) {
+        size_t at = code_.size();
+        imm32(0);
+        if (label.position >= 0) {
+            patchRel32(at, label.position);
+        } else {
+            label.fixups.push_back(at);
+        }
+    }
+    void patchRel32(size_t at, int64_t target) {
+        int32_t offset = static_cast<int32_t>(target - static_cast<int64_t>(at + 4));
+        std::memcpy(&code_[at], &offset, sizeof(offset));
+    }
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_X64_ASSEMBLER_H
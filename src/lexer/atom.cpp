@@ -0,0 +1,158 @@
+#include "atom.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace myndra {
+
+namespace {
+
+// Process-wide table behind Atom.
+//
+// Interning takes a lock; reading an atom's text does not. Texts are copied
+// into blocks that are never moved or freed, and their views sit in
+// segments that double in size (segment k holds 2^(k+8) ids), so an entry
+// never moves once written. A thread can only hold an atom that was
+// published to it somehow, which orders the entry's write before its read.
+class AtomTable {
+public:
+    static constexpr uint32_t kFirstSegmentBits = 8;
+    static constexpr size_t kSegments = 32 - kFirstSegmentBits;
+    static constexpr uint32_t kMaxAtoms = uint32_t(1) << 31;
+    static constexpr size_t kBlockBytes = 64 * 1024;
+
+    AtomTable() { intern(std::string_view()); }
+
+    uint32_t intern(std::string_view text) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = ids_.find(text);
+        if (found != ids_.end()) {
+            return found->second;
+        }
+        uint32_t id = count_.load(std::memory_order_relaxed);
+        if (id == kMaxAtoms) {
+            throw std::runtime_error("Too many distinct identifiers");
+        }
+        std::string_view stored = store(text);
+        size_t segment, offset;
+        locate(id, segment, offset);
+        std::string_view* entries = segments_[segment].load(std::memory_order_relaxed);
+        if (!entries) {
+            entries = new std::string_view[size_t(1) << (segment + kFirstSegmentBits)];
+            segments_[segment].store(entries, std::memory_order_release);
+        }
+        entries[offset] = stored;
+        ids_.emplace(stored, id);
+        count_.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    uint32_t find(std::string_view text) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = ids_.find(text);
+        return found != ids_.end() ? found->second : 0;
+    }
+
+    std::string_view text(uint32_t id) const {
+        size_t segment, offset;
+        locate(id, segment, offset);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    size_t count() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string_view, uint32_t> ids_;   // Keys view the stored texts
+    std::array<std::atomic<std::string_view*>, kSegments> segments_{};
+    std::atomic<uint32_t> count_{0};
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* free_ = nullptr;
+    size_t freeBytes_ = 0;
+
+    static void locate(uint32_t id, size_t& segment, size_t& offset) {
+        uint32_t biased = id + (uint32_t(1) << kFirstSegmentBits);
+        segment = std::bit_width(biased) - 1 - kFirstSegmentBits;
+        offset = biased - (uint32_t(1) << (segment + kFirstSegmentBits));
+    }
+
+    std::string_view store(std::string_view text) {
+        if (text.size() > freeBytes_) {
+            size_t bytes = std::max(text.size(), kBlockBytes);
+            blocks_.push_back(std::make_unique<char[]>(bytes));
+            free_ = blocks_.back().get();
+            freeBytes_ = bytes;
+        }
+        if (!text.empty()) {
+            std::memcpy(free_, text.data(), text.size());
+        }
+        std::string_view stored(free_, text.size());
+        free_ += text.size();
+        freeBytes_ -= text.size();
+        return stored;
+    }
+};
+
+AtomTable& table() {
+    // Never destroyed: atoms may be read while other statics are torn down
+    static AtomTable* atoms = new AtomTable();
+    return *atoms;
+}
+
+// Recently interned texts of this thread, by hash, so re-interning a
+// common name takes no lock and does not touch the table. `text` views the
+// table's copy, which never moves.
+struct CacheEntry {
+    const char* text = nullptr;
+    uint32_t length = 0;
+    uint32_t id = 0;
+};
+constexpr size_t kCacheEntries = 1024;
+thread_local std::array<CacheEntry, kCacheEntries> cache;
+
+// FNV-1a; identifiers are short, so this beats a general-purpose hash
+size_t cacheIndex(std::string_view text) {
+    uint32_t hash = 2166136261u;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return (hash ^ (hash >> 16)) % kCacheEntries;
+}
+
+} // namespace
+
+Atom Atom::intern(std::string_view text) {
+    if (text.empty()) {
+        return Atom();
+    }
+    CacheEntry& entry = cache[cacheIndex(text)];
+    if (entry.length == text.size() && entry.id != 0 && std::memcmp(entry.text, text.data(), text.size()) == 0) {
+        return Atom(entry.id);
+    }
+    AtomTable& atoms = table();
+    uint32_t id = atoms.intern(text);
+    std::string_view stored = atoms.text(id);
+    entry = {stored.data(), static_cast<uint32_t>(stored.size()), id};
+    return Atom(id);
+}
+
+Atom Atom::find(std::string_view text) {
+    return text.empty() ? Atom() : Atom(table().find(text));
+}
+
+size_t Atom::count() {
+    return table().count();
+}
+
+std::string_view Atom::text() const {
+    return table().text(id_);
+}
+
+} // namespace myndra
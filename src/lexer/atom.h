@@ -0,0 +1,57 @@
+#ifndef MYNDRA_ATOM_H
+#define MYNDRA_ATOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace myndra {
+
+// Interned name: a 32-bit id standing for its text.
+//
+// The lexer interns every identifier once, and from then on names travel
+// through the AST, the passes and the runtime as atoms, so comparing or
+// hashing one is an integer operation. Equal texts get the same atom
+// everywhere in the process, whichever thread interned them. The default
+// atom is the empty name.
+class Atom {
+public:
+    constexpr Atom() = default;
+
+    // Atom for `text`, added to the table if it is new. Thread-safe.
+    static Atom intern(std::string_view text);
+    // Atom for `text` if it was ever interned, else the empty atom
+    static Atom find(std::string_view text);
+    // Atoms interned so far, the empty one included
+    static size_t count();
+
+    // Valid for the life of the process; safe to call from any thread that
+    // obtained the atom
+    std::string_view text() const;
+
+    uint32_t id() const { return id_; }
+    bool empty() const { return id_ == 0; }
+
+    // Atom with a known id, e.g. one read back from a serialized program
+    static constexpr Atom fromId(uint32_t id) { return Atom(id); }
+
+    bool operator==(const Atom& other) const { return id_ == other.id_; }
+    bool operator!=(const Atom& other) const { return id_ != other.id_; }
+
+private:
+    constexpr explicit Atom(uint32_t id) : id_(id) {}
+
+    uint32_t id_ = 0;
+};
+
+static_assert(sizeof(Atom) == 4, "atoms are stored in AST nodes");
+
+} // namespace myndra
+
+template <>
+struct std::hash<myndra::Atom> {
+    size_t operator()(const myndra::Atom& atom) const { return atom.id(); }
+};
+
+#endif // MYNDRA_ATOM_H
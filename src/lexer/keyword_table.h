@@ -0,0 +1,82 @@
+#ifndef MYNDRA_KEYWORD_TABLE_H
+#define MYNDRA_KEYWORD_TABLE_H
+
+#include "token.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace myndra {
+
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+// Perfect hash table over a fixed word list, built entirely at compile time.
+//
+// The constructor searches for a seed under which every word lands in its
+// own slot; declaring the table constexpr forces that search into the
+// compiler, and a word list with no perfect seed fails to compile. Empty
+// slots point at a sentinel entry with empty text, so a lookup is one hash,
+// one load and one string compare, with no probing and no mutable state.
+template <size_t Count, size_t Slots>
+class KeywordTable {
+    static_assert(Count > 0 && Count < 0xFF, "slot indices are stored in a byte");
+    static_assert((Slots & (Slots - 1)) == 0 && Slots >= 2 * Count, "Slots must be a power of two with headroom");
+
+public:
+    constexpr explicit KeywordTable(const std::array<KeywordEntry, Count>& words) {
+        for (size_t i = 0; i < Count; ++i) {
+            entries_[i] = words[i];
+            minLength_ = i == 0 || words[i].text.size() < minLength_ ? words[i].text.size() : minLength_;
+            maxLength_ = words[i].text.size() > maxLength_ ? words[i].text.size() : maxLength_;
+        }
+        entries_[Count] = {std::string_view(), TokenType::ERROR};
+        if (minLength_ < 2) throw "keyword tables hash the first two bytes";
+
+        for (seed_ = 1; seed_ < 1000000; ++seed_) {
+            if (tryBuild()) return;
+        }
+        throw "no perfect hash seed for this word list";
+    }
+
+    // Type of `text`, or `otherwise` if it is not in the table
+    constexpr TokenType find(std::string_view text, TokenType otherwise) const {
+        if (text.size() - minLength_ > maxLength_ - minLength_) return otherwise;
+        const KeywordEntry& entry = entries_[slots_[slot(text, seed_)]];
+        return entry.text == text ? entry.type : otherwise;
+    }
+
+private:
+    std::array<KeywordEntry, Count + 1> entries_{};
+    std::array<uint8_t, Slots> slots_{};
+    uint32_t seed_ = 0;
+    size_t minLength_ = 0;
+    size_t maxLength_ = 0;
+
+    // Mixes the length with the first, second and last bytes (FNV-1a style)
+    static constexpr size_t slot(std::string_view text, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        h = (h ^ static_cast<uint32_t>(text.size())) * 16777619u;
+        h = (h ^ static_cast<uint8_t>(text[0])) * 16777619u;
+        h = (h ^ static_cast<uint8_t>(text[1])) * 16777619u;
+        h = (h ^ static_cast<uint8_t>(text[text.size() - 1])) * 16777619u;
+        return (h ^ (h >> 15)) & (Slots - 1);
+    }
+
+    constexpr bool tryBuild() {
+        slots_.fill(static_cast<uint8_t>(Count));
+        for (size_t i = 0; i < Count; ++i) {
+            uint8_t& index = slots_[slot(entries_[i].text, seed_)];
+            if (index != Count) return false;
+            index = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_KEYWORD_TABLE_H
@@ -1,73 +1,73 @@
 #include "lexer.h"
+#include "keyword_table.h"
 #include <cctype>
-#include <algorithm>
 
 namespace myndra {
 
-std::unordered_map<std::string, TokenType> Lexer::keywords_;
-std::unordered_map<std::string, TokenType> Lexer::annotations_;
+namespace {
 
-Lexer::Lexer(const std::string& source) 
-    : source_(source), current_(0), line_(1), column_(1) {
-    if (keywords_.empty()) {
-        init_keywords();
-    }
-    if (annotations_.empty()) {
-        init_annotations();
-    }
-}
+// Both tables are constant-initialized, so no lexer ever writes to them
+constexpr KeywordTable<35, 128> kKeywords(std::array<KeywordEntry, 35>{{
+    KeywordEntry{"let", TokenType::LET},
+    KeywordEntry{"fn", TokenType::FN},
+    KeywordEntry{"if", TokenType::IF},
+    KeywordEntry{"else", TokenType::ELSE},
+    KeywordEntry{"while", TokenType::WHILE},
+    KeywordEntry{"for", TokenType::FOR},
+    KeywordEntry{"in", TokenType::IN},
+    KeywordEntry{"return", TokenType::RETURN},
+    KeywordEntry{"import", TokenType::IMPORT},
+    KeywordEntry{"export", TokenType::EXPORT},
+    KeywordEntry{"with", TokenType::WITH},
+    KeywordEntry{"capabilities", TokenType::CAPABILITIES},
+    KeywordEntry{"capsule", TokenType::CAPSULE},
+    KeywordEntry{"dsl", TokenType::DSL},
+    KeywordEntry{"fallback", TokenType::FALLBACK},
+    KeywordEntry{"retry", TokenType::RETRY},
+    KeywordEntry{"context", TokenType::CONTEXT},
+    KeywordEntry{"over", TokenType::OVER},
+    KeywordEntry{"tag", TokenType::TAG},
+    KeywordEntry{"did", TokenType::DID},
+    KeywordEntry{"evolving", TokenType::EVOLVING},
+    KeywordEntry{"true", TokenType::BOOLEAN},
+    KeywordEntry{"false", TokenType::BOOLEAN},
+    KeywordEntry{"nil", TokenType::NIL},
+    KeywordEntry{"and", TokenType::AND},
+    KeywordEntry{"or", TokenType::OR},
+    KeywordEntry{"not", TokenType::NOT},
+    KeywordEntry{"observable", TokenType::OBSERVABLE},
+    KeywordEntry{"subscribe", TokenType::SUBSCRIBE},
+    KeywordEntry{"emit", TokenType::EMIT},
+    KeywordEntry{"transition", TokenType::TRANSITION},
+    KeywordEntry{"timeline", TokenType::TIMELINE},
+    KeywordEntry{"verify", TokenType::VERIFY},
+    KeywordEntry{"proof", TokenType::PROOF},
+    KeywordEntry{"has_proof", TokenType::HAS_PROOF}
+}});
 
-void Lexer::init_keywords() {
-    keywords_ = {
-        {"let", TokenType::LET},
-        {"fn", TokenType::FN},
-        {"if", TokenType::IF},
-        {"else", TokenType::ELSE},
-        {"while", TokenType::WHILE},
-        {"for", TokenType::FOR},
-        {"return", TokenType::RETURN},
-        {"import", TokenType::IMPORT},
-        {"export", TokenType::EXPORT},
-        {"with", TokenType::WITH},
-        {"capabilities", TokenType::CAPABILITIES},
-        {"capsule", TokenType::CAPSULE},
-        {"dsl", TokenType::DSL},
-        {"fallback", TokenType::FALLBACK},
-        {"retry", TokenType::RETRY},
-        {"context", TokenType::CONTEXT},
-        {"over", TokenType::OVER},
-        {"tag", TokenType::TAG},
-        {"did", TokenType::DID},
-        {"evolving", TokenType::EVOLVING},
-        {"true", TokenType::BOOLEAN},
-        {"false", TokenType::BOOLEAN},
-        {"nil", TokenType::NIL},
-        {"and", TokenType::AND},
-        {"or", TokenType::OR},
-        {"not", TokenType::NOT},
-        {"observable", TokenType::OBSERVABLE},
-        {"subscribe", TokenType::SUBSCRIBE},
-        {"emit", TokenType::EMIT},
-        {"transition", TokenType::TRANSITION},
-        {"timeline", TokenType::TIMELINE},
-        {"verify", TokenType::VERIFY},
-        {"proof", TokenType::PROOF},
-        {"has_proof", TokenType::HAS_PROOF}
-    };
-}
+constexpr KeywordTable<5, 16> kAnnotations(std::array<KeywordEntry, 5>{{
+    KeywordEntry{"@sync", TokenType::AT_SYNC},
+    KeywordEntry{"@async", TokenType::AT_ASYNC},
+    KeywordEntry{"@parallel", TokenType::AT_PARALLEL},
+    KeywordEntry{"@reactive", TokenType::AT_REACTIVE},
+    KeywordEntry{"@temporal", TokenType::AT_TEMPORAL}
+}});
+
+} // namespace
 
-void Lexer::init_annotations() {
-    annotations_ = {
-        {"@sync", TokenType::AT_SYNC},
-        {"@async", TokenType::AT_ASYNC},
-        {"@parallel", TokenType::AT_PARALLEL},
-        {"@reactive", TokenType::AT_REACTIVE},
-        {"@temporal", TokenType::AT_TEMPORAL}
-    };
+Lexer::Lexer(const std::string& source) : Lexer(SourceBuffer::create(source)) {}
+
+Lexer::Lexer(std::shared_ptr<const SourceBuffer> source, const ScanKernels& scan)
+    : buffer_(std::move(source)), source_(buffer_->text()), scan_(scan), start_(0), current_(0) {
+    if (source_.size() > UINT32_MAX) {
+        add_error("Source is larger than 4 GiB");
+        source_ = source_.substr(0, 0);
+    }
 }
 
-std::vector<Token> Lexer::tokenize() {
+TokenStream Lexer::tokenize() {
     std::vector<Token> tokens;
+    tokens.reserve(source_.size() / 4 + 1); // Rough tokens-per-byte estimate
     
     while (!is_at_end()) {
         Token token = next_token();
@@ -80,94 +80,94 @@ std::vector<Token> Lexer::tokenize() {
     }
     
     if (tokens.empty() || tokens.back().type != TokenType::EOF_TOKEN) {
-        tokens.emplace_back(TokenType::EOF_TOKEN, "", line_, column_);
+        start_ = current_;
+        tokens.push_back(make_token(TokenType::EOF_TOKEN));
     }
     
-    return tokens;
+    return TokenStream(buffer_, std::move(tokens));
 }
 
 Token Lexer::next_token() {
     skip_whitespace();
     
+    start_ = current_;
+    
     if (is_at_end()) {
-        return make_token(TokenType::EOF_TOKEN, std::string(""));
+        return make_token(TokenType::EOF_TOKEN);
     }
     
     char c = advance();
     
     // Single-character tokens
     switch (c) {
-        case '(': return make_token(TokenType::LEFT_PAREN, std::string("("));
-        case ')': return make_token(TokenType::RIGHT_PAREN, std::string(")"));
-        case '{': return make_token(TokenType::LEFT_BRACE, std::string("{"));
-        case '}': return make_token(TokenType::RIGHT_BRACE, std::string("}"));
-        case '[': return make_token(TokenType::LEFT_BRACKET, std::string("["));
-        case ']': return make_token(TokenType::RIGHT_BRACKET, std::string("]"));
-        case ',': return make_token(TokenType::COMMA, std::string(","));
-        case '.': return make_token(TokenType::DOT, std::string("."));
-        case ';': return make_token(TokenType::SEMICOLON, std::string(";"));
-        case '?': return make_token(TokenType::QUESTION, std::string("?"));
+        case '(': return make_token(TokenType::LEFT_PAREN);
+        case ')': return make_token(TokenType::RIGHT_PAREN);
+        case '{': return make_token(TokenType::LEFT_BRACE);
+        case '}': return make_token(TokenType::RIGHT_BRACE);
+        case '[': return make_token(TokenType::LEFT_BRACKET);
+        case ']': return make_token(TokenType::RIGHT_BRACKET);
+        case ',': return make_token(TokenType::COMMA);
+        case '.':
+            if (match('.')) return make_token(TokenType::DOT_DOT);
+            return make_token(TokenType::DOT);
+        case ';': return make_token(TokenType::SEMICOLON);
+        case '?': return make_token(TokenType::QUESTION);
         case '+': 
-            if (match('=')) return make_token(TokenType::PLUS_ASSIGN, std::string("+="));
-            return make_token(TokenType::PLUS, std::string("+"));
+            if (match('=')) return make_token(TokenType::PLUS_ASSIGN);
+            return make_token(TokenType::PLUS);
         case '-': 
-            if (match('=')) return make_token(TokenType::MINUS_ASSIGN, std::string("-="));
-            if (match('>')) return make_token(TokenType::ARROW, std::string("->"));
-            return make_token(TokenType::MINUS, std::string("-"));
-        case '*': return make_token(TokenType::MULTIPLY, std::string("*"));
-        case '%': return make_token(TokenType::MODULO, std::string("%"));
+            if (match('=')) return make_token(TokenType::MINUS_ASSIGN);
+            if (match('>')) return make_token(TokenType::ARROW);
+            return make_token(TokenType::MINUS);
+        case '*': return make_token(TokenType::MULTIPLY);
+        case '%': return make_token(TokenType::MODULO);
         case '!':
-            if (match('=')) return make_token(TokenType::NOT_EQUAL, std::string("!="));
-            return make_token(TokenType::NOT, std::string("!"));
+            if (match('=')) return make_token(TokenType::NOT_EQUAL);
+            return make_token(TokenType::NOT);
         case '=':
-            if (match('=')) return make_token(TokenType::EQUAL, std::string("=="));
-            if (match('>')) return make_token(TokenType::FAT_ARROW, std::string("=>"));
-            return make_token(TokenType::ASSIGN, std::string("="));
+            if (match('=')) return make_token(TokenType::EQUAL);
+            if (match('>')) return make_token(TokenType::FAT_ARROW);
+            return make_token(TokenType::ASSIGN);
         case '<':
-            if (match('=')) return make_token(TokenType::LESS_EQUAL, std::string("<="));
-            return make_token(TokenType::LESS, std::string("<"));
+            if (match('=')) return make_token(TokenType::LESS_EQUAL);
+            return make_token(TokenType::LESS);
         case '>':
-            if (match('=')) return make_token(TokenType::GREATER_EQUAL, std::string(">="));
-            return make_token(TokenType::GREATER, std::string(">"));
+            if (match('=')) return make_token(TokenType::GREATER_EQUAL);
+            return make_token(TokenType::GREATER);
         case ':':
-            if (match(':')) return make_token(TokenType::DOUBLE_COLON, std::string("::"));
-            return make_token(TokenType::COLON, std::string(":"));
+            if (match(':')) return make_token(TokenType::DOUBLE_COLON);
+            return make_token(TokenType::COLON);
         case '/':
             if (match('/')) {
                 skip_line_comment();
-                return make_token(TokenType::COMMENT, std::string(""));
+                return make_token(TokenType::COMMENT);
             }
             if (match('*')) {
                 skip_block_comment();
-                return make_token(TokenType::COMMENT, std::string(""));
+                return make_token(TokenType::COMMENT);
             }
-            return make_token(TokenType::DIVIDE, std::string("/"));
+            return make_token(TokenType::DIVIDE);
         case '#':
             if (is_alpha(peek())) {
                 return semantic_tag();
             }
-            return make_token(TokenType::HASH, std::string("#"));
+            return make_token(TokenType::HASH);
         case '@':
             return annotation();
         case '\n':
-            line_++;
-            column_ = 1;
-            return make_token(TokenType::NEWLINE, std::string("\n"));
+            return make_token(TokenType::NEWLINE);
         case '"':
             return string_literal();
         default:
             if (is_digit(c)) {
                 current_--; // Back up to re-read the digit
-                column_--;
                 return number_literal();
             }
             if (is_alpha(c)) {
                 current_--; // Back up to re-read the character
-                column_--;
                 return identifier_or_keyword();
             }
-            add_error("Unexpected character: " + std::string(1, c));
-            return error_token("Unexpected character");
+            return error_token("Unexpected character: " + std::string(1, c));
     }
 }
 
@@ -177,7 +177,6 @@ bool Lexer::is_at_end() const {
 
 char Lexer::advance() {
     if (is_at_end()) return '\0';
-    column_++;
     return source_[current_++];
 }
 
@@ -195,82 +194,77 @@ bool Lexer::match(char expected) {
     if (is_at_end()) return false;
     if (source_[current_] != expected) return false;
     current_++;
-    column_++;
     return true;
 }
 
+// The scanning loops below jump over whole runs with the vector kernels;
+// positions are plain offsets and line/column are derived only on demand.
+
 void Lexer::skip_whitespace() {
-    while (!is_at_end()) {
-        char c = peek();
-        if (c == ' ' || c == '\r' || c == '\t') {
-            advance();
-        } else {
-            break;
+    // Most tokens are separated by at most one blank; only runs are worth a
+    // kernel call
+    if (current_ + 1 >= source_.size() || source_[current_] != ' ' ||
+        (source_[current_ + 1] != ' ' && source_[current_ + 1] != '\t')) {
+        while (current_ < source_.size() &&
+               (source_[current_] == ' ' || source_[current_] == '\t' || source_[current_] == '\r')) {
+            current_++;
         }
+        return;
     }
+    current_ = scan_.skipWhitespace(source_.data() + current_, source_.data() + source_.size()) - source_.data();
 }
 
 void Lexer::skip_line_comment() {
-    while (peek() != '\n' && !is_at_end()) {
-        advance();
-    }
+    current_ = scan_.findEither(source_.data() + current_, source_.data() + source_.size(), '\n', '\n') - source_.data();
 }
 
 void Lexer::skip_block_comment() {
-    while (!is_at_end()) {
-        if (peek() == '*' && peek_next() == '/') {
-            advance(); // consume '*'
-            advance(); // consume '/'
+    const char* end = source_.data() + source_.size();
+    const char* p = source_.data() + current_;
+    for (;;) {
+        p = scan_.findEither(p, end, '*', '*');
+        if (p >= end) break;
+        if (p + 1 < end && p[1] == '/') {
+            p += 2; // consume '*/'
             break;
         }
-        if (peek() == '\n') {
-            line_++;
-            column_ = 0; // Will be incremented by advance()
-        }
-        advance();
+        ++p;
     }
+    current_ = p - source_.data();
 }
 
 Token Lexer::string_literal() {
-    std::string value;
-    
-    while (peek() != '"' && !is_at_end()) {
-        if (peek() == '\n') {
-            line_++;
-            column_ = 0; // Will be incremented by advance()
-        }
-        if (peek() == '\\') {
-            advance(); // consume backslash
-            char escaped = peek();
-            switch (escaped) {
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case 'r': value += '\r'; break;
-                case '\\': value += '\\'; break;
-                case '"': value += '"'; break;
-                default:
-                    add_error("Unknown escape sequence: \\" + std::string(1, escaped));
-                    value += escaped;
-                    break;
-            }
-            advance();
-        } else {
-            value += advance();
+    // Escapes are only validated here; TokenStream::stringValue decodes them
+    const char* end = source_.data() + source_.size();
+    for (;;) {
+        current_ = scan_.findEither(source_.data() + current_, end, '"', '\\') - source_.data();
+        if (is_at_end() || peek() == '"') break;
+        
+        advance(); // consume backslash
+        char escaped = peek();
+        switch (escaped) {
+            case 'n':
+            case 't':
+            case 'r':
+            case '\\':
+            case '"':
+                break;
+            default:
+                add_error("Unknown escape sequence: \\" + std::string(1, escaped));
+                break;
         }
+        advance();
     }
     
     if (is_at_end()) {
-        add_error("Unterminated string");
         return error_token("Unterminated string");
     }
     
     advance(); // consume closing quote
-    return make_token(TokenType::STRING, value);
+    return make_token(TokenType::STRING);
 }
 
 Token Lexer::number_literal() {
-    size_t start = current_;
-    
     while (is_digit(peek())) {
         advance();
     }
@@ -284,56 +278,36 @@ Token Lexer::number_literal() {
         }
     }
     
-    std::string number_str = source_.substr(start, current_ - start);
-    
-    if (is_float) {
-        double value = std::stod(number_str);
-        return make_token(TokenType::FLOAT, value);
-    } else {
-        int64_t value = std::stoll(number_str);
-        return make_token(TokenType::INTEGER, value);
-    }
+    // The value is decoded by the parser when it needs it
+    return make_token(is_float ? TokenType::FLOAT : TokenType::INTEGER);
 }
 
 Token Lexer::identifier_or_keyword() {
-    size_t start = current_;
+    current_ = scan_.skipIdentifier(source_.data() + current_, source_.data() + source_.size()) - source_.data();
     
-    while (is_alnum(peek()) || peek() == '_') {
-        advance();
-    }
+    std::string_view text = source_.substr(start_, current_ - start_);
     
-    std::string text = source_.substr(start, current_ - start);
-    
-    // Check for keywords
-    auto keyword_it = keywords_.find(text);
-    if (keyword_it != keywords_.end()) {
-        TokenType type = keyword_it->second;
-        if (type == TokenType::BOOLEAN) {
-            bool value = (text == "true");
-            return make_token(type, value);
-        }
-        return make_token(type, text);
+    TokenType type = kKeywords.find(text, TokenType::IDENTIFIER);
+    if (type != TokenType::IDENTIFIER) {
+        return make_token(type);
     }
-    
-    return make_token(TokenType::IDENTIFIER, text);
+    return Token(type, static_cast<uint32_t>(start_), static_cast<uint32_t>(current_ - start_),
+                 Atom::intern(text));
 }
 
 Token Lexer::annotation() {
-    size_t start = current_ - 1; // Include the '@'
-    
     while (is_alnum(peek()) || peek() == '_') {
         advance();
     }
     
-    std::string text = source_.substr(start, current_ - start);
+    std::string_view text = source_.substr(start_, current_ - start_); // Includes the '@'
     
-    auto annotation_it = annotations_.find(text);
-    if (annotation_it != annotations_.end()) {
-        return make_token(annotation_it->second);
+    TokenType type = kAnnotations.find(text, TokenType::ERROR);
+    if (type != TokenType::ERROR) {
+        return make_token(type);
     }
     
-    add_error("Unknown annotation: " + text);
-    return error_token("Unknown annotation");
+    return error_token("Unknown annotation: " + std::string(text));
 }
 
 Token Lexer::semantic_tag() {
@@ -343,7 +317,7 @@ Token Lexer::semantic_tag() {
         advance();
     }
     
-    return make_token(TokenType::TAG, std::string(""));
+    return make_token(TokenType::TAG);
 }
 
 bool Lexer::is_alpha(char c) const {
@@ -359,32 +333,19 @@ bool Lexer::is_alnum(char c) const {
 }
 
 Token Lexer::make_token(TokenType type) {
-    return Token(type, "", line_, column_);
-}
-
-Token Lexer::make_token(TokenType type, int64_t value) {
-    return Token(type, std::to_string(value), value, line_, column_);
-}
-
-Token Lexer::make_token(TokenType type, double value) {
-    return Token(type, std::to_string(value), value, line_, column_);
-}
-
-Token Lexer::make_token(TokenType type, const std::string& value) {
-    return Token(type, value, value, line_, column_);
-}
-
-Token Lexer::make_token(TokenType type, bool value) {
-    return Token(type, value ? "true" : "false", value, line_, column_);
+    return Token(type, static_cast<uint32_t>(start_), static_cast<uint32_t>(current_ - start_));
 }
 
 Token Lexer::error_token(const std::string& message) {
-    return Token(TokenType::ERROR, message, line_, column_);
+    // Tokens carry no text of their own, so the message goes to the errors
+    add_error(message);
+    return make_token(TokenType::ERROR);
 }
 
 void Lexer::add_error(const std::string& message) {
-    errors_.push_back("Line " + std::to_string(line_) + 
-                      ", Column " + std::to_string(column_) + 
+    SourceLocation location = buffer_->location(static_cast<uint32_t>(current_));
+    errors_.push_back("Line " + std::to_string(location.line) + 
+                      ", Column " + std::to_string(location.column) + 
                       ": " + message);
 }
 
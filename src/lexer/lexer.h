@@ -2,32 +2,33 @@
 #define MYNDRA_LEXER_H
 
 #include "token.h"
+#include "scan.h"
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
 namespace myndra {
 
 class Lexer {
 public:
     explicit Lexer(const std::string& source);
+    explicit Lexer(std::shared_ptr<const SourceBuffer> source, const ScanKernels& scan = scanKernels());
     
-    std::vector<Token> tokenize();
+    TokenStream tokenize();
     Token next_token();
     
     bool has_errors() const { return !errors_.empty(); }
     const std::vector<std::string>& get_errors() const { return errors_; }
     
 private:
-    std::string source_;
+    std::shared_ptr<const SourceBuffer> buffer_;
+    std::string_view source_;
+    const ScanKernels& scan_;
+    size_t start_;            // Offset of the token being scanned
     size_t current_;
-    size_t line_;
-    size_t column_;
     std::vector<std::string> errors_;
     
-    static std::unordered_map<std::string, TokenType> keywords_;
-    static std::unordered_map<std::string, TokenType> annotations_;
-    
     // Helper methods
     bool is_at_end() const;
     char advance();
@@ -38,12 +39,8 @@ private:
     void skip_line_comment();
     void skip_block_comment();
     
-    // Token creation
+    // Token creation; the lexeme runs from start_ to current_
     Token make_token(TokenType type);
-    Token make_token(TokenType type, int64_t value);
-    Token make_token(TokenType type, double value);
-    Token make_token(TokenType type, const std::string& value);
-    Token make_token(TokenType type, bool value);
     Token error_token(const std::string& message);
     
     // Literal parsing
@@ -59,9 +56,6 @@ private:
     bool is_alnum(char c) const;
     
     void add_error(const std::string& message);
-    
-    static void init_keywords();
-    static void init_annotations();
 };
 
 } // namespace myndra
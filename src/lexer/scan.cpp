@@ -0,0 +1,189 @@
+#include "scan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MYNDRA_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define MYNDRA_SCAN_X86 0
+#endif
+
+namespace myndra {
+
+namespace {
+
+// Scalar kernels (also finish the tail of every vector kernel)
+
+inline bool isIdentifierByte(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+const char* scalarSkipIdentifier(const char* p, const char* end) {
+    while (p < end && isIdentifierByte(*p)) ++p;
+    return p;
+}
+
+const char* scalarSkipWhitespace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+const char* scalarFindEither(const char* p, const char* end, char a, char b) {
+    while (p < end && *p != a && *p != b) ++p;
+    return p;
+}
+
+#if MYNDRA_SCAN_X86
+
+// Bytes >= 0x80 are negative under the signed compares below, so they
+// never fall inside an ASCII range.
+
+// SSE2 (always present on x86-64)
+__attribute__((target("sse2")))
+const char* sse2SkipIdentifier(const char* p, const char* end) {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i beforeA = _mm_set1_epi8('a' - 1);
+    const __m128i afterZ = _mm_set1_epi8('z' + 1);
+    const __m128i before0 = _mm_set1_epi8('0' - 1);
+    const __m128i after9 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i lower = _mm_or_si128(v, caseBit);
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, beforeA), _mm_cmplt_epi8(lower, afterZ));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, before0), _mm_cmplt_epi8(v, after9));
+        __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(v, underscore));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(ident)) & 0xFFFFu;
+        if (stop) return p + __builtin_ctz(stop);
+        p += 16;
+    }
+    return scalarSkipIdentifier(p, end);
+}
+
+__attribute__((target("sse2")))
+const char* sse2SkipWhitespace(const char* p, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                     _mm_cmpeq_epi8(v, cr));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(blank)) & 0xFFFFu;
+        if (stop) return p + __builtin_ctz(stop);
+        p += 16;
+    }
+    return scalarSkipWhitespace(p, end);
+}
+
+__attribute__((target("sse2")))
+const char* sse2FindEither(const char* p, const char* end, char a, char b) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned hit = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb))));
+        if (hit) return p + __builtin_ctz(hit);
+        p += 16;
+    }
+    return scalarFindEither(p, end, a, b);
+}
+
+// AVX2
+__attribute__((target("avx2")))
+const char* avx2SkipIdentifier(const char* p, const char* end) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i beforeA = _mm256_set1_epi8('a' - 1);
+    const __m256i lastZ = _mm256_set1_epi8('z');
+    const __m256i before0 = _mm256_set1_epi8('0' - 1);
+    const __m256i last9 = _mm256_set1_epi8('9');
+    const __m256i underscore = _mm256_set1_epi8('_');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i lower = _mm256_or_si256(v, caseBit);
+        __m256i alpha = _mm256_andnot_si256(_mm256_cmpgt_epi8(lower, lastZ), _mm256_cmpgt_epi8(lower, beforeA));
+        __m256i digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(v, last9), _mm256_cmpgt_epi8(v, before0));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(v, underscore));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+        if (stop) return p + __builtin_ctz(stop);
+        p += 32;
+    }
+    return sse2SkipIdentifier(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2SkipWhitespace(const char* p, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i blank = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                        _mm256_cmpeq_epi8(v, cr));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+        if (stop) return p + __builtin_ctz(stop);
+        p += 32;
+    }
+    return sse2SkipWhitespace(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2FindEither(const char* p, const char* end, char a, char b) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned hit = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb))));
+        if (hit) return p + __builtin_ctz(hit);
+        p += 32;
+    }
+    return sse2FindEither(p, end, a, b);
+}
+
+const ScanKernels kSse2Kernels = {"sse2", sse2SkipIdentifier, sse2SkipWhitespace, sse2FindEither};
+const ScanKernels kAvx2Kernels = {"avx2", avx2SkipIdentifier, avx2SkipWhitespace, avx2FindEither};
+
+bool cpuHasSse2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+bool cpuHasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif // MYNDRA_SCAN_X86
+
+const ScanKernels kScalarKernels = {"scalar", scalarSkipIdentifier, scalarSkipWhitespace, scalarFindEither};
+
+const ScanKernels& selectKernels() {
+#if MYNDRA_SCAN_X86
+    if (cpuHasAvx2()) return kAvx2Kernels;
+    if (cpuHasSse2()) return kSse2Kernels;
+#endif
+    return kScalarKernels;
+}
+
+} // namespace
+
+const ScanKernels& scanKernels() {
+    static const ScanKernels& kernels = selectKernels();
+    return kernels;
+}
+
+const ScanKernels& scalarScanKernels() {
+    return kScalarKernels;
+}
+
+std::vector<const ScanKernels*> availableScanKernels() {
+    std::vector<const ScanKernels*> kernels{&kScalarKernels};
+#if MYNDRA_SCAN_X86
+    if (cpuHasSse2()) kernels.push_back(&kSse2Kernels);
+    if (cpuHasAvx2()) kernels.push_back(&kAvx2Kernels);
+#endif
+    return kernels;
+}
+
+} // namespace myndra
@@ -0,0 +1,36 @@
+#ifndef MYNDRA_SCAN_H
+#define MYNDRA_SCAN_H
+
+#include <vector>
+
+namespace myndra {
+
+// Bulk character-class scanners used by the lexer's hot loops.
+//
+// Each kernel takes the half-open range [p, end) and returns a pointer to
+// the first byte that stops the scan (or `end`). The vector versions
+// classify 16 (SSE2) or 32 (AVX2) bytes per step and finish the tail with
+// the scalar code, so every implementation returns exactly the same result.
+struct ScanKernels {
+    const char* name;
+
+    // First byte that is not [A-Za-z0-9_]
+    const char* (*skipIdentifier)(const char* p, const char* end);
+    // First byte that is not ' ', '\t' or '\r' (newlines are tokens)
+    const char* (*skipWhitespace)(const char* p, const char* end);
+    // First byte equal to `a` or `b`
+    const char* (*findEither)(const char* p, const char* end, char a, char b);
+};
+
+// Fastest kernels supported by the running CPU, chosen once
+const ScanKernels& scanKernels();
+
+// Portable byte-at-a-time kernels
+const ScanKernels& scalarScanKernels();
+
+// Every kernel set this CPU can run, scalar first (tests and benchmarks)
+std::vector<const ScanKernels*> availableScanKernels();
+
+} // namespace myndra
+
+#endif // MYNDRA_SCAN_H
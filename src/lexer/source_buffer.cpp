@@ -0,0 +1,24 @@
+#include "source_buffer.h"
+#include "scan.h"
+#include <algorithm>
+
+namespace myndra {
+
+SourceLocation SourceBuffer::location(uint32_t offset) const {
+    std::call_once(linesOnce_, [this] {
+        const ScanKernels& scan = scanKernels();
+        const char* begin = text_.data();
+        const char* end = begin + text_.size();
+        lineStarts_.push_back(0);
+        for (const char* p = scan.findEither(begin, end, '\n', '\n'); p < end;
+             p = scan.findEither(p + 1, end, '\n', '\n')) {
+            lineStarts_.push_back(static_cast<uint32_t>(p - begin + 1));
+        }
+    });
+    
+    auto next = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), offset);
+    uint32_t line = static_cast<uint32_t>(next - lineStarts_.begin());
+    return {line, offset - *(next - 1) + 1};
+}
+
+} // namespace myndra
@@ -0,0 +1,50 @@
+#ifndef MYNDRA_SOURCE_BUFFER_H
+#define MYNDRA_SOURCE_BUFFER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myndra {
+
+// 1-based line and byte column of a source offset
+struct SourceLocation {
+    uint32_t line;
+    uint32_t column;
+};
+
+// Immutable source text shared by the lexer and every token stream cut
+// from it. Tokens refer to their lexemes by offset into this buffer, so the
+// text is stored exactly once per compilation.
+//
+// Nothing tracks line numbers while lexing; the first location() call finds
+// every newline in one vectorized pass and later calls binary-search it.
+class SourceBuffer {
+public:
+    explicit SourceBuffer(std::string text) : text_(std::move(text)) {}
+    
+    static std::shared_ptr<const SourceBuffer> create(std::string text) {
+        return std::make_shared<const SourceBuffer>(std::move(text));
+    }
+    
+    std::string_view text() const { return text_; }
+    size_t size() const { return text_.size(); }
+    
+    std::string_view slice(uint32_t offset, uint32_t length) const {
+        return std::string_view(text_).substr(offset, length);
+    }
+    
+    SourceLocation location(uint32_t offset) const;
+    
+private:
+    std::string text_;
+    mutable std::once_flag linesOnce_;
+    mutable std::vector<uint32_t> lineStarts_;   // Offset of the first byte of each line
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_SOURCE_BUFFER_H
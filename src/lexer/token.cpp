@@ -1,4 +1,5 @@
 #include "token.h"
+#include <charconv>
 
 namespace myndra {
 
@@ -57,6 +58,7 @@ const char* token_type_to_string(TokenType type) {
         case TokenType::SEMICOLON: return "SEMICOLON";
         case TokenType::COMMA: return "COMMA";
         case TokenType::DOT: return "DOT";
+        case TokenType::DOT_DOT: return "DOT_DOT";
         case TokenType::COLON: return "COLON";
         case TokenType::DOUBLE_COLON: return "DOUBLE_COLON";
         case TokenType::QUESTION: return "QUESTION";
@@ -86,4 +88,46 @@ const char* token_type_to_string(TokenType type) {
     }
 }
 
+bool TokenStream::integerValue(const Token& token, int64_t& value) const {
+    std::string_view text = lexeme(token);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool TokenStream::floatValue(const Token& token, double& value) const {
+    std::string_view text = lexeme(token);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+std::string TokenStream::stringValue(const Token& token) const {
+    std::string_view text = lexeme(token);
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        text = text.substr(1, text.size() - 2);
+    }
+    
+    // The lexer already reported malformed escapes; they decode to the
+    // escaped character itself
+    std::string value;
+    value.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            switch (text[++i]) {
+                case 'n': value += '\n'; break;
+                case 't': value += '\t'; break;
+                case 'r': value += '\r'; break;
+                default: value += text[i]; break;
+            }
+        } else {
+            value += c;
+        }
+    }
+    return value;
+}
+
+bool TokenStream::boolValue(const Token& token) const {
+    return lexeme(token) == "true";
+}
+
 } // namespace myndra
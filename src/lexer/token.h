@@ -1,12 +1,19 @@
 #ifndef MYNDRA_TOKEN_H
 #define MYNDRA_TOKEN_H
 
+#include "atom.h"
+#include "source_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <string>
-#include <variant>
+#include <string_view>
+#include <vector>
 
 namespace myndra {
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     // Literals
     INTEGER,
     FLOAT,
@@ -79,6 +86,7 @@ enum class TokenType {
     SEMICOLON,
     COMMA,
     DOT,
+    DOT_DOT,      // ..
     COLON,
     DOUBLE_COLON, // ::
     QUESTION,
@@ -120,27 +128,79 @@ enum class TokenType {
     ERROR
 };
 
+constexpr size_t kTokenTypeCount = static_cast<size_t>(TokenType::ERROR) + 1;
+
+// Constant set of token types, one bit per type, so membership is a mask
+// test rather than a scan
+class TokenSet {
+public:
+    constexpr TokenSet(std::initializer_list<TokenType> types) {
+        for (TokenType type : types) {
+            bits_[index(type) / 64] |= uint64_t(1) << (index(type) % 64);
+        }
+    }
+    
+    constexpr bool contains(TokenType type) const {
+        return (bits_[index(type) / 64] >> (index(type) % 64)) & 1;
+    }
+    
+private:
+    static constexpr size_t index(TokenType type) { return static_cast<size_t>(type); }
+    
+    uint64_t bits_[2] = {};
+};
+
+static_assert(kTokenTypeCount <= 128, "token types must fit in a TokenSet");
+
+// Compact token. The lexeme is the byte range [offset, offset + length) of
+// the source buffer; literal values and line/column are derived on demand
+// by TokenStream. Identifiers carry their interned name.
 struct Token {
     TokenType type;
-    std::string lexeme;
-    std::variant<int64_t, double, std::string, bool> literal;
-    size_t line;
-    size_t column;
-    
-    Token(TokenType t, std::string lex, size_t ln, size_t col)
-        : type(t), lexeme(std::move(lex)), line(ln), column(col) {}
-    
-    Token(TokenType t, std::string lex, int64_t value, size_t ln, size_t col)
-        : type(t), lexeme(std::move(lex)), literal(value), line(ln), column(col) {}
+    uint32_t offset;
+    uint32_t length;
+    Atom atom;
     
-    Token(TokenType t, std::string lex, double value, size_t ln, size_t col)
-        : type(t), lexeme(std::move(lex)), literal(value), line(ln), column(col) {}
-    
-    Token(TokenType t, std::string lex, std::string value, size_t ln, size_t col)
-        : type(t), lexeme(std::move(lex)), literal(std::move(value)), line(ln), column(col) {}
-    
-    Token(TokenType t, std::string lex, bool value, size_t ln, size_t col)
-        : type(t), lexeme(std::move(lex)), literal(value), line(ln), column(col) {}
+    Token(TokenType t, uint32_t off, uint32_t len, Atom a = Atom())
+        : type(t), offset(off), length(len), atom(a) {}
+};
+
+static_assert(sizeof(Token) == 16, "Token should stay compact");
+
+// Tokens of one source buffer, which they keep alive
+class TokenStream {
+public:
+    TokenStream() = default;
+    TokenStream(std::shared_ptr<const SourceBuffer> source, std::vector<Token> tokens)
+        : source_(std::move(source)), tokens_(std::move(tokens)) {}
+    
+    size_t size() const { return tokens_.size(); }
+    bool empty() const { return tokens_.empty(); }
+    const Token& operator[](size_t index) const { return tokens_[index]; }
+    const Token& back() const { return tokens_.back(); }
+    std::vector<Token>::const_iterator begin() const { return tokens_.begin(); }
+    std::vector<Token>::const_iterator end() const { return tokens_.end(); }
+    
+    const SourceBuffer& source() const { return *source_; }
+    
+    std::string_view lexeme(const Token& token) const {
+        return source_->slice(token.offset, token.length);
+    }
+    
+    SourceLocation location(const Token& token) const {
+        return source_->location(token.offset);
+    }
+    
+    // Literal decoding; the numeric forms return false if the value does
+    // not fit its type
+    bool integerValue(const Token& token, int64_t& value) const;
+    bool floatValue(const Token& token, double& value) const;
+    std::string stringValue(const Token& token) const;   // Quotes stripped, escapes applied
+    bool boolValue(const Token& token) const;
+    
+private:
+    std::shared_ptr<const SourceBuffer> source_;
+    std::vector<Token> tokens_;
 };
 
 const char* token_type_to_string(TokenType type);
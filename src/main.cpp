@@ -1,4 +1,5 @@
 #include "myndra.h"
+#include "jit/jit.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -13,6 +14,13 @@ void print_usage(const char* program_name) {
     std::cout << "  -c, --context <type>    Set execution context (dev|prod|test)\n";
     std::cout << "  -i, --interactive       Start interactive REPL\n";
     std::cout << "  -r, --run               Run the program immediately\n";
+    std::cout << "  -e, --engine <engine>   Execution engine (tiered|interpreter|vm)\n";
+    std::cout << "  --cache-dir <dir>       Cache parsed programs in <dir>\n";
+    std::cout << "  --cache-report          Report module cache hits and misses\n";
+    std::cout << "  --no-jit                Run every VM function in the interpreter loop\n";
+    std::cout << "  --trace-tiering         Log functions and loops moving between tiers\n";
+    std::cout << "  --emit <obj|exe>        Compile to a native object file or executable\n";
+    std::cout << "  -o, --output <path>     Output path for --emit\n";
     std::cout << "  --no-live-reload        Disable live code reloading\n";
     std::cout << "  --no-reactive           Disable reactive programming\n";
     std::cout << "  --no-temporal           Disable temporal types\n";
@@ -34,7 +42,22 @@ void print_usage(const char* program_name) {
 void print_version() {
     std::cout << "Myndra Programming Language\n";
     std::cout << "Version: 1.0.0\n";
+#ifdef MYNDRA_HAVE_LLVM
     std::cout << "Built with: C++20, LLVM\n";
+#else
+    std::cout << "Built with: C++20\n";
+#endif
+    // Only the backends this build actually carries
+    std::cout << "Engines: interpreter, bytecode VM";
+    if (myndra::Jit::supported()) {
+        std::cout << ", x86-64 JIT";
+    }
+    std::cout << "\n";
+#ifdef MYNDRA_HAVE_LLVM
+    std::cout << "Native output: LLVM (--emit obj|exe)\n";
+#else
+    std::cout << "Native output: none (built without LLVM)\n";
+#endif
     std::cout << "Features: All advanced features enabled\n";
 }
 
@@ -108,6 +131,8 @@ int main(int argc, char* argv[]) {
     std::string filename;
     bool interactive = false;
     bool run_immediately = false;
+    std::string emit;         // Native output kind, empty to run the program
+    std::string output_path;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -130,6 +155,57 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: --context requires an argument\n";
                 return 1;
             }
+        } else if (arg == "-e" || arg == "--engine") {
+            if (i + 1 < argc) {
+                std::string engine = argv[++i];
+                if (engine == "tiered") {
+                    options.engine = myndra::ExecutionEngine::TIERED;
+                } else if (engine == "interpreter") {
+                    options.engine = myndra::ExecutionEngine::INTERPRETER;
+                } else if (engine == "vm") {
+                    options.engine = myndra::ExecutionEngine::BYTECODE_VM;
+                } else {
+                    std::cerr << "Error: Unknown engine '" << engine << "' (expected tiered, interpreter or vm)\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --engine requires an argument\n";
+                return 1;
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                options.module_cache_dir = argv[++i];
+            } else {
+                std::cerr << "Error: --cache-dir requires an argument\n";
+                return 1;
+            }
+        } else if (arg == "--cache-report") {
+            options.report_module_cache = true;
+        } else if (arg == "--no-jit") {
+            options.jit_threshold = 0;
+        } else if (arg == "--trace-tiering") {
+            options.trace_tiering = true;
+        } else if (arg == "--emit" || arg.rfind("--emit=", 0) == 0) {
+            if (arg == "--emit") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --emit requires an argument\n";
+                    return 1;
+                }
+                emit = argv[++i];
+            } else {
+                emit = arg.substr(7);
+            }
+            if (emit != "obj" && emit != "exe") {
+                std::cerr << "Error: Unknown output '" << emit << "' (expected obj or exe)\n";
+                return 1;
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 < argc) {
+                output_path = argv[++i];
+            } else {
+                std::cerr << "Error: --output requires an argument\n";
+                return 1;
+            }
         } else if (arg == "--no-live-reload") {
             options.enable_live_reload = false;
         } else if (arg == "--no-reactive") {
@@ -154,6 +230,8 @@ int main(int argc, char* argv[]) {
     }
     
     try {
+        // A script is the whole program; the REPL keeps adding to it
+        options.whole_program = !interactive;
         myndra::Compiler compiler(options);
         
         if (interactive) {
@@ -175,6 +253,28 @@ int main(int argc, char* argv[]) {
         }
         file.close();
         
+        if (!emit.empty()) {
+            // Defaults to the input's name without the .myn extension
+            if (output_path.empty()) {
+                output_path = filename;
+                if (output_path.size() > 4 && output_path.compare(output_path.size() - 4, 4, ".myn") == 0) {
+                    output_path.resize(output_path.size() - 4);
+                }
+                if (emit == "obj") {
+                    output_path += ".o";
+                }
+            }
+            auto kind = emit == "obj" ? myndra::NativeOutput::OBJECT : myndra::NativeOutput::EXECUTABLE;
+            if (!compiler.emit_native(filename, kind, output_path)) {
+                std::cerr << "Compilation failed:\n";
+                for (const auto& error : compiler.get_errors()) {
+                    std::cerr << "  " << error << "\n";
+                }
+                return 1;
+            }
+            return 0;
+        }
+        
         std::cout << "Compiling " << filename << " with context '" 
                   << options.target_context << "'...\n";
         
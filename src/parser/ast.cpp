@@ -1,236 +1,634 @@
 #include "ast.h"
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace myndra {
 
-// IntegerLiteral
-void IntegerLiteral::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+// AstBuilder
+void AstBuilder::checkIndex(size_t index) {
+    if (index > NodeRef::kMaxIndex) {
+        throw std::runtime_error("Program has too many nodes");
+    }
 }
 
-// FloatLiteral
-void FloatLiteral::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+NodeList AstBuilder::addList(std::span<const NodeRef> nodes) {
+    NodeList list{static_cast<uint32_t>(refs_.size()), static_cast<uint32_t>(nodes.size())};
+    refs_.insert(refs_.end(), nodes.begin(), nodes.end());
+    return list;
 }
 
-// StringLiteral
-void StringLiteral::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+ParameterList AstBuilder::addParameters(std::span<const Parameter> parameters) {
+    ParameterList list{static_cast<uint32_t>(parameters_.size()), static_cast<uint32_t>(parameters.size())};
+    parameters_.insert(parameters_.end(), parameters.begin(), parameters.end());
+    return list;
 }
 
-// BooleanLiteral
-void BooleanLiteral::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+StringRef AstBuilder::addString(std::string_view text) {
+    StringRef ref{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(text.size())};
+    strings_.append(text);
+    return ref;
 }
 
-// Identifier
-void Identifier::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
-}
+namespace {
 
-// BinaryExpression
-void BinaryExpression::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+size_t alignUp(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
 }
 
-std::string BinaryExpression::to_string() const {
-    return "(" + left->to_string() + " " + operator_to_string(op) + " " + right->to_string() + ")";
+// Reserves room for `items` in the block layout and returns its offset
+template <typename T>
+size_t layout(size_t& size, const std::vector<T>& items) {
+    size_t offset = alignUp(size, alignof(T));
+    size = offset + items.size() * sizeof(T);
+    return offset;
 }
 
-std::string BinaryExpression::operator_to_string(BinaryOperator op) const {
-    switch (op) {
-        case BinaryOperator::Add: return "+";
-        case BinaryOperator::Sub: return "-";
-        case BinaryOperator::Mul: return "*";
-        case BinaryOperator::Div: return "/";
-        case BinaryOperator::Mod: return "%";
-        case BinaryOperator::Eq: return "==";
-        case BinaryOperator::Ne: return "!=";
-        case BinaryOperator::Lt: return "<";
-        case BinaryOperator::Le: return "<=";
-        case BinaryOperator::Gt: return ">";
-        case BinaryOperator::Ge: return ">=";
-        case BinaryOperator::And: return "and";
-        case BinaryOperator::Or: return "or";
-        case BinaryOperator::Assign: return "=";
-        default: return "<?>";
-    }
-}
+// Calls `visit` on every Atom field of a node
+template <typename T, typename F>
+void forEachAtom(T&, F&&) {}
 
-// UnaryExpression
-void UnaryExpression::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
-}
+template <typename F>
+void forEachAtom(Identifier& node, F&& visit) { visit(node.name); }
 
-std::string UnaryExpression::to_string() const {
-    return "(" + operator_to_string(op) + operand->to_string() + ")";
-}
+template <typename F>
+void forEachAtom(MemberAccess& node, F&& visit) { visit(node.member); }
 
-std::string UnaryExpression::operator_to_string(UnaryOperator op) const {
-    switch (op) {
-        case UnaryOperator::Not: return "not ";
-        case UnaryOperator::Neg: return "-";
-        case UnaryOperator::Plus: return "+";
-        default: return "<?>";
-    }
-}
+template <typename F>
+void forEachAtom(ObjectProperty& node, F&& visit) { visit(node.key); }
 
-// FunctionCall
-void FunctionCall::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename F>
+void forEachAtom(VariableDeclaration& node, F&& visit) {
+    visit(node.name);
+    visit(node.type);
 }
 
-std::string FunctionCall::to_string() const {
-    std::ostringstream oss;
-    oss << function->to_string() << "(";
-    for (size_t i = 0; i < arguments.size(); ++i) {
-        if (i > 0) oss << ", ";
-        oss << arguments[i]->to_string();
-    }
-    oss << ")";
-    return oss.str();
+template <typename F>
+void forEachAtom(Parameter& node, F&& visit) {
+    visit(node.name);
+    visit(node.type);
 }
 
-// ArrayAccess
-void ArrayAccess::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename F>
+void forEachAtom(FunctionDefinition& node, F&& visit) {
+    visit(node.name);
+    visit(node.return_type);
 }
 
-std::string ArrayAccess::to_string() const {
-    return array->to_string() + "[" + index->to_string() + "]";
-}
+template <typename F>
+void forEachAtom(ForStatement& node, F&& visit) { visit(node.variable); }
 
-// MemberAccess
-void MemberAccess::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
-}
+// Calls `visit` on every reference a node holds into the block: child
+// NodeRefs and lists (with the kind the passes assume, where they assume
+// one), parameter lists, string table ranges and function indexes
+template <typename T, typename V>
+void forEachReference(const T&, V&) {}
+
+template <typename V>
+void forEachReference(const StringLiteral& node, V& visit) { visit(node.value); }
 
-std::string MemberAccess::to_string() const {
-    return object->to_string() + "." + member;
+template <typename V>
+void forEachReference(const BinaryExpression& node, V& visit) {
+    visit(node.left);
+    visit(node.right);
 }
 
-// ContextConditional
-void ContextConditional::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename V>
+void forEachReference(const UnaryExpression& node, V& visit) { visit(node.operand); }
+
+template <typename V>
+void forEachReference(const FunctionCall& node, V& visit) {
+    visit(node.function);
+    visit(node.arguments);
 }
 
-std::string ContextConditional::to_string() const {
-    return expression->to_string() + " if context == \"" + context + "\"";
+template <typename V>
+void forEachReference(const ArrayAccess& node, V& visit) {
+    visit(node.array);
+    visit(node.index);
 }
 
-// ExpressionStatement
-void ExpressionStatement::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename V>
+void forEachReference(const MemberAccess& node, V& visit) { visit(node.object); }
+
+template <typename V>
+void forEachReference(const ContextConditional& node, V& visit) {
+    visit(node.expression);
+    visit(node.context);
+    visit.function(node.function);
 }
 
-std::string ExpressionStatement::to_string() const {
-    return expression->to_string();
+template <typename V>
+void forEachReference(const ArrayLiteral& node, V& visit) { visit(node.elements); }
+
+template <typename V>
+void forEachReference(const ObjectLiteral& node, V& visit) { visit(node.properties, NodeKind::ObjectProperty); }
+
+template <typename V>
+void forEachReference(const ObjectProperty& node, V& visit) { visit(node.value); }
+
+template <typename V>
+void forEachReference(const ExpressionStatement& node, V& visit) { visit(node.expression); }
+
+template <typename V>
+void forEachReference(const VariableDeclaration& node, V& visit) { visit(node.initializer); }
+
+template <typename V>
+void forEachReference(const Block& node, V& visit) { visit(node.statements); }
+
+template <typename V>
+void forEachReference(const FunctionDefinition& node, V& visit) {
+    visit(node.parameters);
+    visit(node.body, NodeKind::Block);
 }
 
-// VariableDeclaration
-void VariableDeclaration::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename V>
+void forEachReference(const ReturnStatement& node, V& visit) { visit(node.value); }
+
+template <typename V>
+void forEachReference(const IfStatement& node, V& visit) {
+    visit(node.condition);
+    visit(node.then_branch);
+    visit(node.else_branch);
 }
 
-std::string VariableDeclaration::to_string() const {
-    std::ostringstream oss;
-    oss << "let ";
-    if (is_mutable) oss << "mut ";
-    oss << name;
-    if (!type.empty()) oss << ": " << type;
-    if (initializer) oss << " = " << initializer->to_string();
-    return oss.str();
+template <typename V>
+void forEachReference(const WhileStatement& node, V& visit) {
+    visit(node.condition);
+    visit(node.body);
 }
 
-// Block
-void Block::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+template <typename V>
+void forEachReference(const ForStatement& node, V& visit) {
+    visit(node.start);
+    visit(node.end);
+    visit(node.body);
 }
 
-std::string Block::to_string() const {
-    std::ostringstream oss;
-    oss << "{\n";
-    for (const auto& stmt : statements) {
-        oss << "  " << stmt->to_string() << "\n";
+// Checks references against the section sizes in a block's header
+struct BoundsCheck {
+    const ProgramLayout& header;
+    const NodeRef* refs;
+    bool valid = true;
+
+    bool fits(NodeRef ref) const {
+        return ref.isNull() || (ref.kind() < NodeKind::COUNT && ref.index() < header.counts[static_cast<size_t>(ref.kind())]);
     }
-    oss << "}";
-    return oss.str();
-}
+    void operator()(NodeRef ref) { valid = valid && fits(ref); }
+    void operator()(NodeRef ref, NodeKind kind) { valid = valid && ref && ref.kind() == kind && fits(ref); }
+    void operator()(NodeList list) { valid = valid && uint64_t(list.begin) + list.count <= header.refCount; }
+    void operator()(NodeList list, NodeKind kind) {
+        (*this)(list);
+        for (uint32_t i = 0; valid && i < list.count; ++i) {
+            (*this)(refs[list.begin + i], kind);
+        }
+    }
+    void operator()(ParameterList list) { valid = valid && uint64_t(list.begin) + list.count <= header.parameterCount; }
+    void operator()(StringRef ref) { valid = valid && uint64_t(ref.offset) + ref.length <= header.stringBytes; }
+    void function(uint32_t index) {
+        valid = valid && (index == ContextConditional::kTopLevel ||
+                          index < header.counts[static_cast<size_t>(NodeKind::FunctionDefinition)]);
+    }
+};
 
-// FunctionDefinition
-void FunctionDefinition::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
-}
+// Gathers the non-null children of a node, already bounds checked
+struct ChildList {
+    const NodeRef* refs;
+    std::vector<NodeRef>& children;
 
-std::string FunctionDefinition::to_string() const {
-    std::ostringstream oss;
-    oss << "fn " << name << "(";
-    for (size_t i = 0; i < parameters.size(); ++i) {
-        if (i > 0) oss << ", ";
-        oss << parameters[i].name << ": " << parameters[i].type;
-    }
-    oss << ")";
-    if (!return_type.empty()) oss << " -> " << return_type;
-    oss << " " << body->to_string();
-    return oss.str();
+    void operator()(NodeRef ref, NodeKind = NodeKind::COUNT) {
+        if (ref) {
+            children.push_back(ref);
+        }
+    }
+    void operator()(NodeList list, NodeKind kind = NodeKind::COUNT) {
+        for (uint32_t i = 0; i < list.count; ++i) {
+            (*this)(refs[list.begin + i], kind);
+        }
+    }
+    void operator()(ParameterList) {}
+    void operator()(StringRef) {}
+    void function(uint32_t) {}
+};
+
+} // namespace
+
+std::vector<AtomEntry> AstBuilder::collectAtoms() {
+    std::vector<AtomEntry> atoms;
+    std::unordered_set<uint32_t> seen;
+    auto collect = [&](Atom& atom) {
+        if (!atom.empty() && seen.insert(atom.id()).second) {
+            atoms.push_back({atom.id(), addString(atom.text())});
+        }
+    };
+    std::apply([&](auto&... pool) {
+        ((std::for_each(pool.begin(), pool.end(), [&](auto& node) { forEachAtom(node, collect); })), ...);
+    }, pools_);
+    for (Parameter& parameter : parameters_) {
+        forEachAtom(parameter, collect);
+    }
+    return atoms;
+}
+
+std::unique_ptr<Program> AstBuilder::finish(NodeList statements) {
+    std::vector<AtomEntry> atoms = collectAtoms();
+
+    // Lay out the header, every pool, then the lists, atoms and strings, in one block
+    ProgramLayout header;
+    size_t size = sizeof(ProgramLayout);
+    std::apply([&](const auto&... pool) {
+        ((header.poolOffsets[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)] = layout(size, pool)), ...);
+        ((header.counts[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)] =
+              static_cast<uint32_t>(pool.size())), ...);
+    }, pools_);
+    header.refsOffset = layout(size, refs_);
+    header.parametersOffset = layout(size, parameters_);
+    header.atomsOffset = layout(size, atoms);
+    header.stringsOffset = size;
+    size += strings_.size();
+    header.size = size;
+    header.refCount = static_cast<uint32_t>(refs_.size());
+    header.parameterCount = static_cast<uint32_t>(parameters_.size());
+    header.atomCount = static_cast<uint32_t>(atoms.size());
+    header.stringBytes = strings_.size();
+    header.statements = statements;
+
+    // Zeroed so padding is deterministic when the block is written out. An
+    // empty vector's data() may be null, which memcpy must never see.
+    unsigned char* block = new unsigned char[size]();
+    auto copy = [block](uint64_t offset, const void* source, size_t bytes) {
+        if (bytes) {
+            std::memcpy(block + offset, source, bytes);
+        }
+    };
+    copy(0, &header, sizeof(header));
+    std::apply([&](auto&... pool) {
+        (copy(header.poolOffsets[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)],
+              pool.data(), pool.size() * sizeof(pool[0])), ...);
+    }, pools_);
+    copy(header.refsOffset, refs_.data(), refs_.size() * sizeof(NodeRef));
+    copy(header.parametersOffset, parameters_.data(), parameters_.size() * sizeof(Parameter));
+    copy(header.atomsOffset, atoms.data(), atoms.size() * sizeof(AtomEntry));
+    copy(header.stringsOffset, strings_.data(), strings_.size());
+
+    std::unique_ptr<Program> program(new Program());
+    program->block_ = std::unique_ptr<unsigned char[], Program::BlockDeleter>(block, Program::BlockDeleter{nullptr, 0});
+    program->size_ = size;
+    program->attach();
+
+    *this = AstBuilder();
+    return program;
 }
 
-// ReturnStatement
-void ReturnStatement::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+// Program
+void Program::BlockDeleter::operator()(unsigned char* block) const {
+    if (release) {
+        release(block, size);
+    } else {
+        delete[] block;
+    }
 }
 
-std::string ReturnStatement::to_string() const {
-    if (value) {
-        return "return " + value->to_string();
-    } else {
-        return "return";
+std::unique_ptr<Program> Program::adopt(unsigned char* block, size_t size, ReleaseFn release) {
+    std::unique_ptr<Program> program(new Program());
+    program->block_ = std::unique_ptr<unsigned char[], BlockDeleter>(block, BlockDeleter{release, size});
+    program->size_ = size;
+
+    // Every section must lie inside the block, and every reference in the
+    // nodes inside its section (see validate())
+    ProgramLayout header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Corrupt program block");
+    }
+    std::memcpy(&header, block, sizeof(header));
+    auto fits = [size](uint64_t offset, uint64_t bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+    bool valid = header.size == size && fits(header.refsOffset, uint64_t(header.refCount) * sizeof(NodeRef)) &&
+                 fits(header.parametersOffset, uint64_t(header.parameterCount) * sizeof(Parameter)) &&
+                 fits(header.atomsOffset, uint64_t(header.atomCount) * sizeof(AtomEntry)) &&
+                 fits(header.stringsOffset, header.stringBytes) &&
+                 uint64_t(header.statements.begin) + header.statements.count <= header.refCount;
+    std::apply([&](const auto&... pool) {
+        ((valid = valid && fits(header.poolOffsets[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)],
+                                uint64_t(header.counts[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)]) *
+                                    sizeof(typename std::decay_t<decltype(pool)>::value_type))), ...);
+    }, AstBuilder::Pools());
+    if (!valid) {
+        throw std::runtime_error("Corrupt program block");
     }
+
+    program->attach();
+    program->validate(header);
+    program->remapAtoms(header);
+    return program;
 }
 
-// IfStatement
-void IfStatement::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+void Program::validate(const ProgramLayout& header) const {
+    auto corrupt = [] { throw std::runtime_error("Corrupt program block"); };
+    BoundsCheck bounds{header, refs_};
+    for (uint32_t i = 0; i < header.refCount; ++i) {
+        bounds(refs_[i]);
+    }
+    bounds(statements_);
+    auto eachNode = [&](auto&& visit) {
+        std::apply([&](const auto&... pool) {
+            ([&] {
+                using T = typename std::decay_t<decltype(pool)>::value_type;
+                const T* nodes = static_cast<const T*>(pools_[static_cast<size_t>(T::kKind)]);
+                for (uint32_t i = 0; i < counts_[static_cast<size_t>(T::kKind)]; ++i) {
+                    visit(nodes[i]);
+                }
+            }(), ...);
+        }, AstBuilder::Pools());
+    };
+    eachNode([&](const auto& node) { forEachReference(node, bounds); });
+    if (!bounds.valid) {
+        corrupt();
+    }
+
+    // The passes recurse through children, so the nodes must also form a
+    // DAG; a depth-first walk from every node looks for a back edge
+    enum : uint8_t { kNew, kOpen, kDone };
+    std::array<std::vector<uint8_t>, static_cast<size_t>(NodeKind::COUNT)> state;
+    for (size_t kind = 0; kind < state.size(); ++kind) {
+        state[kind].assign(counts_[kind], kNew);
+    }
+    auto stateOf = [&](NodeRef ref) -> uint8_t& { return state[static_cast<size_t>(ref.kind())][ref.index()]; };
+    std::vector<NodeRef> stack;
+    std::vector<NodeRef> children;
+    ChildList childList{refs_, children};
+    auto collect = [&](NodeRef ref) {
+        std::apply([&](const auto&... pool) {
+            ([&] {
+                using T = typename std::decay_t<decltype(pool)>::value_type;
+                if (ref.kind() == T::kKind) {
+                    forEachReference(node<T>(ref), childList);
+                }
+            }(), ...);
+        }, AstBuilder::Pools());
+    };
+    for (size_t kind = 0; kind < state.size(); ++kind) {
+        for (uint32_t index = 0; index < counts_[kind]; ++index) {
+            stack.push_back(NodeRef(static_cast<NodeKind>(kind), index));
+            while (!stack.empty()) {
+                NodeRef ref = stack.back();
+                uint8_t& current = stateOf(ref);
+                if (current != kNew) {
+                    current = kDone;
+                    stack.pop_back();
+                    continue;
+                }
+                current = kOpen;
+                children.clear();
+                collect(ref);
+                for (NodeRef child : children) {
+                    uint8_t seen = stateOf(child);
+                    if (seen == kOpen) {
+                        corrupt();
+                    }
+                    if (seen == kNew) {
+                        stack.push_back(child);
+                    }
+                }
+            }
+        }
+    }
 }
 
-std::string IfStatement::to_string() const {
-    std::ostringstream oss;
-    oss << "if " << condition->to_string() << " " << then_branch->to_string();
-    if (else_branch) {
-        oss << " else " << else_branch->to_string();
+void Program::remapAtoms(const ProgramLayout& header) {
+    const auto* entries = reinterpret_cast<const AtomEntry*>(block_.get() + header.atomsOffset);
+    std::unordered_map<uint32_t, Atom> atoms;
+    bool renumbered = false;
+    for (uint32_t i = 0; i < header.atomCount; ++i) {
+        StringRef ref = entries[i].text;
+        if (ref.offset > header.stringBytes || ref.length > header.stringBytes - ref.offset) {
+            throw std::runtime_error("Corrupt program block");
+        }
+        Atom atom = Atom::intern(text(ref));
+        renumbered = renumbered || atom.id() != entries[i].id;
+        atoms.emplace(entries[i].id, atom);
+    }
+
+    // Every atom in the nodes must be in the table, even when the ids stay;
+    // only a renumbering writes, so unchanged pages stay shared
+    auto remap = [&](Atom& atom) {
+        if (atom.empty()) {
+            return;
+        }
+        auto found = atoms.find(atom.id());
+        if (found == atoms.end()) {
+            throw std::runtime_error("Corrupt program block");
+        }
+        if (renumbered) {
+            atom = found->second;
+        }
+    };
+    std::apply([&](const auto&... pool) {
+        ((std::for_each(static_cast<typename std::decay_t<decltype(pool)>::value_type*>(
+                            pools_[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)]),
+                        static_cast<typename std::decay_t<decltype(pool)>::value_type*>(
+                            pools_[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)]) +
+                            counts_[static_cast<size_t>(std::decay_t<decltype(pool)>::value_type::kKind)],
+                        [&](auto& node) { forEachAtom(node, remap); })), ...);
+    }, AstBuilder::Pools());
+    // The block is writable; only the accessors are const
+    auto* parameters = const_cast<Parameter*>(parameters_);
+    for (uint32_t i = 0; i < header.parameterCount; ++i) {
+        forEachAtom(parameters[i], remap);
     }
-    return oss.str();
 }
 
-// WhileStatement
-void WhileStatement::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+void Program::attach() {
+    unsigned char* block = block_.get();
+    const auto& header = *reinterpret_cast<const ProgramLayout*>(block);
+    for (size_t kind = 0; kind < pools_.size(); ++kind) {
+        pools_[kind] = block + header.poolOffsets[kind];
+        counts_[kind] = header.counts[kind];
+    }
+    refs_ = reinterpret_cast<const NodeRef*>(block + header.refsOffset);
+    parameters_ = reinterpret_cast<const Parameter*>(block + header.parametersOffset);
+    strings_ = reinterpret_cast<const char*>(block + header.stringsOffset);
+    statements_ = header.statements;
 }
 
-std::string WhileStatement::to_string() const {
-    return "while " + condition->to_string() + " " + body->to_string();
+size_t Program::nodeCount() const {
+    size_t total = 0;
+    for (uint32_t count : counts_) {
+        total += count;
+    }
+    return total;
 }
 
-// ForStatement
-void ForStatement::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+const char* binaryOperatorText(BinaryOperator op) {
+    switch (op) {
+        case BinaryOperator::Add: return "+";
+        case BinaryOperator::Sub: return "-";
+        case BinaryOperator::Mul: return "*";
+        case BinaryOperator::Div: return "/";
+        case BinaryOperator::Mod: return "%";
+        case BinaryOperator::Eq: return "==";
+        case BinaryOperator::Ne: return "!=";
+        case BinaryOperator::Lt: return "<";
+        case BinaryOperator::Le: return "<=";
+        case BinaryOperator::Gt: return ">";
+        case BinaryOperator::Ge: return ">=";
+        case BinaryOperator::And: return "and";
+        case BinaryOperator::Or: return "or";
+        case BinaryOperator::Assign: return "=";
+        default: return "<?>";
+    }
 }
 
-std::string ForStatement::to_string() const {
-    return "for " + variable + " in " + start->to_string() + ".." + end->to_string() + " " + body->to_string();
+const char* unaryOperatorText(UnaryOperator op) {
+    switch (op) {
+        case UnaryOperator::Not: return "not ";
+        case UnaryOperator::Neg: return "-";
+        case UnaryOperator::Plus: return "+";
+        default: return "<?>";
+    }
 }
 
-// Program
-void Program::accept(ASTVisitor& visitor) {
-    visitor.visit(*this);
+std::string Program::to_string(NodeRef ref) const {
+    if (ref.isNull()) {
+        return "<error>";
+    }
+
+    std::ostringstream oss;
+    switch (ref.kind()) {
+        case NodeKind::IntegerLiteral:
+            return std::to_string(node<IntegerLiteral>(ref).value);
+        case NodeKind::FloatLiteral:
+            return std::to_string(node<FloatLiteral>(ref).value);
+        case NodeKind::StringLiteral:
+            return "\"" + std::string(text(node<StringLiteral>(ref).value)) + "\"";
+        case NodeKind::BooleanLiteral:
+            return node<BooleanLiteral>(ref).value ? "true" : "false";
+        case NodeKind::Identifier:
+            return std::string(text(node<Identifier>(ref).name));
+        case NodeKind::BinaryExpression: {
+            const auto& binary = node<BinaryExpression>(ref);
+            return "(" + to_string(binary.left) + " " + binaryOperatorText(binary.op) + " " +
+                   to_string(binary.right) + ")";
+        }
+        case NodeKind::UnaryExpression: {
+            const auto& unary = node<UnaryExpression>(ref);
+            return "(" + std::string(unaryOperatorText(unary.op)) + to_string(unary.operand) + ")";
+        }
+        case NodeKind::FunctionCall: {
+            const auto& call = node<FunctionCall>(ref);
+            oss << to_string(call.function) << "(";
+            auto arguments = list(call.arguments);
+            for (size_t i = 0; i < arguments.size(); ++i) {
+                if (i > 0) oss << ", ";
+                oss << to_string(arguments[i]);
+            }
+            oss << ")";
+            return oss.str();
+        }
+        case NodeKind::ArrayAccess: {
+            const auto& access = node<ArrayAccess>(ref);
+            return to_string(access.array) + "[" + to_string(access.index) + "]";
+        }
+        case NodeKind::MemberAccess: {
+            const auto& access = node<MemberAccess>(ref);
+            return to_string(access.object) + "." + std::string(text(access.member));
+        }
+        case NodeKind::ContextConditional: {
+            const auto& conditional = node<ContextConditional>(ref);
+            return to_string(conditional.expression) + " if context == \"" +
+                   std::string(text(conditional.context)) + "\"";
+        }
+        case NodeKind::ArrayLiteral: {
+            oss << "[";
+            auto elements = list(node<ArrayLiteral>(ref).elements);
+            for (size_t i = 0; i < elements.size(); ++i) {
+                if (i > 0) oss << ", ";
+                oss << to_string(elements[i]);
+            }
+            oss << "]";
+            return oss.str();
+        }
+        case NodeKind::ObjectLiteral: {
+            oss << "{";
+            auto properties = list(node<ObjectLiteral>(ref).properties);
+            for (size_t i = 0; i < properties.size(); ++i) {
+                oss << (i > 0 ? ", " : " ") << to_string(properties[i]);
+            }
+            oss << (properties.empty() ? "}" : " }");
+            return oss.str();
+        }
+        case NodeKind::ObjectProperty: {
+            const auto& property = node<ObjectProperty>(ref);
+            return std::string(text(property.key)) + ": " + to_string(property.value);
+        }
+        case NodeKind::ExpressionStatement:
+            return to_string(node<ExpressionStatement>(ref).expression);
+        case NodeKind::VariableDeclaration: {
+            const auto& declaration = node<VariableDeclaration>(ref);
+            oss << "let ";
+            if (declaration.is_mutable) oss << "mut ";
+            oss << text(declaration.name);
+            if (!declaration.type.empty()) oss << ": " << text(declaration.type);
+            if (declaration.initializer) oss << " = " << to_string(declaration.initializer);
+            return oss.str();
+        }
+        case NodeKind::Block: {
+            oss << "{\n";
+            for (NodeRef stmt : list(node<Block>(ref).statements)) {
+                oss << "  " << to_string(stmt) << "\n";
+            }
+            oss << "}";
+            return oss.str();
+        }
+        case NodeKind::FunctionDefinition: {
+            const auto& function = node<FunctionDefinition>(ref);
+            oss << "fn " << text(function.name) << "(";
+            auto params = parameters(function.parameters);
+            for (size_t i = 0; i < params.size(); ++i) {
+                if (i > 0) oss << ", ";
+                oss << text(params[i].name) << ": " << text(params[i].type);
+            }
+            oss << ")";
+            if (!function.return_type.empty()) oss << " -> " << text(function.return_type);
+            oss << " " << to_string(function.body);
+            return oss.str();
+        }
+        case NodeKind::ReturnStatement: {
+            const auto& ret = node<ReturnStatement>(ref);
+            return ret.value ? "return " + to_string(ret.value) : "return";
+        }
+        case NodeKind::IfStatement: {
+            const auto& stmt = node<IfStatement>(ref);
+            oss << "if " << to_string(stmt.condition) << " " << to_string(stmt.then_branch);
+            if (stmt.else_branch) {
+                oss << " else " << to_string(stmt.else_branch);
+            }
+            return oss.str();
+        }
+        case NodeKind::WhileStatement: {
+            const auto& stmt = node<WhileStatement>(ref);
+            return "while " + to_string(stmt.condition) + " " + to_string(stmt.body);
+        }
+        case NodeKind::ForStatement: {
+            const auto& stmt = node<ForStatement>(ref);
+            return "for " + std::string(text(stmt.variable)) + " in " + to_string(stmt.start) + ".." +
+                   to_string(stmt.end) + " " + to_string(stmt.body);
+        }
+        default:
+            return "<?>";
+    }
 }
 
 std::string Program::to_string() const {
     std::ostringstream oss;
-    for (const auto& stmt : statements) {
-        oss << stmt->to_string() << "\n";
+    for (NodeRef stmt : statements()) {
+        oss << to_string(stmt) << "\n";
     }
     return oss.str();
 }
 
-} // namespace myndra
\ No newline at end of file
+} // namespace myndra
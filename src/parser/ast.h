@@ -1,355 +1,490 @@
 #ifndef MYNDRA_AST_H
 #define MYNDRA_AST_H
 
+#include "../lexer/atom.h"
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <vector>
+#include <span>
 #include <string>
-#include <variant>
-#include "../lexer/token.h"
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace myndra {
 
-// Forward declarations
-class ASTVisitor;
+// Flat AST.
+//
+// Nodes are plain structs kept in one pool per node kind and addressed by
+// 32-bit NodeRefs instead of owning pointers. The parser appends to growable
+// pools through an AstBuilder; finishing the program packs every pool, the
+// child lists and the string bytes into a single allocation owned by the
+// Program, so walking a program touches a few dense arrays and freeing it
+// is one deallocation. Passes switch on NodeRef::kind() and index the pools
+// directly.
+
+// Names (identifiers, members, type annotations) are Atoms, so passes
+// compare and hash them as integers; only literal text is in the table.
+
+// Lexical address of a variable, filled in by the Resolver.
+// `depth` counts frames outward from the current one; globals use kGlobal
+// so they are reached directly instead of by walking frames.
+struct SlotAddress {
+    static constexpr uint16_t kUnresolved = 0xFFFF;
+    static constexpr uint16_t kGlobal = 0xFFFE;
+
+    uint16_t depth = kUnresolved;
+    uint32_t slot = 0;
+
+    bool isResolved() const { return depth != kUnresolved; }
+    bool isGlobal() const { return depth == kGlobal; }
+};
 
-// Base AST node class
-class ASTNode {
-public:
-    virtual ~ASTNode() = default;
-    virtual void accept(ASTVisitor& visitor) = 0;
-    virtual std::string to_string() const = 0;
-    
-    // Source location information
-    size_t line = 0;
-    size_t column = 0;
+enum class NodeKind : uint8_t {
+    // Expressions
+    IntegerLiteral,
+    FloatLiteral,
+    StringLiteral,
+    BooleanLiteral,
+    Identifier,
+    BinaryExpression,
+    UnaryExpression,
+    FunctionCall,
+    ArrayAccess,
+    MemberAccess,
+    ContextConditional,
+    ArrayLiteral,
+    ObjectLiteral,
+    ObjectProperty,
+
+    // Statements
+    ExpressionStatement,
+    VariableDeclaration,
+    Block,
+    FunctionDefinition,
+    ReturnStatement,
+    IfStatement,
+    WhileStatement,
+    ForStatement,
+
+    COUNT
 };
 
-// Expression nodes
-class Expression : public ASTNode {
+// Handle to a node: its kind in the top 5 bits, its index in that kind's
+// pool in the low 27. The default value is the null reference.
+class NodeRef {
 public:
-    virtual ~Expression() = default;
+    static constexpr uint32_t kIndexBits = 27;
+    static constexpr uint32_t kMaxIndex = (uint32_t(1) << kIndexBits) - 2;
+
+    NodeRef() : bits_(UINT32_MAX) {}
+    NodeRef(NodeKind kind, uint32_t index)
+        : bits_((static_cast<uint32_t>(kind) << kIndexBits) | index) {}
+
+    NodeKind kind() const { return static_cast<NodeKind>(bits_ >> kIndexBits); }
+    uint32_t index() const { return bits_ & ((uint32_t(1) << kIndexBits) - 1); }
+    bool isNull() const { return bits_ == UINT32_MAX; }
+    explicit operator bool() const { return !isNull(); }
+
+    bool operator==(const NodeRef& other) const { return bits_ == other.bits_; }
+    bool operator!=(const NodeRef& other) const { return bits_ != other.bits_; }
+
+private:
+    uint32_t bits_;
 };
 
-class Statement : public ASTNode {
-public:
-    virtual ~Statement() = default;
+static_assert(static_cast<uint32_t>(NodeKind::COUNT) < 32, "node kinds must fit in 5 bits");
+
+// Bytes [offset, offset + length) of the program's string table
+struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+
+    bool empty() const { return length == 0; }
+};
+
+// Run of child NodeRefs (statements, call arguments)
+struct NodeList {
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+// Run of function parameters
+struct ParameterList {
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+// Binary operations
+enum class BinaryOperator : uint8_t {
+    Add, Sub, Mul, Div, Mod,           // Arithmetic
+    Eq, Ne, Lt, Le, Gt, Ge,            // Comparison
+    And, Or,                           // Logical
+    Assign                             // Assignment
+};
+
+// Unary operations
+enum class UnaryOperator : uint8_t {
+    Not, Neg, Plus
 };
 
 // Literal expressions
-class IntegerLiteral : public Expression {
-public:
+struct IntegerLiteral {
+    static constexpr NodeKind kKind = NodeKind::IntegerLiteral;
     int64_t value;
-    
-    explicit IntegerLiteral(int64_t val) : value(val) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override {
-        return std::to_string(value);
-    }
 };
 
-class FloatLiteral : public Expression {
-public:
+struct FloatLiteral {
+    static constexpr NodeKind kKind = NodeKind::FloatLiteral;
     double value;
-    
-    explicit FloatLiteral(double val) : value(val) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override {
-        return std::to_string(value);
-    }
 };
 
-class StringLiteral : public Expression {
-public:
-    std::string value;
-    
-    explicit StringLiteral(std::string val) : value(std::move(val)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override {
-        return "\"" + value + "\"";
-    }
+struct StringLiteral {
+    static constexpr NodeKind kKind = NodeKind::StringLiteral;
+    StringRef value;  // Escapes already decoded
 };
 
-class BooleanLiteral : public Expression {
-public:
+struct BooleanLiteral {
+    static constexpr NodeKind kKind = NodeKind::BooleanLiteral;
     bool value;
-    
-    explicit BooleanLiteral(bool val) : value(val) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override {
-        return value ? "true" : "false";
-    }
 };
 
-class Identifier : public Expression {
-public:
-    std::string name;
-    
-    explicit Identifier(std::string n) : name(std::move(n)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override {
-        return name;
-    }
+struct Identifier {
+    static constexpr NodeKind kKind = NodeKind::Identifier;
+    Atom name;
+    SlotAddress address{};  // Set by the Resolver
 };
 
-// Binary operations
-enum class BinaryOperator {
-    Add, Sub, Mul, Div, Mod,           // Arithmetic
-    Eq, Ne, Lt, Le, Gt, Ge,            // Comparison
-    And, Or,                           // Logical
-    Assign                             // Assignment
+// Type of a value, as far as it is known before running the code
+enum class ValueType : uint8_t { Unknown, Int, Float, Bool, String };
+
+// Operand types a binary expression has seen, recorded by the interpreter
+// so later evaluations can skip the generic type dispatch
+enum class BinaryFeedback : uint8_t {
+    Uninitialized,  // Not evaluated yet
+    SmallInts,
+    Doubles,
+    Strings,
+    Generic,        // Mixed types, or a specialization failed; final
+    ProvenDoubles   // The TypeChecker proved both doubles; unguarded, final
 };
 
-class BinaryExpression : public Expression {
-public:
-    std::unique_ptr<Expression> left;
+struct BinaryExpression {
+    static constexpr NodeKind kKind = NodeKind::BinaryExpression;
+    NodeRef left;
+    NodeRef right;
     BinaryOperator op;
-    std::unique_ptr<Expression> right;
-    
-    BinaryExpression(std::unique_ptr<Expression> l, BinaryOperator o, std::unique_ptr<Expression> r)
-        : left(std::move(l)), op(o), right(std::move(r)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
-    
-private:
-    std::string operator_to_string(BinaryOperator op) const;
-};
-
-// Unary operations
-enum class UnaryOperator {
-    Not, Neg, Plus
+    BinaryFeedback feedback = BinaryFeedback::Uninitialized;  // Set by the Interpreter
+    ValueType operands = ValueType::Unknown;  // Int or Float if the TypeChecker proved both are (arithmetic and comparisons only)
 };
 
-class UnaryExpression : public Expression {
-public:
+struct UnaryExpression {
+    static constexpr NodeKind kKind = NodeKind::UnaryExpression;
+    NodeRef operand;
     UnaryOperator op;
-    std::unique_ptr<Expression> operand;
-    
-    UnaryExpression(UnaryOperator o, std::unique_ptr<Expression> expr)
-        : op(o), operand(std::move(expr)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
-    
-private:
-    std::string operator_to_string(UnaryOperator op) const;
 };
 
 // Function call
-class FunctionCall : public Expression {
-public:
-    std::unique_ptr<Expression> function;  // Usually an Identifier
-    std::vector<std::unique_ptr<Expression>> arguments;
-    
-    FunctionCall(std::unique_ptr<Expression> func, std::vector<std::unique_ptr<Expression>> args)
-        : function(std::move(func)), arguments(std::move(args)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct FunctionCall {
+    static constexpr NodeKind kKind = NodeKind::FunctionCall;
+    static constexpr uint16_t kNoNative = 0xFFFF;
+
+    NodeRef function;                // Usually an Identifier
+    NodeList arguments;
+    uint16_t native_id = kNoNative;  // Native function id, set by the Resolver
 };
 
 // Array access
-class ArrayAccess : public Expression {
-public:
-    std::unique_ptr<Expression> array;
-    std::unique_ptr<Expression> index;
-    
-    ArrayAccess(std::unique_ptr<Expression> arr, std::unique_ptr<Expression> idx)
-        : array(std::move(arr)), index(std::move(idx)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct ArrayAccess {
+    static constexpr NodeKind kKind = NodeKind::ArrayAccess;
+    NodeRef array;
+    NodeRef index;
 };
 
 // Member access (for future struct support)
-class MemberAccess : public Expression {
-public:
-    std::unique_ptr<Expression> object;
-    std::string member;
-    
-    MemberAccess(std::unique_ptr<Expression> obj, std::string mem)
-        : object(std::move(obj)), member(std::move(mem)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
-};
-
-// Context-aware conditional expression
-class ContextConditional : public Expression {
-public:
-    std::unique_ptr<Expression> expression;
-    std::string context;  // "dev", "prod", "test"
-    
-    ContextConditional(std::unique_ptr<Expression> expr, std::string ctx)
-        : expression(std::move(expr)), context(std::move(ctx)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct MemberAccess {
+    static constexpr NodeKind kKind = NodeKind::MemberAccess;
+    NodeRef object;
+    Atom member;
+};
+
+// Deployment context the engines assume until told otherwise, as in
+// Compiler::Options
+constexpr std::string_view kDefaultContext = "dev";
+
+// Context-aware conditional expression: `expr if context == "prod"` is
+// `expr` in that context and 0 (without evaluating it) in any other
+struct ContextConditional {
+    static constexpr NodeKind kKind = NodeKind::ContextConditional;
+    static constexpr uint32_t kTopLevel = UINT32_MAX;
+    NodeRef expression;
+    StringRef context;             // "dev", "prod", "test"
+    uint32_t function = kTopLevel; // Index of the enclosing FunctionDefinition, set by the Resolver
+    bool enabled = false;          // `context` is the current one, set by the interpreter
+};
+
+// Array literal: `[a, b, c]`
+struct ArrayLiteral {
+    static constexpr NodeKind kKind = NodeKind::ArrayLiteral;
+    NodeList elements;
+};
+
+// Object literal: `{ key: value, ... }`. Its properties are ObjectProperty
+// nodes in source order, with distinct keys.
+struct ObjectLiteral {
+    static constexpr NodeKind kKind = NodeKind::ObjectLiteral;
+    NodeList properties;
+};
+
+struct ObjectProperty {
+    static constexpr NodeKind kKind = NodeKind::ObjectProperty;
+    Atom key;
+    NodeRef value;
 };
 
 // Statement nodes
-class ExpressionStatement : public Statement {
-public:
-    std::unique_ptr<Expression> expression;
-    
-    explicit ExpressionStatement(std::unique_ptr<Expression> expr)
-        : expression(std::move(expr)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct ExpressionStatement {
+    static constexpr NodeKind kKind = NodeKind::ExpressionStatement;
+    NodeRef expression;
 };
 
 // Variable declaration
-class VariableDeclaration : public Statement {
-public:
-    std::string name;
-    std::string type;  // Optional type annotation (empty if inferred)
-    std::unique_ptr<Expression> initializer;
-    bool is_mutable;
-    
-    VariableDeclaration(std::string n, std::string t, std::unique_ptr<Expression> init, bool mut = false)
-        : name(std::move(n)), type(std::move(t)), initializer(std::move(init)), is_mutable(mut) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct VariableDeclaration {
+    static constexpr NodeKind kKind = NodeKind::VariableDeclaration;
+    Atom name;
+    Atom type;            // Optional type annotation (empty if inferred)
+    NodeRef initializer{};  // Null if absent
+    bool is_mutable = false;
+    SlotAddress address{};  // Set by the Resolver
 };
 
 // Function parameter
 struct Parameter {
-    std::string name;
-    std::string type;
-    
-    Parameter(std::string n, std::string t) : name(std::move(n)), type(std::move(t)) {}
+    Atom name;
+    Atom type;
 };
 
 // Block statement
-class Block : public Statement {
-public:
-    std::vector<std::unique_ptr<Statement>> statements;
-    
-    explicit Block(std::vector<std::unique_ptr<Statement>> stmts)
-        : statements(std::move(stmts)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct Block {
+    static constexpr NodeKind kKind = NodeKind::Block;
+    NodeList statements;
 };
 
 // Function definition
-class FunctionDefinition : public Statement {
-public:
-    std::string name;
-    std::vector<Parameter> parameters;
-    std::string return_type;  // Optional return type (empty if void/inferred)
-    std::unique_ptr<Block> body;
-    
-    FunctionDefinition(std::string n, std::vector<Parameter> params, std::string ret_type, std::unique_ptr<Block> b)
-        : name(std::move(n)), parameters(std::move(params)), return_type(std::move(ret_type)), body(std::move(b)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct FunctionDefinition {
+    static constexpr NodeKind kKind = NodeKind::FunctionDefinition;
+    Atom name;
+    ParameterList parameters;
+    Atom return_type;         // Optional return type (empty if void/inferred)
+    NodeRef body;             // Block
+    SlotAddress address{};    // Slot holding the function value, set by the Resolver
+    uint32_t frame_size = 0;  // Slots needed by one activation, set by the Resolver
+    uint32_t invocations = 0; // Calls so far, counted by the tiered interpreter
+    uint32_t context_epoch = 0; // Context the body's conditionals were last set for, by the interpreter
 };
 
 // Return statement
-class ReturnStatement : public Statement {
-public:
-    std::unique_ptr<Expression> value;  // nullptr for bare "return"
-    
-    explicit ReturnStatement(std::unique_ptr<Expression> val = nullptr)
-        : value(std::move(val)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct ReturnStatement {
+    static constexpr NodeKind kKind = NodeKind::ReturnStatement;
+    NodeRef value;           // Null for bare "return"
+    bool tail_call = false;  // value is a call in tail position, set by the Resolver
 };
 
 // If statement
-class IfStatement : public Statement {
-public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> then_branch;
-    std::unique_ptr<Statement> else_branch;  // nullptr if no else
-    
-    IfStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> then_stmt, std::unique_ptr<Statement> else_stmt = nullptr)
-        : condition(std::move(cond)), then_branch(std::move(then_stmt)), else_branch(std::move(else_stmt)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+struct IfStatement {
+    static constexpr NodeKind kKind = NodeKind::IfStatement;
+    NodeRef condition;
+    NodeRef then_branch;
+    NodeRef else_branch;  // Null if no else
 };
 
 // While loop
-class WhileStatement : public Statement {
-public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> body;
-    
-    WhileStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> b)
-        : condition(std::move(cond)), body(std::move(b)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
-};
-
-// For loop (simplified version)
-class ForStatement : public Statement {
-public:
-    std::string variable;     // Loop variable name
-    std::unique_ptr<Expression> start;      // Start value
-    std::unique_ptr<Expression> end;        // End value  
-    std::unique_ptr<Statement> body;
-    
-    ForStatement(std::string var, std::unique_ptr<Expression> s, std::unique_ptr<Expression> e, std::unique_ptr<Statement> b)
-        : variable(std::move(var)), start(std::move(s)), end(std::move(e)), body(std::move(b)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
-};
-
-// Program (top-level)
-class Program : public ASTNode {
+struct WhileStatement {
+    static constexpr NodeKind kKind = NodeKind::WhileStatement;
+    NodeRef condition;
+    NodeRef body;
+    uint32_t backedges = 0;  // Iterations so far, counted by the tiered interpreter
+};
+
+// Counted loop over the integers start, start + 1, ..., end - 1. Both
+// bounds are evaluated once, before the first iteration; the body sees a
+// copy of the counter, so assigning the variable does not change the count.
+struct ForStatement {
+    static constexpr NodeKind kKind = NodeKind::ForStatement;
+    Atom variable;       // Loop variable name
+    NodeRef start;       // Start value
+    NodeRef end;         // End value (exclusive)
+    NodeRef body;
+    // Set by the Resolver: three consecutive slots holding the counter,
+    // the end bound and the variable
+    SlotAddress address{};
+    uint32_t backedges = 0;  // Iterations so far, counted by the tiered interpreter
+};
+
+// Atom as it was numbered by the process that built the block, with its
+// text in the string table. Atom ids are process-local, so adopting a block
+// re-interns these and renumbers the nodes if they differ.
+struct AtomEntry {
+    uint32_t id = 0;
+    StringRef text;
+};
+
+// Header at the start of every program block. Offsets are relative to the
+// block, so a block can be written out as is and mapped back later.
+struct ProgramLayout {
+    static constexpr size_t kKinds = static_cast<size_t>(NodeKind::COUNT);
+
+    uint64_t size = 0;
+    std::array<uint64_t, kKinds> poolOffsets{};
+    std::array<uint32_t, kKinds> counts{};
+    uint64_t refsOffset = 0;
+    uint64_t parametersOffset = 0;
+    uint64_t atomsOffset = 0;
+    uint64_t stringsOffset = 0;
+    uint32_t refCount = 0;
+    uint32_t parameterCount = 0;
+    uint32_t atomCount = 0;
+    uint64_t stringBytes = 0;
+    NodeList statements;
+};
+
+// A parsed program. All nodes live in one block owned by the Program;
+// annotation fields (addresses, frame sizes) are written in place by the
+// later passes.
+class Program {
 public:
-    std::vector<std::unique_ptr<Statement>> statements;
-    
-    explicit Program(std::vector<std::unique_ptr<Statement>> stmts)
-        : statements(std::move(stmts)) {}
-    
-    void accept(ASTVisitor& visitor) override;
-    std::string to_string() const override;
+    // Frees a block the Program does not own through delete[]
+    using ReleaseFn = void (*)(unsigned char* block, size_t size);
+
+    Program(const Program&) = delete;
+    Program& operator=(const Program&) = delete;
+
+    // Takes over a block produced by an earlier Program (e.g. read back from
+    // the module cache). The block must be 8-byte aligned and writable; it
+    // is handed to `release` when the Program dies. Throws if the layout
+    // header does not describe a block of `size` bytes or a node refers
+    // outside it. Atoms in the nodes are renumbered in place to this
+    // process's ids.
+    static std::unique_ptr<Program> adopt(unsigned char* block, size_t size, ReleaseFn release);
+
+    template <typename T>
+    T& node(NodeRef ref) {
+        return static_cast<T*>(pools_[static_cast<size_t>(T::kKind)])[ref.index()];
+    }
+    template <typename T>
+    const T& node(NodeRef ref) const {
+        return static_cast<const T*>(pools_[static_cast<size_t>(T::kKind)])[ref.index()];
+    }
+
+    std::span<const NodeRef> list(NodeList list) const { return {refs_ + list.begin, list.count}; }
+    std::span<const Parameter> parameters(ParameterList list) const { return {parameters_ + list.begin, list.count}; }
+    std::string_view text(StringRef ref) const { return {strings_ + ref.offset, ref.length}; }
+    std::string_view text(Atom atom) const { return atom.text(); }
+
+    // Top-level statements
+    std::span<const NodeRef> statements() const { return list(statements_); }
+
+    // Number of nodes of one kind, and of all kinds
+    uint32_t count(NodeKind kind) const { return counts_[static_cast<size_t>(kind)]; }
+    size_t nodeCount() const;
+    // The single block holding the program, layout header included
+    std::span<const unsigned char> bytes() const { return {block_.get(), size_}; }
+    size_t memoryBytes() const { return size_; }
+
+    std::string to_string() const;
+    std::string to_string(NodeRef ref) const;
+
+private:
+    friend class AstBuilder;
+
+    // Null `release` means the block came from new[]
+    struct BlockDeleter {
+        ReleaseFn release;
+        size_t size;
+        void operator()(unsigned char* block) const;
+    };
+
+    Program() = default;
+    // Points the accessors into block_ as described by its layout header
+    void attach();
+    // Throws unless every NodeRef, list and string range in the nodes lies
+    // inside the block's sections and the nodes form no cycle
+    void validate(const ProgramLayout& header) const;
+    // Maps the block's atom ids to this process's; throws on an unknown id
+    void remapAtoms(const ProgramLayout& header);
+
+    std::unique_ptr<unsigned char[], BlockDeleter> block_{nullptr, BlockDeleter{nullptr, 0}};
+    size_t size_ = 0;
+    std::array<void*, static_cast<size_t>(NodeKind::COUNT)> pools_{};
+    std::array<uint32_t, static_cast<size_t>(NodeKind::COUNT)> counts_{};
+    const NodeRef* refs_ = nullptr;
+    const Parameter* parameters_ = nullptr;
+    const char* strings_ = nullptr;
+    NodeList statements_;
 };
 
-// Visitor pattern for AST traversal
-class ASTVisitor {
+// Collects nodes while parsing, then packs them into a Program
+class AstBuilder {
 public:
-    virtual ~ASTVisitor() = default;
-    
-    // Expression visitors
-    virtual void visit(IntegerLiteral& node) = 0;
-    virtual void visit(FloatLiteral& node) = 0;
-    virtual void visit(StringLiteral& node) = 0;
-    virtual void visit(BooleanLiteral& node) = 0;
-    virtual void visit(Identifier& node) = 0;
-    virtual void visit(BinaryExpression& node) = 0;
-    virtual void visit(UnaryExpression& node) = 0;
-    virtual void visit(FunctionCall& node) = 0;
-    virtual void visit(ArrayAccess& node) = 0;
-    virtual void visit(MemberAccess& node) = 0;
-    virtual void visit(ContextConditional& node) = 0;
-    
-    // Statement visitors
-    virtual void visit(ExpressionStatement& node) = 0;
-    virtual void visit(VariableDeclaration& node) = 0;
-    virtual void visit(Block& node) = 0;
-    virtual void visit(FunctionDefinition& node) = 0;
-    virtual void visit(ReturnStatement& node) = 0;
-    virtual void visit(IfStatement& node) = 0;
-    virtual void visit(WhileStatement& node) = 0;
-    virtual void visit(ForStatement& node) = 0;
-    virtual void visit(Program& node) = 0;
+    template <typename T>
+    NodeRef add(const T& node) {
+        static_assert(std::is_trivially_copyable_v<T>, "nodes are copied into the program block");
+        auto& pool = std::get<std::vector<T>>(pools_);
+        checkIndex(pool.size());
+        T& stored = pool.emplace_back(node);
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+        // Padding is copied from the caller's temporary; clear it so cached
+        // blocks are byte-for-byte reproducible
+        __builtin_clear_padding(&stored);
+#endif
+#endif
+        (void)stored;
+        return NodeRef(T::kKind, static_cast<uint32_t>(pool.size() - 1));
+    }
+
+    // Node already added, for filling in fields after its children
+    template <typename T>
+    T& node(NodeRef ref) {
+        return std::get<std::vector<T>>(pools_)[ref.index()];
+    }
+
+    NodeList addList(std::span<const NodeRef> nodes);
+    ParameterList addParameters(std::span<const Parameter> parameters);
+    StringRef addString(std::string_view text);
+
+    // Packs everything into one block; the builder is left empty
+    std::unique_ptr<Program> finish(NodeList statements);
+
+private:
+    friend class Program;
+
+    // One pool per node kind, in NodeKind order
+    using Pools = std::tuple<std::vector<IntegerLiteral>, std::vector<FloatLiteral>, std::vector<StringLiteral>,
+                             std::vector<BooleanLiteral>, std::vector<Identifier>, std::vector<BinaryExpression>,
+                             std::vector<UnaryExpression>, std::vector<FunctionCall>, std::vector<ArrayAccess>,
+                             std::vector<MemberAccess>, std::vector<ContextConditional>, std::vector<ArrayLiteral>,
+                             std::vector<ObjectLiteral>, std::vector<ObjectProperty>, std::vector<ExpressionStatement>,
+                             std::vector<VariableDeclaration>, std::vector<Block>, std::vector<FunctionDefinition>,
+                             std::vector<ReturnStatement>, std::vector<IfStatement>, std::vector<WhileStatement>,
+                             std::vector<ForStatement>>;
+
+    Pools pools_;
+    std::vector<NodeRef> refs_;
+    std::vector<Parameter> parameters_;
+    std::string strings_;
+
+    static void checkIndex(size_t index);
+    // The atom section: every distinct atom in the nodes, texts appended
+    // to the string table
+    std::vector<AtomEntry> collectAtoms();
 };
 
+// Operator spelling, shared by to_string and diagnostics
+const char* binaryOperatorText(BinaryOperator op);
+const char* unaryOperatorText(UnaryOperator op);
+
 } // namespace myndra
 
-#endif // MYNDRA_AST_H
\ No newline at end of file
+#endif // MYNDRA_AST_H
@@ -1,18 +1,56 @@
 #include "parser.h"
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <sstream>
 
 namespace myndra {
 
-Parser::Parser(const std::vector<Token>& tokens) : tokens_(tokens), current_(0) {
+namespace {
+
+// Binary operator of each token type; precedence 0 means "not one"
+struct BinaryRule {
+    uint8_t precedence = 0;
+    BinaryOperator op = BinaryOperator::Add;
+};
+
+constexpr std::array<BinaryRule, kTokenTypeCount> kBinaryRules = [] {
+    std::array<BinaryRule, kTokenTypeCount> rules{};
+    auto rule = [&](TokenType type, int precedence, BinaryOperator op) {
+        rules[static_cast<size_t>(type)] = {static_cast<uint8_t>(precedence), op};
+    };
+    rule(TokenType::OR, 1, BinaryOperator::Or);
+    rule(TokenType::AND, 2, BinaryOperator::And);
+    rule(TokenType::EQUAL, 3, BinaryOperator::Eq);
+    rule(TokenType::NOT_EQUAL, 3, BinaryOperator::Ne);
+    rule(TokenType::LESS, 4, BinaryOperator::Lt);
+    rule(TokenType::LESS_EQUAL, 4, BinaryOperator::Le);
+    rule(TokenType::GREATER, 4, BinaryOperator::Gt);
+    rule(TokenType::GREATER_EQUAL, 4, BinaryOperator::Ge);
+    rule(TokenType::PLUS, 5, BinaryOperator::Add);
+    rule(TokenType::MINUS, 5, BinaryOperator::Sub);
+    rule(TokenType::MULTIPLY, 6, BinaryOperator::Mul);
+    rule(TokenType::DIVIDE, 6, BinaryOperator::Div);
+    rule(TokenType::MODULO, 6, BinaryOperator::Mod);
+    rule(TokenType::ASSIGN, 0, BinaryOperator::Assign);   // Right-associative, parsed on its own
+    return rules;
+}();
+
+constexpr TokenSet kUnaryOperators = {TokenType::NOT, TokenType::MINUS, TokenType::PLUS};
+constexpr TokenSet kPostfixOperators = {TokenType::LEFT_PAREN, TokenType::LEFT_BRACKET, TokenType::DOT};
+constexpr TokenSet kStatementStarts = {TokenType::FN, TokenType::LET, TokenType::IF,
+                                       TokenType::WHILE, TokenType::FOR, TokenType::RETURN};
+
+} // namespace
+
+Parser::Parser(const TokenStream& tokens) : tokens_(tokens), current_(0) {
     // Constructor
 }
 
 // Utility methods
 const Token& Parser::currentToken() const {
     if (isAtEnd()) {
-        static Token eof_token{TokenType::EOF_TOKEN, "", 0, 0};
-        return eof_token;
+        return tokens_.back(); // The lexer always ends the stream with EOF
     }
     return tokens_[current_];
 }
@@ -20,8 +58,7 @@ const Token& Parser::currentToken() const {
 const Token& Parser::peekToken(size_t offset) const {
     size_t pos = current_ + offset;
     if (pos >= tokens_.size()) {
-        static Token eof_token{TokenType::EOF_TOKEN, "", 0, 0};
-        return eof_token;
+        return tokens_.back();
     }
     return tokens_[pos];
 }
@@ -49,17 +86,15 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
-bool Parser::match(const std::vector<TokenType>& types) {
-    for (TokenType type : types) {
-        if (check(type)) {
-            advance();
-            return true;
-        }
+bool Parser::match(TokenSet types) {
+    if (!isAtEnd() && types.contains(currentToken().type)) {
+        advance();
+        return true;
     }
     return false;
 }
 
-Token Parser::consume(TokenType type, const std::string& message) {
+Token Parser::consume(TokenType type, const char* message) {
     if (check(type)) {
         return advance();
     }
@@ -71,29 +106,24 @@ Token Parser::consume(TokenType type, const std::string& message) {
 void Parser::error(const std::string& message) {
     const Token& token = currentToken();
     std::ostringstream oss;
-    oss << "Parse error at line " << token.line << ", column " << token.column;
+    SourceLocation location = tokens_.location(token);
+    oss << "Parse error at line " << location.line << ", column " << location.column;
     oss << ": " << message;
-    oss << " (got '" << token.lexeme << "')";
+    oss << " (got '" << tokens_.lexeme(token) << "')";
     errors_.push_back(oss.str());
 }
 
+void Parser::skipNewlines() {
+    while (match(TokenType::NEWLINE)) {
+    }
+}
+
 void Parser::synchronize() {
     advance();
     
     while (!isAtEnd()) {
         if (tokens_[current_ - 1].type == TokenType::SEMICOLON) return;
-        
-        switch (currentToken().type) {
-            case TokenType::FN:
-            case TokenType::LET:
-            case TokenType::IF:
-            case TokenType::WHILE:
-            case TokenType::FOR:
-            case TokenType::RETURN:
-                return;
-            default:
-                break;
-        }
+        if (kStatementStarts.contains(currentToken().type)) return;
         
         advance();
     }
@@ -101,35 +131,42 @@ void Parser::synchronize() {
 
 // Main parsing methods
 std::unique_ptr<Program> Parser::parseProgram() {
-    std::vector<std::unique_ptr<Statement>> statements;
+    size_t start = pending_.size();
     
     while (!isAtEnd()) {
         // Skip newlines between statements
         while (match(TokenType::NEWLINE)) {
             // Continue skipping newlines
         }
-        
+    
         if (isAtEnd()) break;
-        
+    
         // DEBUG: Program parsing debug removed for cleaner output
-        auto stmt = parseDeclaration();
+        NodeRef stmt = parseDeclaration();
         if (stmt) {
             // DEBUG: Success message removed for cleaner output
-            statements.push_back(std::move(stmt));
+            pending_.push_back(stmt);
         } else {
             // DEBUG: Error message removed for cleaner output
             synchronize();
         }
     }
     
-    return std::make_unique<Program>(std::move(statements));
+    return ast_.finish(takePending(start));
 }
 
-std::unique_ptr<Expression> Parser::parseExpression() {
-    return parseAssignment();
+NodeRef Parser::parseExpression() {
+    NodeRef expr = parseAssignment();
+    
+    // A context-aware conditional applies to the whole expression before it
+    if (check(TokenType::IF) && peekToken().type == TokenType::CONTEXT) {
+        return parseContextConditional(expr);
+    }
+    
+    return expr;
 }
 
-std::unique_ptr<Statement> Parser::parseStatement() {
+NodeRef Parser::parseStatement() {
     if (match(TokenType::IF)) return parseIfStatement();
     if (match(TokenType::WHILE)) return parseWhileStatement();
     if (match(TokenType::FOR)) return parseForStatement();
@@ -142,178 +179,121 @@ std::unique_ptr<Statement> Parser::parseStatement() {
     return parseExpressionStatement();
 }
 
-// Expression parsing (precedence climbing)
-std::unique_ptr<Expression> Parser::parseAssignment() {
-    auto expr = parseLogicalOr();
+// Expression parsing (Pratt: binary operators by precedence table)
+NodeRef Parser::parseAssignment() {
+    NodeRef expr = parseBinary(1);
     
     if (match(TokenType::ASSIGN)) {
-        auto equals = tokens_[current_ - 1];
-        auto value = parseAssignment();
-        
-        // Check if left side is assignable (identifier for now)
-        if (auto identifier = dynamic_cast<Identifier*>(expr.get())) {
-            return std::make_unique<BinaryExpression>(std::move(expr), BinaryOperator::Assign, std::move(value));
-        }
-        
-        error("Invalid assignment target");
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseLogicalOr() {
-    auto expr = parseLogicalAnd();
-    
-    while (match(TokenType::OR)) {
-        auto op = BinaryOperator::Or;
-        auto right = parseLogicalAnd();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseLogicalAnd() {
-    auto expr = parseEquality();
-    
-    while (match(TokenType::AND)) {
-        auto op = BinaryOperator::And;
-        auto right = parseEquality();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseEquality() {
-    auto expr = parseComparison();
-    
-    while (match({TokenType::EQUAL, TokenType::NOT_EQUAL})) {
-        auto op = tokenToBinaryOperator(tokens_[current_ - 1].type);
-        auto right = parseComparison();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseComparison() {
-    auto expr = parseTerm();
-    
-    while (match({TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL})) {
-        auto op = tokenToBinaryOperator(tokens_[current_ - 1].type);
-        auto right = parseTerm();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
+        NodeRef value = parseAssignment();
     
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseTerm() {
-    auto expr = parseFactor();
+        // Variables, array elements and properties are assignable
+        if (expr && (expr.kind() == NodeKind::Identifier || expr.kind() == NodeKind::ArrayAccess ||
+                     expr.kind() == NodeKind::MemberAccess)) {
+            return ast_.add(BinaryExpression{expr, value, BinaryOperator::Assign});
+        }
     
-    while (match({TokenType::PLUS, TokenType::MINUS})) {
-        auto op = tokenToBinaryOperator(tokens_[current_ - 1].type);
-        auto right = parseFactor();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
+        error("Invalid assignment target");
     }
     
     return expr;
 }
 
-std::unique_ptr<Expression> Parser::parseFactor() {
-    auto expr = parseUnary();
+// Operands joined by operators binding at least as tightly as
+// `minPrecedence`; every level is left-associative
+NodeRef Parser::parseBinary(int minPrecedence) {
+    NodeRef expr = parseUnary();
     
-    while (match({TokenType::MULTIPLY, TokenType::DIVIDE, TokenType::MODULO})) {
-        auto op = tokenToBinaryOperator(tokens_[current_ - 1].type);
-        auto right = parseUnary();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
+    for (;;) {
+        TokenType type = currentToken().type;   // EOF at the end, which binds nothing
+        int precedence = getBinaryPrecedence(type);
+        if (precedence == 0 || precedence < minPrecedence) break;
+        advance();
+        NodeRef right = parseBinary(precedence + 1);
+        expr = ast_.add(BinaryExpression{expr, right, tokenToBinaryOperator(type)});
     }
     
     return expr;
 }
 
-std::unique_ptr<Expression> Parser::parseUnary() {
-    if (match({TokenType::NOT, TokenType::MINUS, TokenType::PLUS})) {
+NodeRef Parser::parseUnary() {
+    if (match(kUnaryOperators)) {
         auto op = tokenToUnaryOperator(tokens_[current_ - 1].type);
-        auto right = parseUnary();
-        return std::make_unique<UnaryExpression>(op, std::move(right));
+        NodeRef right = parseUnary();
+        return ast_.add(UnaryExpression{right, op});
     }
     
     return parseCall();
 }
 
-std::unique_ptr<Expression> Parser::parseCall() {
-    auto expr = parsePrimary();
+NodeRef Parser::parseCall() {
+    NodeRef expr = parsePrimary();
     
-    while (true) {
-        if (match(TokenType::LEFT_PAREN)) {
-            expr = finishCall(std::move(expr));
-        } else if (match(TokenType::LEFT_BRACKET)) {
-            expr = finishArrayAccess(std::move(expr));
-        } else if (match(TokenType::DOT)) {
-            expr = finishMemberAccess(std::move(expr));
-        } else {
-            break;
+    while (match(kPostfixOperators)) {
+        switch (tokens_[current_ - 1].type) {
+            case TokenType::LEFT_PAREN: expr = finishCall(expr); break;
+            case TokenType::LEFT_BRACKET: expr = finishArrayAccess(expr); break;
+            default: expr = finishMemberAccess(expr); break;
         }
     }
     
-    // Check for context-aware conditional
-    if (check(TokenType::IF) && peekToken().type == TokenType::IDENTIFIER && peekToken(2).type == TokenType::EQUAL) {
-        return parseContextConditional(std::move(expr));
-    }
-    
     return expr;
 }
 
-std::unique_ptr<Expression> Parser::parsePrimary() {
-    if (match(TokenType::TRUE)) {
-        return std::make_unique<BooleanLiteral>(true);
-    }
-    
-    if (match(TokenType::FALSE)) {
-        return std::make_unique<BooleanLiteral>(false);
-    }
-    
-    if (match(TokenType::INTEGER)) {
-        int64_t value = std::stoll(tokens_[current_ - 1].lexeme);
-        return std::make_unique<IntegerLiteral>(value);
-    }
-    
-    if (match(TokenType::FLOAT)) {
-        double value = std::stod(tokens_[current_ - 1].lexeme);
-        return std::make_unique<FloatLiteral>(value);
-    }
-    
-    if (match(TokenType::STRING)) {
-        std::string value = tokens_[current_ - 1].lexeme;
-        // Remove surrounding quotes
-        if (value.length() >= 2 && value.front() == '"' && value.back() == '"') {
-            value = value.substr(1, value.length() - 2);
+NodeRef Parser::parsePrimary() {
+    // Literal values are decoded from the source only here
+    const Token& token = currentToken();
+    switch (isAtEnd() ? TokenType::EOF_TOKEN : token.type) {
+        case TokenType::BOOLEAN:
+            advance();
+            return ast_.add(BooleanLiteral{tokens_.boolValue(token)});
+        case TokenType::INTEGER: {
+            advance();
+            int64_t value = 0;
+            if (!tokens_.integerValue(token, value)) {
+                error("Integer literal out of range");
+            }
+            return ast_.add(IntegerLiteral{value});
         }
-        return std::make_unique<StringLiteral>(value);
-    }
-    
-    if (match(TokenType::IDENTIFIER)) {
-        return std::make_unique<Identifier>(tokens_[current_ - 1].lexeme);
-    }
-    
-    if (match(TokenType::LEFT_PAREN)) {
-        auto expr = parseExpression();
-        consume(TokenType::RIGHT_PAREN, "Expect ')' after expression");
-        return expr;
+        case TokenType::FLOAT: {
+            advance();
+            double value = 0.0;
+            if (!tokens_.floatValue(token, value)) {
+                error("Float literal out of range");
+            }
+            return ast_.add(FloatLiteral{value});
+        }
+        case TokenType::STRING:
+            advance();
+            return ast_.add(StringLiteral{ast_.addString(tokens_.stringValue(token))});
+        case TokenType::IDENTIFIER:
+            advance();
+            return ast_.add(Identifier{token.atom});
+        case TokenType::LEFT_PAREN: {
+            advance();
+            NodeRef expr = parseExpression();
+            consume(TokenType::RIGHT_PAREN, "Expect ')' after expression");
+            return expr;
+        }
+        case TokenType::LEFT_BRACKET:
+            advance();
+            return finishArrayLiteral();
+        case TokenType::LEFT_BRACE:
+            // Only in expression position; a statement starting with '{' is a block
+            advance();
+            return finishObjectLiteral();
+        default:
+            break;
     }
     
     error("Expect expression");
     if (!isAtEnd()) advance(); // Advance to avoid infinite loops
-    return nullptr;
+    return NodeRef();
 }
 
 // Context-aware parsing
-std::unique_ptr<Expression> Parser::parseContextConditional(std::unique_ptr<Expression> expr) {
+NodeRef Parser::parseContextConditional(NodeRef expr) {
     consume(TokenType::IF, "Expected 'if' for context conditional");
-    consume(TokenType::IDENTIFIER, "Expected 'context' identifier");
-    consume(TokenType::EQUAL, "Expected '==' in context conditional");
+    consume(TokenType::CONTEXT, "Expected 'context' after 'if'");
     consume(TokenType::EQUAL, "Expected '==' in context conditional");
     
     if (!match(TokenType::STRING)) {
@@ -321,136 +301,180 @@ std::unique_ptr<Expression> Parser::parseContextConditional(std::unique_ptr<Expr
         return expr;
     }
     
-    std::string context = tokens_[current_ - 1].lexeme;
-    // Remove quotes
-    if (context.length() >= 2 && context.front() == '"' && context.back() == '"') {
-        context = context.substr(1, context.length() - 2);
-    }
+    StringRef context = ast_.addString(tokens_.stringValue(tokens_[current_ - 1]));
     
-    return std::make_unique<ContextConditional>(std::move(expr), context);
+    return ast_.add(ContextConditional{expr, context});
 }
 
 // Helper methods for call, array access, member access
-std::unique_ptr<Expression> Parser::finishCall(std::unique_ptr<Expression> callee) {
-    std::vector<std::unique_ptr<Expression>> arguments;
-    
-    if (!check(TokenType::RIGHT_PAREN)) {
-        do {
-            arguments.push_back(parseExpression());
-        } while (match(TokenType::COMMA));
-    }
-    
+NodeRef Parser::finishCall(NodeRef callee) {
+    NodeList arguments = parseArgumentList();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments");
-    return std::make_unique<FunctionCall>(std::move(callee), std::move(arguments));
+    return ast_.add(FunctionCall{callee, arguments});
 }
 
-std::unique_ptr<Expression> Parser::finishArrayAccess(std::unique_ptr<Expression> array) {
-    auto index = parseExpression();
+NodeRef Parser::finishArrayAccess(NodeRef array) {
+    NodeRef index = parseExpression();
     consume(TokenType::RIGHT_BRACKET, "Expect ']' after array index");
-    return std::make_unique<ArrayAccess>(std::move(array), std::move(index));
+    return ast_.add(ArrayAccess{array, index});
 }
 
-std::unique_ptr<Expression> Parser::finishMemberAccess(std::unique_ptr<Expression> object) {
+NodeRef Parser::finishArrayLiteral() {
+    size_t start = pending_.size();
+    if (!check(TokenType::RIGHT_BRACKET)) {
+        do {
+            pending_.push_back(parseExpression());
+        } while (match(TokenType::COMMA));
+    }
+    consume(TokenType::RIGHT_BRACKET, "Expect ']' after array elements");
+    return ast_.add(ArrayLiteral{takePending(start)});
+}
+
+NodeRef Parser::finishObjectLiteral() {
+    size_t start = pending_.size();
+    std::vector<Atom> keys;
+    // Literals may span lines, like blocks
+    skipNewlines();
+    while (!check(TokenType::RIGHT_BRACE)) {
+        // Keys are names or strings; a trailing comma is allowed
+        const Token& token = currentToken();
+        Atom key;
+        if (token.type == TokenType::IDENTIFIER) {
+            key = token.atom;
+        } else if (token.type == TokenType::STRING) {
+            key = Atom::intern(tokens_.stringValue(token));
+        } else {
+            error("Expect property name in object literal");
+            break;
+        }
+        if (std::find(keys.begin(), keys.end(), key) != keys.end()) {
+            error("Duplicate key '" + std::string(key.text()) + "' in object literal");
+        }
+        keys.push_back(key);
+        advance();
+        consume(TokenType::COLON, "Expect ':' after property name");
+        skipNewlines();
+        NodeRef value = parseExpression();
+        pending_.push_back(ast_.add(ObjectProperty{key, value}));
+        skipNewlines();
+        if (!match(TokenType::COMMA)) break;
+        skipNewlines();
+    }
+    consume(TokenType::RIGHT_BRACE, "Expect '}' after object properties");
+    return ast_.add(ObjectLiteral{takePending(start)});
+}
+
+NodeRef Parser::finishMemberAccess(NodeRef object) {
     Token name = consume(TokenType::IDENTIFIER, "Expect property name after '.'");
-    return std::make_unique<MemberAccess>(std::move(object), name.lexeme);
+    return ast_.add(MemberAccess{object, name.atom});
 }
 
 // Statement parsing
-std::unique_ptr<Statement> Parser::parseDeclaration() {
+NodeRef Parser::parseDeclaration() {
+    size_t pending = pending_.size();
     try {
         if (match(TokenType::FN)) return parseFunctionDeclaration();
         if (match(TokenType::LET)) return parseVarDeclaration();
-        
+    
         return parseStatement();
     } catch (...) {
+        pending_.resize(pending);   // Lists the statement left half-built
         synchronize();
-        return nullptr;
+        return NodeRef();
     }
 }
 
-std::unique_ptr<Statement> Parser::parseVarDeclaration() {
+NodeRef Parser::parseVarDeclaration() {
     bool is_mutable = match(TokenType::MUT);
     
     Token name = consume(TokenType::IDENTIFIER, "Expect variable name");
     
-    std::string type;
+    Atom type;
     if (match(TokenType::COLON)) {
         type = parseType();
     }
     
-    std::unique_ptr<Expression> initializer = nullptr;
+    NodeRef initializer;
     if (match(TokenType::ASSIGN)) {
         initializer = parseExpression();
     }
     
     consume(TokenType::SEMICOLON, "Expect ';' after variable declaration");
     
-    return std::make_unique<VariableDeclaration>(name.lexeme, type, std::move(initializer), is_mutable);
+    VariableDeclaration declaration;
+    declaration.name = name.atom;
+    declaration.type = type;
+    declaration.initializer = initializer;
+    declaration.is_mutable = is_mutable;
+    return ast_.add(declaration);
 }
 
-std::unique_ptr<Statement> Parser::parseFunctionDeclaration() {
+NodeRef Parser::parseFunctionDeclaration() {
     Token name = consume(TokenType::IDENTIFIER, "Expect function name");
     
     consume(TokenType::LEFT_PAREN, "Expect '(' after function name");
-    auto parameters = parseParameterList();
+    ParameterList parameters = parseParameterList();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after parameters");
     
-    std::string return_type;
+    Atom return_type;
     if (match(TokenType::ARROW)) {
         return_type = parseType();
     }
     
-    auto body = parseBlockStatement();
-    auto block_ptr = std::unique_ptr<Block>(dynamic_cast<Block*>(body.release()));
-    
-    return std::make_unique<FunctionDefinition>(name.lexeme, std::move(parameters), return_type, std::move(block_ptr));
+    FunctionDefinition function;
+    function.name = name.atom;
+    function.parameters = parameters;
+    function.return_type = return_type;
+    function.body = parseBlockStatement();
+    return ast_.add(function);
 }
 
-std::unique_ptr<Statement> Parser::parseIfStatement() {
-    auto condition = parseExpression();
-    auto then_branch = parseStatement();
+NodeRef Parser::parseIfStatement() {
+    NodeRef condition = parseExpression();
+    NodeRef then_branch = parseStatement();
     
-    std::unique_ptr<Statement> else_branch = nullptr;
+    NodeRef else_branch;
     if (match(TokenType::ELSE)) {
         else_branch = parseStatement();
     }
     
-    return std::make_unique<IfStatement>(std::move(condition), std::move(then_branch), std::move(else_branch));
+    return ast_.add(IfStatement{condition, then_branch, else_branch});
 }
 
-std::unique_ptr<Statement> Parser::parseWhileStatement() {
-    auto condition = parseExpression();
-    auto body = parseStatement();
+NodeRef Parser::parseWhileStatement() {
+    NodeRef condition = parseExpression();
+    NodeRef body = parseStatement();
     
-    return std::make_unique<WhileStatement>(std::move(condition), std::move(body));
+    return ast_.add(WhileStatement{condition, body});
 }
 
-std::unique_ptr<Statement> Parser::parseForStatement() {
+NodeRef Parser::parseForStatement() {
     Token var_name = consume(TokenType::IDENTIFIER, "Expect loop variable name");
     consume(TokenType::IN, "Expect 'in' after loop variable");
     
-    auto start = parseExpression();
-    consume(TokenType::DOT, "Expect '..' in range");
-    consume(TokenType::DOT, "Expect '..' in range");
-    auto end = parseExpression();
+    NodeRef start = parseExpression();
+    consume(TokenType::DOT_DOT, "Expect '..' in range");
+    NodeRef end = parseExpression();
     
-    auto body = parseStatement();
+    NodeRef body = parseStatement();
     
-    return std::make_unique<ForStatement>(var_name.lexeme, std::move(start), std::move(end), std::move(body));
+    return ast_.add(ForStatement{var_name.atom, start, end, body});
 }
 
-std::unique_ptr<Statement> Parser::parseReturnStatement() {
-    std::unique_ptr<Expression> value = nullptr;
+NodeRef Parser::parseReturnStatement() {
+    NodeRef value;
     if (!check(TokenType::SEMICOLON)) {
         value = parseExpression();
     }
     
     consume(TokenType::SEMICOLON, "Expect ';' after return value");
-    return std::make_unique<ReturnStatement>(std::move(value));
+    return ast_.add(ReturnStatement{value});
 }
 
-std::unique_ptr<Statement> Parser::parseBlockStatement() {
-    std::vector<std::unique_ptr<Statement>> statements;
+NodeRef Parser::parseBlockStatement() {
+    // Children of nested blocks are appended to the shared list pool first,
+    // so this block's statements are collected here and added as one run
+    size_t start = pending_.size();
     
     consume(TokenType::LEFT_BRACE, "Expect '{'");
     
@@ -459,68 +483,60 @@ std::unique_ptr<Statement> Parser::parseBlockStatement() {
         while (match(TokenType::NEWLINE)) {
             // Continue skipping newlines
         }
-        
+    
         if (check(TokenType::RIGHT_BRACE) || isAtEnd()) break;
-        
-        statements.push_back(parseDeclaration());
+    
+        NodeRef stmt = parseDeclaration();
+        if (stmt) {
+            pending_.push_back(stmt);
+        }
     }
     
     consume(TokenType::RIGHT_BRACE, "Expect '}'");
-    return std::make_unique<Block>(std::move(statements));
+    return ast_.add(Block{takePending(start)});
 }
 
-std::unique_ptr<Statement> Parser::parseExpressionStatement() {
-    auto expr = parseExpression();
+NodeRef Parser::parseExpressionStatement() {
+    NodeRef expr = parseExpression();
     consume(TokenType::SEMICOLON, "Expect ';' after expression");
-    return std::make_unique<ExpressionStatement>(std::move(expr));
+    return ast_.add(ExpressionStatement{expr});
 }
 
 // Helper methods
-std::vector<Parameter> Parser::parseParameterList() {
-    std::vector<Parameter> parameters;
+ParameterList Parser::parseParameterList() {
+    // Parameter lists do not nest
+    parameters_.clear();
     
     if (!check(TokenType::RIGHT_PAREN)) {
         do {
             Token name = consume(TokenType::IDENTIFIER, "Expect parameter name");
             consume(TokenType::COLON, "Expect ':' after parameter name");
-            std::string type = parseType();
-            parameters.emplace_back(name.lexeme, type);
+            Atom type = parseType();
+            parameters_.push_back(Parameter{name.atom, type});
         } while (match(TokenType::COMMA));
     }
     
-    return parameters;
+    return ast_.addParameters(parameters_);
 }
 
-std::string Parser::parseType() {
+Atom Parser::parseType() {
     if (match(TokenType::IDENTIFIER)) {
-        return tokens_[current_ - 1].lexeme;
+        return tokens_[current_ - 1].atom;
+    }
+    // Array types are named by their spelling, e.g. "[float]"
+    if (match(TokenType::LEFT_BRACKET)) {
+        Atom element = parseType();
+        consume(TokenType::RIGHT_BRACKET, "Expect ']' after array element type");
+        return Atom::intern("[" + std::string(element.text()) + "]");
     }
     
     error("Expected type name");
-    return "";
+    return Atom();
 }
 
 // Operator conversion helpers
 BinaryOperator Parser::tokenToBinaryOperator(TokenType type) const {
-    switch (type) {
-        case TokenType::PLUS: return BinaryOperator::Add;
-        case TokenType::MINUS: return BinaryOperator::Sub;
-        case TokenType::MULTIPLY: return BinaryOperator::Mul;
-        case TokenType::DIVIDE: return BinaryOperator::Div;
-        case TokenType::MODULO: return BinaryOperator::Mod;
-        case TokenType::EQUAL: return BinaryOperator::Eq;
-        case TokenType::NOT_EQUAL: return BinaryOperator::Ne;
-        case TokenType::LESS: return BinaryOperator::Lt;
-        case TokenType::LESS_EQUAL: return BinaryOperator::Le;
-        case TokenType::GREATER: return BinaryOperator::Gt;
-        case TokenType::GREATER_EQUAL: return BinaryOperator::Ge;
-        case TokenType::AND: return BinaryOperator::And;
-        case TokenType::OR: return BinaryOperator::Or;
-        case TokenType::ASSIGN: return BinaryOperator::Assign;
-        default:
-            // Should not reach here
-            return BinaryOperator::Add;
-    }
+    return kBinaryRules[static_cast<size_t>(type)].op;
 }
 
 UnaryOperator Parser::tokenToUnaryOperator(TokenType type) const {
@@ -534,36 +550,27 @@ UnaryOperator Parser::tokenToUnaryOperator(TokenType type) const {
     }
 }
 
-// Missing method implementations
 int Parser::getBinaryPrecedence(TokenType type) const {
-    switch (type) {
-        case TokenType::OR: return 1;
-        case TokenType::AND: return 2;
-        case TokenType::EQUAL:
-        case TokenType::NOT_EQUAL: return 3;
-        case TokenType::LESS:
-        case TokenType::LESS_EQUAL:
-        case TokenType::GREATER:
-        case TokenType::GREATER_EQUAL: return 4;
-        case TokenType::PLUS:
-        case TokenType::MINUS: return 5;
-        case TokenType::MULTIPLY:
-        case TokenType::DIVIDE:
-        case TokenType::MODULO: return 6;
-        default: return 0;
-    }
+    return kBinaryRules[static_cast<size_t>(type)].precedence;
 }
 
-std::vector<std::unique_ptr<Expression>> Parser::parseArgumentList() {
-    std::vector<std::unique_ptr<Expression>> arguments;
+NodeList Parser::parseArgumentList() {
+    size_t start = pending_.size();
     
     if (!check(TokenType::RIGHT_PAREN)) {
         do {
-            arguments.push_back(parseExpression());
+            NodeRef argument = parseExpression();
+            pending_.push_back(argument);
         } while (match(TokenType::COMMA));
     }
     
-    return arguments;
+    return takePending(start);
+}
+
+NodeList Parser::takePending(size_t start) {
+    NodeList list = ast_.addList(std::span<const NodeRef>(pending_).subspan(start));
+    pending_.resize(start);
+    return list;
 }
 
 } // namespace myndra
\ No newline at end of file
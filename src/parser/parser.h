@@ -11,21 +11,26 @@ namespace myndra {
 
 class Parser {
 public:
-    explicit Parser(const std::vector<Token>& tokens);
+    // The parser reads `tokens` in place; it must outlive the parser
+    explicit Parser(const TokenStream& tokens);
+    Parser(TokenStream&&) = delete;
     
-    // Main parsing entry points
+    // Main parsing entry point
     std::unique_ptr<Program> parseProgram();
-    std::unique_ptr<Expression> parseExpression();
-    std::unique_ptr<Statement> parseStatement();
     
     // Error handling
     bool hasErrors() const { return !errors_.empty(); }
     const std::vector<std::string>& getErrors() const { return errors_; }
     
 private:
-    std::vector<Token> tokens_;
+    const TokenStream& tokens_;
     size_t current_;
     std::vector<std::string> errors_;
+    AstBuilder ast_;
+    // Children of the lists being parsed, innermost last; each list takes
+    // its run off the top, so no list allocates its own vector
+    std::vector<NodeRef> pending_;
+    std::vector<Parameter> parameters_;
     
     // Utility methods
     const Token& currentToken() const;
@@ -34,52 +39,54 @@ private:
     Token advance();
     bool check(TokenType type) const;
     bool match(TokenType type);
-    bool match(const std::vector<TokenType>& types);
-    Token consume(TokenType type, const std::string& message);
+    bool match(TokenSet types);
+    Token consume(TokenType type, const char* message);
     
     // Error handling
     void error(const std::string& message);
     void synchronize();
+    void skipNewlines();
     
-    // Expression parsing (precedence climbing)
-    std::unique_ptr<Expression> parseAssignment();
-    std::unique_ptr<Expression> parseLogicalOr();
-    std::unique_ptr<Expression> parseLogicalAnd();
-    std::unique_ptr<Expression> parseEquality();
-    std::unique_ptr<Expression> parseComparison();
-    std::unique_ptr<Expression> parseTerm();
-    std::unique_ptr<Expression> parseFactor();
-    std::unique_ptr<Expression> parseUnary();
-    std::unique_ptr<Expression> parseCall();
-    std::unique_ptr<Expression> parsePrimary();
+    NodeRef parseExpression();
+    NodeRef parseStatement();
+    
+    // Expression parsing (Pratt: binary operators by precedence table)
+    NodeRef parseAssignment();
+    NodeRef parseBinary(int minPrecedence);
+    NodeRef parseUnary();
+    NodeRef parseCall();
+    NodeRef parsePrimary();
     
     // Context-aware parsing
-    std::unique_ptr<Expression> parseContextConditional(std::unique_ptr<Expression> expr);
+    NodeRef parseContextConditional(NodeRef expr);
     
     // Helper for function calls and array access
-    std::unique_ptr<Expression> finishCall(std::unique_ptr<Expression> expr);
-    std::unique_ptr<Expression> finishArrayAccess(std::unique_ptr<Expression> expr);
-    std::unique_ptr<Expression> finishMemberAccess(std::unique_ptr<Expression> expr);
+    NodeRef finishCall(NodeRef expr);
+    NodeRef finishArrayAccess(NodeRef expr);
+    NodeRef finishArrayLiteral();
+    NodeRef finishObjectLiteral();
+    NodeRef finishMemberAccess(NodeRef expr);
     
     // Statement parsing
-    std::unique_ptr<Statement> parseDeclaration();
-    std::unique_ptr<Statement> parseVarDeclaration();
-    std::unique_ptr<Statement> parseFunctionDeclaration();
-    std::unique_ptr<Statement> parseIfStatement();
-    std::unique_ptr<Statement> parseWhileStatement();
-    std::unique_ptr<Statement> parseForStatement();
-    std::unique_ptr<Statement> parseReturnStatement();
-    std::unique_ptr<Statement> parseBlockStatement();
-    std::unique_ptr<Statement> parseExpressionStatement();
+    NodeRef parseDeclaration();
+    NodeRef parseVarDeclaration();
+    NodeRef parseFunctionDeclaration();
+    NodeRef parseIfStatement();
+    NodeRef parseWhileStatement();
+    NodeRef parseForStatement();
+    NodeRef parseReturnStatement();
+    NodeRef parseBlockStatement();
+    NodeRef parseExpressionStatement();
     
     // Helper methods
-    std::vector<Parameter> parseParameterList();
-    std::vector<std::unique_ptr<Expression>> parseArgumentList();
+    ParameterList parseParameterList();
+    NodeList parseArgumentList();
+    NodeList takePending(size_t start);
     
     // Type parsing (for future type system)
-    std::string parseType();
+    Atom parseType();
     
-    // Operator precedence helpers
+    // Operator precedence helpers; 0 for tokens that are not binary operators
     int getBinaryPrecedence(TokenType type) const;
     BinaryOperator tokenToBinaryOperator(TokenType type) const;
     UnaryOperator tokenToUnaryOperator(TokenType type) const;
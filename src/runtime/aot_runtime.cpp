@@ -0,0 +1,167 @@
+#include "aot_runtime.h"
+#include "array.h"
+#include "natives.h"
+#include "object.h"
+#include "value.h"
+#include "../interpreter/interpreter.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace myndra;
+
+static_assert(sizeof(RuntimeValue) == sizeof(uint64_t), "compiled code passes values as their bits");
+
+namespace {
+
+// Takes over `count` argument references for the duration of a call
+class OwnedArgs {
+public:
+    OwnedArgs(uint64_t* args, uint32_t count) : args_(reinterpret_cast<RuntimeValue*>(args)), count_(count) {}
+    ~OwnedArgs() {
+        for (uint32_t i = 0; i < count_; ++i) {
+            args_[i].~RuntimeValue();
+        }
+    }
+
+    NativeArgs view() const { return NativeArgs(args_, count_); }
+
+private:
+    RuntimeValue* args_;
+    uint32_t count_;
+};
+
+// The inline cache of a property site, made on its first run and kept for
+// the life of the program
+PropertyCache& propertySite(void** site, const char* key, uint64_t length) {
+    if (!*site) {
+        *site = new PropertyCache(Atom::intern(std::string_view(key, length)));
+    }
+    return *static_cast<PropertyCache*>(*site);
+}
+
+} // namespace
+
+extern "C" {
+
+int myndra_rt_main(MyndraProgramBody body) {
+    try {
+        body();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout.flush();
+        std::cerr << "Runtime error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+uint64_t myndra_rt_string(const char* bytes, uint64_t length) {
+    return RuntimeValue(StringObject::make(std::string_view(bytes, length))).takeBits();
+}
+
+uint64_t myndra_rt_int(int64_t value) {
+    return RuntimeValue(value).takeBits();
+}
+
+uint64_t myndra_rt_function(const char* name, uint64_t length, uint32_t arity, uint64_t (*entry)(uint64_t* args)) {
+    auto* function = new FunctionObject(std::string(name, length), arity);
+    function->native = entry;
+    return RuntimeValue(function).takeBits();
+}
+
+uint64_t myndra_rt_binary(uint32_t op, uint64_t left, uint64_t right) {
+    RuntimeValue l = RuntimeValue::fromBits(left);
+    RuntimeValue r = RuntimeValue::fromBits(right);
+    return evaluateBinary(static_cast<BinaryOperator>(op), l, r).takeBits();
+}
+
+uint64_t myndra_rt_unary(uint32_t op, uint64_t operand) {
+    RuntimeValue value = RuntimeValue::fromBits(operand);
+    return evaluateUnary(static_cast<UnaryOperator>(op), value).takeBits();
+}
+
+uint32_t myndra_rt_truthy(uint64_t value) {
+    return runtimeValueTruthy(RuntimeValue::fromBits(value)) ? 1 : 0;
+}
+
+int64_t myndra_rt_range_bound(uint64_t value) {
+    RuntimeValue bound = RuntimeValue::fromBits(value);
+    checkRangeBounds(bound, bound);
+    return bound.asInt();
+}
+
+uint64_t myndra_rt_array(uint64_t* elements, uint32_t count) {
+    OwnedArgs owned(elements, count);
+    return ArrayObject::make(reinterpret_cast<const RuntimeValue*>(elements), count).takeBits();
+}
+
+uint64_t myndra_rt_index(uint64_t array, uint64_t index) {
+    RuntimeValue a = RuntimeValue::fromBits(array);
+    RuntimeValue i = RuntimeValue::fromBits(index);
+    return indexArray(a, i).takeBits();
+}
+
+void myndra_rt_store_index(uint64_t array, uint64_t index, uint64_t value) {
+    RuntimeValue a = RuntimeValue::fromBits(array);
+    RuntimeValue i = RuntimeValue::fromBits(index);
+    RuntimeValue v = RuntimeValue::fromBits(value);
+    storeIndex(a, i, v);
+}
+
+uint64_t myndra_rt_object(void** shape, const char* keys, uint64_t* values, uint32_t count) {
+    OwnedArgs owned(values, count);
+    if (!*shape) {
+        const Shape* built = Shape::empty();
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length;
+            std::memcpy(&length, keys, sizeof(length));
+            keys += sizeof(length);
+            built = built->add(Atom::intern(std::string_view(keys, length)));
+            keys += length;
+        }
+        *shape = const_cast<Shape*>(built);
+    }
+    return ShapedObject::make(static_cast<const Shape*>(*shape), reinterpret_cast<const RuntimeValue*>(values))
+        .takeBits();
+}
+
+uint64_t myndra_rt_get_member(uint64_t object, void** site, const char* key, uint64_t length) {
+    RuntimeValue o = RuntimeValue::fromBits(object);
+    return getProperty(o, propertySite(site, key, length)).takeBits();
+}
+
+void myndra_rt_set_member(uint64_t object, uint64_t value, void** site, const char* key, uint64_t length) {
+    RuntimeValue o = RuntimeValue::fromBits(object);
+    RuntimeValue v = RuntimeValue::fromBits(value);
+    setProperty(o, v, propertySite(site, key, length));
+}
+
+uint64_t myndra_rt_call(uint64_t callee, uint64_t* args, uint32_t count) {
+    RuntimeValue function = RuntimeValue::fromBits(callee);
+    try {
+        checkCallable(function, count);
+    } catch (...) {
+        OwnedArgs dropped(args, count);
+        throw;
+    }
+    // Only functions of this program exist, and each has a native body,
+    // which takes over the arguments
+    return function.asFunction()->native(args);
+}
+
+uint64_t myndra_rt_native(uint32_t id, uint64_t* args, uint32_t count) {
+    OwnedArgs owned(args, count);
+    return NativeRegistry::builtins().call(static_cast<uint16_t>(id), owned.view()).takeBits();
+}
+
+void myndra_rt_destroy(void* object) {
+    destroyHeapObject(static_cast<HeapObject*>(object));
+}
+
+void myndra_rt_raise(const char* message) {
+    throw std::runtime_error(message);
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef MYNDRA_AOT_RUNTIME_H
+#define MYNDRA_AOT_RUNTIME_H
+
+#include <cstdint>
+
+// Entry points natively compiled programs call into, linked from the
+// myndra_runtime library. Values cross this boundary as raw RuntimeValue
+// bits. Every value passed in is consumed (its reference moves to the
+// callee) and every value returned is owned by the caller. Runtime errors
+// are thrown as C++ exceptions and caught by myndra_rt_main.
+extern "C" {
+
+// Body of the program; its top-level code
+using MyndraProgramBody = void (*)();
+
+// Runs `body`; prints a runtime error to stderr and returns 1 if it throws
+int myndra_rt_main(MyndraProgramBody body);
+
+// Values the code cannot build inline
+uint64_t myndra_rt_string(const char* bytes, uint64_t length);
+uint64_t myndra_rt_int(int64_t value);   // Outside the 48-bit immediate range
+uint64_t myndra_rt_function(const char* name, uint64_t length, uint32_t arity, uint64_t (*entry)(uint64_t* args));
+
+// Operations the inline fast paths do not cover
+uint64_t myndra_rt_binary(uint32_t op, uint64_t left, uint64_t right);
+uint64_t myndra_rt_unary(uint32_t op, uint64_t operand);
+uint32_t myndra_rt_truthy(uint64_t value);
+// Integer value of a for loop bound; raises unless it is an integer
+int64_t myndra_rt_range_bound(uint64_t value);
+
+// Arrays; indexing raises unless the index is an integer in bounds
+uint64_t myndra_rt_array(uint64_t* elements, uint32_t count);
+uint64_t myndra_rt_index(uint64_t array, uint64_t index);
+void myndra_rt_store_index(uint64_t array, uint64_t index, uint64_t value);
+
+// Objects. Every literal and property site passes a global of its own,
+// null at first, where the runtime keeps its shape or inline cache.
+// `keys` holds a literal's property names, each a 32-bit length and then
+// its bytes; a site's key is `key` .. `key + length`.
+uint64_t myndra_rt_object(void** shape, const char* keys, uint64_t* values, uint32_t count);
+uint64_t myndra_rt_get_member(uint64_t object, void** site, const char* key, uint64_t length);
+void myndra_rt_set_member(uint64_t object, uint64_t value, void** site, const char* key, uint64_t length);
+
+// Calls through a function value, and calls to builtin natives
+uint64_t myndra_rt_call(uint64_t callee, uint64_t* args, uint32_t count);
+uint64_t myndra_rt_native(uint32_t id, uint64_t* args, uint32_t count);
+
+// Frees an object whose reference count reached zero
+void myndra_rt_destroy(void* object);
+
+[[noreturn]] void myndra_rt_raise(const char* message);
+
+}
+
+#endif // MYNDRA_AOT_RUNTIME_H
@@ -0,0 +1,233 @@
+#include "array.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace myndra {
+
+namespace {
+
+constexpr size_t kMinCapacity = 4;
+
+ArrayObject* checkedArray(const RuntimeValue& array) {
+    if (!isArray(array)) {
+        throw std::runtime_error("Only arrays can be indexed");
+    }
+    return asArray(array);
+}
+
+size_t checkedIndex(const ArrayObject* array, const RuntimeValue& index) {
+    if (!index.isInt()) {
+        throw std::runtime_error("Array index must be an integer");
+    }
+    int64_t i = index.asInt();
+    if (i < 0 || static_cast<uint64_t>(i) >= array->length) {
+        throw std::runtime_error("Array index " + std::to_string(i) + " out of bounds for length " +
+                                 std::to_string(array->length));
+    }
+    return static_cast<size_t>(i);
+}
+
+} // namespace
+
+const GcClass ArrayObject::kClass = {
+    "array",
+    [](GcObject* object, GcVisitFn visit, void* context) {
+        auto* array = static_cast<ArrayObject*>(object);
+        if (array->kind == ElementsKind::Generic) {
+            auto* slots = static_cast<RuntimeValue*>(array->data);
+            for (size_t i = 0; i < array->length; ++i) {
+                visit(slots[i], context);
+            }
+        }
+    },
+    [](GcObject* object) { static_cast<ArrayObject*>(object)->~ArrayObject(); },
+};
+
+ArrayObject::~ArrayObject() {
+    if (kind == ElementsKind::Generic) {
+        std::destroy_n(static_cast<RuntimeValue*>(data), length);
+    }
+    if (data) {
+        MemoryManager::deallocate(data, capacity * elementSize(kind));
+    }
+}
+
+RuntimeValue ArrayObject::make(const RuntimeValue* elements, size_t count) {
+    // The storage is sized and typed once, for all the elements
+    ElementsKind target = ElementsKind::Empty;
+    for (size_t i = 0; i < count && target != ElementsKind::Generic; ++i) {
+        ElementsKind element = kindOf(elements[i]);
+        target = target == ElementsKind::Empty || target == element ? element : ElementsKind::Generic;
+    }
+    RuntimeValue value = GcHeap::current().make<ArrayObject>();
+    ArrayObject* array = asArray(value);
+    if (count) {
+        array->reserve(count, target);
+        for (size_t i = 0; i < count; ++i) {
+            array->push(elements[i]);
+        }
+    }
+    return value;
+}
+
+size_t ArrayObject::elementSize(ElementsKind kind) {
+    switch (kind) {
+        case ElementsKind::Int: return sizeof(int64_t);
+        case ElementsKind::Double: return sizeof(double);
+        case ElementsKind::Bool: return sizeof(uint8_t);
+        case ElementsKind::Generic: return sizeof(RuntimeValue);
+        default: return 0;
+    }
+}
+
+ArrayObject::ElementsKind ArrayObject::kindOf(const RuntimeValue& value) {
+    if (value.isInt()) return ElementsKind::Int;
+    if (value.isDouble()) return ElementsKind::Double;
+    if (value.isBool()) return ElementsKind::Bool;
+    return ElementsKind::Generic;
+}
+
+ArrayObject::ElementsKind ArrayObject::widen(const RuntimeValue& value) const {
+    if (kind == ElementsKind::Generic) {
+        return kind;
+    }
+    ElementsKind element = kindOf(value);
+    return kind == ElementsKind::Empty || kind == element ? element : ElementsKind::Generic;
+}
+
+void ArrayObject::reserve(size_t count, ElementsKind target) {
+    if (target == kind && count <= capacity) {
+        return;
+    }
+    size_t grown = target == kind ? std::max(count, capacity * 2) : std::max(count, capacity);
+    grown = std::max(grown, kMinCapacity);
+    void* buffer = MemoryManager::current().allocate(grown * elementSize(target));
+    if (target == kind) {
+        // Values are plain bits, Generic ones included, so they can move
+        // by copying
+        std::memcpy(buffer, data, length * elementSize(kind));
+    } else {
+        // Only Empty converts to another unboxed kind, and it holds nothing
+        auto* slots = static_cast<RuntimeValue*>(buffer);
+        for (size_t i = 0; i < length; ++i) {
+            new (&slots[i]) RuntimeValue(get(i));
+        }
+    }
+    if (data) {
+        MemoryManager::deallocate(data, capacity * elementSize(kind));
+    }
+    data = buffer;
+    capacity = grown;
+    kind = target;
+}
+
+RuntimeValue ArrayObject::get(size_t index) const {
+    switch (kind) {
+        case ElementsKind::Int: return RuntimeValue(static_cast<const int64_t*>(data)[index]);
+        case ElementsKind::Double: return RuntimeValue(static_cast<const double*>(data)[index]);
+        case ElementsKind::Bool: return RuntimeValue(static_cast<const uint8_t*>(data)[index] != 0);
+        case ElementsKind::Generic: return static_cast<const RuntimeValue*>(data)[index];
+        default: return RuntimeValue();
+    }
+}
+
+void ArrayObject::set(size_t index, const RuntimeValue& value) {
+    ElementsKind target = widen(value);
+    if (target != kind) {
+        reserve(length, target);
+    }
+    switch (kind) {
+        case ElementsKind::Int:
+            static_cast<int64_t*>(data)[index] = value.asInt();
+            break;
+        case ElementsKind::Double:
+            static_cast<double*>(data)[index] = value.asDouble();
+            break;
+        case ElementsKind::Bool:
+            static_cast<uint8_t*>(data)[index] = value.asBool();
+            break;
+        default:
+            GcHeap::writeBarrier(this, value);
+            static_cast<RuntimeValue*>(data)[index] = value;
+            break;
+    }
+}
+
+void ArrayObject::push(const RuntimeValue& value) {
+    ElementsKind target = widen(value);
+    if (target != kind || length == capacity) {
+        reserve(length + 1, target);
+    }
+    switch (kind) {
+        case ElementsKind::Int:
+            static_cast<int64_t*>(data)[length] = value.asInt();
+            break;
+        case ElementsKind::Double:
+            static_cast<double*>(data)[length] = value.asDouble();
+            break;
+        case ElementsKind::Bool:
+            static_cast<uint8_t*>(data)[length] = value.asBool();
+            break;
+        default:
+            GcHeap::writeBarrier(this, value);
+            new (&static_cast<RuntimeValue*>(data)[length]) RuntimeValue(value);
+            break;
+    }
+    ++length;
+}
+
+RuntimeValue ArrayObject::pop() {
+    --length;
+    if (kind != ElementsKind::Generic) {
+        return get(length);
+    }
+    auto* slots = static_cast<RuntimeValue*>(data);
+    RuntimeValue last = std::move(slots[length]);
+    slots[length].~RuntimeValue();
+    return last;
+}
+
+RuntimeValue ArrayObject::shift() {
+    RuntimeValue first;
+    if (kind == ElementsKind::Generic) {
+        first = std::move(static_cast<RuntimeValue*>(data)[0]);  // Leaves plain bits behind
+    } else {
+        first = get(0);
+    }
+    size_t size = elementSize(kind);
+    auto* bytes = static_cast<unsigned char*>(data);
+    std::memmove(bytes, bytes + size, (length - 1) * size);
+    --length;
+    return first;
+}
+
+RuntimeValue indexArray(const RuntimeValue& array, const RuntimeValue& index) {
+    ArrayObject* object = checkedArray(array);
+    return object->get(checkedIndex(object, index));
+}
+
+void storeIndex(const RuntimeValue& array, const RuntimeValue& index, const RuntimeValue& value) {
+    ArrayObject* object = checkedArray(array);
+    object->set(checkedIndex(object, index), value);
+}
+
+RuntimeValue indexArrayUnchecked(const RuntimeValue& array, const RuntimeValue& index) {
+    return asArray(array)->get(static_cast<size_t>(index.asInt()));
+}
+
+void storeIndexUnchecked(const RuntimeValue& array, const RuntimeValue& index, const RuntimeValue& value) {
+    asArray(array)->set(static_cast<size_t>(index.asInt()), value);
+}
+
+bool indexRangeInBounds(const RuntimeValue& array, const RuntimeValue& start, const RuntimeValue& end) {
+    if (!isArray(array) || !start.isInt() || !end.isInt()) {
+        return false;
+    }
+    int64_t last = end.asInt();
+    return start.asInt() >= 0 && last >= 0 && static_cast<uint64_t>(last) <= asArray(array)->length;
+}
+
+} // namespace myndra
@@ -0,0 +1,87 @@
+#ifndef MYNDRA_ARRAY_H
+#define MYNDRA_ARRAY_H
+
+#include "gc.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace myndra {
+
+// Growable array with storage specialized to its elements.
+//
+// Like V8's elements kinds, an array remembers the most general kind of
+// element it has held and keeps its elements unboxed while they allow it:
+//
+//   Empty    nothing stored yet; takes the kind of the first element
+//   Int      int64_t per element
+//   Double   double per element (NaNs canonical, as in RuntimeValue)
+//   Bool     one byte per element
+//   Generic  RuntimeValue per element; the only kind the collector traces
+//
+// Storing an element the current kind cannot hold converts the whole
+// buffer to Generic, once; an array never goes back to a narrower kind.
+// Int and Double do not merge into a double kind, since int 1 and float
+// 1.0 are different values in Myndra.
+//
+// The buffer comes from the MemoryManager and doubles in capacity as it
+// grows. Compiled code reads `kind`, `length` and `data` directly.
+struct ArrayObject : GcObject {
+    enum class ElementsKind : uint8_t { Empty, Int, Double, Bool, Generic };
+
+    static const GcClass kClass;
+
+    ElementsKind kind = ElementsKind::Empty;
+    size_t length = 0;
+    size_t capacity = 0;
+    void* data = nullptr;
+
+    ArrayObject() : GcObject(&kClass) {}
+    ~ArrayObject();
+
+    // A new array of `count` elements, from GcHeap::current()
+    static RuntimeValue make(const RuntimeValue* elements, size_t count);
+
+    // Unchecked element access; callers check `index < length`
+    RuntimeValue get(size_t index) const;
+    void set(size_t index, const RuntimeValue& value);
+
+    void push(const RuntimeValue& value);
+    // Remove the last or the first element; the array must not be empty
+    RuntimeValue pop();
+    RuntimeValue shift();
+
+    // Narrowest kind that holds `value`
+    static ElementsKind kindOf(const RuntimeValue& value);
+    static size_t elementSize(ElementsKind kind);
+
+private:
+    // Makes room for `count` elements of `kind`, converting the elements
+    // already stored if the kind changes
+    void reserve(size_t count, ElementsKind target);
+    // Kind that holds both the current elements and `value`
+    ElementsKind widen(const RuntimeValue& value) const;
+};
+
+inline bool isArray(const RuntimeValue& value) {
+    return value.isContainer() && static_cast<GcObject*>(value.asObject())->gcClass == &ArrayObject::kClass;
+}
+
+// Unchecked; callers test isArray first
+inline ArrayObject* asArray(const RuntimeValue& value) {
+    return static_cast<ArrayObject*>(static_cast<GcObject*>(value.asObject()));
+}
+
+// Array operations shared by every engine. The checked forms raise unless
+// `array` is an array and `index` an integer within its bounds; the
+// unchecked ones are for indexes the compiler proved in bounds, and only
+// skip the bounds check.
+RuntimeValue indexArray(const RuntimeValue& array, const RuntimeValue& index);
+void storeIndex(const RuntimeValue& array, const RuntimeValue& index, const RuntimeValue& value);
+RuntimeValue indexArrayUnchecked(const RuntimeValue& array, const RuntimeValue& index);
+void storeIndexUnchecked(const RuntimeValue& array, const RuntimeValue& index, const RuntimeValue& value);
+// True if `array` is an array and every index in [start, end) is within it
+bool indexRangeInBounds(const RuntimeValue& array, const RuntimeValue& start, const RuntimeValue& end);
+
+} // namespace myndra
+
+#endif // MYNDRA_ARRAY_H
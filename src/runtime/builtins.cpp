@@ -0,0 +1,168 @@
+#include "builtins.h"
+#include "array.h"
+#include "../interpreter/interpreter.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace myndra {
+
+namespace {
+
+RuntimeValue builtinPrint(NativeArgs args, void*) {
+    size_t count = args.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) std::cout << " ";
+        if (args[i].isString()) {
+            std::cout << args[i].asString();
+        } else {
+            std::cout << runtimeValueToString(args[i]);
+        }
+    }
+    std::cout << std::endl;
+    return int64_t(0); // Return 0 as success indicator
+}
+
+RuntimeValue builtinInput(NativeArgs args, void*) {
+    size_t count = args.size();
+    // Print prompt if provided
+    if (count > 0) {
+        std::cout << runtimeValueToString(args[0]);
+    }
+    
+    std::string input;
+    std::getline(std::cin, input);
+    return input;
+}
+
+RuntimeValue builtinLength(NativeArgs args, void*) {
+    size_t count = args.size();
+    if (count != 1) {
+        throw std::runtime_error("length() expects exactly 1 argument");
+    }
+    
+    const auto& value = args[0];
+    if (value.isString()) {
+        return static_cast<int64_t>(value.asStringObject()->length);
+    } else if (isArray(value)) {
+        return static_cast<int64_t>(asArray(value)->length);
+    } else {
+        throw std::runtime_error("length() can only be called on strings and arrays");
+    }
+}
+
+RuntimeValue builtinSubstring(NativeArgs args, void*) {
+    size_t count = args.size();
+    if (count < 2 || count > 3) {
+        throw std::runtime_error("substring() expects 2 or 3 arguments: substring(string, start, [length])");
+    }
+    
+    if (!args[0].isString()) {
+        throw std::runtime_error("substring() first argument must be a string");
+    }
+    if (!args[1].isInt()) {
+        throw std::runtime_error("substring() second argument must be an integer");
+    }
+    
+    // Slices share the characters of the string they are cut from
+    int64_t size = static_cast<int64_t>(args[0].asStringObject()->length);
+    int64_t start = args[1].asInt();
+    
+    if (start < 0 || start >= size) {
+        return std::string(""); // Return empty string for out-of-bounds
+    }
+    
+    int64_t length = size - start;
+    if (count == 3) {
+        if (!args[2].isInt()) {
+            throw std::runtime_error("substring() third argument must be an integer");
+        }
+        if (args[2].asInt() < 0) {
+            return std::string("");
+        }
+        length = std::min(length, args[2].asInt());
+    }
+    return sliceString(args[0], static_cast<size_t>(start), static_cast<size_t>(length));
+}
+
+// First argument of an array builtin, which must be an array
+ArrayObject* arrayArgument(NativeArgs args, const char* name, size_t count) {
+    if (args.size() != count) {
+        throw std::runtime_error(std::string(name) + "() expects exactly " + std::to_string(count) +
+                                 (count == 1 ? " argument" : " arguments"));
+    }
+    if (!isArray(args[0])) {
+        throw std::runtime_error(std::string(name) + "() can only be called on arrays");
+    }
+    return asArray(args[0]);
+}
+
+RuntimeValue builtinPush(NativeArgs args, void*) {
+    ArrayObject* array = arrayArgument(args, "push", 2);
+    array->push(args[1]);
+    return static_cast<int64_t>(array->length);
+}
+
+RuntimeValue builtinPop(NativeArgs args, void*) {
+    ArrayObject* array = arrayArgument(args, "pop", 1);
+    if (array->length == 0) {
+        throw std::runtime_error("pop() called on an empty array");
+    }
+    return array->pop();
+}
+
+RuntimeValue builtinShift(NativeArgs args, void*) {
+    ArrayObject* array = arrayArgument(args, "shift", 1);
+    if (array->length == 0) {
+        throw std::runtime_error("shift() called on an empty array");
+    }
+    return array->shift();
+}
+
+RuntimeValue builtinSum(NativeArgs args, void*) {
+    // Unboxed kinds are summed in place; anything else goes through +
+    ArrayObject* array = arrayArgument(args, "sum", 1);
+    switch (array->kind) {
+        case ArrayObject::ElementsKind::Int: {
+            const auto* elements = static_cast<const int64_t*>(array->data);
+            uint64_t total = 0;  // Wraps like int64 addition
+            for (size_t i = 0; i < array->length; ++i) {
+                total += static_cast<uint64_t>(elements[i]);
+            }
+            return static_cast<int64_t>(total);
+        }
+        case ArrayObject::ElementsKind::Double: {
+            const auto* elements = static_cast<const double*>(array->data);
+            double total = 0.0;
+            for (size_t i = 0; i < array->length; ++i) {
+                total += elements[i];
+            }
+            return total;
+        }
+        default: {
+            if (array->length == 0) {
+                return int64_t(0);
+            }
+            RuntimeValue total = array->get(0);
+            for (size_t i = 1; i < array->length; ++i) {
+                total = evaluateBinary(BinaryOperator::Add, total, array->get(i));
+            }
+            return total;
+        }
+    }
+}
+
+} // namespace
+
+void registerBuiltins(NativeRegistry& registry) {
+    registry.define("print", builtinPrint);
+    registry.define("input", builtinInput);
+    registry.define("length", builtinLength);
+    registry.define("substring", builtinSubstring);
+    registry.define("push", builtinPush);
+    registry.define("pop", builtinPop);
+    registry.define("shift", builtinShift);
+    registry.define("sum", builtinSum);
+}
+
+} // namespace myndra
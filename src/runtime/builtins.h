@@ -0,0 +1,14 @@
+#ifndef MYNDRA_BUILTINS_H
+#define MYNDRA_BUILTINS_H
+
+#include "natives.h"
+
+namespace myndra {
+
+// Adds the core builtins (print, input, length, substring, push, pop,
+// shift, sum) to `registry`
+void registerBuiltins(NativeRegistry& registry);
+
+} // namespace myndra
+
+#endif // MYNDRA_BUILTINS_H
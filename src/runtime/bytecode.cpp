@@ -0,0 +1,115 @@
+#include "bytecode.h"
+#include "../jit/jit.h"
+#include <iomanip>
+#include <sstream>
+
+namespace myndra {
+
+const char* opcode_to_string(OpCode op) {
+    switch (op) {
+#define MYNDRA_OPCODE_NAME(name) case OpCode::name: return #name;
+        MYNDRA_OPCODES(MYNDRA_OPCODE_NAME)
+#undef MYNDRA_OPCODE_NAME
+        default: return "UNKNOWN";
+    }
+}
+
+FunctionProto::FunctionProto() = default;
+
+FunctionProto::~FunctionProto() = default;
+
+uint32_t Chunk::addConstant(const RuntimeValue& value) {
+    // Reuse an identical constant if one is already in the pool. Doubles
+    // match by bit pattern, since 0.0 == -0.0; a NaN is never shared
+    bool isDouble = value.isDouble();
+    if (!isDouble || value.asDouble() == value.asDouble()) {
+        for (size_t i = 0; i < constants.size(); ++i) {
+            bool same = isDouble ? constants[i].bits() == value.bits() : constants[i] == value;
+            if (same) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+    }
+    constants.push_back(value);
+    return static_cast<uint32_t>(constants.size() - 1);
+}
+
+size_t Chunk::emit(const Instruction& instruction) {
+    code.push_back(instruction);
+    return code.size() - 1;
+}
+
+std::string Chunk::disassemble() const {
+    std::ostringstream oss;
+    oss << "registers: " << register_count << ", constants: " << constants.size() << "\n";
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& ins = code[i];
+        oss << std::setw(4) << i << "  " << std::left << std::setw(14) << opcode_to_string(ins.op) << std::right;
+        switch (ins.op) {
+            case OpCode::LOAD_CONST:
+                oss << "r" << ins.a << ", k" << ins.bx() << " (" << runtimeValueToString(constants[ins.bx()]) << ")";
+                break;
+            case OpCode::RAISE:
+                oss << "k" << ins.bx();
+                break;
+            case OpCode::JUMP:
+                oss << "-> " << ins.bx();
+                break;
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::FOR_PREP:
+            case OpCode::FOR_LOOP:
+                oss << "r" << ins.a << ", -> " << ins.bx();
+                break;
+            case OpCode::MOVE:
+            case OpCode::NEG:
+            case OpCode::NOT:
+                oss << "r" << ins.a << ", r" << ins.b;
+                break;
+            case OpCode::GET_GLOBAL:
+            case OpCode::SET_GLOBAL:
+                oss << "r" << ins.a << ", g" << ins.bx();
+                break;
+            case OpCode::CALL:
+            case OpCode::TAIL_CALL:
+                oss << "r" << ins.a << ", argc " << ins.c;
+                break;
+            case OpCode::RETURN:
+                oss << "r" << ins.a;
+                break;
+            case OpCode::NEW_ARRAY:
+                oss << "r" << ins.a << ", r" << ins.b << ", count " << ins.c;
+                break;
+            case OpCode::NEW_OBJECT:
+                oss << "r" << ins.a << ", r" << ins.b << ", shape " << ins.c << " {";
+                for (uint32_t slot = 0; slot < shapes[ins.c]->size(); ++slot) {
+                    oss << (slot ? ", " : "") << shapes[ins.c]->key(slot).text();
+                }
+                oss << "}";
+                break;
+            case OpCode::GET_MEMBER:
+            case OpCode::SET_MEMBER:
+                oss << "r" << ins.a << ", r" << ins.b << ", ." << properties[ins.c].key.text();
+                break;
+            case OpCode::CALL_NATIVE:
+                oss << "r" << ins.a << ", native " << ins.b << ", argc " << ins.c;
+                break;
+            case OpCode::HALT:
+                break;
+            default:
+                oss << "r" << ins.a << ", r" << ins.b << ", r" << ins.c;
+                break;
+        }
+        oss << "\n";
+    }
+    
+    // Function bodies are listed after the chunk that defines them
+    for (const auto& constant : constants) {
+        if (constant.isFunction() && constant.asFunction()->proto) {
+            oss << "\nfn " << constant.asFunction()->name << "/" << constant.asFunction()->arity << ":\n"
+                << constant.asFunction()->proto->chunk.disassemble();
+        }
+    }
+    return oss.str();
+}
+
+} // namespace myndra
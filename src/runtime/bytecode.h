@@ -0,0 +1,149 @@
+#ifndef MYNDRA_BYTECODE_H
+#define MYNDRA_BYTECODE_H
+
+#include "../interpreter/interpreter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace myndra {
+
+// Register-based instruction set. Every instruction names its operands
+// directly as register indices, so `a = b + c` is a single dispatch.
+//
+//   A, B, C   register operands (16 bit)
+//   Bx        32-bit operand packed into B/C (constant index or jump target)
+//   G         registers of the top-level frame, addressed from any function
+//
+// A for loop keeps its counter, end bound and variable in R[A] .. R[A + 2].
+// FOR_PREP raises unless both bounds are integers; FOR_LOOP needs no
+// overflow check, since the counter it steps is below the end bound.
+//
+// GET_INDEX and SET_INDEX raise unless R[B] (R[A]) is an array and the index
+// is an integer within it. The _UNCHECKED forms are only emitted for
+// indexes the compiler proved in bounds: a loop whose body indexes arrays
+// with its variable, and can neither rebind nor shrink them, tests every
+// such array against the range once with IN_BOUNDS and runs a copy of the
+// body without the checks if all hold.
+//
+// Property sites name an inline cache of the chunk in C, and NEW_OBJECT a
+// shape; GET_MEMBER raises unless R[B] is an object with the cached key.
+#define MYNDRA_OPCODES(X) \
+    X(LOAD_CONST)   /* R[A] = K[Bx]                                   */ \
+    X(MOVE)         /* R[A] = R[B]                                    */ \
+    X(ADD)          /* R[A] = R[B] + R[C]                             */ \
+    X(SUB)          /* R[A] = R[B] - R[C]                             */ \
+    X(MUL)          /* R[A] = R[B] * R[C]                             */ \
+    X(DIV)          /* R[A] = R[B] / R[C]                             */ \
+    X(EQ)           /* R[A] = R[B] == R[C]                            */ \
+    X(NE)           /* R[A] = R[B] != R[C]                            */ \
+    X(LT)           /* R[A] = R[B] < R[C]                             */ \
+    X(LE)           /* R[A] = R[B] <= R[C]                            */ \
+    X(GT)           /* R[A] = R[B] > R[C]                             */ \
+    X(GE)           /* R[A] = R[B] >= R[C]                            */ \
+    X(ADD_FLOAT)    /* R[A] = R[B] + R[C], both proven doubles        */ \
+    X(SUB_FLOAT)    /* R[A] = R[B] - R[C], both proven doubles        */ \
+    X(MUL_FLOAT)    /* R[A] = R[B] * R[C], both proven doubles        */ \
+    X(DIV_FLOAT)    /* R[A] = R[B] / R[C], both proven doubles        */ \
+    X(LT_FLOAT)     /* R[A] = R[B] < R[C], both proven doubles        */ \
+    X(LE_FLOAT)     /* R[A] = R[B] <= R[C], both proven doubles       */ \
+    X(GT_FLOAT)     /* R[A] = R[B] > R[C], both proven doubles        */ \
+    X(GE_FLOAT)     /* R[A] = R[B] >= R[C], both proven doubles       */ \
+    X(AND)          /* R[A] = truthy(R[B]) && truthy(R[C])            */ \
+    X(OR)           /* R[A] = truthy(R[B]) || truthy(R[C])            */ \
+    X(NEG)          /* R[A] = -R[B]                                   */ \
+    X(NOT)          /* R[A] = !truthy(R[B])                           */ \
+    X(JUMP)         /* pc = Bx                                        */ \
+    X(JUMP_IF_FALSE)/* if !truthy(R[A]) pc = Bx                       */ \
+    X(FOR_PREP)     /* R[A+2] = R[A] if R[A] < R[A+1], else pc = Bx   */ \
+    X(FOR_LOOP)     /* ++R[A]; if R[A] < R[A+1] {R[A+2]=R[A]; pc=Bx}  */ \
+    X(GET_GLOBAL)   /* R[A] = G[Bx]                                   */ \
+    X(SET_GLOBAL)   /* G[Bx] = R[A]                                   */ \
+    X(NEW_ARRAY)    /* R[A] = [R[B] .. R[B + C - 1]]                  */ \
+    X(GET_INDEX)    /* R[A] = R[B][R[C]]                              */ \
+    X(SET_INDEX)    /* R[A][R[B]] = R[C]                              */ \
+    X(GET_INDEX_UNCHECKED) /* R[A] = R[B][R[C]], proven in bounds     */ \
+    X(SET_INDEX_UNCHECKED) /* R[A][R[B]] = R[C], proven in bounds     */ \
+    X(IN_BOUNDS)    /* R[A] = R[B] is an array holding R[C] .. R[C+1]-1 */ \
+    X(NEW_OBJECT)   /* R[A] = object of shape S[C], slots from R[B].. */ \
+    X(GET_MEMBER)   /* R[A] = R[B].key of P[C]                        */ \
+    X(SET_MEMBER)   /* R[A].key of P[C] = R[B]                        */ \
+    X(CALL)         /* R[A] = R[A](R[A + 1] .. R[A + C])              */ \
+    X(TAIL_CALL)    /* return R[A](R[A + 1] .. R[A + C]) in place     */ \
+    X(RETURN)       /* return R[A] to the caller                      */ \
+    X(CALL_NATIVE)  /* R[A] = native[B](R[A] .. R[A + C - 1])         */ \
+    X(RAISE)        /* throw runtime_error(K[Bx])                     */ \
+    X(HALT)         /* stop execution                                 */
+
+enum class OpCode : uint8_t {
+#define MYNDRA_OPCODE_ENUM(name) name,
+    MYNDRA_OPCODES(MYNDRA_OPCODE_ENUM)
+#undef MYNDRA_OPCODE_ENUM
+    COUNT
+};
+
+const char* opcode_to_string(OpCode op);
+
+// Fixed-width 8 byte instruction
+struct Instruction {
+    OpCode op;
+    uint8_t reserved = 0;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint16_t c = 0;
+
+    Instruction() : op(OpCode::HALT) {}
+    Instruction(OpCode o, uint16_t ra, uint16_t rb = 0, uint16_t rc = 0)
+        : op(o), a(ra), b(rb), c(rc) {}
+
+    static Instruction wide(OpCode o, uint16_t ra, uint32_t bx) {
+        return Instruction(o, ra, static_cast<uint16_t>(bx & 0xFFFF), static_cast<uint16_t>(bx >> 16));
+    }
+
+    uint32_t bx() const { return static_cast<uint32_t>(b) | (static_cast<uint32_t>(c) << 16); }
+    void setBx(uint32_t value) {
+        b = static_cast<uint16_t>(value & 0xFFFF);
+        c = static_cast<uint16_t>(value >> 16);
+    }
+};
+
+static_assert(sizeof(Instruction) == 8, "Instruction must stay 8 bytes");
+
+// A compiled unit of bytecode
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<RuntimeValue> constants;
+    uint32_t register_count = 0;    // Registers needed to run this chunk
+    std::vector<const Shape*> shapes;   // S: shapes of the object literals
+    // P: inline cache of each property site, filled in as the chunk runs;
+    // compiled code points into it, so it must not grow once compiled
+    mutable std::vector<PropertyCache> properties;
+
+    uint32_t addConstant(const RuntimeValue& value);
+    size_t emit(const Instruction& instruction);
+
+    std::string disassemble() const;
+};
+
+class JitCode;
+
+// Compiled body of a user function. Parameters arrive in R[0] .. R[arity - 1]
+// and the callee value itself sits in the register just below R[0].
+struct FunctionProto {
+    std::string name;
+    uint32_t arity = 0;
+    Chunk chunk;
+
+    // Kept by the JIT
+    uint32_t hotness = 0;           // Calls and loop back-edges so far
+    bool jitFailed = false;         // Has an instruction the JIT cannot compile
+    std::unique_ptr<JitCode> jit;   // Machine code, once the function is hot
+
+    FunctionProto();
+    ~FunctionProto();
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_BYTECODE_H
@@ -0,0 +1,501 @@
+#include "gc.h"
+#include <algorithm>
+
+namespace myndra {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kChunkBytes = 256 * 1024;          // Chunks are aligned to their size
+constexpr size_t kAlignment = 16;
+constexpr size_t kLargeObjectBytes = kChunkBytes / 4;   // Bigger objects get a chunk of their own
+constexpr size_t kSliceBytes = 64 * 1024;           // Allocation between incremental slices
+// Objects a slice handles whatever the budget: four passes over as many
+// objects as one slice's allocation can promote, so cycles outpace the
+// mutator instead of growing with it
+constexpr size_t kMinSliceWork = 4 * kSliceBytes / sizeof(GcObject);
+constexpr size_t kMinMajorBytes = 4 * 1024 * 1024;  // Chunk memory in use that starts the first cycle
+constexpr size_t kSpareChunks = 4;
+constexpr size_t kChunkHeaderBytes = 64;             // Keeps objects 16-byte aligned
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+GcObject* objectOf(GcLinks* links) {
+    return static_cast<GcObject*>(links);
+}
+
+GcObject* containerOf(const RuntimeValue& value) {
+    return value.isContainer() ? static_cast<GcObject*>(value.asObject()) : nullptr;
+}
+
+void unlink(GcLinks* links) {
+    links->prev->next = links->next;
+    links->next->prev = links->prev;
+    links->prev = links->next = links;
+}
+
+void pushBack(GcLinks& list, GcLinks* links) {
+    links->prev = list.prev;
+    links->next = &list;
+    list.prev->next = links;
+    list.prev = links;
+}
+
+// Moves every object of `from` to the end of `to`
+void spliceBack(GcLinks& to, GcLinks& from) {
+    if (from.next == &from) {
+        return;
+    }
+    from.next->prev = to.prev;
+    to.prev->next = from.next;
+    from.prev->next = &to;
+    to.prev = from.prev;
+    from.prev = from.next = &from;
+}
+
+} // namespace
+
+// Header at the start of every chunk; objects follow it
+struct GcHeap::Chunk {
+    GcHeap* heap;
+    unsigned char* top;     // Next free byte
+    unsigned char* end;
+    size_t bytes;           // Size of the whole region
+    size_t liveObjects = 0;
+    Chunk* prev = nullptr;  // chunks_ list
+    Chunk* next = nullptr;
+};
+
+GcHeap::GcHeap() : GcHeap(Config()) {}
+
+GcHeap::GcHeap(const Config& config) : config_(config), majorThreshold_(kMinMajorBytes) {}
+
+GcHeap::~GcHeap() {
+    phase_ = Phase::Idle;
+    cursor_ = nullptr;
+    markStack_.clear();
+
+    // Whatever is left is garbage cycles: break them all
+    std::vector<GcObject*> remaining;
+    for (GcLinks* list : {&young_, &old_, &collecting_}) {
+        for (GcLinks* links = list->next; links != list; links = links->next) {
+            remaining.push_back(objectOf(links));
+        }
+    }
+    freeGarbage(remaining);
+
+    while (chunks_) {
+        freeChunk(chunks_);
+    }
+    for (Chunk* chunk : spareChunks_) {
+        ::operator delete(chunk, std::align_val_t(kChunkBytes));
+    }
+}
+
+GcHeap& GcHeap::of(const GcObject* object) {
+    return *chunkOf(object)->heap;
+}
+
+GcHeap& GcHeap::threadHeap() {
+    // Never destroyed: its containers may outlive the thread's statics
+    thread_local GcHeap* heap = new GcHeap();
+    return *heap;
+}
+
+GcHeap::Chunk* GcHeap::chunkOf(const void* address) {
+    return reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(address) & ~uintptr_t(kChunkBytes - 1));
+}
+
+// Allocation
+GcHeap::Chunk* GcHeap::newChunk(size_t bytes) {
+    static_assert(sizeof(Chunk) <= kChunkHeaderBytes, "objects would overlap the chunk header");
+    void* region = ::operator new(bytes, std::align_val_t(kChunkBytes));
+    Chunk* chunk = new (region) Chunk();
+    chunk->heap = this;
+    chunk->top = static_cast<unsigned char*>(region) + kChunkHeaderBytes;
+    chunk->end = static_cast<unsigned char*>(region) + bytes;
+    chunk->bytes = bytes;
+    stats_.reservedBytes += bytes;
+    linkChunk(chunk);
+    return chunk;
+}
+
+void GcHeap::linkChunk(Chunk* chunk) {
+    chunkBytes_ += chunk->bytes;
+    chunk->prev = nullptr;
+    chunk->next = chunks_;
+    if (chunks_) {
+        chunks_->prev = chunk;
+    }
+    chunks_ = chunk;
+}
+
+void GcHeap::unlinkChunk(Chunk* chunk) {
+    chunkBytes_ -= chunk->bytes;
+    if (chunk->prev) {
+        chunk->prev->next = chunk->next;
+    } else {
+        chunks_ = chunk->next;
+    }
+    if (chunk->next) {
+        chunk->next->prev = chunk->prev;
+    }
+    chunk->prev = chunk->next = nullptr;
+}
+
+void GcHeap::freeChunk(Chunk* chunk) {
+    unlinkChunk(chunk);
+    stats_.reservedBytes -= chunk->bytes;
+    ::operator delete(chunk, std::align_val_t(kChunkBytes));
+}
+
+void GcHeap::retireChunk(Chunk* chunk) {
+    // Keep a few empty nursery-sized chunks around instead of returning them
+    if (chunk->bytes != kChunkBytes || spareChunks_.size() >= kSpareChunks) {
+        freeChunk(chunk);
+        return;
+    }
+    unlinkChunk(chunk);
+    chunk->top = reinterpret_cast<unsigned char*>(chunk) + kChunkHeaderBytes;
+    spareChunks_.push_back(chunk);
+}
+
+void* GcHeap::allocate(size_t size) {
+    size = alignUp(size, kAlignment);
+
+    // Collect before handing out memory, so the new object is never seen
+    // half-built
+    if (youngBytes_ >= config_.nurseryBytes) {
+        auto start = Clock::now();
+        collectYoung();
+        if (!cycleActive() && chunkBytes_ >= majorThreshold_) {
+            beginCycle();
+        }
+        recordPause(start);
+    }
+    if (cycleActive() && sinceSlice_ >= kSliceBytes) {
+        auto start = Clock::now();
+        sinceSlice_ = 0;
+        ++stats_.incrementalSlices;
+        if (advanceCycle(start + config_.pauseBudget)) {
+            finishCycle();
+        }
+        recordPause(start);
+    }
+
+    stats_.bytesAllocated += size;
+    youngBytes_ += size;
+    sinceSlice_ += size;
+
+    if (size > kLargeObjectBytes) {
+        Chunk* chunk = newChunk(alignUp(kChunkHeaderBytes + size, kChunkBytes));
+        void* memory = chunk->top;
+        chunk->top += size;
+        return memory;
+    }
+
+    if (!nursery_ || size > static_cast<size_t>(nursery_->end - nursery_->top)) {
+        Chunk* previous = nursery_;
+        if (!spareChunks_.empty()) {
+            nursery_ = spareChunks_.back();
+            spareChunks_.pop_back();
+            linkChunk(nursery_);
+        } else {
+            nursery_ = newChunk(kChunkBytes);
+        }
+        if (previous && previous->liveObjects == 0) {
+            retireChunk(previous);
+        }
+    }
+    void* memory = nursery_->top;
+    nursery_->top += size;
+    return memory;
+}
+
+void GcHeap::track(GcObject* object, size_t size) {
+    object->size = static_cast<uint32_t>(alignUp(size, kAlignment));
+    object->generation = GcObject::Young;
+    pushBack(young_, object);
+    chunkOf(object)->liveObjects++;
+    stats_.liveBytes += object->size;
+}
+
+void GcHeap::destroy(GcObject* object) {
+    GcHeap& heap = of(object);
+    if (heap.freeing_) {
+        heap.pendingFree_.push_back(object);
+        return;
+    }
+    heap.freeing_ = true;
+    heap.release(object);
+    while (!heap.pendingFree_.empty()) {
+        GcObject* next = heap.pendingFree_.back();
+        heap.pendingFree_.pop_back();
+        heap.release(next);
+    }
+    heap.freeing_ = false;
+}
+
+void GcHeap::release(GcObject* object) {
+    if (cursor_ == object) {
+        cursor_ = object->next;
+    }
+    unlink(object);
+    stats_.liveBytes -= object->size;
+
+    Chunk* chunk = chunkOf(object);
+    object->gcClass->destroy(object);
+    if (--chunk->liveObjects == 0 && chunk != nursery_) {
+        retireChunk(chunk);
+    }
+}
+
+// Collection
+std::vector<GcObject*> GcHeap::unreachable(const std::vector<GcObject*>& set, uint8_t generation) {
+    struct Walk {
+        uint8_t generation;
+        std::vector<GcObject*> stack;
+    } walk{generation, {}};
+
+    for (GcObject* object : set) {
+        object->gcRefs = static_cast<int32_t>(object->refcount);
+        object->flags &= ~GcObject::Reachable;
+    }
+
+    // What is left of a count after removing the set's own references
+    // comes from outside the set
+    for (GcObject* object : set) {
+        object->gcClass->trace(object, [](RuntimeValue& field, void* context) {
+            GcObject* child = containerOf(field);
+            if (child && child->generation == static_cast<Walk*>(context)->generation) {
+                --child->gcRefs;
+            }
+        }, &walk);
+    }
+
+    for (GcObject* root : set) {
+        if (root->gcRefs <= 0 || (root->flags & GcObject::Reachable)) {
+            continue;
+        }
+        root->flags |= GcObject::Reachable;
+        walk.stack.push_back(root);
+        while (!walk.stack.empty()) {
+            GcObject* object = walk.stack.back();
+            walk.stack.pop_back();
+            object->gcClass->trace(object, [](RuntimeValue& field, void* context) {
+                auto* walk = static_cast<Walk*>(context);
+                GcObject* child = containerOf(field);
+                if (child && child->generation == walk->generation && !(child->flags & GcObject::Reachable)) {
+                    child->flags |= GcObject::Reachable;
+                    walk->stack.push_back(child);
+                }
+            }, &walk);
+        }
+    }
+
+    std::vector<GcObject*> garbage;
+    for (GcObject* object : set) {
+        if (!(object->flags & GcObject::Reachable)) {
+            garbage.push_back(object);
+        }
+    }
+    return garbage;
+}
+
+void GcHeap::freeGarbage(const std::vector<GcObject*>& garbage) {
+    // Hold every object while the cycles are cut, then let the counts
+    // free them
+    std::vector<RuntimeValue> held;
+    held.reserve(garbage.size());
+    for (GcObject* object : garbage) {
+        held.push_back(RuntimeValue::share(object));
+    }
+    for (GcObject* object : garbage) {
+        object->gcClass->trace(object, [](RuntimeValue& field, void*) { field = RuntimeValue(); }, nullptr);
+    }
+    stats_.objectsCollected += garbage.size();
+}
+
+void GcHeap::collectYoung() {
+    std::vector<GcObject*> young;
+    for (GcLinks* links = young_.next; links != &young_; links = links->next) {
+        young.push_back(objectOf(links));
+    }
+    freeGarbage(unreachable(young, GcObject::Young));
+
+    // Survivors are promoted in place
+    for (GcLinks* links = young_.next; links != &young_; links = links->next) {
+        GcObject* object = objectOf(links);
+        object->generation = GcObject::Old;
+        object->flags = 0;
+        stats_.bytesPromoted += object->size;
+    }
+    spliceBack(old_, young_);
+    youngBytes_ = 0;
+    ++stats_.minorCollections;
+}
+
+void GcHeap::beginCycle() {
+    // The cycle works on the old generation as it is now; later promotions
+    // wait for the next one
+    spliceBack(collecting_, old_);
+    phase_ = Phase::Scan;
+    cursor_ = collecting_.next;
+}
+
+bool GcHeap::advanceCycle(Clock::time_point deadline) {
+    size_t work = 0;
+    auto expired = [&] { return ++work >= kMinSliceWork && (work & 63) == 0 && Clock::now() >= deadline; };
+
+    struct Subtract {
+        static void visit(RuntimeValue& field, void*) {
+            GcObject* child = containerOf(field);
+            if (child && child->generation == GcObject::Collecting) {
+                --child->gcRefs;
+            }
+        }
+    };
+
+    for (;;) {
+        switch (phase_) {
+            case Phase::Idle:
+                return true;
+            case Phase::Scan:
+                // Snapshot the counts
+                while (cursor_ != &collecting_) {
+                    GcObject* object = objectOf(cursor_);
+                    object->generation = GcObject::Collecting;
+                    object->gcRefs = static_cast<int32_t>(object->refcount);
+                    object->flags = 0;
+                    cursor_ = cursor_->next;
+                    if (expired()) return false;
+                }
+                phase_ = Phase::Subtract;
+                cursor_ = collecting_.next;
+                break;
+            case Phase::Subtract:
+                // Remove references held inside the generation
+                while (cursor_ != &collecting_) {
+                    GcObject* object = objectOf(cursor_);
+                    cursor_ = cursor_->next;
+                    object->gcClass->trace(object, Subtract::visit, nullptr);
+                    if (expired()) return false;
+                }
+                phase_ = Phase::Mark;
+                cursor_ = collecting_.next;
+                break;
+            case Phase::Mark:
+                // Objects with outside references, or written to since the
+                // snapshot, are roots; mark what they reach
+                for (;;) {
+                    while (!markStack_.empty()) {
+                        RuntimeValue held = std::move(markStack_.back());
+                        markStack_.pop_back();
+                        GcObject* object = containerOf(held);
+                        object->gcClass->trace(object, [](RuntimeValue& field, void* context) {
+                            GcObject* child = containerOf(field);
+                            if (child && child->generation == GcObject::Collecting) {
+                                static_cast<GcHeap*>(context)->shade(child);
+                            }
+                        }, this);
+                        if (expired()) return false;
+                    }
+                    if (cursor_ == &collecting_) {
+                        return true;
+                    }
+                    GcObject* object = objectOf(cursor_);
+                    cursor_ = cursor_->next;
+                    if (object->gcRefs > 0 || (object->flags & GcObject::Pinned)) {
+                        shade(object);
+                    }
+                    if (expired()) return false;
+                }
+        }
+    }
+}
+
+void GcHeap::shade(GcObject* object) {
+    if (phase_ == Phase::Mark) {
+        if (!(object->flags & GcObject::Reachable)) {
+            object->flags |= GcObject::Reachable;
+            markStack_.push_back(RuntimeValue::share(object));
+        }
+    } else {
+        object->flags |= GcObject::Pinned;
+    }
+}
+
+void GcHeap::recordWrite(GcObject* container, const RuntimeValue& value) {
+    shade(container);
+    GcObject* stored = containerOf(value);
+    if (stored && stored->generation == GcObject::Collecting) {
+        shade(stored);
+    }
+}
+
+void GcHeap::finishCycle() {
+    // The mutator ran between slices, so recheck what the cycle did not
+    // reach against the counts as they are now; only this step frees
+    std::vector<GcObject*> candidates;
+    for (GcLinks* links = collecting_.next; links != &collecting_; links = links->next) {
+        GcObject* object = objectOf(links);
+        if (!(object->flags & GcObject::Reachable)) {
+            object->generation = GcObject::Candidate;
+            candidates.push_back(object);
+        }
+    }
+    freeGarbage(unreachable(candidates, GcObject::Candidate));
+
+    // Pace the next cycle by the chunks what survived this one keeps, not
+    // by what was promoted while it ran
+    std::vector<Chunk*> survivorChunks;
+    for (GcLinks* links = collecting_.next; links != &collecting_; links = links->next) {
+        GcObject* object = objectOf(links);
+        object->generation = GcObject::Old;
+        object->flags = 0;
+        survivorChunks.push_back(chunkOf(object));
+    }
+    std::sort(survivorChunks.begin(), survivorChunks.end());
+    survivorChunks.erase(std::unique(survivorChunks.begin(), survivorChunks.end()), survivorChunks.end());
+    size_t survivorBytes = 0;
+    for (Chunk* chunk : survivorChunks) {
+        survivorBytes += chunk->bytes;
+    }
+    spliceBack(old_, collecting_);
+    phase_ = Phase::Idle;
+    cursor_ = nullptr;
+    majorThreshold_ = std::max(kMinMajorBytes, survivorBytes * 2);
+    ++stats_.majorCollections;
+}
+
+void GcHeap::collect() {
+    auto start = Clock::now();
+    collectYoung();
+    // A running cycle does not cover what was promoted since it began
+    if (cycleActive()) {
+        advanceCycle(Clock::time_point::max());
+        finishCycle();
+    }
+    beginCycle();
+    advanceCycle(Clock::time_point::max());
+    finishCycle();
+    recordPause(start);
+}
+
+void GcHeap::recordPause(Clock::time_point start) {
+    auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    stats_.totalPause += pause;
+    stats_.maxPause = std::max(stats_.maxPause, pause);
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(pause).count();
+    size_t bucket = 0;
+    while (bucket < kPauseBucketLimits.size() && micros >= kPauseBucketLimits[bucket]) {
+        ++bucket;
+    }
+    ++stats_.pauseHistogram[bucket];
+}
+
+} // namespace myndra
@@ -0,0 +1,229 @@
+#ifndef MYNDRA_GC_H
+#define MYNDRA_GC_H
+
+#include "value.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myndra {
+
+struct GcObject;
+
+// Called for every RuntimeValue field of a container
+using GcVisitFn = void (*)(RuntimeValue& field, void* context);
+
+// Describes one container type (array, object, closure) to the collector
+struct GcClass {
+    const char* name;
+    // Calls `visit` on every RuntimeValue the object holds
+    void (*trace)(GcObject* object, GcVisitFn visit, void* context);
+    // Runs the object's destructor; the heap reclaims the memory
+    void (*destroy)(GcObject* object);
+};
+
+// Links of the generation list an object is on
+struct GcLinks {
+    GcLinks* prev = this;
+    GcLinks* next = this;
+};
+
+// Header of a heap object that holds other values and can therefore end up
+// in a reference cycle. Containers are reference counted like every other
+// object; the collector only exists to find cycles that counting misses.
+struct GcObject : HeapObject, GcLinks {
+    enum Generation : uint8_t {
+        Young,       // Allocated since the last minor collection
+        Old,         // Survived a minor collection
+        Collecting,  // Part of the running old-generation cycle
+        Candidate    // Unreached by that cycle, being rechecked
+    };
+    enum Flags : uint8_t {
+        Reachable = 1,  // Reached from an outside reference
+        Pinned = 2      // Written during the running cycle; kept alive by it
+    };
+
+    const GcClass* gcClass;
+    uint32_t size = 0;    // Bytes taken from the heap
+    int32_t gcRefs = 0;   // Scratch reference count during a collection
+    uint8_t generation = Young;
+    uint8_t flags = 0;
+
+    explicit GcObject(const GcClass* cls) : HeapObject(Kind::Container), gcClass(cls) {}
+};
+
+// Heap for containers, with a generational, incremental cycle collector.
+//
+// Every reference a C++ frame, register or temporary holds is a counted
+// RuntimeValue, so the roots need no enumeration: an object is referenced
+// from outside a set of containers exactly when its reference count exceeds
+// the number of references the set's own fields hold to it (trial deletion).
+// This stays precise without stack maps, and collections can run inside
+// any allocation.
+//
+// New containers are bump-allocated in the nursery. When Config::nurseryBytes
+// have been allocated, a minor collection frees the cycles among the young
+// containers and promotes the survivors. Objects never move, since C++
+// code holds raw pointers to them. Promotion only relabels an object, and
+// a chunk is recycled once all its objects are dead. A single survivor
+// therefore keeps its whole chunk, so old-generation cycles are paced by
+// the chunk memory in use rather than by the bytes promoted.
+//
+// The old generation is collected in slices, each bounded by the pause
+// budget. A write barrier pins containers stored to while a cycle runs,
+// which keeps its result accurate. Before anything is freed, the unreached
+// set is rechecked against the current reference counts in one step. That
+// recheck is what makes freeing safe, whatever the mutator did between
+// slices.
+class GcHeap {
+public:
+    struct Config {
+        size_t nurseryBytes = 1 << 20;                 // Allocation between minor collections
+        std::chrono::microseconds pauseBudget{1000};   // Longest incremental slice
+    };
+
+    // Pause histogram buckets: bucket i counts pauses shorter than
+    // kPauseBucketLimits[i] microseconds, the last bucket everything longer
+    static constexpr size_t kPauseBuckets = 8;
+    static constexpr std::array<uint32_t, kPauseBuckets - 1> kPauseBucketLimits = {10, 50, 100, 500, 1000, 5000, 10000};
+
+    struct Stats {
+        size_t minorCollections = 0;
+        size_t majorCollections = 0;       // Completed old-generation cycles
+        size_t incrementalSlices = 0;
+        size_t bytesAllocated = 0;
+        size_t bytesPromoted = 0;
+        size_t objectsCollected = 0;       // Freed by the collector rather than by counting
+        size_t liveBytes = 0;
+        size_t reservedBytes = 0;          // Chunk memory held from the system
+        std::chrono::nanoseconds totalPause{0};
+        std::chrono::nanoseconds maxPause{0};
+        std::array<size_t, kPauseBuckets> pauseHistogram{};
+    };
+
+    GcHeap();
+    explicit GcHeap(const Config& config);
+    // Every value pointing into the heap must be gone by now
+    ~GcHeap();
+
+    GcHeap(const GcHeap&) = delete;
+    GcHeap& operator=(const GcHeap&) = delete;
+
+    // Allocates and constructs a container. May run a collection first,
+    // so callers must keep the containers they use in RuntimeValues.
+    template <typename T, typename... Args>
+    RuntimeValue make(Args&&... args) {
+        static_assert(std::is_base_of_v<GcObject, T>);
+        void* memory = allocate(sizeof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        track(object, sizeof(T));
+        return RuntimeValue(static_cast<HeapObject*>(object));
+    }
+
+    // Call before storing `value` into a field of `container`
+    static void writeBarrier(GcObject* container, const RuntimeValue& value) {
+        if (container->generation == GcObject::Collecting) {
+            of(container).recordWrite(container, value);
+        }
+    }
+
+    // Runs a minor collection and a complete old-generation cycle at once
+    void collect();
+
+    bool cycleActive() const { return phase_ != Phase::Idle; }
+    const Stats& stats() const { return stats_; }
+
+    // Heap owning `object`
+    static GcHeap& of(const GcObject* object);
+    // Heap that containers created on this thread come from: the innermost
+    // Scope's, else one the thread keeps for good
+    static GcHeap& current() { return currentHeap ? *currentHeap : threadHeap(); }
+
+    // Makes `heap` current on this thread for the scope's lifetime
+    class Scope {
+    public:
+        explicit Scope(GcHeap& heap) : previous_(currentHeap) { currentHeap = &heap; }
+        ~Scope() { currentHeap = previous_; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GcHeap* previous_;
+    };
+    // Frees a container whose reference count dropped to zero
+    static void destroy(GcObject* object);
+
+private:
+    struct Chunk;
+
+    enum class Phase : uint8_t { Idle, Scan, Subtract, Mark };
+
+    inline static thread_local GcHeap* currentHeap = nullptr;
+
+    Config config_;
+    Stats stats_;
+
+    // Generation lists (sentinels)
+    GcLinks young_;
+    GcLinks old_;
+    GcLinks collecting_;
+
+    // Chunks holding objects, the one being bump-allocated from, and a few
+    // empty ones kept for reuse
+    Chunk* chunks_ = nullptr;
+    Chunk* nursery_ = nullptr;
+    std::vector<Chunk*> spareChunks_;
+
+    size_t youngBytes_ = 0;       // Allocated since the last minor collection
+    size_t chunkBytes_ = 0;       // Size of the chunks holding objects
+    size_t majorThreshold_;       // chunkBytes_ that starts the next cycle
+    size_t sinceSlice_ = 0;       // Allocated since the last slice
+
+    // Old-generation cycle in progress
+    Phase phase_ = Phase::Idle;
+    GcLinks* cursor_ = nullptr;
+    std::vector<RuntimeValue> markStack_;   // Holds its objects alive
+
+    // Objects whose count hit zero while another was being freed; freeing
+    // them from a loop keeps long chains from recursing
+    bool freeing_ = false;
+    std::vector<GcObject*> pendingFree_;
+
+    static GcHeap& threadHeap();
+
+    void* allocate(size_t size);
+    void track(GcObject* object, size_t size);
+    void release(GcObject* object);
+
+    static Chunk* chunkOf(const void* address);
+    Chunk* newChunk(size_t bytes);
+    void linkChunk(Chunk* chunk);
+    void unlinkChunk(Chunk* chunk);
+    void retireChunk(Chunk* chunk);
+    void freeChunk(Chunk* chunk);
+
+    void collectYoung();
+    void beginCycle();
+    // Works on the running cycle until `deadline`; returns true once done
+    bool advanceCycle(std::chrono::steady_clock::time_point deadline);
+    void finishCycle();
+    void recordWrite(GcObject* container, const RuntimeValue& value);
+    void shade(GcObject* object);
+
+    // Trial deletion over the objects of `set`, whose generation is
+    // `generation`: returns the ones no outside reference reaches
+    static std::vector<GcObject*> unreachable(const std::vector<GcObject*>& set, uint8_t generation);
+    void freeGarbage(const std::vector<GcObject*>& garbage);
+
+    void recordPause(std::chrono::steady_clock::time_point start);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_GC_H
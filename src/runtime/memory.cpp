@@ -0,0 +1,228 @@
+#include "memory.h"
+#include <new>
+#include <unordered_map>
+#include <utility>
+
+namespace myndra {
+
+namespace {
+
+static_assert(MemoryManager::kGranule >= sizeof(void*) * 2, "slab and large block headers must fit a granule");
+
+std::atomic<uint64_t> nextManagerId{1};
+
+// Managers alive right now, by id. Leaked like the global manager, since
+// threads may still exit while statics are being destroyed.
+std::mutex& registryMutex() {
+    static auto* mutex = new std::mutex();
+    return *mutex;
+}
+
+std::unordered_map<uint64_t, MemoryManager*>& liveManagers() {
+    static auto* managers = new std::unordered_map<uint64_t, MemoryManager*>();
+    return *managers;
+}
+
+// Set once this thread's exit hook has run
+thread_local bool threadExiting = false;
+
+} // namespace
+
+// Hands a thread's magazines back to their managers when the thread exits,
+// so the blocks they hold are not stranded
+struct ThreadExit {
+    std::vector<std::pair<uint64_t, MemoryManager::ThreadCache*>> caches;
+
+    ~ThreadExit() {
+        threadExiting = true;
+        MemoryManager::cacheSlots = {};
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto& [id, cache] : caches) {
+            auto found = liveManagers().find(id);
+            if (found != liveManagers().end()) {
+                found->second->releaseThreadCache(cache);
+            }
+        }
+    }
+};
+
+namespace {
+
+thread_local ThreadExit threadExit;
+
+} // namespace
+
+MemoryManager::MemoryManager() : id_(nextManagerId.fetch_add(1, std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    liveManagers().emplace(id_, this);
+}
+
+MemoryManager::~MemoryManager() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        liveManagers().erase(id_);
+    }
+    releaseAll();
+    for (ThreadCache* cache : caches_) {
+        delete cache;
+    }
+}
+
+MemoryManager& MemoryManager::global() {
+    // Never destroyed: objects may still be freed during static destruction
+    static auto* manager = new MemoryManager();
+    return *manager;
+}
+
+MemoryManager::ThreadCache& MemoryManager::findThreadCache() {
+    std::thread::id self = std::this_thread::get_id();
+    ThreadCache* cache = nullptr;
+    bool created = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (ThreadCache* candidate : caches_) {
+            if (candidate->owner == self) {
+                cache = candidate;
+                break;
+            }
+        }
+        if (!cache) {
+            cache = new ThreadCache();
+            cache->owner = self;
+            caches_.push_back(cache);
+            created = true;
+        }
+    }
+    // A cache made while the thread exits stays with the manager until it
+    // is destroyed
+    if (created && !threadExiting) {
+        threadExit.caches.emplace_back(id_, cache);
+    }
+    cacheSlots[nextCacheSlot] = CacheSlot{id_, cache};
+    nextCacheSlot = (nextCacheSlot + 1) % kCacheSlots;
+    return *cache;
+}
+
+void MemoryManager::refill(ThreadCache& cache, size_t sizeClass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Central& central = central_[sizeClass];
+    Magazine& magazine = cache.magazines[sizeClass];
+    const size_t wanted = kMagazineSize / 2;
+
+    while (magazine.count < wanted && central.free) {
+        FreeBlock* block = central.free;
+        central.free = block->next;
+        block->next = magazine.top;
+        magazine.top = block;
+        ++magazine.count;
+    }
+
+    // Carve the rest from the class's newest slab
+    const size_t blockSize = classSize(sizeClass);
+    while (magazine.count < wanted) {
+        if (static_cast<size_t>(central.end - central.bump) < blockSize) {
+            void* memory = ::operator new(kSlabBytes, std::align_val_t(kSlabBytes));
+            Slab* slab = new (memory) Slab{this, slabs_};
+            slabs_ = slab;
+            ++slabCount_;
+            central.bump = static_cast<unsigned char*>(memory) + kGranule;
+            central.end = static_cast<unsigned char*>(memory) + kSlabBytes;
+        }
+        auto* block = reinterpret_cast<FreeBlock*>(central.bump);
+        central.bump += blockSize;
+        block->next = magazine.top;
+        magazine.top = block;
+        ++magazine.count;
+    }
+}
+
+void MemoryManager::flush(ThreadCache& cache, size_t sizeClass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Central& central = central_[sizeClass];
+    Magazine& magazine = cache.magazines[sizeClass];
+    for (size_t i = 0; i < kMagazineSize / 2; ++i) {
+        FreeBlock* block = magazine.top;
+        magazine.top = block->next;
+        block->next = central.free;
+        central.free = block;
+    }
+    magazine.count -= kMagazineSize / 2;
+}
+
+void MemoryManager::releaseThreadCache(ThreadCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t sizeClass = 0; sizeClass < kSizeClasses; ++sizeClass) {
+        Magazine& magazine = cache->magazines[sizeClass];
+        while (magazine.top) {
+            FreeBlock* block = magazine.top;
+            magazine.top = block->next;
+            block->next = central_[sizeClass].free;
+            central_[sizeClass].free = block;
+        }
+    }
+    retiredAllocations_ += cache->allocations.load(std::memory_order_relaxed);
+    retiredDeallocations_ += cache->deallocations.load(std::memory_order_relaxed);
+    retiredRequestedBytes_ += cache->requestedBytes.load(std::memory_order_relaxed);
+    retiredBlockBytes_ += cache->blockBytes.load(std::memory_order_relaxed);
+    std::erase(caches_, cache);
+    delete cache;
+}
+
+void MemoryManager::releaseAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (slabs_) {
+        Slab* next = slabs_->next;
+        ::operator delete(slabs_, std::align_val_t(kSlabBytes));
+        slabs_ = next;
+    }
+    slabCount_ = 0;
+    central_ = {};
+    for (ThreadCache* cache : caches_) {
+        cache->magazines = {};
+    }
+}
+
+void* MemoryManager::allocateLarge(size_t size) {
+    auto* header = static_cast<LargeHeader*>(::operator new(kGranule + size));
+    header->manager = this;
+    header->size = size;
+    largeAllocations_.fetch_add(1, std::memory_order_relaxed);
+    largeBytes_.fetch_add(size, std::memory_order_relaxed);
+    return reinterpret_cast<unsigned char*>(header) + kGranule;
+}
+
+void MemoryManager::deallocateLarge(void* pointer) {
+    auto* header = reinterpret_cast<LargeHeader*>(static_cast<unsigned char*>(pointer) - kGranule);
+    MemoryManager& manager = *header->manager;
+    manager.largeFrees_.fetch_add(1, std::memory_order_relaxed);
+    manager.largeBytes_.fetch_sub(header->size, std::memory_order_relaxed);
+    ::operator delete(header);
+}
+
+MemoryManager::Stats MemoryManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.allocations = retiredAllocations_;
+    stats.deallocations = retiredDeallocations_;
+    stats.requestedBytes = retiredRequestedBytes_;
+    stats.blockBytes = retiredBlockBytes_;
+    for (const ThreadCache* cache : caches_) {
+        stats.allocations += cache->allocations.load(std::memory_order_relaxed);
+        stats.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+        stats.requestedBytes += cache->requestedBytes.load(std::memory_order_relaxed);
+        stats.blockBytes += cache->blockBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t largeAllocations = largeAllocations_.load(std::memory_order_relaxed);
+    size_t largeBytes = largeBytes_.load(std::memory_order_relaxed);
+    stats.largeAllocations = largeAllocations;
+    stats.allocations += largeAllocations;
+    stats.deallocations += largeFrees_.load(std::memory_order_relaxed);
+    stats.requestedBytes += largeBytes;
+    stats.blockBytes += largeBytes;
+    stats.slabs = slabCount_;
+    stats.reservedBytes = slabCount_ * kSlabBytes + largeBytes;
+    return stats;
+}
+
+} // namespace myndra
@@ -0,0 +1,229 @@
+#ifndef MYNDRA_MEMORY_H
+#define MYNDRA_MEMORY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace myndra {
+
+// Size-class pool allocator for runtime objects.
+//
+// Requests up to kMaxSmallSize bytes are rounded up to a multiple of
+// kGranule and served from slabs of that size class. Each thread keeps a
+// magazine of free blocks per class, so the common allocation and free
+// touch no lock and no shared cache line. A thread takes blocks from the
+// manager's central lists in batches when its magazine runs dry, and hands
+// back half a magazine when it fills. Larger requests go to the system
+// allocator.
+//
+// Slabs are aligned to their size and begin with a header naming their
+// manager, so a block can be freed from any thread and without knowing
+// which manager it came from. Callers pass the size they allocated.
+//
+// Each manager owns its slabs. Destroying the manager, or releaseAll(),
+// returns all of them in one step, which is much cheaper than freeing
+// objects one by one.
+class MemoryManager {
+public:
+    static constexpr size_t kGranule = 16;
+    static constexpr size_t kMaxSmallSize = 512;
+    static constexpr size_t kSizeClasses = kMaxSmallSize / kGranule;
+    static constexpr size_t kSlabBytes = 64 * 1024;
+    static constexpr size_t kMagazineSize = 64;   // Free blocks a thread keeps per class
+
+    struct Stats {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t largeAllocations = 0;    // Passed to the system allocator
+        size_t requestedBytes = 0;      // Live, as requested by callers
+        size_t blockBytes = 0;          // Live, rounded up to the size classes
+        size_t reservedBytes = 0;       // Slabs and large blocks held
+        size_t slabs = 0;
+
+        // Share of reserved memory not holding live data: rounding waste
+        // plus free blocks
+        double fragmentation() const {
+            return reservedBytes ? 1.0 - static_cast<double>(requestedBytes) / reservedBytes : 0.0;
+        }
+    };
+
+    MemoryManager();
+    // Every block must have been freed, or be abandoned with its memory
+    ~MemoryManager();
+
+    MemoryManager(const MemoryManager&) = delete;
+    MemoryManager& operator=(const MemoryManager&) = delete;
+
+    void* allocate(size_t size) {
+        if (size > kMaxSmallSize) {
+            return allocateLarge(size);
+        }
+        size_t sizeClass = classOf(size);
+        ThreadCache& cache = threadCache();
+        Magazine& magazine = cache.magazines[sizeClass];
+        if (!magazine.top) {
+            refill(cache, sizeClass);
+        }
+        FreeBlock* block = magazine.top;
+        magazine.top = block->next;
+        --magazine.count;
+        cache.count(cache.allocations, 1);
+        cache.count(cache.requestedBytes, size);
+        cache.count(cache.blockBytes, classSize(sizeClass));
+        return block;
+    }
+
+    // Frees a block of `size` bytes from any manager
+    static void deallocate(void* pointer, size_t size) {
+        if (size > kMaxSmallSize) {
+            deallocateLarge(pointer);
+            return;
+        }
+        size_t sizeClass = classOf(size);
+        MemoryManager& manager = *slabOf(pointer)->manager;
+        ThreadCache& cache = manager.threadCache();
+        Magazine& magazine = cache.magazines[sizeClass];
+        if (magazine.count == kMagazineSize) {
+            manager.flush(cache, sizeClass);
+        }
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->next = magazine.top;
+        magazine.top = block;
+        ++magazine.count;
+        cache.count(cache.deallocations, 1);
+        cache.count(cache.requestedBytes, 0 - size);
+        cache.count(cache.blockBytes, 0 - classSize(sizeClass));
+    }
+
+    // Returns every slab at once. No block may be in use, and no other
+    // thread may be using the manager.
+    void releaseAll();
+
+    Stats stats() const;
+
+    // Block size of requests of `size` bytes
+    static size_t roundedSize(size_t size) {
+        return size > kMaxSmallSize ? size : classSize(classOf(size));
+    }
+
+    // Process-wide manager, used outside any Scope
+    static MemoryManager& global();
+    // Manager that runtime objects allocated on this thread come from
+    static MemoryManager& current() { return currentManager ? *currentManager : global(); }
+
+    // Makes `manager` current on this thread for the scope's lifetime
+    class Scope {
+    public:
+        explicit Scope(MemoryManager& manager) : previous_(currentManager) { currentManager = &manager; }
+        ~Scope() { currentManager = previous_; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        MemoryManager* previous_;
+    };
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Magazine {
+        FreeBlock* top = nullptr;
+        size_t count = 0;
+    };
+
+    // One thread's magazines for this manager. Counters have a single
+    // writer; stats() reads them from other threads.
+    struct ThreadCache {
+        std::thread::id owner;
+        std::array<Magazine, kSizeClasses> magazines{};
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> deallocations{0};
+        std::atomic<size_t> requestedBytes{0};   // Wraps below zero when other threads free
+        std::atomic<size_t> blockBytes{0};
+
+        static void count(std::atomic<size_t>& counter, size_t delta) {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    };
+
+    struct Slab {
+        MemoryManager* manager;
+        Slab* next;
+    };
+
+    // Blocks of one size class not held by any thread
+    struct Central {
+        FreeBlock* free = nullptr;
+        unsigned char* bump = nullptr;   // Uncarved rest of the newest slab
+        unsigned char* end = nullptr;
+    };
+
+    // Large blocks are preceded by this, padded to kGranule
+    struct LargeHeader {
+        MemoryManager* manager;
+        size_t size;
+    };
+
+    // Recently used caches of this thread, keyed by manager id (ids are
+    // never reused, so a destroyed manager's entry never matches)
+    struct CacheSlot {
+        uint64_t manager;
+        ThreadCache* cache;
+    };
+    static constexpr size_t kCacheSlots = 4;
+
+    inline static thread_local MemoryManager* currentManager = nullptr;
+    inline static thread_local std::array<CacheSlot, kCacheSlots> cacheSlots{};
+    inline static thread_local size_t nextCacheSlot = 0;
+
+    uint64_t id_;
+    mutable std::mutex mutex_;
+    std::array<Central, kSizeClasses> central_{};
+    Slab* slabs_ = nullptr;
+    size_t slabCount_ = 0;
+    std::vector<ThreadCache*> caches_;
+    // Counters of caches whose threads have exited
+    size_t retiredAllocations_ = 0;
+    size_t retiredDeallocations_ = 0;
+    size_t retiredRequestedBytes_ = 0;
+    size_t retiredBlockBytes_ = 0;
+    // Large blocks are counted here, whichever thread frees them
+    std::atomic<size_t> largeAllocations_{0};
+    std::atomic<size_t> largeFrees_{0};
+    std::atomic<size_t> largeBytes_{0};
+
+    static size_t classOf(size_t size) { return size ? (size - 1) / kGranule : 0; }
+    static size_t classSize(size_t sizeClass) { return (sizeClass + 1) * kGranule; }
+    static Slab* slabOf(const void* pointer) {
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(kSlabBytes - 1));
+    }
+
+    ThreadCache& threadCache() {
+        for (CacheSlot& slot : cacheSlots) {
+            if (slot.manager == id_) {
+                return *slot.cache;
+            }
+        }
+        return findThreadCache();
+    }
+    ThreadCache& findThreadCache();
+    void refill(ThreadCache& cache, size_t sizeClass);
+    void flush(ThreadCache& cache, size_t sizeClass);
+    void releaseThreadCache(ThreadCache* cache);
+    void* allocateLarge(size_t size);
+    static void deallocateLarge(void* pointer);
+
+    friend struct ThreadExit;
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_MEMORY_H
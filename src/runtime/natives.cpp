@@ -0,0 +1,42 @@
+#include "natives.h"
+#include "builtins.h"
+#include <stdexcept>
+
+namespace myndra {
+
+NativeRegistry::NativeRegistry() {
+    registerBuiltins(*this);
+}
+
+const NativeRegistry& NativeRegistry::builtins() {
+    static const NativeRegistry registry;
+    return registry;
+}
+
+uint16_t NativeRegistry::define(const std::string& name, NativeFn fn, void* data) {
+    Atom atom = Atom::intern(name);
+    auto existing = ids_.find(atom);
+    if (existing != ids_.end()) {
+        entries_[existing->second] = {name, fn, data};
+        return existing->second;
+    }
+    if (entries_.size() >= kNone) {
+        throw std::runtime_error("Too many native functions");
+    }
+    uint16_t id = static_cast<uint16_t>(entries_.size());
+    entries_.push_back({name, fn, data});
+    ids_.emplace(atom, id);
+    return id;
+}
+
+uint16_t NativeRegistry::lookup(Atom name) const {
+    auto it = ids_.find(name);
+    return it == ids_.end() ? kNone : it->second;
+}
+
+uint16_t NativeRegistry::lookup(const std::string& name) const {
+    Atom atom = Atom::find(name);
+    return atom.empty() ? kNone : lookup(atom);
+}
+
+} // namespace myndra
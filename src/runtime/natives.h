@@ -0,0 +1,64 @@
+#ifndef MYNDRA_NATIVES_H
+#define MYNDRA_NATIVES_H
+
+#include "value.h"
+#include "../lexer/atom.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace myndra {
+
+// Arguments of a native call: a view over the caller's registers (VM) or
+// frame slots (interpreter), never a copy
+using NativeArgs = std::span<const RuntimeValue>;
+
+// Native entry point; `data` is the pointer given at registration
+using NativeFn = RuntimeValue (*)(NativeArgs args, void* data);
+
+// Table of C++ functions callable from Myndra code.
+//
+// Call sites resolve a name to a dense id once, when they are resolved or
+// compiled (by atom, an integer lookup); the call itself is an array index plus an indirect call. Ids are
+// stable: redefining a name replaces its entry in place, so code compiled
+// earlier picks up the new function.
+class NativeRegistry {
+public:
+    static constexpr uint16_t kNone = UINT16_MAX;
+
+    struct Entry {
+        std::string name;
+        NativeFn fn;
+        void* data;
+    };
+
+    // Starts out holding the core builtins (print, input, length, substring,
+    // push, pop, shift, sum)
+    NativeRegistry();
+
+    // Shared registry with nothing but the core builtins
+    static const NativeRegistry& builtins();
+
+    uint16_t define(const std::string& name, NativeFn fn, void* data = nullptr);
+    uint16_t lookup(Atom name) const;
+    uint16_t lookup(const std::string& name) const;
+
+    const Entry* entries() const { return entries_.data(); }
+    size_t size() const { return entries_.size(); }
+
+    RuntimeValue call(uint16_t id, NativeArgs args) const {
+        const Entry& entry = entries_[id];
+        return entry.fn(args, entry.data);
+    }
+
+private:
+    std::vector<Entry> entries_;
+    std::unordered_map<Atom, uint16_t> ids_;
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_NATIVES_H
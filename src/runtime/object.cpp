@@ -0,0 +1,279 @@
+#include "object.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace myndra {
+
+namespace {
+
+constexpr size_t kMinCapacity = 4;
+
+// Guards every shape's transitions and appends to key tables
+std::mutex& transitionLock() {
+    static std::mutex* lock = new std::mutex();
+    return *lock;
+}
+
+ShapedObject* checkedObject(const RuntimeValue& object) {
+    if (!isShapedObject(object)) {
+        throw std::runtime_error("Only objects have properties");
+    }
+    return asShapedObject(object);
+}
+
+// Adds `entry` unless the cache is full, in which case the site stops
+// caching
+void remember(PropertyCache& cache, const PropertyCache::Entry& entry) {
+    if (cache.count == PropertyCache::kEntries) {
+        cache.megamorphic = true;
+    } else if (!cache.megamorphic) {
+        cache.entries[cache.count++] = entry;
+    }
+}
+
+const PropertyCache::Entry* lookup(const PropertyCache& cache, const Shape* shape) {
+    for (uint8_t i = 0; i < cache.count; ++i) {
+        if (cache.entries[i].shape == shape) {
+            return &cache.entries[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// Keys of a chain of shapes, appended under the tree's lock and read
+// without one. Keys sit in segments that double in size (segment k holds
+// 2^(k+3) keys), so a key never moves once written. Past kLinearKeys they
+// are also indexed by an open-addressed hash of (atom, slot) words; a
+// grown index replaces the old one, which stays alive for readers still
+// probing it. Every append ends by storing `count` with release, and
+// readers load it with acquire before touching the keys below it.
+struct Shape::KeyTable {
+    static constexpr uint32_t kFirstSegmentBits = 3;
+    static constexpr size_t kSegments = 32 - kFirstSegmentBits;
+
+    struct Index {
+        uint32_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> entries;   // 0 when free
+
+        explicit Index(uint32_t capacity) : mask(capacity - 1), entries(new std::atomic<uint64_t>[capacity]()) {}
+
+        static uint32_t hash(Atom key) { return static_cast<uint32_t>((key.id() * 0x9E3779B97F4A7C15ULL) >> 32); }
+
+        void insert(Atom key, uint32_t slot) {
+            uint32_t i = hash(key) & mask;
+            while (entries[i].load(std::memory_order_relaxed) != 0) {
+                i = (i + 1) & mask;
+            }
+            entries[i].store(uint64_t(key.id()) << 32 | slot, std::memory_order_relaxed);
+        }
+
+        // A key appears at most once, so a hit at or past `limit` is a miss
+        uint32_t find(Atom key, uint32_t limit) const {
+            for (uint32_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                uint64_t entry = entries[i].load(std::memory_order_relaxed);
+                if (entry == 0) {
+                    return kNotFound;
+                }
+                if (entry >> 32 == key.id()) {
+                    uint32_t slot = static_cast<uint32_t>(entry);
+                    return slot < limit ? slot : kNotFound;
+                }
+            }
+        }
+    };
+
+    std::array<Atom*, kSegments> segments{};
+    std::atomic<uint32_t> count{0};
+    std::atomic<Index*> index{nullptr};
+    std::vector<std::unique_ptr<Index>> indexes;   // Every index built; under the lock
+
+    static void locate(uint32_t slot, size_t& segment, size_t& offset) {
+        uint32_t biased = slot + (uint32_t(1) << kFirstSegmentBits);
+        segment = std::bit_width(biased) - 1 - kFirstSegmentBits;
+        offset = biased - (uint32_t(1) << (segment + kFirstSegmentBits));
+    }
+
+    // Only for slots below a count loaded with acquire, or under the lock
+    Atom key(uint32_t slot) const {
+        size_t segment, offset;
+        locate(slot, segment, offset);
+        return segments[segment][offset];
+    }
+
+    // Under the lock
+    void append(Atom key) {
+        uint32_t slot = count.load(std::memory_order_relaxed);
+        size_t segment, offset;
+        locate(slot, segment, offset);
+        if (!segments[segment]) {
+            segments[segment] = new Atom[size_t(1) << (segment + kFirstSegmentBits)];
+        }
+        segments[segment][offset] = key;
+        if (slot >= kLinearKeys) {
+            Index* current = index.load(std::memory_order_relaxed);
+            if (!current || (slot + 1) * 2 > current->mask + 1) {
+                indexes.push_back(std::make_unique<Index>(std::bit_ceil((slot + 1) * 4)));
+                current = indexes.back().get();
+                for (uint32_t i = 0; i < slot; ++i) {
+                    current->insert(this->key(i), i);
+                }
+                index.store(current, std::memory_order_release);
+            }
+            current->insert(key, slot);
+        }
+        count.store(slot + 1, std::memory_order_release);
+    }
+};
+
+// Tables live as long as their shapes, which is forever
+Shape::Shape() : table_(new KeyTable()) {}
+
+Shape::Shape(const Shape& parent, Atom key) : table_(parent.table_), size_(parent.size_ + 1) {
+    if (table_->count.load(std::memory_order_relaxed) != parent.size_) {
+        // Another child already extended the parent's table
+        table_ = new KeyTable();
+        for (uint32_t slot = 0; slot < parent.size_; ++slot) {
+            table_->append(parent.table_->key(slot));
+        }
+    }
+    table_->append(key);
+}
+
+const Shape* Shape::empty() {
+    // Never destroyed, like every shape reached from it
+    static const Shape* root = new Shape();
+    return root;
+}
+
+const Shape* Shape::add(Atom key) const {
+    std::lock_guard<std::mutex> lock(transitionLock());
+    const Shape*& next = transitions_[key];
+    if (!next) {
+        next = new Shape(*this, key);
+    }
+    return next;
+}
+
+uint32_t Shape::find(Atom key) const {
+    const KeyTable& table = *table_;
+    // Pairs with the release in append(): the table holds at least this
+    // shape's keys, all visible from here on
+    uint32_t limit = std::min(size_, table.count.load(std::memory_order_acquire));
+    if (limit > kLinearKeys) {
+        return table.index.load(std::memory_order_acquire)->find(key, limit);
+    }
+    for (uint32_t slot = 0; slot < limit; ++slot) {
+        if (table.key(slot) == key) {
+            return slot;
+        }
+    }
+    return kNotFound;
+}
+
+Atom Shape::key(uint32_t slot) const {
+    // Acquire as in find()
+    uint32_t count = table_->count.load(std::memory_order_acquire);
+    return slot < std::min(size_, count) ? table_->key(slot) : Atom();
+}
+
+const GcClass ShapedObject::kClass = {
+    "object",
+    [](GcObject* object, GcVisitFn visit, void* context) {
+        auto* shaped = static_cast<ShapedObject*>(object);
+        for (uint32_t i = 0; i < shaped->shape->size(); ++i) {
+            visit(shaped->slots[i], context);
+        }
+    },
+    [](GcObject* object) { static_cast<ShapedObject*>(object)->~ShapedObject(); },
+};
+
+ShapedObject::~ShapedObject() {
+    std::destroy_n(slots, shape->size());
+    if (slots) {
+        MemoryManager::deallocate(slots, capacity * sizeof(RuntimeValue));
+    }
+}
+
+RuntimeValue ShapedObject::make(const Shape* shape, const RuntimeValue* values) {
+    RuntimeValue value = GcHeap::current().make<ShapedObject>(shape);
+    ShapedObject* object = asShapedObject(value);
+    uint32_t count = shape->size();
+    if (count) {
+        object->slots = static_cast<RuntimeValue*>(MemoryManager::current().allocate(count * sizeof(RuntimeValue)));
+        object->capacity = count;
+        std::uninitialized_copy_n(values, count, object->slots);
+    }
+    return value;
+}
+
+void ShapedObject::store(uint32_t slot, const RuntimeValue& value) {
+    GcHeap::writeBarrier(this, value);
+    slots[slot] = value;
+}
+
+void ShapedObject::append(const Shape* next, const RuntimeValue& value) {
+    uint32_t slot = shape->size();
+    GcHeap::writeBarrier(this, value);
+    if (slot < capacity) {
+        new (&slots[slot]) RuntimeValue(value);
+    } else {
+        // Values are plain bits, so they move by copying. `value` may live
+        // in the old buffer, which goes last.
+        size_t grown = std::max(capacity * 2, kMinCapacity);
+        auto* buffer = static_cast<RuntimeValue*>(MemoryManager::current().allocate(grown * sizeof(RuntimeValue)));
+        if (slot) {
+            std::memcpy(static_cast<void*>(buffer), slots, slot * sizeof(RuntimeValue));
+        }
+        new (&buffer[slot]) RuntimeValue(value);
+        if (slots) {
+            MemoryManager::deallocate(slots, capacity * sizeof(RuntimeValue));
+        }
+        slots = buffer;
+        capacity = grown;
+    }
+    shape = next;
+}
+
+RuntimeValue getPropertySlow(const RuntimeValue& object, PropertyCache& cache) {
+    ShapedObject* shaped = checkedObject(object);
+    if (const PropertyCache::Entry* entry = lookup(cache, shaped->shape)) {
+        return shaped->slots[entry->slot];
+    }
+    uint32_t slot = shaped->shape->find(cache.key);
+    if (slot == Shape::kNotFound) {
+        throw std::runtime_error("Object has no property '" + std::string(cache.key.text()) + "'");
+    }
+    remember(cache, {shaped->shape, slot, nullptr});
+    return shaped->slots[slot];
+}
+
+void setProperty(const RuntimeValue& object, const RuntimeValue& value, PropertyCache& cache) {
+    ShapedObject* shaped = checkedObject(object);
+    PropertyCache::Entry miss;
+    const PropertyCache::Entry* entry = lookup(cache, shaped->shape);
+    if (!entry) {
+        // A missing key is added, moving the object to the next shape
+        const Shape* shape = shaped->shape;
+        uint32_t slot = shape->find(cache.key);
+        miss = slot != Shape::kNotFound ? PropertyCache::Entry{shape, slot, nullptr}
+                                        : PropertyCache::Entry{shape, shape->size(), shape->add(cache.key)};
+        remember(cache, miss);
+        entry = &miss;
+    }
+    if (entry->transition) {
+        shaped->append(entry->transition, value);
+    } else {
+        shaped->store(static_cast<uint32_t>(entry->slot), value);
+    }
+}
+
+} // namespace myndra
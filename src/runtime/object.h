@@ -0,0 +1,129 @@
+#ifndef MYNDRA_OBJECT_H
+#define MYNDRA_OBJECT_H
+
+#include "gc.h"
+#include "../lexer/atom.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace myndra {
+
+// Hidden class: the keys of an object, in the order they were added, which
+// is also the order of their slots.
+//
+// Shapes form a transition tree rooted at empty(): adding a key to a shape
+// always leads to the same child, so objects built the same way share a
+// shape and a property's slot is known from the shape alone. That is what
+// lets an inline cache trade a key lookup for one pointer compare.
+//
+// Shapes are process-wide and never freed, like atoms, so caches and
+// compiled code may hold them without counting. A shape does not copy its
+// parent's keys: the shapes along a chain of transitions share one
+// append-only key table, each seeing the first size() keys, so building an
+// object of n properties costs O(n). Lookups take no lock; adding a
+// transition does.
+class Shape {
+public:
+    static constexpr uint32_t kNotFound = UINT32_MAX;
+
+    static const Shape* empty();
+
+    // The shape with `key` appended; `key` must not be present yet
+    const Shape* add(Atom key) const;
+    // Slot of `key`, or kNotFound
+    uint32_t find(Atom key) const;
+
+    uint32_t size() const { return size_; }
+    Atom key(uint32_t slot) const;
+
+private:
+    // Shapes this large look their keys up by hash
+    static constexpr uint32_t kLinearKeys = 8;
+
+    struct KeyTable;
+
+    KeyTable* table_;
+    uint32_t size_ = 0;
+    mutable std::unordered_map<Atom, const Shape*> transitions_;   // Under the tree's lock
+
+    Shape();
+    Shape(const Shape& parent, Atom key);
+};
+
+// Object with named properties. The values sit in `slots`, in the order of
+// the shape's keys; the buffer comes from the MemoryManager and grows as
+// properties are added. Compiled code reads `shape` and `slots` directly.
+struct ShapedObject : GcObject {
+    static const GcClass kClass;
+
+    const Shape* shape;
+    size_t capacity = 0;
+    RuntimeValue* slots = nullptr;
+
+    explicit ShapedObject(const Shape* shape) : GcObject(&kClass), shape(shape) {}
+    ~ShapedObject();
+
+    // A new object of `shape`, its slots copied from `values`
+    static RuntimeValue make(const Shape* shape, const RuntimeValue* values);
+
+    void store(uint32_t slot, const RuntimeValue& value);
+    // Adds the property that takes `next` from the current shape
+    void append(const Shape* next, const RuntimeValue& value);
+};
+
+inline bool isShapedObject(const RuntimeValue& value) {
+    return value.isContainer() && static_cast<GcObject*>(value.asObject())->gcClass == &ShapedObject::kClass;
+}
+
+// Unchecked; callers test isShapedObject first
+inline ShapedObject* asShapedObject(const RuntimeValue& value) {
+    return static_cast<ShapedObject*>(static_cast<GcObject*>(value.asObject()));
+}
+
+// Inline cache of one `object.key` site: the shapes seen there and where
+// each keeps the key. Up to kEntries shapes are remembered (monomorphic
+// with one, polymorphic beyond); a site that sees more goes megamorphic
+// and looks the key up every time. Store sites also cache adding the key:
+// `transition` is then the shape after the add and `slot` the new slot.
+//
+// Entries only ever fill in, never move, so compiled code may read them
+// in place. An unused entry has a null shape and matches nothing.
+struct PropertyCache {
+    static constexpr size_t kEntries = 4;
+
+    struct Entry {
+        const Shape* shape = nullptr;
+        size_t slot = 0;
+        const Shape* transition = nullptr;
+    };
+
+    Atom key;
+    std::array<Entry, kEntries> entries{};
+    uint8_t count = 0;
+    bool megamorphic = false;
+
+    PropertyCache() = default;
+    explicit PropertyCache(Atom key) : key(key) {}
+};
+
+RuntimeValue getPropertySlow(const RuntimeValue& object, PropertyCache& cache);
+
+// Property operations shared by every engine. Reading a missing property
+// raises; storing one adds it. Both raise unless `object` is an object.
+inline RuntimeValue getProperty(const RuntimeValue& object, PropertyCache& cache) {
+    if (isShapedObject(object)) {
+        ShapedObject* shaped = asShapedObject(object);
+        if (shaped->shape == cache.entries[0].shape) {
+            return shaped->slots[cache.entries[0].slot];
+        }
+    }
+    return getPropertySlow(object, cache);
+}
+
+void setProperty(const RuntimeValue& object, const RuntimeValue& value, PropertyCache& cache);
+
+} // namespace myndra
+
+#endif // MYNDRA_OBJECT_H
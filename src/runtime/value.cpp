@@ -0,0 +1,194 @@
+#include "value.h"
+#include "bytecode.h"
+#include "gc.h"
+#include <stdexcept>
+#include <vector>
+
+namespace myndra {
+
+FunctionObject::FunctionObject(std::string n, uint32_t a)
+    : HeapObject(Kind::Function), name(std::move(n)), arity(a) {}
+
+FunctionObject::~FunctionObject() = default;
+
+namespace {
+
+// Drops a reference a string holds to one of its parts, queueing the part
+// on `dead` instead of recursing when it was the last, so that freeing or
+// flattening a rope a million concatenations deep stays off the C++ stack
+void releasePart(StringObject* part, std::vector<StringObject*>& dead) {
+    if (--part->refcount == 0) dead.push_back(part);
+}
+
+void retainPart(StringObject* part) {
+    ++part->refcount;
+}
+
+size_t concatLength(const StringObject* left, const StringObject* right) {
+    if (left->length > StringObject::kMaxLength - right->length) {
+        throw std::runtime_error("String too long");
+    }
+    return left->length + right->length;
+}
+
+} // namespace
+
+StringObject* StringObject::make(std::string_view text) {
+    char* characters;
+    StringObject* string = make(text.size(), characters);
+    std::memcpy(characters, text.data(), text.size());
+    return string;
+}
+
+StringObject* StringObject::make(size_t length, char*& characters) {
+    if (length <= kInlineCapacity) {
+        auto* string = new StringObject(Form::Inline, length);
+        characters = string->chars;
+        return string;
+    }
+    characters = static_cast<char*>(MemoryManager::current().allocate(length));
+    auto* string = new StringObject(Form::Buffer, length);
+    string->flat.data = characters;
+    string->flat.base = nullptr;
+    return string;
+}
+
+StringObject* StringObject::concat(StringObject* left, StringObject* right) {
+    auto* string = new StringObject(Form::Rope, concatLength(left, right));
+    retainPart(left);
+    retainPart(right);
+    string->rope.left = left;
+    string->rope.right = right;
+    return string;
+}
+
+StringObject* StringObject::slice(StringObject* base, size_t start, size_t length) {
+    std::string_view text = base->view();
+    if (base->form == Form::Slice) {
+        base = base->flat.base;
+    }
+    auto* string = new StringObject(Form::Slice, length);
+    retainPart(base);
+    string->flat.data = text.data() + start;
+    string->flat.base = base;
+    return string;
+}
+
+void StringObject::flatten() {
+    char* characters = static_cast<char*>(MemoryManager::current().allocate(length));
+    // Leaves left to right; a rope's parts may themselves be ropes, and
+    // ones that were read before are flat by now
+    char* out = characters;
+    std::vector<StringObject*> pending{rope.right, rope.left};
+    while (!pending.empty()) {
+        StringObject* part = pending.back();
+        pending.pop_back();
+        if (part->form == Form::Rope) {
+            pending.push_back(part->rope.right);
+            pending.push_back(part->rope.left);
+            continue;
+        }
+        std::string_view text = part->view();
+        std::memcpy(out, text.data(), text.size());
+        out += text.size();
+    }
+
+    std::vector<StringObject*> dead;
+    releasePart(rope.left, dead);
+    releasePart(rope.right, dead);
+    form = Form::Buffer;
+    flat.data = characters;
+    flat.base = nullptr;
+    for (StringObject* string : dead) {
+        destroy(string);
+    }
+}
+
+void StringObject::destroy(StringObject* string) {
+    std::vector<StringObject*> dead;
+    for (;;) {
+        switch (string->form) {
+            case Form::Inline:
+                break;
+            case Form::Buffer:
+                MemoryManager::deallocate(const_cast<char*>(string->flat.data), string->length);
+                break;
+            case Form::Slice:
+                releasePart(string->flat.base, dead);
+                break;
+            case Form::Rope:
+                releasePart(string->rope.left, dead);
+                releasePart(string->rope.right, dead);
+                break;
+        }
+        delete string;
+        if (dead.empty()) return;
+        string = dead.back();
+        dead.pop_back();
+    }
+}
+
+RuntimeValue concatStrings(const RuntimeValue& left, const RuntimeValue& right) {
+    StringObject* l = left.asStringObject();
+    StringObject* r = right.asStringObject();
+    if (r->length == 0) return left;
+    if (l->length == 0) return right;
+    size_t length = concatLength(l, r);
+    if (length >= StringObject::kMinRopeLength) {
+        return RuntimeValue(StringObject::concat(l, r));
+    }
+    char* characters;
+    RuntimeValue result(StringObject::make(length, characters));
+    std::string_view first = l->view();
+    std::memcpy(characters, first.data(), first.size());
+    std::string_view second = r->view();
+    std::memcpy(characters + first.size(), second.data(), second.size());
+    return result;
+}
+
+RuntimeValue sliceString(const RuntimeValue& string, size_t start, size_t length) {
+    StringObject* base = string.asStringObject();
+    if (start == 0 && length == base->length) return string;
+    // Short substrings are cheaper to copy than to keep their base alive for
+    if (length <= StringObject::kInlineCapacity) {
+        return RuntimeValue(StringObject::make(base->view().substr(start, length)));
+    }
+    return RuntimeValue(StringObject::slice(base, start, length));
+}
+
+void destroyHeapObject(HeapObject* object) {
+    switch (object->kind) {
+        case HeapObject::Kind::String:
+            StringObject::destroy(static_cast<StringObject*>(object));
+            break;
+        case HeapObject::Kind::BoxedInt:
+            delete static_cast<BoxedIntObject*>(object);
+            break;
+        case HeapObject::Kind::Function:
+            delete static_cast<FunctionObject*>(object);
+            break;
+        case HeapObject::Kind::Container:
+            GcHeap::destroy(static_cast<GcObject*>(object));
+            break;
+    }
+}
+
+bool RuntimeValue::operator==(const RuntimeValue& other) const {
+    if (bits_ == other.bits_) {
+        // Identical bits are equal, except NaN which never equals itself
+        return !isDouble() || asDouble() == asDouble();
+    }
+    if (isDouble() && other.isDouble()) {
+        return asDouble() == other.asDouble(); // 0.0 == -0.0
+    }
+    if (isInt() && other.isInt()) {
+        return asInt() == other.asInt();
+    }
+    if (isString() && other.isString()) {
+        // Lengths are known without flattening a rope
+        return asStringObject()->length == other.asStringObject()->length && asString() == other.asString();
+    }
+    return false;
+}
+
+} // namespace myndra
@@ -0,0 +1,292 @@
+#ifndef MYNDRA_VALUE_H
+#define MYNDRA_VALUE_H
+
+#include "memory.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace myndra {
+
+class Program;
+struct FunctionProto;
+
+// Header shared by every heap-allocated runtime object.
+// Objects are reference counted by the RuntimeValues that point at them.
+struct HeapObject {
+    enum class Kind : uint8_t {
+        String,
+        BoxedInt,   // int64 that does not fit the 48-bit immediate
+        Function,
+        Container   // Holds other values; a GcObject managed by a GcHeap
+    };
+
+    uint32_t refcount = 0;
+    Kind kind;
+
+    explicit HeapObject(Kind k) : kind(k) {}
+
+    // Objects come from the current thread's MemoryManager, which may not
+    // be the one that frees them
+    static void* operator new(size_t size) { return MemoryManager::current().allocate(size); }
+    static void operator delete(void* pointer, size_t size) { MemoryManager::deallocate(pointer, size); }
+    // Containers are constructed in memory their GcHeap provides
+    static void* operator new(size_t, void* place) { return place; }
+    static void operator delete(void*, void*) {}
+};
+
+// Immutable string.
+//
+// Strings of up to kInlineCapacity bytes keep their characters in the
+// object itself; longer ones own a buffer from the MemoryManager. Two more
+// forms keep the common operations O(1):
+//
+//   Slice  a substring; shares the characters of a flat base string and
+//          keeps the base alive
+//   Rope   a concatenation; holds both operands and is flattened into an
+//          owned buffer the first time its characters are read, so
+//          `s = s + x` in a loop copies each character once
+//
+// The length is known without flattening. Flattening changes the form,
+// never the contents, so a string still never changes once created.
+struct StringObject : HeapObject {
+    enum class Form : uint8_t { Inline, Buffer, Slice, Rope };
+
+    static constexpr size_t kInlineCapacity = 24;
+    // Shorter concatenations are copied instead of becoming ropes
+    static constexpr size_t kMinRopeLength = 64;
+    // Longer concatenations raise an error, well before the length wraps
+    static constexpr size_t kMaxLength = (size_t(1) << 31) - 1;
+
+    struct Flat {
+        const char* data;
+        StringObject* base;   // Owns the characters of a Slice; null for a Buffer
+    };
+    struct Rope {
+        StringObject* left;
+        StringObject* right;
+    };
+
+    Form form;
+    size_t length;
+    union {
+        char chars[kInlineCapacity];   // Inline
+        Flat flat;                     // Buffer and Slice
+        Rope rope;
+    };
+
+    // A flat copy of `text`
+    static StringObject* make(std::string_view text);
+    // A flat string of `length` characters for the caller to fill in
+    static StringObject* make(size_t length, char*& characters);
+    // A rope or slice; takes a reference to each part it holds. concat()
+    // throws if the result would be longer than kMaxLength
+    static StringObject* concat(StringObject* left, StringObject* right);
+    static StringObject* slice(StringObject* base, size_t start, size_t length);
+
+    // The characters, flattening a rope first
+    std::string_view view() {
+        if (form == Form::Rope) flatten();
+        return {form == Form::Inline ? chars : flat.data, length};
+    }
+
+    // Frees `string` and every part only it was holding
+    static void destroy(StringObject* string);
+
+private:
+    explicit StringObject(Form f, size_t n) : HeapObject(Kind::String), form(f), length(n) {}
+    void flatten();
+};
+
+struct BoxedIntObject : HeapObject {
+    int64_t value;
+
+    explicit BoxedIntObject(int64_t v) : HeapObject(Kind::BoxedInt), value(v) {}
+};
+
+// A callable user function. The tree walker runs the FunctionDefinition at
+// index `declaration` of `program`, the VM runs `proto`, and natively
+// compiled programs call `native`; whichever engine created the object
+// fills in its fields.
+struct FunctionObject : HeapObject {
+    // Ahead-of-time compiled body: takes the (owned) arguments, returns an
+    // owned result, both as RuntimeValue bits
+    using NativeEntry = uint64_t (*)(uint64_t* args);
+
+    std::string name;
+    uint32_t arity;
+    Program* program = nullptr;             // Not owned; outlives the function
+    uint32_t declaration = 0;
+    std::unique_ptr<FunctionProto> proto;   // Owned by this object
+    NativeEntry native = nullptr;
+
+    FunctionObject(std::string n, uint32_t a);
+    ~FunctionObject();
+};
+
+// Frees an object whose reference count dropped to zero
+void destroyHeapObject(HeapObject* object);
+
+// 8-byte NaN-boxed runtime value.
+//
+// Doubles are stored as their raw IEEE bits (NaNs are canonicalized), and
+// everything else lives in the negative quiet-NaN space, tagged by the top
+// 16 bits:
+//
+//   0xFFF9  48-bit signed integer immediate
+//   0xFFFA  boolean immediate
+//   0xFFFC  48-bit pointer to a refcounted HeapObject
+//
+// Integers outside the 48-bit range are boxed on the heap so the language
+// keeps full int64 semantics.
+class RuntimeValue {
+public:
+    static constexpr uint64_t kTagShift = 48;
+    static constexpr uint64_t kPayloadMask = (uint64_t(1) << kTagShift) - 1;
+    static constexpr uint64_t kIntTag = uint64_t(0xFFF9) << kTagShift;
+    static constexpr uint64_t kBoolTag = uint64_t(0xFFFA) << kTagShift;
+    static constexpr uint64_t kObjectTag = uint64_t(0xFFFC) << kTagShift;
+    static constexpr uint64_t kCanonicalNaN = uint64_t(0x7FF8) << kTagShift;
+    static constexpr int64_t kSmallIntMin = -(int64_t(1) << 47);
+    static constexpr int64_t kSmallIntMax = (int64_t(1) << 47) - 1;
+
+    RuntimeValue() : bits_(kIntTag) {}
+    RuntimeValue(int64_t value) {
+        if (value >= kSmallIntMin && value <= kSmallIntMax) {
+            bits_ = kIntTag | (static_cast<uint64_t>(value) & kPayloadMask);
+        } else {
+            bits_ = objectBits(new BoxedIntObject(value));
+        }
+    }
+    RuntimeValue(double value) {
+        std::memcpy(&bits_, &value, sizeof(bits_));
+        if (value != value) bits_ = kCanonicalNaN;
+    }
+    RuntimeValue(bool value) : bits_(kBoolTag | static_cast<uint64_t>(value)) {}
+    RuntimeValue(const std::string& value) : bits_(objectBits(StringObject::make(value))) {}
+    RuntimeValue(const char* value) : bits_(objectBits(StringObject::make(value))) {}
+    // Takes ownership of a freshly allocated object
+    explicit RuntimeValue(HeapObject* object) : bits_(objectBits(object)) {}
+
+    // An integer already known to fit the 48-bit immediate range
+    static RuntimeValue smallInt(int64_t value) {
+        RuntimeValue result;
+        result.bits_ = kIntTag | (static_cast<uint64_t>(value) & kPayloadMask);
+        return result;
+    }
+
+    // New reference to an object that is already owned elsewhere
+    static RuntimeValue share(HeapObject* object) {
+        RuntimeValue value;
+        value.bits_ = kObjectTag | reinterpret_cast<uint64_t>(object);
+        value.retain();
+        return value;
+    }
+
+    RuntimeValue(const RuntimeValue& other) : bits_(other.bits_) { retain(); }
+    RuntimeValue(RuntimeValue&& other) noexcept : bits_(other.bits_) { other.bits_ = kIntTag; }
+    ~RuntimeValue() { release(); }
+
+    RuntimeValue& operator=(const RuntimeValue& other) {
+        if (bits_ != other.bits_) {
+            other.retain();
+            release();
+            bits_ = other.bits_;
+        }
+        return *this;
+    }
+    RuntimeValue& operator=(RuntimeValue&& other) noexcept {
+        if (this != &other) {
+            release();
+            bits_ = other.bits_;
+            other.bits_ = kIntTag;
+        }
+        return *this;
+    }
+
+    // Tag checks
+    bool isSmallInt() const { return (bits_ >> kTagShift) == (kIntTag >> kTagShift); }
+    bool isDouble() const { return bits_ < kIntTag; }
+    bool isBool() const { return (bits_ >> kTagShift) == (kBoolTag >> kTagShift); }
+    bool isObject() const { return (bits_ >> kTagShift) == (kObjectTag >> kTagShift); }
+    bool isInt() const { return isSmallInt() || isObjectOf(HeapObject::Kind::BoxedInt); }
+    bool isString() const { return isObjectOf(HeapObject::Kind::String); }
+    bool isFunction() const { return isObjectOf(HeapObject::Kind::Function); }
+    bool isContainer() const { return isObjectOf(HeapObject::Kind::Container); }
+
+    // Unchecked accessors; callers test the tag first
+    int64_t asSmallInt() const { return static_cast<int64_t>(bits_ << 16) >> 16; }
+    int64_t asInt() const {
+        return isSmallInt() ? asSmallInt() : static_cast<BoxedIntObject*>(asObject())->value;
+    }
+    double asDouble() const {
+        double value;
+        std::memcpy(&value, &bits_, sizeof(value));
+        return value;
+    }
+    bool asBool() const { return (bits_ & 1) != 0; }
+    HeapObject* asObject() const { return reinterpret_cast<HeapObject*>(bits_ & kPayloadMask); }
+    StringObject* asStringObject() const { return static_cast<StringObject*>(asObject()); }
+    std::string_view asString() const { return asStringObject()->view(); }
+    FunctionObject* asFunction() const { return static_cast<FunctionObject*>(asObject()); }
+
+    // Both operands are 48-bit integer immediates
+    static bool bothSmallInts(const RuntimeValue& a, const RuntimeValue& b) {
+        return a.isSmallInt() && b.isSmallInt();
+    }
+
+    uint64_t bits() const { return bits_; }
+
+    // Raw encodings passed to natively compiled code: fromBits takes over
+    // the reference `bits` holds, takeBits hands this value's to the caller
+    static RuntimeValue fromBits(uint64_t bits) {
+        RuntimeValue value;
+        value.bits_ = bits;
+        return value;
+    }
+    uint64_t takeBits() {
+        uint64_t bits = bits_;
+        bits_ = kIntTag;
+        return bits;
+    }
+
+    // Same type and same value (int 1 and float 1.0 are different)
+    bool operator==(const RuntimeValue& other) const;
+    bool operator!=(const RuntimeValue& other) const { return !(*this == other); }
+
+private:
+    uint64_t bits_;
+
+    static uint64_t objectBits(HeapObject* object) {
+        object->refcount = 1;
+        return kObjectTag | reinterpret_cast<uint64_t>(object);
+    }
+
+    bool isObjectOf(HeapObject::Kind kind) const {
+        return isObject() && asObject()->kind == kind;
+    }
+
+    void retain() const {
+        if (isObject()) ++asObject()->refcount;
+    }
+    void release() {
+        if (isObject()) {
+            HeapObject* object = asObject();
+            if (--object->refcount == 0) destroyHeapObject(object);
+        }
+    }
+};
+
+static_assert(sizeof(RuntimeValue) == 8, "RuntimeValue must stay 8 bytes");
+
+// String operations shared by every engine; operands must be strings.
+// Results share characters with their operands where that is cheaper.
+RuntimeValue concatStrings(const RuntimeValue& left, const RuntimeValue& right);
+// Characters [start, start + length) of `string`, which must hold them
+RuntimeValue sliceString(const RuntimeValue& string, size_t start, size_t length);
+
+} // namespace myndra
+
+#endif // MYNDRA_VALUE_H
@@ -0,0 +1,487 @@
+#include "vm.h"
+#include "array.h"
+#include "object.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+// Use computed goto ("labels as values") for dispatch where the compiler
+// supports it; otherwise fall back to a plain switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define MYNDRA_COMPUTED_GOTO 1
+#else
+#define MYNDRA_COMPUTED_GOTO 0
+#endif
+
+namespace myndra {
+
+VM::VM(const NativeRegistry& natives, size_t stackSize, const Jit::Options& jit)
+    : natives_(natives), stack_(stackSize), jit_(jit), jitContext_{stack_.data(), this},
+      globals_(stack_.data()), hostTop_(stack_.data()) {
+    frames_.reserve(kMaxCallDepth);
+}
+
+void VM::attachHost(const Host& host) {
+    host_ = host;
+    if (host.globals) {
+        globals_ = host.globals;
+        jitContext_.globals = host.globals;
+    }
+}
+
+void VM::reset() {
+    frames_.clear();
+    nativeDepth_ = 0;
+    jitError_ = nullptr;
+    jitPendingRelease_ = RuntimeValue();
+    hostTop_ = stack_.data();
+}
+
+RuntimeValue VM::call(const RuntimeValue& callee, NativeArgs args) {
+    // Above everything the VM is using; the callee sits below the window
+    RuntimeValue* window = hostTop_ + 1;
+    if (window + args.size() > stack_.data() + stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    window[-1] = callee;
+    std::copy(args.begin(), args.end(), window);
+    invoke(window);
+    return std::move(window[-1]);
+}
+
+bool VM::enterLoop(const Chunk& chunk, RuntimeValue* frame, uint32_t frameSize, RuntimeValue& result) {
+    RuntimeValue* window = hostTop_ + 1;
+    if (window + std::max(chunk.register_count, frameSize) > stack_.data() + stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    window[-1] = RuntimeValue();
+    std::copy(frame, frame + frameSize, window);
+    if (run(&chunk, nullptr, window)) {
+        result = std::move(window[-1]);
+        return true;
+    }
+    std::copy(window, window + frameSize, frame);
+    return false;
+}
+
+RuntimeValue VM::callHost(const RuntimeValue& callee, RuntimeValue* args, uint32_t count, RuntimeValue* top) {
+    if (!host_.call) {
+        throw std::runtime_error("Function '" + callee.asFunction()->name + "' has no bytecode");
+    }
+    // Calls the host makes back into the VM go above `top`
+    struct Top {
+        RuntimeValue*& top;
+        RuntimeValue* saved;
+        Top(RuntimeValue*& t, RuntimeValue* value) : top(t), saved(t) { top = value; }
+        ~Top() { top = saved; }
+    } guard(hostTop_, top);
+    return host_.call(host_.data, callee, NativeArgs(args, count));
+}
+
+void VM::execute(const Chunk& chunk) {
+    if (chunk.register_count > stack_.size()) {
+        throw std::runtime_error("Stack overflow");
+    }
+    // Left behind by a runtime error
+    frames_.clear();
+    nativeDepth_ = 0;
+    jitError_ = nullptr;
+
+    run(&chunk, nullptr, stack_.data());
+}
+
+void VM::invoke(RuntimeValue* window) {
+    if (window[-1].asFunction()->proto) {
+        if (depthExceeded()) {
+            throw std::runtime_error("Stack overflow");
+        }
+        struct Depth {
+            size_t& depth;
+            explicit Depth(size_t& d) : depth(d) { ++depth; }
+            ~Depth() { --depth; }
+        } depth(nativeDepth_);
+
+        if (invokeBytecode(window)) {
+            return;
+        }
+    }
+    // The function (possibly reached by a tail call) has no bytecode; the
+    // host runs it
+    uint32_t arity = window[-1].asFunction()->arity;
+    RuntimeValue result = callHost(window[-1], window, arity, window + arity);
+    window[-1] = std::move(result);
+}
+
+bool VM::invokeBytecode(RuntimeValue* window) {
+    // Tail calls from compiled code come back here with the next callee
+    for (;;) {
+        FunctionProto* proto = window[-1].asFunction()->proto.get();
+        if (!proto) {
+            return false;
+        }
+        if (!jit_.tick(*proto)) {
+            run(&proto->chunk, proto, window);
+            return true;
+        }
+        if (window + proto->chunk.register_count > stack_.data() + stack_.size()) {
+            throw std::runtime_error("Stack overflow");
+        }
+        JitStatus status = proto->jit->entry()(&jitContext_, window);
+        // The caller's code has returned; its function may go now
+        jitPendingRelease_ = RuntimeValue();
+        if (status == kJitOk) {
+            return true;
+        }
+        if (status == kJitError) {
+            std::rethrow_exception(std::exchange(jitError_, nullptr));
+        }
+    }
+}
+
+bool VM::run(const Chunk* chunk, FunctionProto* proto, RuntimeValue* window) {
+    RuntimeValue* const G = globals_;
+    RuntimeValue* const stackEnd = stack_.data() + stack_.size();
+    const size_t base = frames_.size();
+    RuntimeValue* R = window;
+    const NativeRegistry::Entry* natives = natives_.entries();
+    const Chunk* current = chunk;
+    const RuntimeValue* K = chunk->constants.data();
+    const Instruction* code = chunk->code.data();
+    const Instruction* ip = code;
+    const Instruction* ins;
+
+// Make function `target` the running one with its register window at `window`
+#define ENTER_FUNCTION(target, window) \
+    { \
+        proto = (target); \
+        current = &proto->chunk; \
+        if ((window) + current->register_count > stackEnd) { \
+            throw std::runtime_error("Stack overflow"); \
+        } \
+        R = (window); \
+        K = current->constants.data(); \
+        code = current->code.data(); \
+        ip = code; \
+    }
+
+// Integer-immediate fast path (a tag check plus the native op); the shared
+// evaluator handles every other combination. 48-bit operands cannot
+// overflow int64 for +, - and comparisons.
+#define ARITH_OP(op, binop) \
+    { \
+        const RuntimeValue& l = R[ins->b]; \
+        const RuntimeValue& r = R[ins->c]; \
+        if (RuntimeValue::bothSmallInts(l, r)) { \
+            R[ins->a] = l.asSmallInt() op r.asSmallInt(); \
+        } else { \
+            R[ins->a] = evaluateBinary(binop, l, r); \
+        } \
+    }
+
+// Operands the TypeChecker proved to be doubles: no tag checks at all
+#define FLOAT_OP(op) \
+    { \
+        R[ins->a] = R[ins->b].asDouble() op R[ins->c].asDouble(); \
+    }
+
+#if MYNDRA_COMPUTED_GOTO
+    static void* dispatchTable[] = {
+#define MYNDRA_OPCODE_LABEL(name) &&op_##name,
+        MYNDRA_OPCODES(MYNDRA_OPCODE_LABEL)
+#undef MYNDRA_OPCODE_LABEL
+    };
+#define DISPATCH() do { ins = ip++; goto *dispatchTable[static_cast<uint8_t>(ins->op)]; } while (0)
+#define CASE(name) op_##name:
+#define NEXT() DISPATCH()
+    DISPATCH();
+#else
+#define CASE(name) case OpCode::name:
+#define NEXT() break
+    for (;;) {
+    ins = ip++;
+    switch (ins->op) {
+#endif
+
+    CASE(LOAD_CONST) {
+        R[ins->a] = K[ins->bx()];
+        NEXT();
+    }
+    CASE(MOVE) {
+        R[ins->a] = R[ins->b];
+        NEXT();
+    }
+    CASE(ADD) {
+        ARITH_OP(+, BinaryOperator::Add);
+        NEXT();
+    }
+    CASE(SUB) {
+        ARITH_OP(-, BinaryOperator::Sub);
+        NEXT();
+    }
+    CASE(MUL) {
+        R[ins->a] = evaluateBinary(BinaryOperator::Mul, R[ins->b], R[ins->c]);
+        NEXT();
+    }
+    CASE(DIV) {
+        R[ins->a] = evaluateBinary(BinaryOperator::Div, R[ins->b], R[ins->c]);
+        NEXT();
+    }
+    CASE(EQ) {
+        R[ins->a] = (R[ins->b] == R[ins->c]);
+        NEXT();
+    }
+    CASE(NE) {
+        R[ins->a] = (R[ins->b] != R[ins->c]);
+        NEXT();
+    }
+    CASE(LT) {
+        ARITH_OP(<, BinaryOperator::Lt);
+        NEXT();
+    }
+    CASE(LE) {
+        ARITH_OP(<=, BinaryOperator::Le);
+        NEXT();
+    }
+    CASE(GT) {
+        ARITH_OP(>, BinaryOperator::Gt);
+        NEXT();
+    }
+    CASE(GE) {
+        ARITH_OP(>=, BinaryOperator::Ge);
+        NEXT();
+    }
+    CASE(ADD_FLOAT) {
+        FLOAT_OP(+);
+        NEXT();
+    }
+    CASE(SUB_FLOAT) {
+        FLOAT_OP(-);
+        NEXT();
+    }
+    CASE(MUL_FLOAT) {
+        FLOAT_OP(*);
+        NEXT();
+    }
+    CASE(DIV_FLOAT) {
+        if (R[ins->c].asDouble() == 0.0) {
+            throw std::runtime_error("Division by zero");
+        }
+        FLOAT_OP(/);
+        NEXT();
+    }
+    CASE(LT_FLOAT) {
+        FLOAT_OP(<);
+        NEXT();
+    }
+    CASE(LE_FLOAT) {
+        FLOAT_OP(<=);
+        NEXT();
+    }
+    CASE(GT_FLOAT) {
+        FLOAT_OP(>);
+        NEXT();
+    }
+    CASE(GE_FLOAT) {
+        FLOAT_OP(>=);
+        NEXT();
+    }
+    CASE(AND) {
+        R[ins->a] = runtimeValueTruthy(R[ins->b]) && runtimeValueTruthy(R[ins->c]);
+        NEXT();
+    }
+    CASE(OR) {
+        R[ins->a] = runtimeValueTruthy(R[ins->b]) || runtimeValueTruthy(R[ins->c]);
+        NEXT();
+    }
+    CASE(NEG) {
+        R[ins->a] = evaluateUnary(UnaryOperator::Neg, R[ins->b]);
+        NEXT();
+    }
+    CASE(NOT) {
+        R[ins->a] = !runtimeValueTruthy(R[ins->b]);
+        NEXT();
+    }
+    CASE(JUMP) {
+        // A backward jump closes a loop iteration
+        if (code + ins->bx() < ins && proto) {
+            jit_.tick(*proto);
+        }
+        ip = code + ins->bx();
+        NEXT();
+    }
+    CASE(JUMP_IF_FALSE) {
+        if (!runtimeValueTruthy(R[ins->a])) {
+            ip = code + ins->bx();
+        }
+        NEXT();
+    }
+    CASE(FOR_PREP) {
+        RuntimeValue* range = &R[ins->a];
+        checkRangeBounds(range[0], range[1]);
+        if (range[0].asInt() < range[1].asInt()) {
+            range[2] = range[0];
+        } else {
+            ip = code + ins->bx();
+        }
+        NEXT();
+    }
+    CASE(FOR_LOOP) {
+        // The counter is below the end bound, so stepping it cannot
+        // overflow, and below a small-int bound it stays a small int
+        RuntimeValue* range = &R[ins->a];
+        bool more;
+        if (RuntimeValue::bothSmallInts(range[0], range[1])) {
+            int64_t next = range[0].asSmallInt() + 1;
+            more = next < range[1].asSmallInt();
+            if (more) range[0] = RuntimeValue::smallInt(next);
+        } else {
+            int64_t next = range[0].asInt() + 1;
+            more = next < range[1].asInt();
+            if (more) range[0] = RuntimeValue(next);
+        }
+        if (more) {
+            range[2] = range[0];
+            if (proto) {
+                jit_.tick(*proto);
+            }
+            ip = code + ins->bx();
+        }
+        NEXT();
+    }
+    CASE(GET_GLOBAL) {
+        R[ins->a] = G[ins->bx()];
+        NEXT();
+    }
+    CASE(SET_GLOBAL) {
+        G[ins->bx()] = R[ins->a];
+        NEXT();
+    }
+    CASE(NEW_ARRAY) {
+        R[ins->a] = ArrayObject::make(&R[ins->b], ins->c);
+        NEXT();
+    }
+    CASE(GET_INDEX) {
+        R[ins->a] = indexArray(R[ins->b], R[ins->c]);
+        NEXT();
+    }
+    CASE(SET_INDEX) {
+        storeIndex(R[ins->a], R[ins->b], R[ins->c]);
+        NEXT();
+    }
+    CASE(GET_INDEX_UNCHECKED) {
+        R[ins->a] = asArray(R[ins->b])->get(static_cast<size_t>(R[ins->c].asInt()));
+        NEXT();
+    }
+    CASE(SET_INDEX_UNCHECKED) {
+        asArray(R[ins->a])->set(static_cast<size_t>(R[ins->b].asInt()), R[ins->c]);
+        NEXT();
+    }
+    CASE(IN_BOUNDS) {
+        R[ins->a] = indexRangeInBounds(R[ins->b], R[ins->c], R[ins->c + 1]);
+        NEXT();
+    }
+    CASE(NEW_OBJECT) {
+        R[ins->a] = ShapedObject::make(current->shapes[ins->c], &R[ins->b]);
+        NEXT();
+    }
+    CASE(GET_MEMBER) {
+        R[ins->a] = getProperty(R[ins->b], current->properties[ins->c]);
+        NEXT();
+    }
+    CASE(SET_MEMBER) {
+        setProperty(R[ins->a], R[ins->b], current->properties[ins->c]);
+        NEXT();
+    }
+    CASE(CALL) {
+        // The callee stays in R[A], just below the new window, and receives
+        // the result when the call returns
+        const RuntimeValue& callee = R[ins->a];
+        checkCallable(callee, ins->c);
+        FunctionProto* target = callee.asFunction()->proto.get();
+        if (!target) {
+            RuntimeValue* args = R + ins->a + 1;
+            RuntimeValue result = callHost(callee, args, ins->c, args + ins->c);
+            R[ins->a] = std::move(result);
+            NEXT();
+        }
+        if (jit_.tick(*target)) {
+            invoke(R + ins->a + 1);
+            NEXT();
+        }
+        if (depthExceeded()) {
+            throw std::runtime_error("Stack overflow");
+        }
+        frames_.push_back({current, proto, ip, R});
+        ENTER_FUNCTION(target, R + ins->a + 1);
+        NEXT();
+    }
+    CASE(TAIL_CALL) {
+        uint16_t a = ins->a;
+        uint16_t argc = ins->c;
+        checkCallable(R[a], argc);
+        // The new callee replaces the current one (which may free the
+        // chunk being executed, so nothing below reads from it)
+        R[-1] = std::move(R[a]);
+        for (uint16_t i = 0; i < argc; ++i) {
+            R[i] = std::move(R[a + 1 + i]);
+        }
+        FunctionProto* target = R[-1].asFunction()->proto.get();
+        if (!target) {
+            RuntimeValue result = callHost(R[-1], R, argc, R + argc);
+            R[-1] = std::move(result);
+            goto returned;
+        }
+        if (jit_.tick(*target)) {
+            // Compiled code leaves its result in R[-1], as RETURN would
+            invoke(R);
+            goto returned;
+        }
+        ENTER_FUNCTION(target, R);
+        NEXT();
+    }
+    CASE(RETURN) {
+        R[-1] = std::move(R[ins->a]);
+    returned:
+        if (frames_.size() == base) {
+            return true;
+        }
+        const CallFrame& frame = frames_.back();
+        current = frame.chunk;
+        proto = frame.proto;
+        R = frame.registers;
+        K = current->constants.data();
+        code = current->code.data();
+        ip = frame.ip;
+        frames_.pop_back();
+        NEXT();
+    }
+    CASE(CALL_NATIVE) {
+        const NativeRegistry::Entry& native = natives[ins->b];
+        R[ins->a] = native.fn(NativeArgs(&R[ins->a], ins->c), native.data);
+        NEXT();
+    }
+    CASE(RAISE) {
+        throw std::runtime_error(std::string(K[ins->bx()].asString()));
+    }
+    CASE(HALT) {
+        return false;
+    }
+
+#if !MYNDRA_COMPUTED_GOTO
+    default:
+        throw std::runtime_error("Invalid opcode");
+    }
+    }
+#endif
+
+#undef ARITH_OP
+#undef FLOAT_OP
+#undef ENTER_FUNCTION
+#undef CASE
+#undef NEXT
+#ifdef DISPATCH
+#undef DISPATCH
+#endif
+}
+
+} // namespace myndra
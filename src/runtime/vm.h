@@ -0,0 +1,100 @@
+#ifndef MYNDRA_VM_H
+#define MYNDRA_VM_H
+
+#include "bytecode.h"
+#include "natives.h"
+#include "../jit/jit.h"
+#include <exception>
+#include <vector>
+
+namespace myndra {
+
+// Register-based bytecode virtual machine.
+//
+// All register windows live in one preallocated stack. The top-level chunk
+// owns the bottom of it, and that window outlives a single execute() call so
+// globals defined by one chunk are visible to the next one (REPL sessions).
+// A call slides the window up to the callee's arguments; nothing is
+// allocated per call.
+//
+// Functions that get hot are handed to the JIT. Calls into compiled code,
+// and calls from it back into interpreted functions, nest on the C++
+// stack; the call depth limit counts both kinds of frame.
+//
+// Under tiered execution the VM runs the functions and loops the tree
+// walker promoted, with the tree walker attached as its host.
+class VM {
+public:
+    explicit VM(const NativeRegistry& natives = NativeRegistry::builtins(), size_t stackSize = 1 << 18,
+                const Jit::Options& jit = Jit::Options());
+
+    void execute(const Chunk& chunk);
+
+    const Jit& jit() const { return jit_; }
+
+    // Another engine running code on this VM (tiered execution). Functions
+    // without bytecode are called through `call`; globals live in
+    // `globals`; `depth` counts the host's active calls, which share
+    // kMaxCallDepth with the VM's.
+    struct Host {
+        RuntimeValue (*call)(void* data, const RuntimeValue& callee, NativeArgs args);
+        void* data;
+        RuntimeValue* globals;
+        const size_t* depth;
+    };
+    void attachHost(const Host& host);
+
+    // Calls `callee`, a function with bytecode, from the host
+    RuntimeValue call(const RuntimeValue& callee, NativeArgs args);
+    // Runs `chunk`, one loop compiled for on-stack replacement, over a copy
+    // of the host frame `frame`; the updated slots are copied back when the
+    // loop exits. True if the loop returned from its function instead, with
+    // the value in `result`.
+    bool enterLoop(const Chunk& chunk, RuntimeValue* frame, uint32_t frameSize, RuntimeValue& result);
+    // Forgets the frames a runtime error left behind
+    void reset();
+    // Calls active in this VM
+    size_t depth() const { return frames_.size() + nativeDepth_; }
+
+private:
+    friend class Jit;
+
+    struct CallFrame {
+        const Chunk* chunk;         // Caller's chunk
+        FunctionProto* proto;       // Caller's function; null at the top level
+        const Instruction* ip;      // Resume point in the caller
+        RuntimeValue* registers;    // Caller's register window
+    };
+
+    const NativeRegistry& natives_;
+    std::vector<RuntimeValue> stack_;
+    std::vector<CallFrame> frames_;
+    Jit jit_;
+    JitContext jitContext_;
+    size_t nativeDepth_ = 0;             // Calls running in compiled code
+    std::exception_ptr jitError_;        // Raised inside compiled code
+    RuntimeValue jitPendingRelease_;     // Caller replaced by a tail call from compiled code
+    RuntimeValue* globals_;              // Bottom of stack_, unless a host provides them
+    Host host_{};
+    RuntimeValue* hostTop_;              // Where the host's next call into the VM goes
+
+    // Runs `chunk` in `window` until it returns to this call's depth; true
+    // if it did, false if it halted
+    bool run(const Chunk* chunk, FunctionProto* proto, RuntimeValue* window);
+    // Runs the function in window[-1] to completion, compiled or not; the
+    // result replaces it
+    void invoke(RuntimeValue* window);
+    // invoke() for a function with bytecode; false if a tail call reached
+    // one without
+    bool invokeBytecode(RuntimeValue* window);
+    // Calls a function without bytecode through the host; `top` is the
+    // first stack slot the call may use
+    RuntimeValue callHost(const RuntimeValue& callee, RuntimeValue* args, uint32_t count, RuntimeValue* top);
+    bool depthExceeded() const {
+        return depth() + (host_.depth ? *host_.depth : 0) >= kMaxCallDepth;
+    }
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_VM_H
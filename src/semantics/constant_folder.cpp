@@ -0,0 +1,468 @@
+#include "constant_folder.h"
+#include "../interpreter/interpreter.h"
+#include <cmath>
+
+namespace myndra {
+
+namespace {
+
+bool isIntConstant(const RuntimeValue& value, int64_t expected) {
+    return value.isInt() && value.asInt() == expected;
+}
+
+bool isDoubleConstant(const RuntimeValue& value, double expected) {
+    return value.isDouble() && value.asDouble() == expected && !std::signbit(value.asDouble());
+}
+
+} // namespace
+
+ConstantFolder::ConstantFolder(std::string context, bool fixedContext)
+    : context_(std::move(context)), fixedContext_(fixedContext) {}
+
+std::unique_ptr<Program> ConstantFolder::fold(const Program& program) {
+    source_ = &program;
+    folded_ = 0;
+    functions_.assign(1, FunctionScope());
+    collectWrites();
+
+    NodeList statements = foldStatements(program.statements());
+    auto folded = ast_.finish(statements);
+
+    written_.clear();
+    functions_.clear();
+    source_ = nullptr;
+    return folded;
+}
+
+void ConstantFolder::collectWrites() {
+    // Every node of the program sits in its kind's pool, so no walk is needed
+    const Program& program = *source_;
+    written_.clear();
+    for (uint32_t i = 0; i < program.count(NodeKind::BinaryExpression); ++i) {
+        const auto& binary = program.node<BinaryExpression>(NodeRef(NodeKind::BinaryExpression, i));
+        if (binary.op == BinaryOperator::Assign && binary.left.kind() == NodeKind::Identifier) {
+            written_.insert(program.node<Identifier>(binary.left).name);
+        }
+    }
+    for (uint32_t i = 0; i < program.count(NodeKind::FunctionDefinition); ++i) {
+        const auto& function = program.node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, i));
+        written_.insert(function.name);
+    }
+    for (uint32_t i = 0; i < program.count(NodeKind::ForStatement); ++i) {
+        const auto& loop = program.node<ForStatement>(NodeRef(NodeKind::ForStatement, i));
+        written_.insert(loop.variable);
+    }
+}
+
+// Scopes mirror the Resolver's, but only the current function is searched:
+// a function may run before the code that binds an outer variable
+void ConstantFolder::beginBlock() {
+    FunctionScope& scope = functions_.back();
+    scope.blockStarts.push_back(scope.bindings.size());
+}
+
+void ConstantFolder::endBlock() {
+    FunctionScope& scope = functions_.back();
+    scope.bindings.resize(scope.blockStarts.back());
+    scope.blockStarts.pop_back();
+}
+
+void ConstantFolder::declare(Atom name, const RuntimeValue* constant) {
+    functions_.back().bindings.push_back({name, constant != nullptr,
+                                          constant ? *constant : RuntimeValue()});
+}
+
+StringRef ConstantFolder::copyString(StringRef ref) {
+    return ast_.addString(source_->text(ref));
+}
+
+NodeRef ConstantFolder::copyTarget(NodeRef expr) {
+    // Callees and assignment targets: names are kept as written, since a
+    // propagated value there would change the error; anything else folds
+    if (expr.kind() == NodeKind::Identifier) {
+        return ast_.add(Identifier{source_->node<Identifier>(expr).name});
+    }
+    Folded folded = foldExpression(expr);
+    return emit(folded);
+}
+
+ConstantFolder::Folded ConstantFolder::constantOf(RuntimeValue value) {
+    Folded folded;
+    folded.type = value.isInt() ? ValueType::Int
+                : value.isDouble() ? ValueType::Float
+                : value.isBool() ? ValueType::Bool : ValueType::String;
+    folded.value = std::move(value);
+    folded.constant = true;
+    return folded;
+}
+
+NodeRef ConstantFolder::emit(Folded& folded) {
+    if (folded.node) {
+        return folded.node;
+    }
+    const RuntimeValue& value = folded.value;
+    if (value.isInt()) {
+        folded.node = ast_.add(IntegerLiteral{value.asInt()});
+    } else if (value.isDouble()) {
+        folded.node = ast_.add(FloatLiteral{value.asDouble()});
+    } else if (value.isBool()) {
+        folded.node = ast_.add(BooleanLiteral{value.asBool()});
+    } else {
+        folded.node = ast_.add(StringLiteral{ast_.addString(value.asString())});
+    }
+    return folded.node;
+}
+
+// Expressions
+ConstantFolder::Folded ConstantFolder::foldExpression(NodeRef expr, bool truthiness) {
+    // `truthiness` is set where only the truthiness of the value is used
+    const Program& program = *source_;
+    Folded folded;
+    switch (expr.kind()) {
+        case NodeKind::IntegerLiteral:
+            return constantOf(program.node<IntegerLiteral>(expr).value);
+        case NodeKind::FloatLiteral:
+            return constantOf(program.node<FloatLiteral>(expr).value);
+        case NodeKind::StringLiteral:
+            return constantOf(std::string(program.text(program.node<StringLiteral>(expr).value)));
+        case NodeKind::BooleanLiteral:
+            return constantOf(program.node<BooleanLiteral>(expr).value);
+        case NodeKind::Identifier: {
+            Atom name = program.node<Identifier>(expr).name;
+            const auto& bindings = functions_.back().bindings;
+            for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+                if (it->name == name) {
+                    if (!it->constant) {
+                        break;
+                    }
+                    ++folded_;
+                    return constantOf(it->value);
+                }
+            }
+            folded.node = ast_.add(Identifier{program.node<Identifier>(expr).name});
+            return folded;
+        }
+        case NodeKind::BinaryExpression:
+            return foldBinary(program.node<BinaryExpression>(expr));
+        case NodeKind::UnaryExpression:
+            return foldUnary(program.node<UnaryExpression>(expr), truthiness);
+        case NodeKind::FunctionCall: {
+            // The callee stays a name: a literal callee is a different error
+            const auto& call = program.node<FunctionCall>(expr);
+            NodeRef callee = copyTarget(call.function);
+            std::vector<NodeRef> arguments;
+            for (NodeRef argument : program.list(call.arguments)) {
+                Folded value = foldExpression(argument);
+                arguments.push_back(emit(value));
+            }
+            folded.node = ast_.add(FunctionCall{callee, ast_.addList(arguments)});
+            return folded;
+        }
+        case NodeKind::ArrayAccess: {
+            const auto& access = program.node<ArrayAccess>(expr);
+            Folded array = foldExpression(access.array);
+            Folded index = foldExpression(access.index);
+            folded.node = ast_.add(ArrayAccess{emit(array), emit(index)});
+            return folded;
+        }
+        case NodeKind::MemberAccess: {
+            const auto& access = program.node<MemberAccess>(expr);
+            Folded object = foldExpression(access.object);
+            folded.node = ast_.add(MemberAccess{emit(object), access.member});
+            return folded;
+        }
+        case NodeKind::ArrayLiteral: {
+            // Each evaluation makes a new array, so the literal itself is
+            // never a constant; its elements fold
+            std::vector<NodeRef> elements;
+            for (NodeRef element : program.list(program.node<ArrayLiteral>(expr).elements)) {
+                Folded value = foldExpression(element);
+                elements.push_back(emit(value));
+            }
+            folded.node = ast_.add(ArrayLiteral{ast_.addList(elements)});
+            return folded;
+        }
+        case NodeKind::ObjectLiteral: {
+            // Like arrays, objects are never constants
+            std::vector<NodeRef> properties;
+            for (NodeRef ref : program.list(program.node<ObjectLiteral>(expr).properties)) {
+                const auto& property = program.node<ObjectProperty>(ref);
+                Folded value = foldExpression(property.value);
+                properties.push_back(ast_.add(ObjectProperty{property.key, emit(value)}));
+            }
+            folded.node = ast_.add(ObjectLiteral{ast_.addList(properties)});
+            return folded;
+        }
+        case NodeKind::ContextConditional: {
+            const auto& conditional = program.node<ContextConditional>(expr);
+            if (!context_.empty() && (fixedContext_ || functions_.size() == 1)) {
+                ++folded_;
+                if (program.text(conditional.context) == context_) {
+                    return foldExpression(conditional.expression, truthiness);
+                }
+                return constantOf(RuntimeValue());
+            }
+            Folded inner = foldExpression(conditional.expression);
+            folded.node = ast_.add(ContextConditional{emit(inner), copyString(conditional.context)});
+            return folded;
+        }
+        default:
+            // A statement where an expression belongs stays an error
+            folded.node = foldStatement(expr);
+            return folded;
+    }
+}
+
+ConstantFolder::Folded ConstantFolder::foldBinary(const BinaryExpression& node) {
+    Folded folded;
+    if (node.op == BinaryOperator::Assign) {
+        // The target is written, never replaced by its value
+        NodeRef target = copyTarget(node.left);
+        Folded value = foldExpression(node.right);
+        folded.node = ast_.add(BinaryExpression{target, emit(value), node.op});
+        folded.type = value.type;
+        return folded;
+    }
+
+    bool logical = node.op == BinaryOperator::And || node.op == BinaryOperator::Or;
+    Folded left = foldExpression(node.left, logical);
+    Folded right = foldExpression(node.right, logical);
+
+    // Operations that fail are left for the runtime to report
+    if (left.constant && right.constant) {
+        try {
+            Folded constant = constantOf(evaluateBinary(node.op, left.value, right.value));
+            ++folded_;
+            return constant;
+        } catch (const std::exception&) {
+        }
+    }
+
+    // Operand types the TypeChecker proved, if it ran on the input
+    if (node.operands != ValueType::Unknown) {
+        if (left.type == ValueType::Unknown) left.type = node.operands;
+        if (right.type == ValueType::Unknown) right.type = node.operands;
+    }
+
+    // Identities; the remaining operand is still evaluated, so its side
+    // effects and errors are kept
+    auto keeps = [&](const Folded& operand, const Folded& other, ValueType type, bool identity) {
+        return operand.type == type && other.constant && identity;
+    };
+    switch (node.op) {
+        case BinaryOperator::Add:
+            if (keeps(left, right, ValueType::Int, isIntConstant(right.value, 0))) { ++folded_; return left; }
+            if (keeps(right, left, ValueType::Int, isIntConstant(left.value, 0))) { ++folded_; return right; }
+            break;
+        case BinaryOperator::Sub:
+            // x - +0.0 is x even for -0.0, unlike x + 0.0
+            if (keeps(left, right, ValueType::Int, isIntConstant(right.value, 0)) ||
+                keeps(left, right, ValueType::Float, isDoubleConstant(right.value, 0.0))) {
+                ++folded_;
+                return left;
+            }
+            break;
+        case BinaryOperator::Mul:
+            if (keeps(left, right, ValueType::Int, isIntConstant(right.value, 1)) ||
+                keeps(left, right, ValueType::Float, isDoubleConstant(right.value, 1.0))) {
+                ++folded_;
+                return left;
+            }
+            if (keeps(right, left, ValueType::Int, isIntConstant(left.value, 1)) ||
+                keeps(right, left, ValueType::Float, isDoubleConstant(left.value, 1.0))) {
+                ++folded_;
+                return right;
+            }
+            break;
+        case BinaryOperator::Div:
+            if (keeps(left, right, ValueType::Int, isIntConstant(right.value, 1)) ||
+                keeps(left, right, ValueType::Float, isDoubleConstant(right.value, 1.0))) {
+                ++folded_;
+                return left;
+            }
+            break;
+        default:
+            break;
+    }
+
+    NodeRef l = emit(left);
+    folded.node = ast_.add(BinaryExpression{l, emit(right), node.op});
+    switch (node.op) {
+        case BinaryOperator::Add:
+        case BinaryOperator::Sub:
+        case BinaryOperator::Mul:
+        case BinaryOperator::Div:
+            // Arithmetic needs operands of one type and keeps it
+            if (left.type == right.type && left.type != ValueType::Bool &&
+                (left.type != ValueType::String || node.op == BinaryOperator::Add)) {
+                folded.type = left.type;
+            }
+            break;
+        case BinaryOperator::Mod:
+        case BinaryOperator::Assign:
+            break;
+        default:
+            folded.type = ValueType::Bool;
+            break;
+    }
+    return folded;
+}
+
+ConstantFolder::Folded ConstantFolder::foldUnary(const UnaryExpression& node, bool truthiness) {
+    const Program& program = *source_;
+    Folded folded;
+    if (node.op == UnaryOperator::Not && node.operand.kind() == NodeKind::UnaryExpression &&
+        program.node<UnaryExpression>(node.operand).op == UnaryOperator::Not) {
+        // not not b is b when b is a bool, or when only truthiness counts
+        Folded inner = foldExpression(program.node<UnaryExpression>(node.operand).operand, true);
+        if (!inner.constant && (truthiness || inner.type == ValueType::Bool)) {
+            folded_ += 2;
+            return inner;
+        }
+        Folded negated = foldUnaryValue(UnaryOperator::Not, inner);
+        return foldUnaryValue(UnaryOperator::Not, negated);
+    }
+    Folded operand = foldExpression(node.operand, node.op == UnaryOperator::Not);
+    return foldUnaryValue(node.op, operand);
+}
+
+ConstantFolder::Folded ConstantFolder::foldUnaryValue(UnaryOperator op, Folded& operand) {
+    Folded folded;
+    if (operand.constant) {
+        try {
+            Folded constant = constantOf(evaluateUnary(op, operand.value));
+            ++folded_;
+            return constant;
+        } catch (const std::exception&) {
+        }
+    }
+    folded.node = ast_.add(UnaryExpression{emit(operand), op});
+    if (op == UnaryOperator::Not) {
+        folded.type = ValueType::Bool;
+    } else if (op == UnaryOperator::Neg && (operand.type == ValueType::Int || operand.type == ValueType::Float)) {
+        folded.type = operand.type;
+    }
+    return folded;
+}
+
+// Statements
+NodeList ConstantFolder::foldStatements(std::span<const NodeRef> statements) {
+    std::vector<NodeRef> folded;
+    folded.reserve(statements.size());
+    for (NodeRef stmt : statements) {
+        if (NodeRef copy = foldStatement(stmt)) {
+            folded.push_back(copy);
+        }
+    }
+    return ast_.addList(folded);
+}
+
+NodeRef ConstantFolder::foldStatement(NodeRef stmt) {
+    const Program& program = *source_;
+    switch (stmt.kind()) {
+        case NodeKind::ExpressionStatement: {
+            // A literal on its own does nothing (dev-only logging in prod)
+            Folded expression = foldExpression(program.node<ExpressionStatement>(stmt).expression);
+            if (expression.constant) {
+                ++folded_;
+                return NodeRef();
+            }
+            return ast_.add(ExpressionStatement{emit(expression)});
+        }
+        case NodeKind::VariableDeclaration: {
+            // The initializer still sees any outer binding of the same name
+            const auto& declaration = program.node<VariableDeclaration>(stmt);
+            VariableDeclaration copy{declaration.name, declaration.type};
+            copy.is_mutable = declaration.is_mutable;
+            Folded initializer;
+            if (declaration.initializer) {
+                initializer = foldExpression(declaration.initializer);
+                copy.initializer = emit(initializer);
+            } else {
+                initializer.value = int64_t(0);
+                initializer.constant = true;
+            }
+            Atom name = declaration.name;
+            bool constant = initializer.constant && !declaration.is_mutable && !written_.count(name);
+            declare(name, constant ? &initializer.value : nullptr);
+            return ast_.add(copy);
+        }
+        case NodeKind::Block: {
+            beginBlock();
+            NodeList statements = foldStatements(program.list(program.node<Block>(stmt).statements));
+            endBlock();
+            return ast_.add(Block{statements});
+        }
+        case NodeKind::FunctionDefinition:
+            return foldFunction(program.node<FunctionDefinition>(stmt));
+        case NodeKind::ReturnStatement: {
+            const auto& ret = program.node<ReturnStatement>(stmt);
+            ReturnStatement copy;
+            if (ret.value) {
+                Folded value = foldExpression(ret.value);
+                copy.value = emit(value);
+            }
+            return ast_.add(copy);
+        }
+        case NodeKind::IfStatement: {
+            const auto& branch = program.node<IfStatement>(stmt);
+            Folded condition = foldExpression(branch.condition, true);
+            if (condition.constant) {
+                // Only the branch taken is kept; no branch is an empty block
+                ++folded_;
+                NodeRef taken = runtimeValueTruthy(condition.value) ? branch.then_branch : branch.else_branch;
+                return taken ? foldBody(taken) : ast_.add(Block{ast_.addList({})});
+            }
+            NodeRef test = emit(condition);
+            NodeRef then_branch = foldBody(branch.then_branch);
+            NodeRef else_branch = branch.else_branch ? foldBody(branch.else_branch) : NodeRef();
+            return ast_.add(IfStatement{test, then_branch, else_branch});
+        }
+        case NodeKind::WhileStatement: {
+            const auto& loop = program.node<WhileStatement>(stmt);
+            Folded condition = foldExpression(loop.condition, true);
+            NodeRef test = emit(condition);
+            return ast_.add(WhileStatement{test, foldBody(loop.body)});
+        }
+        case NodeKind::ForStatement: {
+            const auto& loop = program.node<ForStatement>(stmt);
+            Folded start = foldExpression(loop.start);
+            Folded end = foldExpression(loop.end);
+            NodeRef first = emit(start);
+            NodeRef last = emit(end);
+            beginBlock();
+            declare(loop.variable, nullptr);
+            NodeRef body = foldBody(loop.body);
+            endBlock();
+            return ast_.add(ForStatement{loop.variable, first, last, body});
+        }
+        default:
+            if (!stmt) {
+                return stmt;
+            }
+            // An expression where a statement belongs stays an error
+            Folded expression = foldExpression(stmt);
+            return emit(expression);
+    }
+}
+
+NodeRef ConstantFolder::foldBody(NodeRef stmt) {
+    // Where a statement is required, one that folds away leaves an empty block
+    NodeRef folded = foldStatement(stmt);
+    return folded || !stmt ? folded : ast_.add(Block{ast_.addList({})});
+}
+
+NodeRef ConstantFolder::foldFunction(const FunctionDefinition& node) {
+    auto parameters = source_->parameters(node.parameters);
+    functions_.emplace_back();
+    for (const auto& param : parameters) {
+        declare(param.name, nullptr);
+    }
+    NodeRef body = node.body ? foldBody(node.body) : NodeRef();
+    functions_.pop_back();
+
+    FunctionDefinition copy{node.name, ast_.addParameters(parameters), node.return_type, body};
+    return ast_.add(copy);
+}
+
+} // namespace myndra
@@ -0,0 +1,110 @@
+#ifndef MYNDRA_CONSTANT_FOLDER_H
+#define MYNDRA_CONSTANT_FOLDER_H
+
+#include "../parser/ast.h"
+#include "../runtime/value.h"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace myndra {
+
+// Constant folding and algebraic simplification, run between parsing and
+// execution.
+//
+// A Program is one packed block that cannot grow, so the pass copies the
+// tree into a new Program, leaving out what it folded:
+//   - operators whose operands are all literals become one literal, using
+//     the engines' own evaluator; operations that would fail at runtime
+//     (division by zero, mixed operand types) are left for the runtime
+//     to report
+//   - identities (x + 0, x - 0, x * 1, x / 1, not not b) drop the no-op,
+//     but only where the operand is known to have a type the identity
+//     holds for (x + 0 is an error for a string x), or where only the
+//     truthiness of `not not b` matters. Literals and folded arithmetic
+//     have known types; so do operands the TypeChecker proved
+//     (BinaryExpression::operands), which is why the compiler folds again
+//     after checking.
+//   - `let` bindings that are never written (not `mut`, never assigned,
+//     no function of the same name) and whose initializer folded to a
+//     literal are propagated to later reads in the same function
+//   - if statements with a literal condition keep only the branch taken
+//   - context conditionals are resolved where the context is known (see
+//     the constructor): the expression, or 0 for another context
+//   - expression statements left with a literal value are dropped
+//
+// Runs before the Resolver; the output carries no annotations, not even
+// the TypeChecker's.
+class ConstantFolder {
+public:
+    // Top-level code runs right after folding, so with a `context` its
+    // conditionals are resolved for it. Function bodies may outlive a
+    // context change; theirs are resolved only if `fixedContext` (native
+    // code). Without a context every conditional is kept.
+    explicit ConstantFolder(std::string context = {}, bool fixedContext = false);
+
+    std::unique_ptr<Program> fold(const Program& program);
+
+    // Nodes the last fold() removed: folded or simplified operators, if
+    // statements and context conditionals, propagated variable reads and
+    // dropped statements
+    size_t foldedNodes() const { return folded_; }
+
+private:
+    // Result of folding an expression: a value not emitted yet, or a node
+    // already in the output
+    struct Folded {
+        NodeRef node;
+        RuntimeValue value;
+        bool constant = false;
+        ValueType type = ValueType::Unknown;
+    };
+
+    // A name in scope in the current function; `constant` if reads may be
+    // replaced by `value`
+    struct Binding {
+        Atom name;
+        bool constant;
+        RuntimeValue value;
+    };
+    struct FunctionScope {
+        std::vector<Binding> bindings;
+        std::vector<size_t> blockStarts;
+    };
+
+    std::string context_;
+    bool fixedContext_;
+    const Program* source_ = nullptr;
+    AstBuilder ast_;                         // Output program
+    std::vector<FunctionScope> functions_;
+    std::unordered_set<Atom> written_;       // Names assigned, or bound by a function or loop, anywhere
+    size_t folded_ = 0;
+
+    void collectWrites();
+
+    void beginBlock();
+    void endBlock();
+    void declare(Atom name, const RuntimeValue* constant);
+
+    Folded foldExpression(NodeRef expr, bool truthiness = false);
+    Folded foldBinary(const BinaryExpression& node);
+    Folded foldUnary(const UnaryExpression& node, bool truthiness);
+    Folded foldUnaryValue(UnaryOperator op, Folded& operand);
+    static Folded constantOf(RuntimeValue value);
+    NodeRef emit(Folded& folded);
+    NodeRef copyTarget(NodeRef expr);
+    StringRef copyString(StringRef ref);
+
+    NodeRef foldStatement(NodeRef stmt);
+    NodeRef foldBody(NodeRef stmt);
+    NodeList foldStatements(std::span<const NodeRef> statements);
+    NodeRef foldFunction(const FunctionDefinition& node);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_CONSTANT_FOLDER_H
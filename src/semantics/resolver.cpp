@@ -0,0 +1,233 @@
+#include "resolver.h"
+
+namespace myndra {
+
+Resolver::Resolver(const NativeRegistry& natives) : natives_(natives), functions_(1), program_(nullptr) {}
+
+void Resolver::resolve(Program& program) {
+    program_ = &program;
+    resolveStatements(program.statements());
+    program_ = nullptr;
+}
+
+void Resolver::beginBlock() {
+    FunctionScope& scope = functions_.back();
+    scope.blockStarts.push_back(scope.bindings.size());
+}
+
+void Resolver::endBlock() {
+    FunctionScope& scope = functions_.back();
+    size_t start = scope.blockStarts.back();
+    scope.blockStarts.pop_back();
+    
+    // Slots of the block's variables become free for later siblings
+    if (start < scope.bindings.size()) {
+        scope.nextSlot = scope.bindings[start].slot;
+    }
+    scope.bindings.resize(start);
+}
+
+SlotAddress Resolver::declare(Atom name) {
+    FunctionScope& scope = functions_.back();
+    uint32_t slot = scope.nextSlot++;
+    if (scope.nextSlot > scope.slotCount) {
+        scope.slotCount = scope.nextSlot;
+    }
+    scope.bindings.push_back({name, slot});
+    
+    SlotAddress address;
+    address.depth = functions_.size() == 1 ? SlotAddress::kGlobal : 0;
+    address.slot = slot;
+    return address;
+}
+
+SlotAddress Resolver::lookup(Atom name) const {
+    SlotAddress address;
+    for (size_t level = functions_.size(); level-- > 0;) {
+        const auto& bindings = functions_[level].bindings;
+        for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+            if (it->name == name) {
+                address.depth = level == 0 ? SlotAddress::kGlobal
+                                           : static_cast<uint16_t>(functions_.size() - 1 - level);
+                address.slot = it->slot;
+                return address;
+            }
+        }
+    }
+    return address; // Unresolved; reported when evaluated
+}
+
+void Resolver::hoistFunctions(std::span<const NodeRef> statements) {
+    for (NodeRef stmt : statements) {
+        if (stmt.kind() == NodeKind::FunctionDefinition) {
+            auto& function = program_->node<FunctionDefinition>(stmt);
+            function.address = declare(function.name);
+        }
+    }
+}
+
+void Resolver::resolveStatements(std::span<const NodeRef> statements) {
+    hoistFunctions(statements);
+    for (NodeRef stmt : statements) {
+        resolveStatement(stmt);
+    }
+}
+
+// Expressions
+void Resolver::resolveExpression(NodeRef expr) {
+    if (!expr) {
+        return;
+    }
+
+    Program& program = *program_;
+    switch (expr.kind()) {
+        case NodeKind::IntegerLiteral:
+        case NodeKind::FloatLiteral:
+        case NodeKind::StringLiteral:
+        case NodeKind::BooleanLiteral:
+            break;
+        case NodeKind::Identifier: {
+            auto& identifier = program.node<Identifier>(expr);
+            identifier.address = lookup(identifier.name);
+            break;
+        }
+        case NodeKind::BinaryExpression: {
+            const auto& binary = program.node<BinaryExpression>(expr);
+            resolveExpression(binary.left);
+            resolveExpression(binary.right);
+            break;
+        }
+        case NodeKind::UnaryExpression:
+            resolveExpression(program.node<UnaryExpression>(expr).operand);
+            break;
+        case NodeKind::FunctionCall: {
+            auto& call = program.node<FunctionCall>(expr);
+            resolveExpression(call.function);
+            if (call.function && call.function.kind() == NodeKind::Identifier) {
+                const auto& identifier = program.node<Identifier>(call.function);
+                if (!identifier.address.isResolved()) {
+                    call.native_id = natives_.lookup(identifier.name);
+                }
+            } else if (call.function && call.function.kind() == NodeKind::MemberAccess) {
+                // `x.f(args)` calls the native f(x, args)
+                call.native_id = natives_.lookup(program.node<MemberAccess>(call.function).member);
+            }
+            for (NodeRef arg : program.list(call.arguments)) {
+                resolveExpression(arg);
+            }
+            break;
+        }
+        case NodeKind::ArrayAccess: {
+            const auto& access = program.node<ArrayAccess>(expr);
+            resolveExpression(access.array);
+            resolveExpression(access.index);
+            break;
+        }
+        case NodeKind::MemberAccess:
+            resolveExpression(program.node<MemberAccess>(expr).object);
+            break;
+        case NodeKind::ArrayLiteral:
+            for (NodeRef element : program.list(program.node<ArrayLiteral>(expr).elements)) {
+                resolveExpression(element);
+            }
+            break;
+        case NodeKind::ObjectLiteral:
+            for (NodeRef property : program.list(program.node<ObjectLiteral>(expr).properties)) {
+                resolveExpression(program.node<ObjectProperty>(property).value);
+            }
+            break;
+        case NodeKind::ContextConditional: {
+            // The interpreter sets a function's conditionals when it enters it
+            auto& conditional = program.node<ContextConditional>(expr);
+            conditional.function = functions_.back().declaration;
+            resolveExpression(conditional.expression);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Statements
+void Resolver::resolveStatement(NodeRef stmt) {
+    if (!stmt) {
+        return;
+    }
+
+    Program& program = *program_;
+    switch (stmt.kind()) {
+        case NodeKind::ExpressionStatement:
+            resolveExpression(program.node<ExpressionStatement>(stmt).expression);
+            break;
+        case NodeKind::VariableDeclaration: {
+            // The initializer still sees any outer binding of the same name
+            auto& declaration = program.node<VariableDeclaration>(stmt);
+            resolveExpression(declaration.initializer);
+            declaration.address = declare(declaration.name);
+            break;
+        }
+        case NodeKind::Block:
+            beginBlock();
+            resolveStatements(program.list(program.node<Block>(stmt).statements));
+            endBlock();
+            break;
+        case NodeKind::FunctionDefinition:
+            resolveFunction(stmt);
+            break;
+        case NodeKind::ReturnStatement: {
+            auto& ret = program.node<ReturnStatement>(stmt);
+            if (ret.value) {
+                resolveExpression(ret.value);
+                ret.tail_call = functions_.size() > 1 && ret.value.kind() == NodeKind::FunctionCall;
+            }
+            break;
+        }
+        case NodeKind::IfStatement: {
+            const auto& branch = program.node<IfStatement>(stmt);
+            resolveExpression(branch.condition);
+            resolveStatement(branch.then_branch);
+            resolveStatement(branch.else_branch);
+            break;
+        }
+        case NodeKind::WhileStatement: {
+            const auto& loop = program.node<WhileStatement>(stmt);
+            resolveExpression(loop.condition);
+            resolveStatement(loop.body);
+            break;
+        }
+        case NodeKind::ForStatement: {
+            // The counter and end bound are hidden slots below the variable
+            auto& loop = program.node<ForStatement>(stmt);
+            resolveExpression(loop.start);
+            resolveExpression(loop.end);
+            beginBlock();
+            loop.address = declare(Atom());
+            declare(Atom());
+            declare(loop.variable);
+            resolveStatement(loop.body);
+            endBlock();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Resolver::resolveFunction(NodeRef stmt) {
+    auto& node = program_->node<FunctionDefinition>(stmt);
+    if (!node.address.isResolved()) {
+        node.address = declare(node.name);
+    }
+
+    // Parameters occupy the first slots of the new frame
+    functions_.emplace_back();
+    functions_.back().declaration = stmt.index();
+    for (const auto& param : program_->parameters(node.parameters)) {
+        declare(param.name);
+    }
+    resolveStatement(node.body);
+    node.frame_size = functions_.back().slotCount;
+    functions_.pop_back();
+}
+
+} // namespace myndra
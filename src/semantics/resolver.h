@@ -0,0 +1,65 @@
+#ifndef MYNDRA_RESOLVER_H
+#define MYNDRA_RESOLVER_H
+
+#include "../parser/ast.h"
+#include "../runtime/natives.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myndra {
+
+// Resolves every variable to a (depth, slot) lexical address.
+//
+// Each function activation owns one flat frame. Blocks do not get frames of
+// their own: their variables take the next free slots of the enclosing
+// frame, and those slots are reused once the block ends. Top-level bindings
+// persist across resolve() calls so a REPL session keeps its globals.
+// Calls to names that are not variables are bound to native function ids.
+class Resolver {
+public:
+    explicit Resolver(const NativeRegistry& natives = NativeRegistry::builtins());
+    
+    void resolve(Program& program);
+    
+    // Number of slots the global frame needs so far
+    uint32_t globalSlotCount() const { return functions_.front().slotCount; }
+    
+private:
+    struct Binding {
+        Atom name;
+        uint32_t slot;
+    };
+    
+    struct FunctionScope {
+        std::vector<Binding> bindings;      // Innermost binding last
+        std::vector<size_t> blockStarts;    // bindings size at each block entry
+        uint32_t nextSlot = 0;
+        uint32_t slotCount = 0;             // High-water mark, i.e. frame size
+        uint32_t declaration = ContextConditional::kTopLevel;  // FunctionDefinition index
+    };
+    
+    const NativeRegistry& natives_;
+    std::vector<FunctionScope> functions_;  // functions_[0] is the global scope
+    Program* program_;                      // Program being resolved
+    
+    void beginBlock();
+    void endBlock();
+    SlotAddress declare(Atom name);
+    SlotAddress lookup(Atom name) const;
+    
+    void resolveExpression(NodeRef expr);
+    void resolveStatement(NodeRef stmt);
+    void resolveFunction(NodeRef stmt);
+    void resolveStatements(std::span<const NodeRef> statements);
+    
+    // Functions are visible to the whole block that defines them, which
+    // allows mutual recursion between sibling functions
+    void hoistFunctions(std::span<const NodeRef> statements);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_RESOLVER_H
@@ -0,0 +1,685 @@
+#include "type_checker.h"
+#include <unordered_set>
+
+namespace myndra {
+
+TypeChecker::TypeChecker(bool wholeProgram, const NativeRegistry& natives) : wholeProgram_(wholeProgram), natives_(&natives) {}
+
+void TypeChecker::check(Program& program) {
+    program_ = &program;
+    errors_.clear();
+    typed_ = 0;
+    variables_.clear();
+    cells_.clear();
+    literals_.clear();
+    declarations_.clear();
+    loopVariables_.clear();
+    collectFunctions();
+
+    // Types only ever widen, so this settles after a few passes; the last
+    // one sees the final types
+    final_ = false;
+    do {
+        changed_ = false;
+        scopes_.assign(1, Scope());
+        enclosing_.assign(1, kNone);
+        checkStatements(program.statements());
+    } while (changed_);
+
+    final_ = true;
+    scopes_.assign(1, Scope());
+    enclosing_.assign(1, kNone);
+    checkStatements(program.statements());
+
+    scopes_.clear();
+    enclosing_.clear();
+    functions_.clear();
+    program_ = nullptr;
+}
+
+TypeChecker::Type TypeChecker::join(Type a, Type b) {
+    if (a == Type::None) return b;
+    if (b == Type::None) return a;
+    return a == b ? a : Type::Dynamic;
+}
+
+TypeChecker::Type TypeChecker::declaredType(std::string_view annotation) {
+    if (annotation.size() > 2 && annotation.front() == '[' && annotation.back() == ']') return Type::Array;
+    if (annotation == "int") return Type::Int;
+    if (annotation == "float") return Type::Float;
+    if (annotation == "bool") return Type::Bool;
+    if (annotation == "string") return Type::String;
+    return Type::None;  // Absent, or a type not modelled here
+}
+
+const char* TypeChecker::typeName(Type type) {
+    switch (type) {
+        case Type::Int: return "int";
+        case Type::Float: return "float";
+        case Type::Bool: return "bool";
+        case Type::String: return "string";
+        case Type::Array: return "array";
+        default: return "dynamic";
+    }
+}
+
+TypeChecker::Inferred TypeChecker::join(const Inferred& a, const Inferred& b) {
+    if (a.type == Type::None) return b;
+    if (b.type == Type::None) return a;
+    if (a.type == Type::Array && b.type == Type::Array) {
+        // Either may now be the other, so a write to one is a write to both
+        uint32_t kept = root(a.elements);
+        uint32_t merged = root(b.elements);
+        if (kept != merged) {
+            cells_[merged].parent = kept;
+            cells_[kept].element = join(cells_[kept].element, cells_[merged].element);
+            changed_ = true;
+        }
+        return Inferred(Type::Array, kept);
+    }
+    if (a.type == b.type) {
+        return a;
+    }
+    escape(a);
+    escape(b);
+    return Type::Dynamic;
+}
+
+uint32_t TypeChecker::root(uint32_t cell) {
+    while (cells_[cell].parent != cell) {
+        cells_[cell].parent = cells_[cells_[cell].parent].parent;
+        cell = cells_[cell].parent;
+    }
+    return cell;
+}
+
+TypeChecker::Type TypeChecker::elementType(const Inferred& array) {
+    if (array.type == Type::None) {
+        return Type::None;
+    }
+    return array.type == Type::Array ? cells_[root(array.elements)].element : Type::Dynamic;
+}
+
+void TypeChecker::widenElements(uint32_t cell, const Inferred& value) {
+    Type type = value.type;
+    if (type == Type::Array) {
+        escape(value);
+        type = Type::Dynamic;
+    }
+    Cell& elements = cells_[root(cell)];
+    Type joined = join(elements.element, type);
+    if (joined != elements.element) {
+        elements.element = joined;
+        changed_ = true;
+    }
+}
+
+void TypeChecker::escape(const Inferred& value) {
+    if (value.type == Type::Array) {
+        widenElements(value.elements, Type::Dynamic);
+    }
+}
+
+std::string TypeChecker::describe(const Inferred& value) {
+    Type element = elementType(value);
+    if (value.type == Type::Array && known(element)) {
+        return "[" + std::string(typeName(element)) + "]";
+    }
+    return typeName(value.type);
+}
+
+// Whether what was inferred disagrees with `annotation`. Annotations not
+// modelled here, and types not known yet, never do.
+bool TypeChecker::contradicts(std::string_view annotation, const Inferred& value) {
+    Type declared = declaredType(annotation);
+    if (!known(declared) || !known(value.type)) {
+        return false;
+    }
+    if (declared != value.type) {
+        return true;
+    }
+    if (declared != Type::Array) {
+        return false;
+    }
+    Type element = declaredType(annotation.substr(1, annotation.size() - 2));
+    Type inferred = elementType(value);
+    return known(element) && known(inferred) && element != inferred;
+}
+
+void TypeChecker::collectFunctions() {
+    // A function is called directly if its name is bound nowhere else:
+    // never assigned, declared as a variable or parameter, or defined twice
+    const Program& program = *program_;
+    std::unordered_map<Atom, uint32_t> definitions;
+    std::unordered_set<Atom> rebound;
+    for (uint32_t i = 0; i < program.count(NodeKind::FunctionDefinition); ++i) {
+        const auto& function = program.node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, i));
+        ++definitions[function.name];
+        for (const auto& param : program.parameters(function.parameters)) {
+            rebound.insert(param.name);
+        }
+    }
+    for (uint32_t i = 0; i < program.count(NodeKind::VariableDeclaration); ++i) {
+        rebound.insert(program.node<VariableDeclaration>(NodeRef(NodeKind::VariableDeclaration, i)).name);
+    }
+    for (uint32_t i = 0; i < program.count(NodeKind::ForStatement); ++i) {
+        rebound.insert(program.node<ForStatement>(NodeRef(NodeKind::ForStatement, i)).variable);
+    }
+    for (uint32_t i = 0; i < program.count(NodeKind::BinaryExpression); ++i) {
+        const auto& binary = program.node<BinaryExpression>(NodeRef(NodeKind::BinaryExpression, i));
+        if (binary.op == BinaryOperator::Assign && binary.left.kind() == NodeKind::Identifier) {
+            rebound.insert(program.node<Identifier>(binary.left).name);
+        }
+    }
+
+    // Its parameters are typed only if every call is one we see: it is
+    // never used as a value, and nothing outside can name it
+    std::unordered_set<uint32_t> callees;
+    for (uint32_t i = 0; i < program.count(NodeKind::FunctionCall); ++i) {
+        NodeRef callee = program.node<FunctionCall>(NodeRef(NodeKind::FunctionCall, i)).function;
+        if (callee.kind() == NodeKind::Identifier) {
+            callees.insert(callee.index());
+        }
+    }
+    std::unordered_set<Atom> escaping;
+    for (uint32_t i = 0; i < program.count(NodeKind::Identifier); ++i) {
+        if (!callees.count(i)) {
+            escaping.insert(program.node<Identifier>(NodeRef(NodeKind::Identifier, i)).name);
+        }
+    }
+    std::unordered_set<uint32_t> visible;  // Top-level functions, callable from later programs
+    for (NodeRef stmt : program.statements()) {
+        if (stmt.kind() == NodeKind::FunctionDefinition) {
+            visible.insert(stmt.index());
+        }
+    }
+
+    functions_.assign(program.count(NodeKind::FunctionDefinition), Function());
+    for (uint32_t i = 0; i < functions_.size(); ++i) {
+        const auto& definition = program.node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, i));
+        Atom name = definition.name;
+        Function& function = functions_[i];
+        function.direct = definitions[name] == 1 && !rebound.count(name);
+        bool typed = function.direct && !escaping.count(name) && (wholeProgram_ || !visible.count(i));
+        for (uint32_t p = 0; p < definition.parameters.count; ++p) {
+            function.parameters.push_back(typed ? newVariable() : kNone);
+        }
+    }
+}
+
+uint32_t TypeChecker::newVariable() {
+    variables_.push_back(Type::None);
+    return static_cast<uint32_t>(variables_.size() - 1);
+}
+
+void TypeChecker::widen(uint32_t variable, const Inferred& value) {
+    Inferred joined = join(variables_[variable], value);
+    if (joined.type != variables_[variable].type) {
+        changed_ = true;
+    }
+    variables_[variable] = joined;
+}
+
+void TypeChecker::widenResult(uint32_t function, const Inferred& value) {
+    Inferred joined = join(functions_[function].result, value);
+    if (joined.type != functions_[function].result.type) {
+        changed_ = true;
+    }
+    functions_[function].result = joined;
+}
+
+// Scopes mirror the Resolver's
+void TypeChecker::beginBlock() {
+    Scope& scope = scopes_.back();
+    scope.blockStarts.push_back(scope.bindings.size());
+}
+
+void TypeChecker::endBlock() {
+    Scope& scope = scopes_.back();
+    scope.bindings.resize(scope.blockStarts.back());
+    scope.blockStarts.pop_back();
+}
+
+void TypeChecker::declare(Atom name, uint32_t variable, uint32_t function) {
+    scopes_.back().bindings.push_back({name, variable, function});
+}
+
+const TypeChecker::Binding* TypeChecker::lookup(Atom name, bool& local) const {
+    for (size_t level = scopes_.size(); level-- > 0;) {
+        const auto& bindings = scopes_[level].bindings;
+        for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+            if (it->name == name) {
+                local = level == scopes_.size() - 1;
+                return &*it;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::string TypeChecker::where() const {
+    uint32_t function = enclosing_.back();
+    if (function == kNone) {
+        return "Type error: ";
+    }
+    const auto& definition = program_->node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, function));
+    return "Type error in fn " + std::string(program_->text(definition.name)) + ": ";
+}
+
+void TypeChecker::report(const std::string& message) {
+    if (final_) {
+        errors_.push_back(where() + message);
+    }
+}
+
+// Expressions
+TypeChecker::Inferred TypeChecker::checkExpression(NodeRef expr) {
+    if (!expr) {
+        return Type::None;
+    }
+
+    Program& program = *program_;
+    switch (expr.kind()) {
+        case NodeKind::IntegerLiteral:
+            return Type::Int;
+        case NodeKind::FloatLiteral:
+            return Type::Float;
+        case NodeKind::StringLiteral:
+            return Type::String;
+        case NodeKind::BooleanLiteral:
+            return Type::Bool;
+        case NodeKind::Identifier: {
+            bool local = false;
+            const Binding* binding = lookup(program.node<Identifier>(expr).name, local);
+            if (binding && binding->variable != kNone) {
+                if (local) {
+                    return variables_[binding->variable];
+                }
+                // Not followed into this function, which may write to it
+                escape(variables_[binding->variable]);
+            }
+            return Type::Dynamic;
+        }
+        case NodeKind::BinaryExpression:
+            return checkBinary(program.node<BinaryExpression>(expr));
+        case NodeKind::UnaryExpression:
+            return checkUnary(program.node<UnaryExpression>(expr));
+        case NodeKind::FunctionCall:
+            return checkCall(program.node<FunctionCall>(expr));
+        case NodeKind::ArrayAccess: {
+            const auto& access = program.node<ArrayAccess>(expr);
+            Inferred array = checkExpression(access.array);
+            checkExpression(access.index);
+            return elementType(array);
+        }
+        case NodeKind::MemberAccess:
+            checkExpression(program.node<MemberAccess>(expr).object);
+            return Type::Dynamic;
+        case NodeKind::ArrayLiteral: {
+            auto [entry, inserted] = literals_.try_emplace(expr.index(), kNone);
+            if (inserted) {
+                entry->second = static_cast<uint32_t>(cells_.size());
+                cells_.push_back({entry->second});
+            }
+            uint32_t cell = entry->second;
+            for (NodeRef element : program.list(program.node<ArrayLiteral>(expr).elements)) {
+                widenElements(cell, checkExpression(element));
+            }
+            return Inferred(Type::Array, cell);
+        }
+        case NodeKind::ObjectLiteral:
+            for (NodeRef property : program.list(program.node<ObjectLiteral>(expr).properties)) {
+                escape(checkExpression(program.node<ObjectProperty>(property).value));
+            }
+            return Type::Dynamic;
+        case NodeKind::ContextConditional:
+            // 0 in any other context
+            return join(checkExpression(program.node<ContextConditional>(expr).expression), Inferred(Type::Int));
+        default:
+            return Type::Dynamic;
+    }
+}
+
+TypeChecker::Inferred TypeChecker::checkBinary(BinaryExpression& node) {
+    if (node.op == BinaryOperator::Assign) {
+        Inferred value = checkExpression(node.right);
+        if (node.left.kind() == NodeKind::Identifier) {
+            // Outer variables are widened too: a function may write a global
+            bool local = false;
+            const Binding* binding = lookup(program_->node<Identifier>(node.left).name, local);
+            if (binding && binding->variable != kNone) {
+                widen(binding->variable, value);
+            } else {
+                escape(value);
+            }
+        } else if (node.left.kind() == NodeKind::ArrayAccess) {
+            const auto& access = program_->node<ArrayAccess>(node.left);
+            Inferred array = checkExpression(access.array);
+            checkExpression(access.index);
+            if (array.type == Type::Array) {
+                widenElements(array.elements, value);
+            } else {
+                escape(value);
+            }
+        } else {
+            checkExpression(node.left);
+            escape(value);
+        }
+        return value;
+    }
+
+    Inferred checkedLeft = checkExpression(node.left);
+    Inferred checkedRight = checkExpression(node.right);
+    Type left = checkedLeft.type;
+    Type right = checkedRight.type;
+    if (final_) {
+        bool annotated = node.op != BinaryOperator::Mod && node.op <= BinaryOperator::Ge &&
+                         left == right && (left == Type::Int || left == Type::Float);
+        node.operands = !annotated ? ValueType::Unknown : left == Type::Int ? ValueType::Int : ValueType::Float;
+        typed_ += annotated;
+    }
+    if (left == Type::None || right == Type::None) {
+        return Type::None;  // Never produces a value (yet)
+    }
+
+    bool numeric = left == right && (left == Type::Int || left == Type::Float);
+    bool dynamic = left == Type::Dynamic || right == Type::Dynamic;
+    const char* text = binaryOperatorText(node.op);
+    switch (node.op) {
+        case BinaryOperator::Add:
+            if (numeric || (left == Type::String && right == Type::String)) {
+                return left;
+            }
+            break;
+        case BinaryOperator::Sub:
+        case BinaryOperator::Mul:
+        case BinaryOperator::Div:
+            if (numeric) {
+                return left;
+            }
+            break;
+        case BinaryOperator::Eq:
+        case BinaryOperator::Ne:
+        case BinaryOperator::And:
+        case BinaryOperator::Or:
+            return Type::Bool;
+        case BinaryOperator::Lt:
+        case BinaryOperator::Le:
+        case BinaryOperator::Gt:
+        case BinaryOperator::Ge:
+            if (numeric || dynamic) {
+                return Type::Bool;
+            }
+            break;
+        default:
+            report(std::string("operator ") + text + " is not supported");
+            return Type::None;
+    }
+    if (dynamic) {
+        return Type::Dynamic;
+    }
+    report(std::string("invalid operands for ") + text + ": " + typeName(left) + " and " + typeName(right));
+    return Type::None;
+}
+
+TypeChecker::Inferred TypeChecker::checkUnary(const UnaryExpression& node) {
+    Type operand = checkExpression(node.operand).type;
+    if (operand == Type::None) {
+        return Type::None;
+    }
+    switch (node.op) {
+        case UnaryOperator::Not:
+            return Type::Bool;
+        case UnaryOperator::Neg:
+            if (operand == Type::Int || operand == Type::Float || operand == Type::Dynamic) {
+                return operand;
+            }
+            report(std::string("invalid operand for negation: ") + typeName(operand));
+            return Type::None;
+        default:
+            report(std::string("unary ") + unaryOperatorText(node.op) + " is not supported");
+            return Type::None;
+    }
+}
+
+TypeChecker::Inferred TypeChecker::checkCall(const FunctionCall& node) {
+    const Program& program = *program_;
+    std::vector<Inferred> arguments;
+    if (node.function.kind() == NodeKind::MemberAccess) {
+        // `x.f(args)` calls the native f(x, args), whatever this program binds
+        const auto& access = program.node<MemberAccess>(node.function);
+        arguments.push_back(checkExpression(access.object));
+        for (NodeRef argument : program.list(node.arguments)) {
+            arguments.push_back(checkExpression(argument));
+        }
+        return checkNative(access.member, arguments, true);
+    }
+    for (NodeRef argument : program.list(node.arguments)) {
+        arguments.push_back(checkExpression(argument));
+    }
+    if (node.function.kind() != NodeKind::Identifier) {
+        checkExpression(node.function);
+        return checkNative(Atom(), arguments, false);
+    }
+
+    // Anything but a function of this program (a variable, a native, a
+    // function of an earlier program) is dynamic
+    bool local = false;
+    Atom name = program.node<Identifier>(node.function).name;
+    const Binding* binding = lookup(name, local);
+    if (!binding) {
+        // Only a native, unless an earlier program defined the name
+        return checkNative(name, arguments, wholeProgram_);
+    }
+    if (binding->function == kNone || !functions_[binding->function].direct) {
+        return checkNative(Atom(), arguments, false);
+    }
+    Function& function = functions_[binding->function];
+    const auto& definition = program.node<FunctionDefinition>(NodeRef(NodeKind::FunctionDefinition, binding->function));
+    if (arguments.size() != definition.parameters.count) {
+        report("fn " + std::string(program.text(definition.name)) + " takes " +
+               std::to_string(definition.parameters.count) + " arguments, got " + std::to_string(arguments.size()));
+        return Type::None;
+    }
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        if (function.parameters[i] != kNone) {
+            widen(function.parameters[i], arguments[i]);
+        } else {
+            escape(arguments[i]);
+        }
+    }
+    return function.result;
+}
+
+// A callee the checker does not follow may do anything with the arrays it
+// is given, except for the builtins when `builtin` says `name` is theirs
+TypeChecker::Inferred TypeChecker::checkNative(Atom name, const std::vector<Inferred>& arguments, bool builtin) {
+    std::string_view text = builtin && isBuiltin(name) ? name.text() : std::string_view();
+    if (text == "print") {
+        return Type::Dynamic;
+    }
+    if (arguments.size() == 1 && text == "length") {
+        return Type::Int;
+    }
+    if (arguments.size() == 2 && text == "push" && arguments[0].type == Type::Array) {
+        widenElements(arguments[0].elements, arguments[1]);
+        return Type::Int;
+    }
+    if (arguments.size() == 1 && (text == "pop" || text == "shift")) {
+        return elementType(arguments[0]);
+    }
+    if (arguments.size() == 1 && text == "sum") {
+        // An empty array sums to int 0, whatever its elements would be
+        return elementType(arguments[0]) == Type::Int ? Type::Int : Type::Dynamic;
+    }
+    for (const Inferred& argument : arguments) {
+        escape(argument);
+    }
+    return Type::Dynamic;
+}
+
+bool TypeChecker::isBuiltin(Atom name) const {
+    const NativeRegistry& builtins = NativeRegistry::builtins();
+    uint16_t id = natives_->lookup(name);
+    uint16_t builtinId = builtins.lookup(name);
+    if (id == NativeRegistry::kNone || builtinId == NativeRegistry::kNone) {
+        return false;
+    }
+    const NativeRegistry::Entry& entry = natives_->entries()[id];
+    const NativeRegistry::Entry& builtin = builtins.entries()[builtinId];
+    return entry.fn == builtin.fn && entry.data == builtin.data;
+}
+
+// Statements
+void TypeChecker::hoistFunctions(std::span<const NodeRef> statements) {
+    for (NodeRef stmt : statements) {
+        if (stmt.kind() == NodeKind::FunctionDefinition) {
+            declare(program_->node<FunctionDefinition>(stmt).name, kNone, stmt.index());
+        }
+    }
+}
+
+void TypeChecker::checkStatements(std::span<const NodeRef> statements) {
+    hoistFunctions(statements);
+    for (NodeRef stmt : statements) {
+        checkStatement(stmt);
+    }
+}
+
+void TypeChecker::checkStatement(NodeRef stmt) {
+    if (!stmt) {
+        return;
+    }
+
+    Program& program = *program_;
+    switch (stmt.kind()) {
+        case NodeKind::ExpressionStatement:
+            checkExpression(program.node<ExpressionStatement>(stmt).expression);
+            break;
+        case NodeKind::VariableDeclaration: {
+            // The initializer still sees any outer binding of the same name
+            const auto& declaration = program.node<VariableDeclaration>(stmt);
+            Inferred value = declaration.initializer ? checkExpression(declaration.initializer) : Type::Int;
+            Atom name = declaration.name;
+            std::string_view declared = program.text(declaration.type);
+            if (contradicts(declared, value)) {
+                report("variable '" + std::string(name.text()) + "' is declared " + std::string(declared) +
+                       " but initialized with " + describe(value));
+            }
+            // Top-level blocks hand their slots on to later blocks' globals,
+            // which functions may still write under the old name
+            uint32_t variable = kNone;
+            if (scopes_.size() > 1 || scopes_.back().blockStarts.empty()) {
+                auto [entry, inserted] = declarations_.try_emplace(stmt.index(), kNone);
+                if (inserted) {
+                    entry->second = newVariable();
+                }
+                variable = entry->second;
+                widen(variable, value);
+            } else {
+                escape(value);
+            }
+            declare(name, variable);
+            break;
+        }
+        case NodeKind::Block:
+            beginBlock();
+            checkStatements(program.list(program.node<Block>(stmt).statements));
+            endBlock();
+            break;
+        case NodeKind::FunctionDefinition:
+            checkFunction(stmt);
+            break;
+        case NodeKind::ReturnStatement: {
+            const auto& ret = program.node<ReturnStatement>(stmt);
+            Inferred value = ret.value ? checkExpression(ret.value) : Type::Int;
+            if (enclosing_.back() != kNone) {
+                widenResult(enclosing_.back(), value);
+            }
+            break;
+        }
+        case NodeKind::IfStatement: {
+            const auto& branch = program.node<IfStatement>(stmt);
+            checkExpression(branch.condition);
+            checkStatement(branch.then_branch);
+            checkStatement(branch.else_branch);
+            break;
+        }
+        case NodeKind::WhileStatement: {
+            const auto& loop = program.node<WhileStatement>(stmt);
+            checkExpression(loop.condition);
+            checkStatement(loop.body);
+            break;
+        }
+        case NodeKind::ForStatement: {
+            const auto& loop = program.node<ForStatement>(stmt);
+            Type start = checkExpression(loop.start).type;
+            Type end = checkExpression(loop.end).type;
+            for (Type bound : {start, end}) {
+                if (known(bound) && bound != Type::Int) {
+                    report("for loop range bounds must be int, got " + std::string(typeName(bound)));
+                    break;
+                }
+            }
+            // The body only runs with integer bounds, so the variable starts
+            // out an int; in a top-level loop it is dynamic like any block's
+            uint32_t variable = kNone;
+            if (scopes_.size() > 1) {
+                auto [entry, inserted] = loopVariables_.try_emplace(stmt.index(), kNone);
+                if (inserted) {
+                    entry->second = newVariable();
+                }
+                variable = entry->second;
+                widen(variable, Type::Int);
+            }
+            beginBlock();
+            declare(loop.variable, variable);
+            checkStatement(loop.body);
+            endBlock();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void TypeChecker::checkFunction(NodeRef stmt) {
+    const Program& program = *program_;
+    const auto& definition = program.node<FunctionDefinition>(stmt);
+    Function& function = functions_[stmt.index()];
+
+    scopes_.emplace_back();
+    enclosing_.push_back(stmt.index());
+    auto parameters = program.parameters(definition.parameters);
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        uint32_t variable = function.parameters[i];
+        std::string_view declared = program.text(parameters[i].type);
+        if (variable != kNone && contradicts(declared, variables_[variable])) {
+            report("parameter '" + std::string(program.text(parameters[i].name)) + "' is declared " +
+                   std::string(declared) + " but receives " + describe(variables_[variable]));
+        }
+        declare(parameters[i].name, variable);
+    }
+
+    checkStatement(definition.body);
+    // Running off the end returns 0
+    NodeRef last;
+    if (definition.body.kind() == NodeKind::Block) {
+        auto statements = program.list(program.node<Block>(definition.body).statements);
+        if (!statements.empty()) {
+            last = statements.back();
+        }
+    }
+    if (last.kind() != NodeKind::ReturnStatement) {
+        widenResult(stmt.index(), Type::Int);
+    }
+
+    std::string_view declared = program.text(definition.return_type);
+    if (contradicts(declared, function.result)) {
+        report("declared to return " + std::string(declared) + " but returns " + describe(function.result));
+    }
+    enclosing_.pop_back();
+    scopes_.pop_back();
+}
+
+} // namespace myndra
@@ -0,0 +1,166 @@
+#ifndef MYNDRA_TYPE_CHECKER_H
+#define MYNDRA_TYPE_CHECKER_H
+
+#include "../parser/ast.h"
+#include "../runtime/natives.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace myndra {
+
+// Static type inference, run after constant folding. The compiler then
+// folds once more, since identities such as x + 0 need proven types.
+//
+// Every variable, parameter and function result gets the join of all the
+// values that can reach it: a single type (int, float, bool, string,
+// array) or "dynamic". Types flow through operators, `let` initializers,
+// assignments, returns and direct calls; the program is walked until
+// nothing changes.
+//
+// Arrays are shared by reference, so an array's element type belongs to
+// every place the array can reach: arrays that meet (in a variable, a
+// parameter, a result) share one element type, widened by literals,
+// element stores and push(). An array that reaches something the checker
+// does not follow (a dynamic or outer variable, an unknown callee, a
+// container) may be written by it, and its elements become dynamic.
+//
+// Annotations are not enforced at runtime (a parameter declared `int` may
+// receive a function), so nothing is trusted because of them; they are
+// checked against what was inferred instead. What is trusted has to be
+// proven:
+//   - a parameter's type comes from its call sites, so only functions
+//     that are always called directly by name (never passed around,
+//     reassigned or redefined) have typed parameters, and only if no other
+//     program can call them: nested functions, or any function when the
+//     checker is told it sees the whole program
+//   - variables (for loop variables included) are typed within the
+//     function that declares them; reads of outer variables are dynamic.
+//     Top-level variables of nested blocks are dynamic too, since their
+//     slots are reused.
+//   - the array builtins are only known by name where nothing else can
+//     own the name: in `x.f(args)` calls, which always reach a native, or
+//     when the checker sees the whole program; and only while the
+//     registry still holds the builtin itself, not a host replacement
+//
+// Binary arithmetic and comparisons whose operands (element reads
+// included) are proven to be both ints or both floats are annotated (BinaryExpression::operands) for the
+// engines to drop their type dispatch. Operations that can only fail,
+// wrong argument counts and annotations that disagree with the inferred
+// types are reported; they stay runtime errors, so reports do not stop
+// the program.
+class TypeChecker {
+public:
+    // `wholeProgram`: no code outside the programs checked calls into them.
+    // `natives`: the registry the programs will call, which the host may
+    // have redefined builtins in
+    explicit TypeChecker(bool wholeProgram = false, const NativeRegistry& natives = NativeRegistry::builtins());
+
+    void check(Program& program);
+
+    const std::vector<std::string>& errors() const { return errors_; }
+    // Operations the last check() annotated with their operand type
+    size_t typedOperations() const { return typed_; }
+
+private:
+    // Inference lattice: None (no value seen yet) < a type < Dynamic
+    enum class Type : uint8_t { None, Int, Float, Bool, String, Array, Dynamic };
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // What an expression, variable or result holds; arrays also name the
+    // cell holding their element type
+    struct Inferred {
+        Type type = Type::None;
+        uint32_t elements = kNone;  // Index into cells_, for arrays
+
+        Inferred(Type type = Type::None, uint32_t elements = kNone) : type(type), elements(elements) {}
+    };
+    // Element type shared by arrays that meet; merged union-find style.
+    // Elements are followed one level deep: an array stored in an array
+    // makes both dynamic.
+    struct Cell {
+        uint32_t parent;
+        Type element = Type::None;
+    };
+
+    // A name in scope: a typed variable, a function, or neither (dynamic)
+    struct Binding {
+        Atom name;
+        uint32_t variable = kNone;  // Index into variables_
+        uint32_t function = kNone;  // FunctionDefinition index
+    };
+    struct Scope {
+        std::vector<Binding> bindings;
+        std::vector<size_t> blockStarts;
+    };
+    struct Function {
+        std::vector<uint32_t> parameters;  // Variables, or kNone if untyped
+        Inferred result;
+        bool direct = false;               // Calls by name always reach it
+    };
+
+    bool wholeProgram_;
+    const NativeRegistry* natives_;  // A pointer, so checkers stay assignable
+    Program* program_ = nullptr;
+    std::vector<Inferred> variables_;
+    std::vector<Cell> cells_;
+    std::unordered_map<uint32_t, uint32_t> literals_;      // ArrayLiteral index -> cell
+    std::unordered_map<uint32_t, uint32_t> declarations_;  // VariableDeclaration index -> variable
+    std::unordered_map<uint32_t, uint32_t> loopVariables_; // ForStatement index -> variable
+    std::vector<Function> functions_;                      // By FunctionDefinition index
+    std::vector<Scope> scopes_;                            // scopes_[0] is the top level
+    std::vector<uint32_t> enclosing_;                      // Function being checked per scope
+    bool changed_ = false;
+    bool final_ = false;   // Last pass: annotate and report
+    std::vector<std::string> errors_;
+    size_t typed_ = 0;
+
+    static Type join(Type a, Type b);
+    static Type declaredType(std::string_view annotation);
+    static const char* typeName(Type type);
+    static bool known(Type type) { return type != Type::None && type != Type::Dynamic; }
+
+    // Join that merges the cells of two arrays, and gives up on the
+    // elements of an array joined with anything else
+    Inferred join(const Inferred& a, const Inferred& b);
+    uint32_t root(uint32_t cell);
+    Type elementType(const Inferred& array);
+    void widenElements(uint32_t cell, const Inferred& value);
+    // `value` goes where it is no longer followed
+    void escape(const Inferred& value);
+    std::string describe(const Inferred& value);
+    bool contradicts(std::string_view annotation, const Inferred& value);
+
+    void collectFunctions();
+    uint32_t newVariable();
+    void widen(uint32_t variable, const Inferred& value);
+    void widenResult(uint32_t function, const Inferred& value);
+
+    void beginBlock();
+    void endBlock();
+    void declare(Atom name, uint32_t variable, uint32_t function = kNone);
+    const Binding* lookup(Atom name, bool& local) const;
+    std::string where() const;
+    void report(const std::string& message);
+
+    Inferred checkExpression(NodeRef expr);
+    Inferred checkBinary(BinaryExpression& node);
+    Inferred checkUnary(const UnaryExpression& node);
+    Inferred checkCall(const FunctionCall& node);
+    Inferred checkNative(Atom name, const std::vector<Inferred>& arguments, bool builtin);
+    // `name` calls the core builtin of that name
+    bool isBuiltin(Atom name) const;
+
+    void checkStatement(NodeRef stmt);
+    void checkStatements(std::span<const NodeRef> statements);
+    void checkFunction(NodeRef stmt);
+    void hoistFunctions(std::span<const NodeRef> statements);
+};
+
+} // namespace myndra
+
+#endif // MYNDRA_TYPE_CHECKER_H
@@ -23,44 +23,10 @@ void statement_parser_stub() {
 }
 
 // Semantics stubs
-void semantic_analyzer_stub() {
-    // TODO: Implement semantic analysis
-}
-
-void type_checker_stub() {
-    // TODO: Implement type checking
-}
-
-void symbol_table_stub() {
-    // TODO: Implement symbol table
-}
-
 void context_analyzer_stub() {
     // TODO: Implement context analysis
 }
 
-// Code generation stubs
-void llvm_codegen_stub() {
-    // TODO: Implement LLVM code generation
-}
-
-void optimization_stub() {
-    // TODO: Implement optimizations
-}
-
-// Runtime stubs
-void vm_stub() {
-    // TODO: Implement virtual machine
-}
-
-void garbage_collector_stub() {
-    // TODO: Implement garbage collector
-}
-
-void memory_manager_stub() {
-    // TODO: Implement memory manager
-}
-
 // Reactive stubs
 void reactive_engine_stub() {
     // TODO: Implement reactive engine
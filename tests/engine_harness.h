@@ -0,0 +1,137 @@
+#ifndef MYNDRA_TESTS_ENGINE_HARNESS_H
+#define MYNDRA_TESTS_ENGINE_HARNESS_H
+
+// Helpers shared by the tests that run programs: parsing test sources and
+// running them on each execution engine with their output captured.
+
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "interpreter/interpreter.h"
+#include "codegen/bytecode_compiler.h"
+#include "runtime/vm.h"
+#include <cassert>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace myndra::testing {
+
+// Parses `source`, which must lex and parse cleanly
+inline std::unique_ptr<Program> parse(const std::string& source) {
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    assert(!lexer.has_errors());
+
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    assert(!parser.hasErrors());
+    return program;
+}
+
+// Captures everything printed to stdout (and stderr, if asked) while alive
+class Capture {
+public:
+    explicit Capture(std::ostringstream* log = nullptr)
+        : original_(std::cout.rdbuf(output_.rdbuf())), log_(log) {
+        if (log_) {
+            originalLog_ = std::cerr.rdbuf(log_->rdbuf());
+        }
+    }
+    ~Capture() { restore(); }
+
+    // Puts the streams back and returns what was printed
+    std::string restore() {
+        if (original_) {
+            std::cout.rdbuf(original_);
+            original_ = nullptr;
+        }
+        if (originalLog_) {
+            std::cerr.rdbuf(originalLog_);
+            originalLog_ = nullptr;
+        }
+        return output_.str();
+    }
+
+private:
+    std::ostringstream output_;
+    std::streambuf* original_;
+    std::ostringstream* log_;
+    std::streambuf* originalLog_ = nullptr;
+};
+
+enum class Engine {
+    Interpreter,  // The tree walker
+    VM,           // Bytecode only; the JIT is off
+    JIT,          // Every function compiled on its first call
+    Tiered        // Tree walker promoting functions to the VM and the JIT
+};
+
+constexpr std::initializer_list<Engine> kAllEngines = {Engine::Interpreter, Engine::VM, Engine::JIT, Engine::Tiered};
+
+inline const char* engineName(Engine engine) {
+    switch (engine) {
+        case Engine::Interpreter: return "Interpreter";
+        case Engine::VM: return "VM";
+        case Engine::JIT: return "JIT";
+        case Engine::Tiered: return "Tiered";
+    }
+    return "?";
+}
+
+// Runs `program` on `engine` in deployment context `context` and returns
+// what it printed. A runtime error ends the output with an "error: <message>"
+// line.
+inline std::string runOn(Engine engine, Program& program, const std::string& context = std::string(kDefaultContext)) {
+    Capture capture;
+    try {
+        if (engine == Engine::Interpreter || engine == Engine::Tiered) {
+            TieringOptions tiering;
+            if (engine == Engine::Tiered) {
+                tiering.threshold = 2;
+                tiering.jitThreshold = 2;
+            }
+            tiering.perfMap = false;
+            Interpreter interpreter(NativeRegistry::builtins(), true, tiering);
+            interpreter.setContext(context);
+            interpreter.execute(program);
+        } else {
+            // A threshold of 0 turns the JIT off
+            Jit::Options jit;
+            jit.threshold = engine == Engine::JIT ? 1 : 0;
+            jit.perfMap = false;
+            BytecodeCompiler compiler;
+            compiler.setContext(context);
+            VM vm(NativeRegistry::builtins(), 1 << 18, jit);
+            vm.execute(compiler.compile(program));
+        }
+    } catch (const std::exception& e) {
+        std::cout << "error: " << e.what() << "\n";
+    }
+    return capture.restore();
+}
+
+// Runs `source` on each of `engines`, parsing it afresh for each since the
+// engines annotate the program in place, asserts they all print the same
+// and returns that output
+inline std::string runAll(const std::string& source, std::initializer_list<Engine> engines = kAllEngines,
+                          const std::string& context = std::string(kDefaultContext)) {
+    std::vector<std::string> outputs;
+    for (Engine engine : engines) {
+        outputs.push_back(runOn(engine, *parse(source), context));
+    }
+    for (size_t i = 1; i < outputs.size(); ++i) {
+        if (outputs[i] != outputs[0]) {
+            std::cerr << engineName(engines.begin()[0]) << " output:\n" << outputs[0] << "\n"
+                      << engineName(engines.begin()[i]) << " output:\n" << outputs[i] << std::endl;
+        }
+        assert(outputs[i] == outputs[0]);
+    }
+    return outputs[0];
+}
+
+} // namespace myndra::testing
+
+#endif // MYNDRA_TESTS_ENGINE_HARNESS_H
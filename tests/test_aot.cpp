@@ -0,0 +1,361 @@
+#include "engine_harness.h"
+#include "codegen/llvm_codegen.h"
+#include "myndra.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+namespace fs = std::filesystem;
+
+// Scratch directory for the objects and executables
+fs::path work_dir;
+
+// Whether `source` lexes and parses cleanly
+bool parses(const std::string& source) {
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    if (lexer.has_errors()) {
+        return false;
+    }
+    Parser parser(tokens);
+    parser.parseProgram();
+    return !parser.hasErrors();
+}
+
+// Everything the interpreter prints for `source`, ending with the runtime
+// error in the form a native program reports it
+std::string interpret(const std::string& source) {
+    auto program = parse(source);
+    Capture capture;
+    try {
+        Interpreter interpreter;
+        interpreter.execute(*program);
+    } catch (const std::exception& e) {
+        std::cout << "Runtime error: " << e.what() << "\n";
+    }
+    return capture.restore();
+}
+
+// Builds `source` into an executable and returns what running it prints
+std::string compile_and_run(const std::string& source, const std::string& name) {
+    auto program = parse(source);
+
+    fs::path object = work_dir / (name + ".o");
+    fs::path executable = work_dir / name;
+    LlvmCodegen codegen;
+    codegen.emitObject(*program, object.string());
+    LlvmCodegen::linkExecutable(object.string(), executable.string());
+
+    std::string command = "'" + executable.string() + "' 2>&1";
+    FILE* pipe = popen(command.c_str(), "r");
+    assert(pipe);
+    std::string output;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, n);
+    }
+    pclose(pipe);
+    return output;
+}
+
+// The native program must print exactly what the interpreter does
+std::string check_same(const std::string& source, const std::string& name) {
+    std::string expected = interpret(source);
+    std::string actual = compile_and_run(source, name);
+    if (expected != actual) {
+        std::cerr << "Interpreter output:\n" << expected << "\nNative output:\n" << actual << std::endl;
+    }
+    assert(expected == actual);
+    return actual;
+}
+
+void test_arithmetic() {
+    std::cout << "Testing native arithmetic..." << std::endl;
+
+    auto output = check_same(R"(
+        let x = 42;
+        let y = x + 8;
+        print(x * y - 1, y / 3, 1.5 * 2.0, -x, 7 - 10);
+        print(x < y, x >= y, x == 42, x != 42, not (x < y));
+        print(2.5 < 3.5, 2.5 == 2.5, 1.0 / 4.0, -0.5);
+        let big = 140737488355327;
+        print(big + 1, big * big, -big - 1, 0 - (big + 1));
+        print(9223372036854775807 / 2, 17 % 5);
+        print(true and false, true or false, not 0, not 1.5);
+    )", "arithmetic");
+    assert(output.find("2099 16 3.000000 -42 -3\n") == 0);
+
+    std::cout << "✓ Native arithmetic test passed" << std::endl;
+}
+
+void test_control_flow() {
+    std::cout << "Testing native control flow..." << std::endl;
+
+    check_same(R"(
+        let i = 0;
+        let total = 0;
+        while i < 100 {
+            if i % 3 == 0 {
+                total = total + i;
+            } else {
+                total = total - 1;
+            }
+            i = i + 1;
+        }
+        print(total, i);
+        if 0.0 { print("zero is true"); } else { print("zero is false"); }
+        if "text" { print("strings are true"); }
+    )", "control_flow");
+
+    // Counted loops: the counter is a machine integer, the variable a copy
+    check_same(R"(
+        fn triangle(n: int) -> int {
+            let total = 0;
+            for i in 0..n {
+                total = total + i;
+                i = -1;
+            }
+            return total;
+        }
+        print(triangle(100), triangle(0), triangle(-5));
+        for row in 1..4 {
+            let line = "";
+            for col in 0..row { line = line + "*"; }
+            print(row, line);
+        }
+        for big in 140737488355326..140737488355329 { print(big); }
+    )", "for_loops");
+
+    // Context conditionals are resolved for the default context, "dev"
+    check_same(R"(
+        fn scale(x: int) -> int {
+            print("scaling", x) if context == "dev";
+            return x * 10 if context == "prod";
+        }
+        print(scale(4), 7 if context == "dev");
+    )", "context");
+
+    std::cout << "✓ Native control flow test passed" << std::endl;
+}
+
+void test_strings() {
+    std::cout << "Testing native strings..." << std::endl;
+
+    auto output = check_same(R"(
+        let greeting = "Hello";
+        let i = 0;
+        while i < 3 {
+            print(greeting + ", world", length(greeting));
+            i = i + 1;
+        }
+        print(substring("Myndra", 1, 3), greeting == "Hello");
+    )", "strings");
+    assert(output.find("Hello, world 5\n") == 0);
+
+    // Appending builds ropes, flattened once when read
+    output = check_same(R"(
+        let log = "";
+        for i in 0..100000 { log = log + "entry line\n"; }
+        print(length(log), substring(log, 1099995, 10), length(substring(log, 5, 40)));
+    )", "string_log");
+    assert(output == "1100000 line\n 40\n");
+
+    std::cout << "✓ Native strings test passed" << std::endl;
+}
+
+void test_arrays() {
+    std::cout << "Testing native arrays..." << std::endl;
+
+    auto output = check_same(R"(
+        let squares = [];
+        for i in 0..10 { squares.push(i * i); }
+        squares[0] = "zero";
+        print(squares, squares.length());
+        print(squares.pop() + squares[1], squares.shift(), sum([1.5, 2.5]));
+        let grid = [[1, 2], [3, 4]];
+        print(grid[1][0] = 7, grid);
+        print(grid[2]);
+    )", "arrays");
+    assert(output.find("[\"zero\", 1, 4, 9, 16, 25, 36, 49, 64, 81] 10\n") == 0);
+    assert(output.find("Runtime error: Array index 2 out of bounds for length 2") != std::string::npos);
+
+    std::cout << "✓ Native arrays test passed" << std::endl;
+}
+
+void test_objects() {
+    std::cout << "Testing native objects..." << std::endl;
+
+    auto output = check_same(R"(
+        fn area(r: Rect) -> int { return r.w * r.h; }
+        let shapes = [{ w: 2, h: 3 }, { name: "sq", w: 4, h: 4 }];
+        let total = 0;
+        for i in 0..2 { total = total + area(shapes[i]); }
+        let p = { x: 1, "y": 2, };
+        p.z = p.x + p.y;
+        print(total, p, p.z);
+        print(p.missing);
+    )", "objects");
+    assert(output.find("22 {x: 1, y: 2, z: 3} 3\n") == 0);
+    assert(output.find("Runtime error: Object has no property 'missing'") != std::string::npos);
+
+    std::cout << "✓ Native objects test passed" << std::endl;
+}
+
+void test_functions() {
+    std::cout << "Testing native functions..." << std::endl;
+
+    // Direct calls, tail calls and calls through function values
+    auto output = check_same(R"(
+        fn fib(n: int) -> int {
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        fn sum(n: int, acc: int) -> int {
+            if n == 0 { return acc; }
+            return sum(n - 1, acc + n);
+        }
+        fn twice(f: int, x: int) -> int {
+            return f(f(x));
+        }
+        fn inc(x: int) -> int {
+            return x + 1;
+        }
+        fn nothing() {
+            let unused = "dropped";
+        }
+        print(fib(20), sum(100000, 0), twice(inc, 5), nothing());
+        let g = inc;
+        print(g(1));
+        g = fib;
+        print(g(10));
+    )", "functions");
+    assert(output == "6765 5000050000 7 0\n2\n55\n");
+
+    // A reassigned function name is called through its current value
+    check_same(R"(
+        fn op(x: int) -> int { return x * 2; }
+        print(op(4));
+        fn op(x: int) -> int { return x * 3; }
+        print(op(4));
+        return;
+        print("not reached");
+    )", "redefined");
+
+    std::cout << "✓ Native functions test passed" << std::endl;
+}
+
+void test_runtime_errors() {
+    std::cout << "Testing native runtime errors..." << std::endl;
+
+    const std::vector<std::string> programs = {
+        "print(1); print(10 / 0);",
+        "print(1.0 / 0.0);",
+        "print(1 + 1.5);",
+        "print(\"a\" - 1);",
+        "let x = 5; print(x(1));",
+        "fn f(a: int) -> int { return a; } let g = f; print(g(1, 2));",
+        "fn deep(n: int) -> int { return 1 + deep(n + 1); } print(deep(0));",
+        "print(early(1)); fn early(n: int) -> int { return n; }",
+        "print(missing(1));",
+        "print(+1);",
+        "for i in 0..2.5 { print(i); }",
+    };
+    for (size_t i = 0; i < programs.size(); ++i) {
+        auto output = check_same(programs[i], "error" + std::to_string(i));
+        assert(output.find("Runtime error: ") != std::string::npos);
+    }
+
+    std::cout << "✓ Native runtime errors test passed" << std::endl;
+}
+
+void test_examples() {
+    std::cout << "Testing native examples..." << std::endl;
+
+    // Examples the current grammar cannot parse yet are skipped
+    size_t compiled = 0;
+    size_t skipped = 0;
+    for (const auto& entry : fs::directory_iterator(MYNDRA_EXAMPLES_DIR)) {
+        if (entry.path().extension() != ".myn") {
+            continue;
+        }
+        std::ifstream file(entry.path());
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!parses(source)) {
+            ++skipped;
+            continue;
+        }
+        check_same(source, "example_" + entry.path().stem().string());
+        ++compiled;
+    }
+    std::cout << "  " << compiled << " compiled, " << skipped << " skipped (not parseable yet)" << std::endl;
+
+    std::cout << "✓ Native examples test passed" << std::endl;
+}
+
+void test_compiler_api() {
+    std::cout << "Testing Compiler::emit_native..." << std::endl;
+
+    fs::path source = work_dir / "api.myn";
+    std::ofstream(source) << "fn square(x: int) -> int { return x * x; }\nprint(square(12));\n";
+
+    Compiler compiler;
+    fs::path object = work_dir / "api.o";
+    assert(compiler.emit_native(source.string(), NativeOutput::OBJECT, object.string()));
+    assert(fs::file_size(object) > 0);
+
+    fs::path executable = work_dir / "api";
+    assert(compiler.emit_native(source.string(), NativeOutput::EXECUTABLE, executable.string()));
+    assert(!fs::exists(executable.string() + ".o"));
+    FILE* pipe = popen(("'" + executable.string() + "'").c_str(), "r");
+    char line[64] = {};
+    assert(fgets(line, sizeof(line), pipe));
+    assert(pclose(pipe) == 0);
+    assert(std::string(line) == "144\n");
+
+    assert(!compiler.emit_native((work_dir / "missing.myn").string(), NativeOutput::OBJECT, object.string()));
+
+    std::cout << "✓ Compiler::emit_native test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra AOT Tests..." << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    char dir_template[] = "/tmp/myndra_aot_XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        std::cerr << "✗ Cannot create a scratch directory" << std::endl;
+        return 1;
+    }
+    work_dir = dir_template;
+
+    int status = 0;
+    try {
+        test_arithmetic();
+        test_control_flow();
+        test_strings();
+        test_arrays();
+        test_objects();
+        test_functions();
+        test_runtime_errors();
+        test_examples();
+        test_compiler_api();
+
+        std::cout << std::endl;
+        std::cout << "✓ All AOT tests passed!" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        status = 1;
+    }
+    fs::remove_all(work_dir);
+    return status;
+}
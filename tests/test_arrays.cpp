@@ -0,0 +1,228 @@
+#include "engine_harness.h"
+#include "runtime/array.h"
+#include <iostream>
+#include <cassert>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+// Instructions with opcode `op` in the top-level code of `source`
+size_t countOps(const std::string& source, OpCode op) {
+    auto program = parse(source);
+    Chunk chunk = BytecodeCompiler().compile(*program);
+    size_t count = 0;
+    for (const Instruction& ins : chunk.code) {
+        count += ins.op == op;
+    }
+    return count;
+}
+
+void test_elements_kinds() {
+    std::cout << "Testing elements kinds..." << std::endl;
+    using Kind = ArrayObject::ElementsKind;
+
+    RuntimeValue ints[] = {RuntimeValue(int64_t(1)), RuntimeValue(int64_t(2))};
+    RuntimeValue array = ArrayObject::make(ints, 2);
+    ArrayObject* object = asArray(array);
+    assert(isArray(array) && !isArray(ints[0]));
+    assert(object->kind == Kind::Int && object->length == 2);
+    assert(object->get(1).asInt() == 2);
+
+    // Ints beyond the immediate range stay unboxed
+    object->push(RuntimeValue(int64_t(1) << 60));
+    assert(object->kind == Kind::Int);
+    assert(object->get(2).asInt() == int64_t(1) << 60);
+
+    // Anything the kind cannot hold converts the whole buffer, once
+    object->set(0, RuntimeValue(2.5));
+    assert(object->kind == Kind::Generic);
+    assert(object->get(0).asDouble() == 2.5 && object->get(1).asInt() == 2);
+    object->set(0, RuntimeValue(int64_t(7)));
+    assert(object->kind == Kind::Generic);
+
+    RuntimeValue empty = ArrayObject::make(nullptr, 0);
+    assert(asArray(empty)->kind == Kind::Empty && asArray(empty)->data == nullptr);
+    asArray(empty)->push(RuntimeValue(true));
+    assert(asArray(empty)->kind == Kind::Bool);
+    asArray(empty)->push(RuntimeValue(false));
+    assert(asArray(empty)->kind == Kind::Bool);
+    asArray(empty)->push(RuntimeValue("text"));
+    assert(asArray(empty)->kind == Kind::Generic);
+    assert(asArray(empty)->get(1).asBool() == false && asArray(empty)->get(2).asString() == "text");
+
+    RuntimeValue doubles[] = {RuntimeValue(1.5), RuntimeValue(0.0 / 0.0)};
+    assert(asArray(ArrayObject::make(doubles, 2))->kind == Kind::Double);
+
+    // Growth keeps the elements
+    RuntimeValue grown = ArrayObject::make(nullptr, 0);
+    for (int64_t i = 0; i < 1000; ++i) {
+        asArray(grown)->push(RuntimeValue(i));
+    }
+    assert(asArray(grown)->length == 1000 && asArray(grown)->capacity >= 1000);
+    assert(asArray(grown)->get(999).asInt() == 999);
+    assert(asArray(grown)->shift().asInt() == 0 && asArray(grown)->pop().asInt() == 999);
+    assert(asArray(grown)->length == 998 && asArray(grown)->get(0).asInt() == 1);
+
+    std::cout << "✓ Elements kinds test passed" << std::endl;
+}
+
+void test_array_basics() {
+    std::cout << "Testing array literals, indexing and builtins..." << std::endl;
+
+    assert(runAll("print([1, 2, 3]); print([]); print([true, \"a\", [2]]);") == "[1, 2, 3]\n[]\n[true, \"a\", [2]]\n");
+    assert(runAll("let a = [10, 20, 30]; print(a[0] + a[2]); let i = 1; print(a[i]);") == "40\n20\n");
+
+    // Element stores, including ones that change the kind
+    assert(runAll("let a = [1, 2]; a[0] = 5; print(a); a[1] = \"x\"; print(a); print(a[1] = 3);") ==
+           "[5, 2]\n[5, \"x\"]\n3\n");
+
+    // Builtins, called directly or as methods
+    assert(runAll(R"(
+        let a = [];
+        push(a, 1);
+        print(a.push(2));
+        print(length(a), a.length());
+        print(a.sum());
+        print(a.pop(), a.shift(), a);
+    )") == "2\n2 2\n3\n2 1 []\n");
+    assert(runAll("print(sum([1.5, 2.5])); print(sum([])); print(sum([\"a\", \"b\"]));") == "4.000000\n0\nab\n");
+
+    // Arrays are truthy when they are not empty, and shared by reference
+    assert(runAll(R"(
+        if [] { print(1); } else { print(0); }
+        let a = [1];
+        let b = a;
+        b.push(2);
+        print(a);
+    )") == "0\n[1, 2]\n");
+
+    // A self-containing array prints its inner reference as [...]
+    assert(runAll("let a = [1]; a.push(a); print(a);") == "[1, [...]]\n");
+
+    std::cout << "✓ Array basics test passed" << std::endl;
+}
+
+void test_array_errors() {
+    std::cout << "Testing array errors..." << std::endl;
+
+    assert(runAll("let a = [1, 2]; print(a[2]);") == "error: Array index 2 out of bounds for length 2\n");
+    assert(runAll("let a = [1, 2]; a[-1] = 0;") == "error: Array index -1 out of bounds for length 2\n");
+    assert(runAll("let a = [1]; print(a[true]);") == "error: Array index must be an integer\n");
+    assert(runAll("let x = 3; print(x[0]);") == "error: Only arrays can be indexed\n");
+    assert(runAll("let a = []; a.pop();") == "error: pop() called on an empty array\n");
+    assert(runAll("let a = []; a.frobnicate();") == "error: Method 'frobnicate' is not defined\n");
+
+    std::cout << "✓ Array errors test passed" << std::endl;
+}
+
+void test_bounds_check_elimination() {
+    std::cout << "Testing bounds-check elimination..." << std::endl;
+
+    // Indexes by the loop variable skip the checks once the range is proven
+    std::string loop = R"(
+        let a = [1, 2, 3, 4];
+        let b = [0, 0, 0, 0];
+        let total = 0;
+        for i in 0..4 {
+            b[i] = a[i] * 2;
+            total = total + b[i];
+        }
+        print(total, b);
+    )";
+    assert(runAll(loop) == "20 [2, 4, 6, 8]\n");
+    assert(countOps(loop, OpCode::IN_BOUNDS) == 2);
+    assert(countOps(loop, OpCode::GET_INDEX_UNCHECKED) == 2);
+    assert(countOps(loop, OpCode::SET_INDEX_UNCHECKED) == 1);
+    assert(countOps(loop, OpCode::GET_INDEX) == 2);   // In the checked copy
+
+    // A range past the end runs the checked copy, which raises in place
+    assert(runAll("let a = [1, 2, 3]; for i in 0..5 { print(a[i]); }") ==
+           "1\n2\n3\nerror: Array index 3 out of bounds for length 3\n");
+    assert(runAll("let a = [1, 2, 3]; for i in -1..2 { print(a[i]); }") ==
+           "error: Array index -1 out of bounds for length 3\n");
+
+    // Bodies that can shrink or rebind the array keep their checks
+    std::string shrinking = "let a = [1, 2, 3, 4]; for i in 0..4 { print(a[i]); a.pop(); }";
+    assert(runAll(shrinking) == "1\n2\nerror: Array index 2 out of bounds for length 2\n");
+    assert(countOps(shrinking, OpCode::IN_BOUNDS) == 0);
+    std::string rebinding = "let a = [1, 2]; for i in 0..2 { print(a[i]); a = [5]; }";
+    assert(runAll(rebinding) == "1\nerror: Array index 1 out of bounds for length 1\n");
+    assert(countOps(rebinding, OpCode::IN_BOUNDS) == 0);
+    std::string calling = "let a = [1, 2]; fn f() { a = []; } for i in 0..2 { f(); print(a[i]); }";
+    assert(runAll(calling) == "error: Array index 0 out of bounds for length 0\n");
+    assert(countOps(calling, OpCode::IN_BOUNDS) == 0);
+
+    // Growing is fine, and so are kind changes in the unchecked copy
+    std::string growing = "let a = [1, 2, 3]; for i in 0..3 { a.push(a[i]); a[i] = 0.5; } print(a);";
+    assert(runAll(growing) == "[0.500000, 0.500000, 0.500000, 1, 2, 3]\n");
+    assert(countOps(growing, OpCode::IN_BOUNDS) == 1);
+    assert(runAll(R"(
+        let a = [1.5, 2.5];
+        for i in 0..2 { a[i] = a[i] * 2.0; }
+        print(a);
+        for i in 0..2 { a[i] = true; }
+        print(a);
+    )") == "[3.000000, 5.000000]\n[true, true]\n");
+
+    // A failed guard runs the checked copy, whose temporaries and locals
+    // must not land on the loop's own registers
+    std::string guarded = "for i in 0..4 { push(xs, 20 + i); let v = xs[i]; let w = v * 2; print(i, w); }";
+    assert(runAll("let xs = [10]; " + guarded) == "0 20\n1 40\n2 42\n3 44\n");
+    assert(runAll("fn f() { let xs = [10]; " + guarded + " } f();") == "0 20\n1 40\n2 42\n3 44\n");
+    assert(runAll("let xs = [1, 2]; for i in 0..3 { let t = \"s\"; print(xs[i], t); }") ==
+           "1 s\n2 s\nerror: Array index 2 out of bounds for length 2\n");
+
+    // Hot loops in functions: the JIT's inline paths and its slow paths
+    assert(runAll(R"(
+        fn fill(n: int) -> [int] {
+            let a = [];
+            for i in 0..n { a.push(i * i); }
+            return a;
+        }
+        fn total(a: [int], n: int) -> int {
+            let s = 0;
+            for i in 0..n { s = s + a[i]; }
+            return s;
+        }
+        let squares = fill(100);
+        print(total(squares, 100), total(squares, 10));
+        squares[3] = 1000000000000000;
+        print(total(squares, 5));
+        print(total(squares, 101));
+    )") == "328350 285\n1000000000000021\nerror: Array index 100 out of bounds for length 100\n");
+
+    std::cout << "✓ Bounds-check elimination test passed" << std::endl;
+}
+
+void test_array_cycles() {
+    std::cout << "Testing array cycles..." << std::endl;
+
+    GcHeap heap;
+    {
+        GcHeap::Scope scope(heap);
+        RuntimeValue a = ArrayObject::make(nullptr, 0);
+        RuntimeValue b = ArrayObject::make(nullptr, 0);
+        asArray(a)->push(b);
+        asArray(b)->push(a);
+        asArray(b)->push(RuntimeValue("kept alive by b"));
+    }
+    assert(heap.stats().liveBytes > 0);
+    heap.collect();
+    assert(heap.stats().objectsCollected == 2);
+    assert(heap.stats().liveBytes == 0);
+
+    std::cout << "✓ Array cycles test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running array tests..." << std::endl;
+
+    test_elements_kinds();
+    test_array_basics();
+    test_array_errors();
+    test_bounds_check_elimination();
+    test_array_cycles();
+
+    std::cout << "All array tests passed!" << std::endl;
+    return 0;
+}
@@ -1,6 +1,11 @@
 #include "../include/myndra.h"
+#include "parser/ast.h"
+#include <cstring>
 #include <iostream>
 #include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 using namespace myndra;
 
@@ -209,6 +214,140 @@ void test_error_handling() {
     std::cout << "✓ Error handling test passed (found " << errors.size() << " errors as expected)" << std::endl;
 }
 
+void test_native_registration() {
+    std::cout << "Testing native function registration..." << std::endl;
+    
+    for (auto engine : {ExecutionEngine::INTERPRETER, ExecutionEngine::BYTECODE_VM}) {
+        Compiler::Options options;
+        options.target_context = "test";
+        options.engine = engine;
+        Compiler compiler(options);
+        
+        std::vector<int64_t> seen;
+        bool registered = compiler.register_native("record", [&seen](const std::vector<Value>& args) {
+            int64_t sum = 0;
+            for (const auto& arg : args) {
+                sum += std::get<int64_t>(arg.data);
+            }
+            seen.push_back(sum);
+            return Value(sum);
+        });
+        assert(registered);
+        assert(!compiler.register_native("", nullptr));
+        
+        bool result = compiler.compile_string("let total = record(1, 2, 3); record(total, 4);");
+        assert(result);
+        assert(seen.size() == 2 && seen[0] == 6 && seen[1] == 10);
+        
+        // Natives are visible to later programs, and errors they raise surface as runtime errors
+        compiler.register_native("fail", [](const std::vector<Value>&) -> Value {
+            throw std::runtime_error("host failure");
+        });
+        assert(!compiler.compile_string("fail();"));
+        assert(compiler.get_errors().back() == "Runtime error: host failure");
+    }
+    
+    std::cout << "✓ Native function registration test passed" << std::endl;
+}
+
+void test_module_cache() {
+    std::cout << "Testing module cache..." << std::endl;
+    
+    auto directory = std::filesystem::temp_directory_path() / "myndra_test_module_cache";
+    std::filesystem::remove_all(directory);
+    
+    std::string source = R"(
+        fn fib(n: int) -> int {
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        record(fib(15), 7 * 6);
+    )";
+    
+    // Each compiler stands in for one start of the service
+    auto run = [&](ExecutionEngine engine) {
+        Compiler::Options options;
+        options.target_context = "test";
+        options.engine = engine;
+        options.module_cache_dir = directory.string();
+        Compiler compiler(options);
+        
+        std::vector<int64_t> seen;
+        compiler.register_native("record", [&seen](const std::vector<Value>& args) {
+            for (const auto& arg : args) {
+                seen.push_back(std::get<int64_t>(arg.data));
+            }
+            return Value();
+        });
+        assert(compiler.compile_string(source));
+        assert(seen == std::vector<int64_t>({610, 42}));
+        return compiler.get_module_cache_stats();
+    };
+    
+    ModuleCacheStats cold = run(ExecutionEngine::INTERPRETER);
+    assert(cold.hits == 0 && cold.misses == 1 && cold.writes == 1);
+    
+    auto entry = std::filesystem::directory_iterator(directory)->path();
+    auto read = [&entry] {
+        std::ifstream in(entry, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+    std::string written = read();
+    
+    // Warm starts map the entry; resolving it must not write through to the file
+    for (auto engine : {ExecutionEngine::INTERPRETER, ExecutionEngine::BYTECODE_VM}) {
+        ModuleCacheStats warm = run(engine);
+        assert(warm.hits == 1 && warm.misses == 0 && warm.writes == 0);
+    }
+    assert(read() == written);
+    
+    // A damaged entry is a miss and gets rewritten
+    std::filesystem::resize_file(entry, written.size() / 2);
+    ModuleCacheStats damaged = run(ExecutionEngine::INTERPRETER);
+    assert(damaged.hits == 0 && damaged.misses == 1 && damaged.writes == 1);
+    assert(read() == written);
+    
+    // So is an entry for a different source behind a matching header, as
+    // after a hash collision, and one whose nodes point outside the block
+    auto rewrite = [&entry](const std::string& bytes) {
+        std::ofstream out(entry, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    };
+    std::string collided = written;
+    collided.back() ^= 1;  // The entry ends with its source
+    rewrite(collided);
+    ModuleCacheStats collision = run(ExecutionEngine::INTERPRETER);
+    assert(collision.hits == 0 && collision.misses == 1 && collision.writes == 1);
+    
+    constexpr size_t kEntryHeaderBytes = 64;
+    ProgramLayout layout;
+    std::memcpy(&layout, written.data() + kEntryHeaderBytes, sizeof(layout));
+    assert(layout.refCount > 0);
+    std::string dangling = written;
+    NodeRef outside(NodeKind::Block, layout.counts[static_cast<size_t>(NodeKind::Block)] + 100);
+    std::memcpy(dangling.data() + kEntryHeaderBytes + layout.refsOffset, &outside, sizeof(outside));
+    rewrite(dangling);
+    ModuleCacheStats corrupt = run(ExecutionEngine::INTERPRETER);
+    assert(corrupt.hits == 0 && corrupt.misses == 1 && corrupt.writes == 1);
+    assert(read() == written);
+
+    // Damage that leaves every reference in bounds fails the checksum: an
+    // identifier byte flipped in place would otherwise call another native
+    assert(layout.stringBytes > 0);
+    std::string flipped = written;
+    flipped[kEntryHeaderBytes + layout.stringsOffset + layout.stringBytes - 1] ^= 1;
+    rewrite(flipped);
+    for (auto engine : {ExecutionEngine::INTERPRETER, ExecutionEngine::BYTECODE_VM}) {
+        ModuleCacheStats checked = run(engine);
+        assert(checked.hits == 0 && checked.misses == 1 && checked.writes == 1);
+        assert(read() == written);
+        rewrite(flipped);
+    }
+    
+    std::filesystem::remove_all(directory);
+    std::cout << "✓ Module cache test passed" << std::endl;
+}
+
 int main() {
     std::cout << "Running Myndra Compilation Tests..." << std::endl;
     std::cout << "=======================================" << std::endl;
@@ -223,6 +362,8 @@ int main() {
         // test_capsule_compilation();
         // test_context_aware_compilation();
         test_error_handling();
+        test_native_registration();
+        test_module_cache();
         
         std::cout << std::endl;
         std::cout << "✓ All compilation tests passed!" << std::endl;
@@ -0,0 +1,191 @@
+#include "engine_harness.h"
+#include "semantics/constant_folder.h"
+#include "myndra.h"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+// Runs `source` in `context` on the tree walker, the VM and folded, checks
+// they agree and returns the output
+std::string run_all(const std::string& source, const std::string& context) {
+    std::string interpreted = runAll(source, {Engine::Interpreter, Engine::VM}, context);
+    auto folded = ConstantFolder(context, true).fold(*parse(source));
+    std::string specialized = runOn(Engine::Interpreter, *folded, context);
+    if (interpreted != specialized) {
+        std::cerr << "Interpreter output:\n" << interpreted << "\nFolded output:\n" << specialized << std::endl;
+    }
+    assert(interpreted == specialized);
+    return interpreted;
+}
+
+void test_semantics() {
+    std::cout << "Testing context conditionals..." << std::endl;
+
+    // A conditional for another context is 0 and does not evaluate its
+    // expression; it covers the whole expression before it
+    const std::string source = R"(
+        fn trace(label: string) -> int {
+            print("trace", label);
+            return 1;
+        }
+        fn scale(x: int) -> int {
+            trace("scale") if context == "dev";
+            return x * 10 if context == "prod";
+        }
+        let limit = 100 if context == "prod";
+        print(scale(4), limit, 1 + 2 if context == "test");
+        let calls = 0;
+        calls = calls + trace("top") if context == "dev";
+        print(calls);
+    )";
+    assert(run_all(source, "dev") == "trace scale\n0 0 0\ntrace top\n1\n");
+    assert(run_all(source, "prod") == "40 100 0\n0\n");
+    assert(run_all(source, "test") == "0 0 3\n0\n");
+
+    std::cout << "✓ Context conditionals test passed" << std::endl;
+}
+
+void test_folding() {
+    std::cout << "Testing compile-time context elimination..." << std::endl;
+
+    const std::string source = R"(
+        fn work(n: int) -> int {
+            print("work", n) if context == "dev";
+            return n + 1;
+        }
+        print("starting") if context == "dev";
+        print(work(1), 5 if context == "prod");
+    )";
+
+    // Top-level code runs right away: dev-only logging disappears
+    ConstantFolder folder("prod");
+    auto program = folder.fold(*parse(source));
+    std::string text = program->to_string();
+    assert(text.find("\"starting\"") == std::string::npos);
+    assert(text.find("print(work(1), 5)") != std::string::npos);
+    // Function bodies may outlive the context and keep theirs
+    assert(text.find("print(\"work\", n) if context == \"dev\"") != std::string::npos);
+    assert(folder.foldedNodes() == 3);
+
+    // A fixed context (native code) resolves every conditional
+    ConstantFolder fixed("prod", true);
+    program = fixed.fold(*parse(source));
+    text = program->to_string();
+    assert(text.find("context") == std::string::npos);
+    assert(text.find("\"work\"") == std::string::npos);
+    assert(text.find("return (n + 1)") != std::string::npos);
+
+    // Without a context nothing is resolved
+    ConstantFolder unknown;
+    program = unknown.fold(*parse(source));
+    assert(program->count(NodeKind::ContextConditional) == 3);
+
+    std::cout << "✓ Compile-time context elimination test passed" << std::endl;
+}
+
+void test_respecialization() {
+    std::cout << "Testing lazy re-specialization..." << std::endl;
+
+    // Functions defined under one context follow a later change, in the
+    // tree walker and once promoted to bytecode
+    for (uint32_t threshold : {0u, 1u, 3u}) {
+        TieringOptions options;
+        options.threshold = threshold;
+        options.jitThreshold = 0;
+        options.trace = true;
+        std::ostringstream trace;
+        Capture capture(&trace);
+        Interpreter interpreter(NativeRegistry::builtins(), true, options);
+
+        auto definitions = parse(R"(
+            fn level(n: int) -> int {
+                return n + 100 if context == "prod";
+            }
+            fn total(n: int) -> int {
+                let i = 0;
+                let sum = 0;
+                while i < n {
+                    sum = sum + 1 if context == "dev";
+                    i = i + 1;
+                }
+                return sum;
+            }
+        )");
+        interpreter.execute(*definitions);
+        auto calls = parse("print(level(1), level(2), level(3), level(4), total(10));");
+        interpreter.execute(*calls);
+        interpreter.setContext("prod");
+        assert(interpreter.context() == "prod");
+        auto again = parse("print(level(1), level(2), level(3), level(4), total(10));");
+        interpreter.execute(*again);
+        interpreter.setContext("dev");
+        auto back = parse("print(level(5), total(7));");
+        interpreter.execute(*back);
+
+        std::string output = capture.restore();
+        assert(output == "0 0 0 0 10\n101 102 103 104 0\n0 7\n");
+        if (threshold == 1) {
+            // Promoted code built for the old context is promoted again
+            std::string log = trace.str();
+            size_t first = log.find("[tiering] fn level: tree walker -> bytecode");
+            assert(first != std::string::npos);
+            assert(log.find("[tiering] fn level: tree walker -> bytecode", first + 1) != std::string::npos);
+        }
+    }
+
+    std::cout << "✓ Lazy re-specialization test passed" << std::endl;
+}
+
+void test_compiler_context() {
+    std::cout << "Testing Compiler::update_context..." << std::endl;
+
+    Capture capture;
+    Compiler::Options options;
+    options.target_context = "prod";
+    Compiler compiler(options);
+    assert(compiler.compile_string(R"(
+        fn handle(n: int) -> int {
+            print("debug", n) if context == "dev";
+            return n * 2;
+        }
+        print("booting") if context == "dev";
+        print(handle(1));
+    )"));
+
+    ExecutionContext dev;
+    dev.type = "dev";
+    assert(compiler.update_context(dev));
+    assert(compiler.compile_string("print(handle(2));"));
+    assert(!compiler.update_context(ExecutionContext()));
+    std::string output = capture.restore();
+
+    assert(output.find("booting") == std::string::npos);
+    assert(output.find("\n2\n") != std::string::npos);
+    assert(output.find("debug 1") == std::string::npos);
+    assert(output.find("debug 2\n4\n") != std::string::npos);
+
+    std::cout << "✓ Compiler::update_context test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra Context Tests..." << std::endl;
+    std::cout << "===============================" << std::endl;
+
+    try {
+        test_semantics();
+        test_folding();
+        test_respecialization();
+        test_compiler_context();
+
+        std::cout << std::endl;
+        std::cout << "✓ All context tests passed!" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -1,6 +1,8 @@
 #include "lexer.h"
 #include <iostream>
 #include <cassert>
+#include <thread>
+#include <vector>
 
 using namespace myndra;
 
@@ -35,6 +37,22 @@ void test_keywords() {
     assert(tokens[3].type == TokenType::WITH);
     assert(tokens[4].type == TokenType::CAPABILITIES);
     
+    // Every keyword, then near misses that share a hash input with one
+    Lexer all("let fn if else while for in return import export with capabilities capsule dsl "
+              "fallback retry context over tag did evolving true false nil and or not observable "
+              "subscribe emit transition timeline verify proof has_proof");
+    auto words = all.tokenize();
+    assert(words.size() == 36);
+    for (size_t i = 0; i + 1 < words.size(); ++i) {
+        assert(words[i].type != TokenType::IDENTIFIER);
+    }
+    assert(words[21].type == TokenType::BOOLEAN && words[22].type == TokenType::BOOLEAN);
+    
+    Lexer misses("le lets fnn iff inn elsee tru falsy nill andd o nothing emits has_proofs capabilitie x _ f");
+    for (const auto& token : misses.tokenize()) {
+        assert(token.type == TokenType::IDENTIFIER || token.type == TokenType::EOF_TOKEN);
+    }
+    
     std::cout << "✓ Keywords test passed" << std::endl;
 }
 
@@ -49,13 +67,17 @@ void test_annotations() {
     assert(tokens[1].type == TokenType::AT_REACTIVE);
     assert(tokens[2].type == TokenType::AT_TEMPORAL);
     
+    Lexer unknown("@syncs");
+    unknown.tokenize();
+    assert(unknown.has_errors());
+    
     std::cout << "✓ Annotations test passed" << std::endl;
 }
 
 void test_operators() {
     std::cout << "Testing operators..." << std::endl;
     
-    std::string source = "-> => :: += -= == != <= >=";
+    std::string source = "-> => :: += -= == != <= >= ..";
     Lexer lexer(source);
     auto tokens = lexer.tokenize();
     
@@ -68,6 +90,14 @@ void test_operators() {
     assert(tokens[6].type == TokenType::NOT_EQUAL);
     assert(tokens[7].type == TokenType::LESS_EQUAL);
     assert(tokens[8].type == TokenType::GREATER_EQUAL);
+    assert(tokens[9].type == TokenType::DOT_DOT);
+    
+    // A range's dots never join its bounds
+    Lexer range("0..n 1.5..2");
+    auto bounds = range.tokenize();
+    assert(bounds[0].type == TokenType::INTEGER && bounds[1].type == TokenType::DOT_DOT);
+    assert(bounds[2].type == TokenType::IDENTIFIER && bounds[3].type == TokenType::FLOAT);
+    assert(bounds[4].type == TokenType::DOT_DOT && bounds[5].type == TokenType::INTEGER);
     
     std::cout << "✓ Operators test passed" << std::endl;
 }
@@ -80,14 +110,133 @@ void test_string_literals() {
     auto tokens = lexer.tokenize();
     
     assert(tokens[0].type == TokenType::STRING);
-    assert(std::get<std::string>(tokens[0].literal) == "Hello, World!");
+    assert(tokens.stringValue(tokens[0]) == "Hello, World!");
     
     assert(tokens[1].type == TokenType::STRING);
-    assert(std::get<std::string>(tokens[1].literal) == "with\nescapes");
+    assert(tokens.stringValue(tokens[1]) == "with\nescapes");
     
     std::cout << "✓ String literals test passed" << std::endl;
 }
 
+void test_zero_copy_tokens() {
+    std::cout << "Testing zero-copy tokens..." << std::endl;
+    
+    TokenStream tokens;
+    {
+        // The stream keeps the source buffer alive after the lexer is gone
+        Lexer lexer(SourceBuffer::create("let answer = 42 + 0.1 + 9223372036854775807 true\n"));
+        tokens = lexer.tokenize();
+    }
+    
+    assert(tokens.lexeme(tokens[1]) == "answer");
+    assert(tokens.location(tokens[1]).line == 1 && tokens.location(tokens[1]).column == 5);
+    assert(tokens.lexeme(tokens[1]).data() == tokens.source().text().data() + tokens[1].offset);
+    
+    int64_t integer = 0;
+    assert(tokens.integerValue(tokens[3], integer) && integer == 42);
+    double real = 0.0;
+    assert(tokens.floatValue(tokens[5], real) && real == 0.1);
+    assert(tokens.integerValue(tokens[7], integer) && integer == INT64_MAX);
+    assert(tokens[8].type == TokenType::BOOLEAN && tokens.boolValue(tokens[8]));
+    assert(tokens[9].type == TokenType::NEWLINE && tokens.location(tokens[9]).line == 1);
+    assert(tokens.back().type == TokenType::EOF_TOKEN && tokens.location(tokens.back()).line == 2);
+    
+    Lexer overflow("99999999999999999999");
+    auto big = overflow.tokenize();
+    assert(!big.integerValue(big[0], integer));
+    
+    std::cout << "✓ Zero-copy tokens test passed" << std::endl;
+}
+
+void test_atoms() {
+    std::cout << "Testing identifier atoms..." << std::endl;
+    
+    Lexer lexer("let total = total + count; fn count() {}");
+    auto tokens = lexer.tokenize();
+    assert(tokens[1].atom == tokens[3].atom);
+    assert(tokens[1].atom == Atom::intern("total") && tokens[1].atom.text() == "total");
+    assert(tokens[5].atom == tokens[8].atom && tokens[5].atom != tokens[1].atom);
+    // Keywords and punctuation carry none
+    assert(tokens[0].atom.empty() && tokens[2].atom.empty() && tokens[7].atom.empty());
+    assert(Atom::find("total") == tokens[1].atom);
+    assert(Atom::find("never_interned_anywhere").empty());
+    assert(Atom::intern("").empty());
+    
+    // Threads interning the same names concurrently agree on every atom
+    constexpr int kThreads = 8;
+    constexpr int kNames = 5000;
+    std::vector<std::vector<Atom>> seen(kThreads);
+    std::vector<std::thread> threads;
+    size_t before = Atom::count();
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &seen] {
+            for (int i = 0; i < kNames; ++i) {
+                int name = (i * 7 + t * 13) % kNames;
+                seen[t].push_back(Atom::intern("name_" + std::to_string(name)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(Atom::count() == before + kNames);
+    for (int t = 0; t < kThreads; ++t) {
+        for (int i = 0; i < kNames; ++i) {
+            int name = (i * 7 + t * 13) % kNames;
+            assert(seen[t][i] == Atom::intern("name_" + std::to_string(name)));
+            assert(seen[t][i].text() == "name_" + std::to_string(name));
+        }
+    }
+    
+    std::cout << "✓ Identifier atoms test passed" << std::endl;
+}
+
+void test_scan_kernels() {
+    std::cout << "Testing scan kernels..." << std::endl;
+    
+    // Every vector kernel must stop exactly where the scalar one does, for
+    // stops at each position of a 16/32-byte block and in the tail
+    const ScanKernels& scalar = scalarScanKernels();
+    const std::string fillers[] = {"abcXYZ_09", " \t\r", "plain text, no stops"};
+    const char stops[] = {'\n', '"', '\\', '*', '-', '\x80', ' '};
+    for (const ScanKernels* kernels : availableScanKernels()) {
+        for (const auto& filler : fillers) {
+            for (size_t length = 0; length < 80; ++length) {
+                for (char stop : stops) {
+                    std::string text;
+                    while (text.size() < length) text += filler;
+                    text.resize(length);
+                    text += stop;
+                    text += filler;
+                    const char* begin = text.data();
+                    const char* end = begin + text.size();
+                    assert(kernels->skipIdentifier(begin, end) == scalar.skipIdentifier(begin, end));
+                    assert(kernels->skipWhitespace(begin, end) == scalar.skipWhitespace(begin, end));
+                    assert(kernels->findEither(begin, end, '"', '\\') == scalar.findEither(begin, end, '"', '\\'));
+                    assert(kernels->findEither(begin, end, '\n', '\n') == scalar.findEither(begin, end, '\n', '\n'));
+                }
+            }
+        }
+        
+        // Whole token streams agree too
+        auto source = SourceBuffer::create(
+            "let long_identifier_name_that_spans_blocks = \"a string \\\" with escapes\";  \t\n"
+            "// a line comment that is longer than thirty-two bytes\n/* block * comment ** */ x");
+        auto expected = Lexer(source, scalar).tokenize();
+        auto actual = Lexer(source, *kernels).tokenize();
+        assert(expected.size() == actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(expected[i].type == actual[i].type);
+            assert(expected[i].offset == actual[i].offset && expected[i].length == actual[i].length);
+        }
+        assert(actual[0].type == TokenType::LET);
+        assert(actual.back().type == TokenType::EOF_TOKEN);
+        assert(actual.location(actual.back()).line == 3);
+    }
+    
+    std::cout << "✓ Scan kernels test passed (best: " << scanKernels().name << ")" << std::endl;
+}
+
 void test_semantic_tags() {
     std::cout << "Testing semantic tags..." << std::endl;
     
@@ -146,6 +295,9 @@ int main() {
         test_annotations();
         test_operators();
         test_string_literals();
+        test_zero_copy_tokens();
+        test_atoms();
+        test_scan_kernels();
         test_semantic_tags();
         test_complex_example();
         
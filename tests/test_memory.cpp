@@ -0,0 +1,224 @@
+#include "runtime/memory.h"
+#include "runtime/value.h"
+#include "myndra.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace myndra;
+
+void test_size_classes() {
+    std::cout << "Testing size classes..." << std::endl;
+
+    assert(MemoryManager::roundedSize(1) == 16);
+    assert(MemoryManager::roundedSize(16) == 16);
+    assert(MemoryManager::roundedSize(17) == 32);
+    assert(MemoryManager::roundedSize(sizeof(StringObject)) % MemoryManager::kGranule == 0);
+    assert(MemoryManager::roundedSize(MemoryManager::kMaxSmallSize) == MemoryManager::kMaxSmallSize);
+    assert(MemoryManager::roundedSize(MemoryManager::kMaxSmallSize + 1) == MemoryManager::kMaxSmallSize + 1);
+
+    std::cout << "✓ Size class tests passed" << std::endl;
+}
+
+void test_allocation_and_reuse() {
+    std::cout << "Testing allocation and reuse..." << std::endl;
+
+    MemoryManager memory;
+    void* first = memory.allocate(40);
+    assert(reinterpret_cast<uintptr_t>(first) % MemoryManager::kGranule == 0);
+    MemoryManager::deallocate(first, 40);
+    // The magazine hands back the block freed last
+    void* second = memory.allocate(33);
+    assert(second == first);
+
+    auto stats = memory.stats();
+    assert(stats.allocations == 2 && stats.deallocations == 1);
+    assert(stats.requestedBytes == 33 && stats.blockBytes == 48);
+    assert(stats.slabs == 1 && stats.reservedBytes == MemoryManager::kSlabBytes);
+    assert(stats.fragmentation() > 0.99 && stats.fragmentation() < 1.0);
+    MemoryManager::deallocate(second, 33);
+
+    // Blocks of every class are distinct and keep their contents
+    std::vector<std::pair<unsigned char*, size_t>> blocks;
+    for (size_t i = 0; i < 20000; ++i) {
+        size_t size = 1 + (i * 37) % MemoryManager::kMaxSmallSize;
+        auto* block = static_cast<unsigned char*>(memory.allocate(size));
+        std::memset(block, static_cast<int>(i & 0xFF), size);
+        blocks.emplace_back(block, size);
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        auto [block, size] = blocks[i];
+        assert(block[0] == (i & 0xFF) && block[size - 1] == (i & 0xFF));
+    }
+    size_t slabs = memory.stats().slabs;
+    for (auto [block, size] : blocks) {
+        MemoryManager::deallocate(block, size);
+    }
+    assert(memory.stats().requestedBytes == 0 && memory.stats().blockBytes == 0);
+
+    // Freed blocks are reused before any new slab is taken
+    for (auto& [block, size] : blocks) {
+        block = static_cast<unsigned char*>(memory.allocate(size));
+    }
+    assert(memory.stats().slabs == slabs);
+    for (auto [block, size] : blocks) {
+        MemoryManager::deallocate(block, size);
+    }
+
+    // Large requests bypass the slabs
+    void* large = memory.allocate(100000);
+    std::memset(large, 1, 100000);
+    stats = memory.stats();
+    assert(stats.largeAllocations == 1 && stats.requestedBytes == 100000);
+    assert(stats.reservedBytes == slabs * MemoryManager::kSlabBytes + 100000);
+    MemoryManager::deallocate(large, 100000);
+    assert(memory.stats().requestedBytes == 0);
+
+    std::cout << "✓ Allocation and reuse tests passed" << std::endl;
+}
+
+void test_bulk_release() {
+    std::cout << "Testing bulk release..." << std::endl;
+
+    MemoryManager memory;
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10000; ++i) {
+        blocks.push_back(memory.allocate(64));
+    }
+    for (void* block : blocks) {
+        MemoryManager::deallocate(block, 64);
+    }
+    assert(memory.stats().slabs > 1);
+
+    memory.releaseAll();
+    auto stats = memory.stats();
+    assert(stats.slabs == 0 && stats.reservedBytes == 0);
+    assert(stats.allocations == 10000 && stats.deallocations == 10000);
+
+    // The manager keeps working afterwards
+    void* block = memory.allocate(64);
+    assert(memory.stats().slabs == 1);
+    MemoryManager::deallocate(block, 64);
+
+    std::cout << "✓ Bulk release tests passed" << std::endl;
+}
+
+void test_threads() {
+    std::cout << "Testing per-thread magazines..." << std::endl;
+
+    MemoryManager memory;
+    const int threads = 4;
+    const int rounds = 50000;
+
+    // Each thread churns through its own blocks...
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&memory, t] {
+            std::vector<std::pair<void*, size_t>> live;
+            for (int i = 0; i < rounds; ++i) {
+                size_t size = 8 + static_cast<size_t>((i * 13 + t) % 200);
+                live.emplace_back(memory.allocate(size), size);
+                if (live.size() > 100) {
+                    auto [block, blockSize] = live[static_cast<size_t>(i) % live.size()];
+                    live[static_cast<size_t>(i) % live.size()] = live.back();
+                    live.pop_back();
+                    MemoryManager::deallocate(block, blockSize);
+                }
+            }
+            for (auto [block, size] : live) {
+                MemoryManager::deallocate(block, size);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // ...and blocks may be freed by a thread other than the allocating one
+    std::vector<void*> handoff;
+    std::thread producer([&] {
+        for (int i = 0; i < rounds; ++i) {
+            handoff.push_back(memory.allocate(24));
+        }
+    });
+    producer.join();
+    std::thread consumer([&] {
+        for (void* block : handoff) {
+            MemoryManager::deallocate(block, 24);
+        }
+    });
+    consumer.join();
+
+    // Exited threads handed their counters and blocks back
+    auto stats = memory.stats();
+    assert(stats.allocations == static_cast<size_t>(threads + 1) * rounds);
+    assert(stats.deallocations == stats.allocations);
+    assert(stats.requestedBytes == 0 && stats.blockBytes == 0);
+
+    std::cout << "✓ Per-thread magazine tests passed" << std::endl;
+}
+
+void test_runtime_objects() {
+    std::cout << "Testing runtime object allocation..." << std::endl;
+
+    MemoryManager memory;
+    {
+        MemoryManager::Scope scope(memory);
+        RuntimeValue text(std::string("pooled"));
+        RuntimeValue big(int64_t(1) << 60);
+        assert(memory.stats().allocations == 2);
+        assert(memory.stats().requestedBytes == sizeof(StringObject) + sizeof(BoxedIntObject));
+    }
+    assert(memory.stats().deallocations == 2);
+
+    // Outside a scope objects come from the global manager
+    {
+        RuntimeValue text(std::string("global"));
+        assert(memory.stats().allocations == 2);
+    }
+
+    // Each compiler runs its programs in a manager of its own
+    Compiler::Options options;
+    options.target_context = "test";
+    options.fold_constants = false;  // The loop is there to allocate
+    Compiler compiler(options);
+    assert(compiler.compile_string(R"(
+        let greeting = "hello";
+        let i = 0;
+        while i < 100 {
+            let line = greeting + " " + "world";
+            i = i + 1;
+        }
+    )"));
+    MemoryStats reported = compiler.get_memory_stats();
+    assert(reported.allocations >= 200);
+    assert(reported.deallocations <= reported.allocations);
+    assert(reported.reserved_bytes >= reported.live_bytes);
+    assert(reported.fragmentation >= 0.0 && reported.fragmentation <= 1.0);
+
+    std::cout << "✓ Runtime object tests passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra Memory Tests..." << std::endl;
+    std::cout << "==============================" << std::endl;
+
+    try {
+        test_size_classes();
+        test_allocation_and_reuse();
+        test_bulk_release();
+        test_threads();
+        test_runtime_objects();
+
+        std::cout << std::endl;
+        std::cout << "✓ All memory tests passed!" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,269 @@
+#include "engine_harness.h"
+#include "runtime/object.h"
+#include <atomic>
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+void test_shapes() {
+    std::cout << "Testing shapes..." << std::endl;
+
+    Atom x = Atom::intern("x");
+    Atom y = Atom::intern("y");
+    const Shape* empty = Shape::empty();
+    const Shape* xy = empty->add(x)->add(y);
+    assert(empty->size() == 0 && xy->size() == 2);
+    assert(xy == empty->add(x)->add(y));   // Same keys in the same order, same shape
+    assert(xy != empty->add(y)->add(x));
+    assert(xy->find(x) == 0 && xy->find(y) == 1);
+    assert(xy->find(Atom::intern("z")) == Shape::kNotFound);
+    assert(xy->key(1) == y);
+
+    // Large shapes index their keys
+    const Shape* wide = empty;
+    for (int i = 0; i < 20; ++i) {
+        wide = wide->add(Atom::intern("k" + std::to_string(i)));
+    }
+    assert(wide->find(Atom::intern("k0")) == 0 && wide->find(Atom::intern("k19")) == 19);
+    assert(wide->find(x) == Shape::kNotFound);
+
+    // Shapes along a chain share keys; an older shape sees only its own,
+    // and a branch off one gets keys of its own
+    const Shape* half = empty;
+    for (int i = 0; i < 10; ++i) {
+        half = half->add(Atom::intern("k" + std::to_string(i)));
+    }
+    const Shape* branch = half->add(x);
+    assert(half->size() == 10 && half->find(Atom::intern("k15")) == Shape::kNotFound);
+    assert(branch->find(x) == 10 && branch->find(Atom::intern("k10")) == Shape::kNotFound);
+    assert(branch->find(Atom::intern("k9")) == 9 && branch->key(10) == x);
+    assert(wide->find(x) == Shape::kNotFound && wide->key(10) == Atom::intern("k10"));
+    assert(xy->add(Atom::intern("z"))->find(Atom::intern("z")) == 2 && xy->find(Atom::intern("z")) == Shape::kNotFound);
+
+    // Building a wide object is linear, not quadratic
+    const Shape* widest = empty;
+    for (int i = 0; i < 20000; ++i) {
+        widest = widest->add(Atom::intern("w" + std::to_string(i)));
+    }
+    assert(widest->find(Atom::intern("w0")) == 0 && widest->find(Atom::intern("w19999")) == 19999);
+
+    // Readers look keys up while a writer keeps extending the same table
+    constexpr int kKeys = 4000;
+    std::vector<Atom> keys;
+    for (int i = 0; i < kKeys; ++i) {
+        keys.push_back(Atom::intern("c" + std::to_string(i)));
+    }
+    std::atomic<const Shape*> newest{empty};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            const Shape* shape = empty;
+            while (shape->size() < kKeys) {
+                shape = newest.load();
+                uint32_t last = shape->size() - 1;
+                if (shape->size() > 0) {
+                    assert(shape->find(keys[last]) == last && shape->key(last) == keys[last]);
+                    assert(shape->find(keys[last / 2]) == last / 2 && shape->find(keys[0]) == 0);
+                }
+                assert(shape->find(keys[shape->size() % kKeys]) == (shape->size() == kKeys ? 0 : Shape::kNotFound));
+            }
+        });
+    }
+    const Shape* chain = empty;
+    for (int i = 0; i < kKeys; ++i) {
+        chain = chain->add(keys[i]);
+        newest.store(chain);
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::cout << "✓ Shapes test passed" << std::endl;
+}
+
+void test_inline_caches() {
+    std::cout << "Testing inline caches..." << std::endl;
+
+    GcHeap heap;
+    {
+        GcHeap::Scope scope(heap);
+        Atom key = Atom::intern("v");
+        PropertyCache load(key);
+
+        // Monomorphic: one entry, hit from then on
+        RuntimeValue values[] = {RuntimeValue(int64_t(1)), RuntimeValue(int64_t(2))};
+        const Shape* first = Shape::empty()->add(key);
+        RuntimeValue a = ShapedObject::make(first, values);
+        assert(getProperty(a, load).asInt() == 1);
+        assert(load.count == 1 && load.entries[0].shape == first && load.entries[0].slot == 0);
+        assert(getProperty(a, load).asInt() == 1 && load.count == 1);
+
+        // Polymorphic: `v` in another slot of another shape
+        const Shape* second = Shape::empty()->add(Atom::intern("w"))->add(key);
+        RuntimeValue b = ShapedObject::make(second, values);
+        assert(getProperty(b, load).asInt() == 2);
+        assert(load.count == 2 && load.entries[1].slot == 1 && !load.megamorphic);
+
+        // Megamorphic past kEntries shapes; lookups still work
+        for (int i = 0; i < 4; ++i) {
+            const Shape* shape = Shape::empty()->add(Atom::intern("p" + std::to_string(i)))->add(key);
+            assert(getProperty(ShapedObject::make(shape, values), load).asInt() == 2);
+        }
+        assert(load.count == PropertyCache::kEntries && load.megamorphic);
+        assert(getProperty(a, load).asInt() == 1 && getProperty(b, load).asInt() == 2);
+
+        // A store that adds the key caches the transition
+        PropertyCache store(Atom::intern("added"));
+        RuntimeValue c = ShapedObject::make(first, values);
+        RuntimeValue d = ShapedObject::make(first, values);
+        setProperty(c, RuntimeValue("text"), store);
+        assert(store.count == 1 && store.entries[0].transition == first->add(Atom::intern("added")));
+        setProperty(d, RuntimeValue("more"), store);
+        assert(asShapedObject(c)->shape == asShapedObject(d)->shape && store.count == 1);
+        assert(asShapedObject(d)->slots[1].asString() == "more");
+
+        // Growth past the literal's slots keeps the values
+        for (int i = 0; i < 10; ++i) {
+            PropertyCache grow(Atom::intern("g" + std::to_string(i)));
+            setProperty(d, RuntimeValue(int64_t(i)), grow);
+        }
+        assert(asShapedObject(d)->shape->size() == 12 && asShapedObject(d)->capacity >= 12);
+        assert(asShapedObject(d)->slots[0].asInt() == 1 && asShapedObject(d)->slots[11].asInt() == 9);
+    }
+
+    std::cout << "✓ Inline caches test passed" << std::endl;
+}
+
+void test_object_basics() {
+    std::cout << "Testing object literals and properties..." << std::endl;
+
+    assert(runAll(R"(
+        let materials = {
+            rock: { friction: 0.8, restitution: 0.1 },
+            ice: { friction: 0.05, "restitution": 0.0, },
+        };
+        print(materials.rock.friction, materials.ice.restitution);
+        print(materials);
+        print({});
+    )") == "0.800000 0.000000\n"
+           "{rock: {friction: 0.800000, restitution: 0.100000}, ice: {friction: 0.050000, restitution: 0.000000}}\n"
+           "{}\n");
+
+    // Stores replace or add properties; an assignment is its value
+    assert(runAll(R"(
+        let player = { name: "ann", position: 3 };
+        player.position = player.position + 1;
+        print(player.hp = 10);
+        print(player);
+    )") == "10\n{name: \"ann\", position: 4, hp: 10}\n");
+
+    // Objects are truthy and shared by reference
+    assert(runAll(R"(
+        if {} { print(1); } else { print(0); }
+        let a = { n: 1 };
+        let b = a;
+        b.n = 2;
+        print(a.n, [a]);
+    )") == "1\n2 [{n: 2}]\n");
+
+    // A self-referencing object prints its inner reference as {...}
+    assert(runAll("let a = { next: 0 }; a.next = a; print(a);") == "{next: {...}}\n");
+
+    std::cout << "✓ Object basics test passed" << std::endl;
+}
+
+void test_object_errors() {
+    std::cout << "Testing object errors..." << std::endl;
+
+    assert(runAll("let p = { x: 1 }; print(p.y);") == "error: Object has no property 'y'\n");
+    assert(runAll("let n = 3; print(n.x);") == "error: Only objects have properties\n");
+    assert(runAll("let a = [1]; a.x = 2;") == "error: Only objects have properties\n");
+
+    Lexer lexer("let p = { x: 1, y: 2, x: 3 };");
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    parser.parseProgram();
+    assert(parser.hasErrors());
+    assert(parser.getErrors()[0].find("Duplicate key 'x' in object literal") != std::string::npos);
+
+    std::cout << "✓ Object errors test passed" << std::endl;
+}
+
+void test_hot_property_sites() {
+    std::cout << "Testing hot property sites..." << std::endl;
+
+    // One function reads objects of three shapes, then of more than the
+    // cache holds; the JIT's inline checks and its slow path must agree
+    assert(runAll(R"(
+        fn norm(p: Point) -> int { return p.x * p.x + p.y * p.y; }
+        let flat = { x: 3, y: 4 };
+        let deep = { z: 0, y: 1, x: 2 };
+        let labelled = { label: "t", x: 5, y: 12 };
+        let total = 0;
+        for i in 0..50 {
+            total = total + norm(flat) + norm(deep) + norm(labelled);
+        }
+        print(total);
+        let others = [{ a: 1, x: 1, y: 1 }, { b: 1, x: 2, y: 2 }, { c: 1, x: 3, y: 3 }];
+        for i in 0..3 { print(norm(others[i])); }
+        print(norm(flat));
+        print(norm({ x: 1 }));
+    )") == "9950\n2\n8\n18\n25\nerror: Object has no property 'y'\n");
+
+    // Stores in a hot loop, both adding properties and replacing them
+    assert(runAll(R"(
+        fn make(i: int) -> Entity {
+            let o = { id: i };
+            o.double = i * 2;
+            o.id = o.id + o.double;
+            return o;
+        }
+        let sum = 0;
+        for i in 0..100 { sum = sum + make(i).id; }
+        print(sum, make(7));
+    )") == "14850 {id: 21, double: 14}\n");
+
+    std::cout << "✓ Hot property sites test passed" << std::endl;
+}
+
+void test_object_cycles() {
+    std::cout << "Testing object cycles..." << std::endl;
+
+    GcHeap heap;
+    {
+        GcHeap::Scope scope(heap);
+        const Shape* shape = Shape::empty()->add(Atom::intern("other"));
+        RuntimeValue nothing[] = {RuntimeValue()};
+        RuntimeValue a = ShapedObject::make(shape, nothing);
+        RuntimeValue b = ShapedObject::make(shape, nothing);
+        PropertyCache other(Atom::intern("other"));
+        setProperty(a, b, other);
+        setProperty(b, a, other);
+        PropertyCache label(Atom::intern("label"));
+        setProperty(b, RuntimeValue("kept alive by b"), label);
+    }
+    assert(heap.stats().liveBytes > 0);
+    heap.collect();
+    assert(heap.stats().objectsCollected == 2);
+    assert(heap.stats().liveBytes == 0);
+
+    std::cout << "✓ Object cycles test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running object tests..." << std::endl;
+
+    test_shapes();
+    test_inline_caches();
+    test_object_basics();
+    test_object_errors();
+    test_hot_property_sites();
+    test_object_cycles();
+
+    std::cout << "All object tests passed!" << std::endl;
+    return 0;
+}
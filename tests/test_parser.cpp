@@ -0,0 +1,143 @@
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+using namespace myndra;
+
+// Parses `source` and returns the printed program, or the first error
+std::string parse(const std::string& source) {
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    assert(!lexer.has_errors());
+
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    if (parser.hasErrors()) {
+        return "error: " + parser.getErrors().front();
+    }
+    return program->to_string();
+}
+
+void test_precedence() {
+    std::cout << "Testing operator precedence..." << std::endl;
+
+    assert(parse("a + b * c - d / e % f;") == "((a + (b * c)) - ((d / e) % f))\n");
+    assert(parse("a or b and c == d < e + f * g;") == "(a or (b and (c == (d < (e + (f * g))))))\n");
+    assert(parse("a * b + c < d != e and f or g;") == "((((((a * b) + c) < d) != e) and f) or g)\n");
+    assert(parse("(a + b) * c;") == "((a + b) * c)\n");
+
+    // Every level is left-associative; assignment is right-associative
+    assert(parse("a - b - c;") == "((a - b) - c)\n");
+    assert(parse("a / b * c;") == "((a / b) * c)\n");
+    assert(parse("a < b == c < d;") == "((a < b) == (c < d))\n");
+    assert(parse("x = y = a + 1;") == "(x = (y = (a + 1)))\n");
+
+    std::cout << "✓ Operator precedence test passed" << std::endl;
+}
+
+void test_unary_and_postfix() {
+    std::cout << "Testing unary and postfix operators..." << std::endl;
+
+    assert(parse("-a * b;") == "((-a) * b)\n");
+    assert(parse("not a and - - b;") == "((not a) and (-(-b)))\n");
+    assert(parse("f(a, g(b) + 1)[i] * -h();") == "(f(a, (g(b) + 1))[i] * (-h()))\n");
+    assert(parse("point.x + 1 if context == \"dev\";") == "(point.x + 1) if context == \"dev\"\n");
+    assert(parse("print(f(), (1), \"s\", 2.5, true);") == "print(f(), 1, \"s\", 2.500000, true)\n");
+    assert(parse("for i in a.start..n + 1 print(i);") == "for i in a.start..(n + 1) print(i)\n");
+
+    std::cout << "✓ Unary and postfix operators test passed" << std::endl;
+}
+
+void test_errors() {
+    std::cout << "Testing parse errors..." << std::endl;
+
+    assert(parse("a + ;") == "error: Parse error at line 1, column 5: Expect expression (got ';')");
+    assert(parse("1 + 2 = 3;") == "error: Parse error at line 1, column 10: Invalid assignment target (got ';')");
+    assert(parse("f(a, b;") == "error: Parse error at line 1, column 7: Expect ')' after arguments (got ';')");
+    assert(parse("for i in 0 10 {}") == "error: Parse error at line 1, column 12: Expect '..' in range (got '10')");
+
+    // Recovery resumes at the next statement
+    Lexer lexer("let a = * 2; fn f(x: int) { return x; } print(f(1));");
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    assert(parser.hasErrors());
+    std::string text = program->to_string();
+    assert(text.find("fn f(x: int)") != std::string::npos);
+    assert(text.find("print(f(1))") != std::string::npos);
+
+    std::cout << "✓ Parse errors test passed" << std::endl;
+}
+
+void test_cached_atoms() {
+    std::cout << "Testing atoms in program blocks..." << std::endl;
+
+    Lexer lexer("let total = 1; total = total + 1; print(total);");
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto program = parser.parseProgram();
+    auto bytes = program->bytes();
+
+    // A block written by another process numbers its atoms differently;
+    // simulate that by shifting every id in a copy
+    constexpr uint32_t kShift = 1000000;
+    auto copy = [&](bool shiftNodes) {
+        auto* block = new unsigned char[bytes.size()];
+        std::memcpy(block, bytes.data(), bytes.size());
+        ProgramLayout header;
+        std::memcpy(&header, block, sizeof(header));
+        auto* atoms = reinterpret_cast<AtomEntry*>(block + header.atomsOffset);
+        for (uint32_t i = 0; i < header.atomCount; ++i) {
+            atoms[i].id += kShift;
+        }
+        auto shift = [&](Atom& atom) { atom = atom.empty() ? atom : Atom::fromId(atom.id() + kShift); };
+        size_t identifiers = static_cast<size_t>(NodeKind::Identifier);
+        size_t declarations = static_cast<size_t>(NodeKind::VariableDeclaration);
+        for (uint32_t i = 0; shiftNodes && i < header.counts[identifiers]; ++i) {
+            shift(reinterpret_cast<Identifier*>(block + header.poolOffsets[identifiers])[i].name);
+        }
+        for (uint32_t i = 0; shiftNodes && i < header.counts[declarations]; ++i) {
+            shift(reinterpret_cast<VariableDeclaration*>(block + header.poolOffsets[declarations])[i].name);
+        }
+        return block;
+    };
+
+    auto adopted = Program::adopt(copy(true), bytes.size(), nullptr);
+    assert(adopted->to_string() == program->to_string());
+    const auto& declaration = adopted->node<VariableDeclaration>(adopted->statements()[0]);
+    assert(declaration.name == Atom::intern("total"));
+
+    // Ids missing from the atom section mean a damaged block
+    unsigned char* damaged = copy(false);
+    bool rejected = false;
+    try {
+        Program::adopt(damaged, bytes.size(), nullptr);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+
+    std::cout << "✓ Atoms in program blocks test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra Parser Tests..." << std::endl;
+    std::cout << "==============================" << std::endl;
+
+    try {
+        test_precedence();
+        test_unary_and_postfix();
+        test_errors();
+        test_cached_atoms();
+
+        std::cout << std::endl;
+        std::cout << "✓ All parser tests passed!" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,147 @@
+#include "engine_harness.h"
+#include "runtime/memory.h"
+#include <iostream>
+#include <cassert>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+StringObject::Form formOf(const RuntimeValue& value) {
+    return value.asStringObject()->form;
+}
+
+void test_forms() {
+    std::cout << "Testing string representations..." << std::endl;
+
+    RuntimeValue small("short");
+    RuntimeValue large(std::string(100, 'x'));
+    assert(formOf(small) == StringObject::Form::Inline);
+    assert(formOf(large) == StringObject::Form::Buffer);
+    assert(small.asString() == "short" && large.asString() == std::string(100, 'x'));
+
+    // Short concatenations are copied, long ones are ropes until read
+    RuntimeValue pair = concatStrings(small, small);
+    assert(formOf(pair) == StringObject::Form::Inline && pair.asString() == "shortshort");
+    RuntimeValue rope = concatStrings(large, small);
+    assert(formOf(rope) == StringObject::Form::Rope);
+    assert(rope.asStringObject()->length == 105);
+    assert(large.asObject()->refcount == 2);
+    assert(rope.asString() == std::string(100, 'x') + "short");
+    assert(formOf(rope) == StringObject::Form::Buffer);
+    assert(large.asObject()->refcount == 1);
+
+    // Concatenating an empty string is free
+    RuntimeValue empty("");
+    assert(concatStrings(large, empty).bits() == large.bits());
+    assert(concatStrings(empty, small).bits() == small.bits());
+
+    // Long substrings share their base's characters, slices of slices too
+    RuntimeValue slice = sliceString(large, 10, 50);
+    assert(formOf(slice) == StringObject::Form::Slice);
+    assert(slice.asString().data() == large.asString().data() + 10);
+    RuntimeValue inner = sliceString(slice, 5, 30);
+    assert(inner.asStringObject()->flat.base == large.asStringObject());
+    assert(inner.asString().data() == large.asString().data() + 15);
+    assert(formOf(sliceString(large, 3, 4)) == StringObject::Form::Inline);
+    assert(sliceString(large, 0, 100).bits() == large.bits());
+
+    // Equality looks at characters, whatever the forms
+    RuntimeValue built = concatStrings(sliceString(large, 0, 60), RuntimeValue(std::string(40, 'x')));
+    assert(built == large);
+    assert(!(built == slice));
+
+    std::cout << "✓ String representations test passed" << std::endl;
+}
+
+void test_ropes() {
+    std::cout << "Testing deep ropes..." << std::endl;
+
+    MemoryManager memory;
+    {
+        MemoryManager::Scope scope(memory);
+        // Flattening and freeing a rope this deep must not recurse
+        RuntimeValue line(std::string(70, 'a'));
+        RuntimeValue log("");
+        for (int i = 0; i < 1000000; ++i) {
+            log = concatStrings(log, line);
+        }
+        RuntimeValue shared = log;
+        assert(log.asStringObject()->length == 70000000);
+        assert(shared.asString().substr(69999990) == std::string(10, 'a'));
+
+        // An unread rope is freed without flattening as well
+        RuntimeValue prefix("");
+        for (int i = 0; i < 1000000; ++i) {
+            prefix = concatStrings(line, prefix);
+        }
+    }
+    assert(memory.stats().requestedBytes == 0);
+
+    // Nothing is allocated for a concatenation over the limit
+    RuntimeValue half(std::string(100, 'h'));
+    for (size_t length = 100; length <= StringObject::kMaxLength / 2; length *= 2) {
+        half = concatStrings(half, half);
+    }
+    bool threw = false;
+    try {
+        concatStrings(half, half);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()) == "String too long";
+    }
+    assert(threw);
+
+    std::cout << "✓ Deep ropes test passed" << std::endl;
+}
+
+void test_language() {
+    std::cout << "Testing strings in programs..." << std::endl;
+
+    // Building a log appends in linear time on every engine
+    std::string output = runAll(R"(
+        let log = "";
+        for i in 0..200000 { log = log + "entry line\n"; }
+        print(length(log), length(substring(log, 11, 22)), substring(log, 2199995, 100));
+    )");
+    assert(output == "2200000 22 line\n\n");
+
+    output = runAll(R"(
+        let text = "the quick brown fox jumps over the lazy dog";
+        let word = substring(text, 4, 5);
+        let rest = substring(text, 35);
+        print(word, rest, substring(text, 50), substring(text, 2, -1) == "", length(rest));
+        let joined = word + " " + rest + " " + word + " " + rest + " " + word + " " + rest;
+        print(joined == "quick lazy dog quick lazy dog quick lazy dog", length(joined));
+        if joined { print(substring(joined, 6, 8)); }
+        if "" { print("empty is true"); }
+    )");
+    assert(output == "quick lazy dog  true 8\ntrue 44\nlazy dog\n");
+
+    // Doubling a rope hits the length limit long before size_t would wrap
+    output = runAll(R"(
+        let s = "ab";
+        for i in 0..40 { s = s + s; }
+        print(length(s));
+    )");
+    assert(output == "error: String too long\n");
+
+    std::cout << "✓ Strings in programs test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra String Tests..." << std::endl;
+    std::cout << "==============================" << std::endl;
+
+    try {
+        test_forms();
+        test_ropes();
+        test_language();
+
+        std::cout << std::endl;
+        std::cout << "✓ All string tests passed!" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,386 @@
+#include "engine_harness.h"
+#include "semantics/type_checker.h"
+#include "myndra.h"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+// Operations annotated with `type`
+size_t annotated(const Program& program, ValueType type) {
+    size_t count = 0;
+    for (uint32_t i = 0; i < program.count(NodeKind::BinaryExpression); ++i) {
+        count += program.node<BinaryExpression>(NodeRef(NodeKind::BinaryExpression, i)).operands == type;
+    }
+    return count;
+}
+
+// Runs `program` on the tree walker, the VM and compiled code and returns
+// each engine's output (or runtime error), one after the other
+std::string run(Program& program) {
+    std::string output;
+    for (Engine engine : {Engine::Interpreter, Engine::VM, Engine::JIT}) {
+        output += runOn(engine, program);
+    }
+    return output;
+}
+
+// Checks `source`, asserts every engine prints what it does unchecked and
+// returns the checker
+TypeChecker check(const std::string& source, bool wholeProgram = false) {
+    auto unchecked = parse(source);
+    std::string expected = run(*unchecked);
+
+    auto program = parse(source);
+    TypeChecker checker(wholeProgram);
+    checker.check(*program);
+    std::string actual = run(*program);
+    if (expected != actual) {
+        std::cerr << "Unchecked output:\n" << expected << "\nChecked output:\n" << actual << std::endl;
+    }
+    assert(expected == actual);
+    return checker;
+}
+
+void test_inference() {
+    std::cout << "Testing type inference..." << std::endl;
+
+    // Nested functions are typed from their calls
+    const std::string source = R"(
+        fn main() {
+            fn dot(a: float, b: float, n: int) -> float {
+                let i = 0;
+                let sum = 0.0;
+                while i < n {
+                    sum = sum + a * b;
+                    i = i + 1;
+                }
+                return sum;
+            }
+            print(dot(1.5, 2.0, 4), dot(0.5, -1.0, 3));
+        }
+        main();
+    )";
+    TypeChecker checker = check(source);
+    assert(checker.errors().empty());
+    assert(checker.typedOperations() == 4);
+    auto program = parse(source);
+    checker.check(*program);
+    assert(annotated(*program, ValueType::Float) == 2);
+    assert(annotated(*program, ValueType::Int) == 2);
+
+    // Types flow through returns, variables and assignments
+    checker = check(R"(
+        let x = 1.5;
+        let y = x * x;
+        let label = "y=" + "2.25";
+        print(y + 1.0, label, y > x, -x);
+        let n = 2;
+        n = n + 1;
+        print(n * 3);
+    )");
+    assert(checker.typedOperations() == 5);
+
+    // A variable that ever holds two types is dynamic
+    checker = check("let v = 1.5; print(v * 2.0); v = 3; print(v * 2);");
+    assert(checker.typedOperations() == 0);
+    checker = check("let v = 1.5; fn set() { v = \"text\"; } set(); print(v == v);");
+    assert(checker.typedOperations() == 0);
+
+    // Reads of outer variables are dynamic; blocks of the top level reuse slots
+    checker = check("let scale = 2.0; fn f(x: float) -> float { return x * scale; } print(f(1.5));");
+    assert(checker.typedOperations() == 0);
+    checker = check("{ let a = 1.5; print(a * a); } { let b = 2; print(b * b); }");
+    assert(checker.typedOperations() == 0);
+
+    // A for loop variable is an int, unless the body assigns it something else
+    checker = check(R"(
+        fn sums(n: int) {
+            let total = 0;
+            let scaled = 0.0;
+            for i in 0..n { total = total + i * i; }
+            for j in 0..n { j = 0.5; scaled = scaled + j * 2.0; }
+            print(total, scaled);
+        }
+        sums(4);
+        for k in 0..3 { print(k * k); }
+    )");
+    assert(checker.typedOperations() == 2);
+
+    std::cout << "✓ Type inference test passed" << std::endl;
+}
+
+void test_parameters() {
+    std::cout << "Testing parameter typing..." << std::endl;
+
+    // Top-level functions may be called by later programs
+    const std::string kernel = R"(
+        fn axpy(a: float, x: float, y: float) -> float {
+            return a * x + y;
+        }
+        print(axpy(2.0, 3.0, 0.5));
+    )";
+    assert(check(kernel).typedOperations() == 0);
+    assert(check(kernel, true).typedOperations() == 2);
+
+    // Annotations are checked, not trusted: arguments decide
+    TypeChecker checker = check(R"(
+        fn twice(x: float) -> float { return x + x; }
+        print(twice(2), twice(1.5));
+    )", true);
+    assert(checker.typedOperations() == 0);
+    assert(checker.errors().empty());
+
+    // Functions used as values, reassigned or defined twice stay untyped
+    assert(check("fn f(x: float) -> float { return x * x; } let g = f; print(f(1.5), g(2));", true)
+               .typedOperations() == 0);
+    assert(check("fn f(x: float) -> float { return x * x; } print(f(1.5)); fn f(x: int) -> int { return x; }", true)
+               .typedOperations() == 0);
+
+    // Results cross function boundaries, recursion included
+    checker = check(R"(
+        fn fib(n: int) -> int {
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        fn half(x: float) -> float { return x / 2.0; }
+        print(fib(15), half(half(9.0)) * 4.0);
+    )", true);
+    assert(checker.typedOperations() == 6);
+
+    std::cout << "✓ Parameter typing test passed" << std::endl;
+}
+
+void test_errors() {
+    std::cout << "Testing type error reports..." << std::endl;
+
+    // Reported before anything runs; the runtime still raises them if reached
+    TypeChecker checker = check(R"(
+        fn describe(n: int) -> string {
+            return n;
+        }
+        fn pair(a: int, b: int) -> int { return a + b; }
+        let count: int = 1.5;
+        print(describe(3), pair(1));
+        if false { print("a" - 1, -"b"); }
+        print(1 % 2);
+        for i in 0..2.5 { print(i); }
+    )", true);
+    const auto& errors = checker.errors();
+    assert(errors.size() == 7);
+    assert(errors[0] == "Type error in fn describe: declared to return string but returns int");
+    assert(errors[1] == "Type error: variable 'count' is declared int but initialized with float");
+    assert(errors[2] == "Type error: fn pair takes 2 arguments, got 1");
+    assert(errors[3] == "Type error: invalid operands for -: string and int");
+    assert(errors[4] == "Type error: invalid operand for negation: string");
+    assert(errors[5] == "Type error: operator % is not supported");
+    assert(errors[6] == "Type error: for loop range bounds must be int, got float");
+
+    // Parameters declared one type but called with another
+    checker = check("fn f() { fn g(x: int) -> float { return x * 0.5; } print(g(1.5)); } f();");
+    assert(checker.errors().size() == 1);
+    assert(checker.errors()[0] == "Type error in fn g: parameter 'x' is declared int but receives float");
+
+    // Dynamic values are not errors
+    assert(check("fn f(x: int, s: string) { print(x + s); } f(1, \"a\");").errors().empty());
+
+    std::cout << "✓ Type error reports test passed" << std::endl;
+}
+
+void test_unboxed_bytecode() {
+    std::cout << "Testing unboxed float bytecode..." << std::endl;
+
+    auto program = parse(R"(
+        let x = 0.5;
+        let total = 0.0;
+        while total < 10.0 { total = total + x * 3.0; }
+        print(total, total / 0.0);
+    )");
+    TypeChecker().check(*program);
+    std::string listing = BytecodeCompiler().compile(*program).disassemble();
+    assert(listing.find("ADD_FLOAT") != std::string::npos);
+    assert(listing.find("MUL_FLOAT") != std::string::npos);
+    assert(listing.find("LT_FLOAT") != std::string::npos);
+    assert(listing.find("DIV_FLOAT") != std::string::npos);
+    // Division by zero still raises on every engine
+    std::string output = run(*program);
+    assert(output == "error: Division by zero\nerror: Division by zero\nerror: Division by zero\n");
+
+    // Compiled code runs the proven-double templates, not just the VM
+    if (Jit::supported()) {
+        const std::string source = R"(
+            fn decay(x: float, n: int) -> float {
+                let i = 0;
+                while i < n {
+                    x = x * 0.5 + 1.0;
+                    if x >= 1.75 { x = x - 0.25; }
+                    i = i + 1;
+                }
+                return x / 2.0;
+            }
+            fn ratio(a: float, b: float) -> bool { return a / b <= 1.0 and a > b; }
+            print(decay(3.0, 10), decay(-1.0, 3), ratio(1.5, 2.0), ratio(4.0, 2.0));
+            print(ratio(1.0, 0.0));
+        )";
+        program = parse(source);
+        TypeChecker(true).check(*program);
+        Chunk chunk = BytecodeCompiler().compile(*program);
+        listing = chunk.disassemble();
+        for (const char* op : {"ADD_FLOAT", "SUB_FLOAT", "MUL_FLOAT", "DIV_FLOAT", "LE_FLOAT", "GT_FLOAT", "GE_FLOAT"}) {
+            assert(listing.find(op) != std::string::npos);
+        }
+        Jit::Options options;
+        options.threshold = 1;
+        options.perfMap = false;
+        VM vm(NativeRegistry::builtins(), 1 << 18, options);
+        Capture capture;
+        try {
+            vm.execute(chunk);
+        } catch (const std::exception& e) {
+            std::cout << "error: " << e.what() << "\n";
+        }
+        output = capture.restore();
+        assert(vm.jit().compiledFunctions() == 2);
+        assert(output == runOn(Engine::Interpreter, *parse(source)));
+        assert(output.find("\nerror: Division by zero\n") != std::string::npos);
+    }
+
+    std::cout << "✓ Unboxed float bytecode test passed" << std::endl;
+}
+
+void test_arrays() {
+    std::cout << "Testing array element typing..." << std::endl;
+
+    // Literals, element stores and push() type the elements; the builtins
+    // are only known as such in `x.f()` form, or for the whole program
+    const std::string source = R"(
+        fn main() {
+            let xs: [float] = [0.5, 1.5, 2.0];
+            push(xs, 4.0);
+            xs[1] = 2.5;
+            let s = 0.0;
+            for i in 0..length(xs) { s = s + xs[i]; }
+            let ns = [1, 2, 3];
+            let t = 0;
+            for i in 0..3 { t = t + ns[i] * 2; }
+            print(s, t, xs.pop() * 2.0);
+        }
+        main();
+    )";
+    TypeChecker checker = check(source, true);
+    assert(checker.errors().empty());
+    assert(checker.typedOperations() == 4);
+    assert(check(source).typedOperations() == 2);
+
+    // Element reads of a proven [float] run the double-only instructions
+    auto program = parse(source);
+    TypeChecker(true).check(*program);
+    assert(annotated(*program, ValueType::Float) == 2);
+    std::string listing = BytecodeCompiler().compile(*program).disassemble();
+    assert(listing.find("ADD_FLOAT") != std::string::npos);
+    assert(listing.find("MUL_FLOAT") != std::string::npos);
+
+    // Aliases share their elements, and an array handed to anything the
+    // checker does not follow may come back holding anything
+    for (const char* escaping : {
+             "fn main() { let a = [1.5, 2.5]; let b = a; b[0] = 1; print(a[0] * 2.0); } main();",
+             "fn main() { let a = [1.5]; fn poke() { a[0] = \"s\"; } poke(); print(a[0] * 2.0); } main();",
+             "fn poke(v: [float]) { v[0] = 1; } fn main() { let a = [1.5]; poke(a); print(a[0] * 2.0); } main();",
+             "fn main() { let a = [1.5]; let m = [a]; m[0][0] = 2; print(a[0] * 2.0); } main();",
+             "fn main() { let a = [1.5]; let o = { v: a }; o.v[0] = 2; print(a[0] * 2.0); } main();",
+             "fn main() { let a = [1.5]; let f = push; f(a, 2); print(a[1] * 2.0); } main();"}) {
+        assert(check(escaping, true).typedOperations() == 0);
+    }
+    // Arrays meeting in a parameter share one element type
+    checker = check(R"(
+        fn main() {
+            fn first(v: [float]) -> float { return v[0] * 1.0; }
+            let a = [2.5];
+            let b = [1];
+            print(first(a), first(b));
+        }
+        main();
+    )");
+    assert(checker.typedOperations() == 0);
+
+    // [T] annotations are checked against the elements
+    checker = check(R"(
+        let xs: [int] = [1.5, 2.5];
+        let n: [float] = 3;
+        fn f() {
+            fn g(v: [float]) -> float { return v[0]; }
+            print(g([1, 2]));
+        }
+        f();
+    )");
+    const auto& errors = checker.errors();
+    assert(errors.size() == 4);
+    assert(errors[0] == "Type error: variable 'xs' is declared [int] but initialized with [float]");
+    assert(errors[1] == "Type error: variable 'n' is declared [float] but initialized with int");
+    assert(errors[2] == "Type error in fn g: parameter 'v' is declared [float] but receives [int]");
+    assert(errors[3] == "Type error in fn g: declared to return float but returns int");
+
+    std::cout << "✓ Array element typing test passed" << std::endl;
+}
+
+void test_compiler_report() {
+    std::cout << "Testing type checking in the compiler..." << std::endl;
+
+    Capture capture;
+    Compiler::Options options;
+    options.target_context = "test";
+    options.whole_program = true;
+    Compiler compiler(options);
+    bool ok = compiler.compile_string(R"(
+        fn area(r: float) -> float { return 3.0 * r * r; }
+        print(area(2.0), "n" - 1);
+    )");
+    bool again = compiler.compile_string("print(area(1));");
+    std::string output = capture.restore();
+    assert(!ok);
+    assert(!again);
+    assert(output.find("⚠ Type error: invalid operands for -: string and int") != std::string::npos);
+    assert(output.find("✓ Type checking completed (2 operations typed)") != std::string::npos);
+
+    // A builtin the host replaced is no longer known by its name
+    for (auto engine : {ExecutionEngine::INTERPRETER, ExecutionEngine::BYTECODE_VM}) {
+        options.engine = engine;
+        Compiler host(options);
+        host.register_native("pop", [](const std::vector<Value>&) { return Value(std::string("s")); });
+        Capture hostCapture;
+        bool ran = host.compile_string(R"(
+            fn f() -> float { let xs = [1.5, 2.5]; let y = xs.pop(); return y + 1.0; }
+            print(f());
+        )");
+        output = hostCapture.restore();
+        assert(!ran);
+        assert(host.get_errors().back() == "Runtime error: Invalid operands for addition");
+        assert(output.find("✓ Type checking completed (0 operations typed)") != std::string::npos);
+    }
+
+    std::cout << "✓ Type checking in the compiler test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra Type Checker Tests..." << std::endl;
+    std::cout << "====================================" << std::endl;
+
+    try {
+        test_inference();
+        test_parameters();
+        test_errors();
+        test_unboxed_bytecode();
+        test_arrays();
+        test_compiler_report();
+
+        std::cout << std::endl;
+        std::cout << "✓ All type checker tests passed!" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
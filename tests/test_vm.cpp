@@ -0,0 +1,625 @@
+#include "engine_harness.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <cmath>
+#include <unistd.h>
+
+using namespace myndra;
+using namespace myndra::testing;
+
+void test_arithmetic() {
+    std::cout << "Testing VM arithmetic..." << std::endl;
+    
+    auto output = runAll(R"(
+        let x = 42;
+        let y = x + 8;
+        print(x * y - 1, y / 3, 1.5 * 2.0, -x);
+        print(x < y, x >= y, x == 42, x != 42, not (x < y));
+    )");
+    assert(output == "2099 16 3.000000 -42\ntrue false true false false\n");
+
+    // Negative zero keeps its sign through the constant pool
+    output = runAll("let z = 0.0; print(-z, z, -z + 0.0);");
+    assert(output == "-0.000000 0.000000 0.000000\n");
+    Chunk chunk;
+    assert(chunk.addConstant(RuntimeValue(0.0)) != chunk.addConstant(RuntimeValue(-0.0)));
+    assert(chunk.addConstant(RuntimeValue(-0.0)) == 1);
+    double nan = std::nan("");
+    assert(chunk.addConstant(RuntimeValue(nan)) != chunk.addConstant(RuntimeValue(nan)));
+    
+    std::cout << "✓ VM arithmetic test passed" << std::endl;
+}
+
+void test_value_encoding() {
+    std::cout << "Testing NaN-boxed values..." << std::endl;
+    
+    static_assert(sizeof(RuntimeValue) == 8);
+    
+    RuntimeValue small(int64_t(-5));
+    RuntimeValue big(int64_t(1) << 60);
+    RuntimeValue real(2.5);
+    RuntimeValue flag(true);
+    RuntimeValue text(std::string("boxed"));
+    
+    assert(small.isSmallInt() && small.asInt() == -5);
+    assert(big.isInt() && !big.isSmallInt() && big.asInt() == (int64_t(1) << 60));
+    assert(real.isDouble() && real.asDouble() == 2.5);
+    assert(flag.isBool() && flag.asBool());
+    assert(text.isString() && text.asString() == "boxed");
+    
+    RuntimeValue copy = text;
+    assert(copy == text && copy.asObject() == text.asObject());
+    assert(RuntimeValue(int64_t(1)) != RuntimeValue(1.0));
+    
+    // Integers crossing the 48-bit immediate range keep int64 semantics
+    auto output = runAll(R"(
+        let edge = 140737488355327;
+        let big = edge * 4096 + 1;
+        print(edge + 1, big, big - big == 0);
+    )");
+    assert(output == "140737488355328 576460752303419393 true\n");
+    
+    std::cout << "✓ NaN-boxed values test passed" << std::endl;
+}
+
+void test_control_flow() {
+    std::cout << "Testing VM control flow..." << std::endl;
+    
+    auto output = runAll(R"(
+        let i = 0;
+        let sum = 0;
+        while (i < 100) {
+            if (i > 49) {
+                sum = sum + i;
+            } else {
+                sum = sum - 1;
+            }
+            i = i + 1;
+        }
+        print(sum);
+    )");
+    assert(output == "3675\n");
+    
+    std::cout << "✓ VM control flow test passed" << std::endl;
+}
+
+void test_for_loops() {
+    std::cout << "Testing counted for loops..." << std::endl;
+    
+    // Bounds are read once; assigning the variable does not move the counter
+    auto output = runAll(R"(
+        let n = 4;
+        let total = 0;
+        for i in 0..n {
+            n = n + 1;
+            total = total + i;
+            i = 100;
+        }
+        print(total, n);
+        for i in 3..3 { print("empty"); }
+        for i in 5..2 { print("backwards"); }
+        for i in -2..1 { print(i); }
+    )");
+    assert(output == "6 8\n-2\n-1\n0\n");
+    
+    // Nested loops, returns from inside, and counters beyond 48 bits
+    output = runAll(R"(
+        fn pairs(n: int) -> int {
+            let count = 0;
+            for a in 0..n { for b in a..n { count = count + 1; } }
+            return count;
+        }
+        fn find(limit: int) -> int {
+            for i in 1..limit { if i * i > 50 { return i; } }
+            return -1;
+        }
+        print(pairs(10), find(100), find(5));
+        for big in 140737488355326..140737488355329 { print(big); }
+    )");
+    assert(output == "55 8 -1\n140737488355326\n140737488355327\n140737488355328\n");
+    
+    assert(runAll("for i in 0..\"3\" { print(i); }") == "error: For loop range bounds must be integers\n");
+    assert(runAll("for i in 1.0..3 { print(i); }") == "error: For loop range bounds must be integers\n");
+    
+    std::cout << "✓ Counted for loops test passed" << std::endl;
+}
+
+void test_scopes_and_builtins() {
+    std::cout << "Testing VM scopes and builtins..." << std::endl;
+    
+    auto output = runAll(R"(
+        let text = "Hello World";
+        {
+            let text = substring(text, 0, 5);
+            print(text, length(text));
+        }
+        print(text + "!");
+    )");
+    assert(output == "Hello 5\nHello World!\n");
+    
+    // Shadowing, slot reuse after a block ends and per-iteration declarations
+    output = runAll(R"(
+        let x = 1;
+        { let x = x + 1; let y = x * 10; print(x, y); }
+        { let z = 7; print(x, z); }
+        let i = 0;
+        while (i < 3) { let square = i * i; print(square); i = i + 1; }
+    )");
+    assert(output == "2 20\n1 7\n0\n1\n4\n");
+    
+    std::cout << "✓ VM scopes and builtins test passed" << std::endl;
+}
+
+void test_runtime_errors() {
+    std::cout << "Testing VM runtime errors..." << std::endl;
+    
+    runAll("print(1); print(missing);");
+    runAll("print(1 / 0);");
+    runAll("print(\"a\" - 1);");
+    runAll("undefined_function(1);");
+    
+    std::cout << "✓ VM runtime errors test passed" << std::endl;
+}
+
+void test_functions() {
+    std::cout << "Testing function calls..." << std::endl;
+    
+    auto output = runAll(R"(
+        fn fib(n: int) -> int {
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        fn is_even(n: int) -> int {
+            if n == 0 { return 1; }
+            return is_odd(n - 1);
+        }
+        fn is_odd(n: int) -> int {
+            if n == 0 { return 0; }
+            return is_even(n - 1);
+        }
+        let total = 0;
+        fn add(x: int) { total = total + x; }
+        add(5); add(7);
+        print(fib(15), is_even(10), is_odd(7), total, add(1), fib);
+    )");
+    assert(output == "610 1 1 12 0 <fn fib>\n");
+    
+    // Tail calls run in constant frame space, far past the depth limit
+    output = runAll(R"(
+        fn sum(n: int, acc: int) -> int {
+            if n == 0 { return acc; }
+            return sum(n - 1, acc + n);
+        }
+        print(sum(100000, 0));
+    )");
+    assert(output == "5000050000\n");
+    
+    std::cout << "✓ Function calls test passed" << std::endl;
+}
+
+void test_call_errors() {
+    std::cout << "Testing function call errors..." << std::endl;
+    
+    auto output = runAll("fn f(a: int) -> int { return a; } print(f(1, 2));");
+    assert(output == "error: Function 'f' expects 1 arguments but got 2\n");
+    output = runAll("let x = 1; x(2);");
+    assert(output == "error: Value is not callable\n");
+    output = runAll("fn down(n: int) -> int { return 1 + down(n + 1); } down(0);");
+    assert(output == "error: Stack overflow\n");
+    runAll("fn outer() { let hidden = 1; fn inner() -> int { return hidden; } return inner(); } print(outer());");
+    runAll("print(1); return; print(2);");
+    
+    std::cout << "✓ Function call errors test passed" << std::endl;
+}
+
+RuntimeValue nativeSum(NativeArgs args, void* data) {
+    ++*static_cast<int*>(data);
+    int64_t sum = 0;
+    for (const auto& arg : args) {
+        sum += arg.asInt();
+    }
+    return sum;
+}
+
+void test_native_registry() {
+    std::cout << "Testing native registry..." << std::endl;
+    
+    int calls = 0;
+    NativeRegistry natives;
+    uint16_t id = natives.define("sum", nativeSum, &calls);
+    assert(natives.lookup("sum") == id);
+    assert(natives.lookup("print") != NativeRegistry::kNone);
+    assert(natives.lookup("missing") == NativeRegistry::kNone);
+    
+    auto program = parse("fn sum3(a: int) -> int { return sum(a, a, a); } print(sum(1, 2), sum3(4));");
+    Capture capture;
+    Interpreter interpreter(natives);
+    interpreter.execute(*program);
+    BytecodeCompiler compiler(natives);
+    VM vm(natives);
+    vm.execute(compiler.compile(*program));
+    assert(capture.restore() == "3 12\n3 12\n");
+    assert(calls == 4);
+    
+    // Redefinition keeps the id, so compiled call sites follow it
+    assert(natives.define("sum", nativeSum, &calls) == id);
+    
+    std::cout << "✓ Native registry test passed" << std::endl;
+}
+
+void test_persistent_globals() {
+    std::cout << "Testing globals across chunks..." << std::endl;
+    
+    BytecodeCompiler compiler;
+    VM vm;
+    
+    Capture capture;
+    vm.execute(compiler.compile(*parse("let counter = 41;")));
+    vm.execute(compiler.compile(*parse("counter = counter + 1;")));
+    vm.execute(compiler.compile(*parse("print(counter);")));
+    
+    Interpreter interpreter;
+    interpreter.execute(*parse("let counter = 41;"));
+    interpreter.execute(*parse("{ let scratch = 1; } counter = counter + 1;"));
+    interpreter.execute(*parse("let other = counter; print(other);"));
+    
+    assert(capture.restore() == "42\n42\n");
+    
+    std::cout << "✓ Globals test passed" << std::endl;
+}
+
+// The binary expression `return <expr>;` of the function defined by
+// top-level statement `index`
+BinaryExpression& returned_binary(Program& program, size_t index) {
+    const auto& function = program.node<FunctionDefinition>(program.statements()[index]);
+    NodeRef ret = program.list(program.node<Block>(function.body).statements)[0];
+    return program.node<BinaryExpression>(program.node<ReturnStatement>(ret).value);
+}
+
+void test_quickening() {
+    std::cout << "Testing interpreter quickening..." << std::endl;
+    
+    auto program = parse(R"(
+        fn add(a: int, b: int) -> int { return a + b; }
+        fn scale(x: float) -> float { return x * 2.5; }
+        fn greet(name: string) -> string { return "hi " + name; }
+        fn same(a: int, b: int) -> bool { return a == b; }
+        fn either(a: bool, b: bool) -> bool { return a or b; }
+        let i = 0;
+        while i < 3 {
+            print(add(i, 1), scale(1.0), greet("bob"), same(i, 1), either(false, true));
+            i = i + 1;
+        }
+        print(same("x", "x"), same(1.5, 1.5));
+    )");
+    
+    Capture capture;
+    Interpreter interpreter;
+    interpreter.execute(*program);
+    std::string output = capture.restore();
+    
+    assert(returned_binary(*program, 0).feedback == BinaryFeedback::SmallInts);
+    assert(returned_binary(*program, 1).feedback == BinaryFeedback::Doubles);
+    assert(returned_binary(*program, 2).feedback == BinaryFeedback::Strings);
+    // Saw ints first, then strings: back on the generic path
+    assert(returned_binary(*program, 3).feedback == BinaryFeedback::Generic);
+    // Logical operators are never specialized
+    assert(returned_binary(*program, 4).feedback == BinaryFeedback::Generic);
+    assert(output ==
+           "1 2.500000 hi bob false true\n"
+           "2 2.500000 hi bob true true\n"
+           "3 2.500000 hi bob false true\n"
+           "true true\n");
+    
+    // A failed guard still gives the generic result, errors included
+    assert(runAll(R"(
+        fn add(a: int, b: int) -> int { return a + b; }
+        print(add(1, 2), add(1.5, 2.0), add("a", "b"), add(3, 4));
+        print(add(1, 1.5));
+    )") == "3 3.500000 ab 7\nerror: Invalid operands for addition\n");
+    assert(runAll(R"(
+        fn div(a: int, b: int) -> int { return a / b; }
+        print(div(7, 2), div(140737488355327 * 4, 2));
+        print(div(1.0, 0.0));
+    )") == "3 281474976710654\nerror: Division by zero\n");
+    
+    std::cout << "✓ Quickening test passed" << std::endl;
+}
+
+// Runs `source` on a VM that compiles every function on its first call
+std::string run_jit(const std::string& source, size_t* compiled = nullptr) {
+    auto program = parse(source);
+    Jit::Options options;
+    options.threshold = 1;
+
+    Capture capture;
+    BytecodeCompiler compiler;
+    VM vm(NativeRegistry::builtins(), 1 << 18, options);
+    try {
+        vm.execute(compiler.compile(*program));
+    } catch (const std::exception& e) {
+        std::cout << "error: " << e.what() << "\n";
+    }
+    std::string output = capture.restore();
+    if (compiled) {
+        *compiled = vm.jit().compiledFunctions();
+    }
+
+    std::string interpreted = runOn(Engine::Interpreter, *parse(source));
+    if (interpreted != output) {
+        std::cerr << "Interpreter output:\n" << interpreted << "\nJIT output:\n" << output << std::endl;
+    }
+    assert(interpreted == output);
+    return output;
+}
+
+void test_jit() {
+    std::cout << "Testing JIT-compiled functions..." << std::endl;
+
+    if (!Jit::supported()) {
+        std::cout << "✓ JIT test skipped (no code generator for this host)" << std::endl;
+        return;
+    }
+
+    // Inline int and double paths, and the evaluator behind them
+    size_t compiled = 0;
+    auto output = run_jit(R"(
+        fn ints(a: int, b: int) {
+            print(a + b, a - b, a * b, a / b, a < b, a <= b, a > b, a >= b, a == b, a != b, -a, not (a < b));
+        }
+        fn reals(a: float, b: float) {
+            print(a + b, a - b, a * b, a / b, a < b, a <= b, a > b, a >= b, a == b, a != b);
+        }
+        ints(7, 2); ints(-7, 2); ints(2, 2); ints(140737488355327, 1); ints(4294967296, 4294967296);
+        reals(1.5, 0.25); reals(-0.0, 0.5); reals(2.0, 2.0);
+        fn zero(a: float, b: float) -> bool { return a == b; }
+        print(zero(-0.0, 0.0));
+        fn greet(name: string) -> string { return "hi " + name; }
+        print(greet("jit"), greet("jit") == "hi jit");
+    )", &compiled);
+    assert(output.find("9 5 14 3 false false true true false true -7 true\n") == 0);
+    assert(output.find("140737488355328 ") != std::string::npos);   // Overflowed the 48-bit immediate
+    assert(output.find("18446744073709551616") == std::string::npos);
+    assert(output.find("\ntrue\nhi jit true") != std::string::npos);
+    assert(compiled == 4);
+
+    // Loops, globals and recursion inside compiled code
+    output = run_jit(R"(
+        let calls = 0;
+        fn loop(n: int) -> int {
+            let sum = 0;
+            let i = 0;
+            while i < n { sum = sum + i * 2; i = i + 1; }
+            calls = calls + 1;
+            return sum;
+        }
+        fn fib(n: int) -> int {
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        fn sum(n: int, acc: int) -> int {
+            if n == 0 { return acc; }
+            return sum(n - 1, acc + n);
+        }
+        print(loop(1000), fib(20), sum(100000, 0), calls);
+    )");
+    assert(output == "999000 6765 5000050000 1\n");
+
+    // Counted loops step small ints inline and leave for the helper beyond
+    output = run_jit(R"(
+        fn range(a: int, b: int) -> int {
+            let total = 0;
+            for i in a..b { total = total + i; }
+            return total;
+        }
+        print(range(0, 1000), range(5, 5), range(140737488355320, 140737488355330));
+        fn bad(a: float) { for i in 0..a { print(i); } }
+        bad(1.5);
+    )");
+    assert(output == "499500 0 1407374883553245\nerror: For loop range bounds must be integers\n");
+
+    // Errors raised inside compiled code unwind to the caller of execute()
+    output = run_jit("fn div(a: int, b: int) -> int { return a / b; } print(div(6, 3)); print(div(1, 0));");
+    assert(output == "2\nerror: Division by zero\n");
+    output = run_jit("fn bad(a: float) -> float { return a / 0.0; } print(bad(1.0));");
+    assert(output.find("error: ") == 0);
+    output = run_jit("fn down(n: int) -> int { return 1 + down(n + 1); } down(0);");
+    assert(output == "error: Stack overflow\n");
+    output = run_jit("fn f(a: int) -> int { return a; } fn g() -> int { return f(1, 2); } g();");
+    assert(output == "error: Function 'f' expects 1 arguments but got 2\n");
+
+    // Compiled functions are named for perf
+    std::ifstream map("/tmp/perf-" + std::to_string(getpid()) + ".map");
+    std::string contents((std::istreambuf_iterator<char>(map)), std::istreambuf_iterator<char>());
+    assert(contents.find(" myndra:fib\n") != std::string::npos);
+
+    std::cout << "✓ JIT test passed" << std::endl;
+}
+
+// Runs `source` on the tiered interpreter, which must print what the plain
+// tree walker does; `trace` receives the tier transitions
+std::string run_tiered(const std::string& source, uint32_t threshold, std::string* trace = nullptr) {
+    auto program = parse(source);
+    TieringOptions options;
+    options.threshold = threshold;
+    options.jitThreshold = 0;
+    options.trace = true;
+
+    std::ostringstream log;
+    Capture capture(&log);
+    try {
+        Interpreter interpreter(NativeRegistry::builtins(), true, options);
+        interpreter.execute(*program);
+    } catch (const std::exception& e) {
+        std::cout << "error: " << e.what() << "\n";
+    }
+    std::string output = capture.restore();
+    if (trace) {
+        *trace = log.str();
+    }
+
+    std::string interpreted = runOn(Engine::Interpreter, *parse(source));
+    if (interpreted != output) {
+        std::cerr << "Interpreter output:\n" << interpreted << "\nTiered output:\n" << output << std::endl;
+    }
+    assert(interpreted == output);
+    return output;
+}
+
+void test_tiering() {
+    std::cout << "Testing tiered execution..." << std::endl;
+
+    const std::string calls = R"(
+        let calls = 0;
+        fn fib(n: int) -> int {
+            calls = calls + 1;
+            if n < 2 { return n; }
+            return fib(n - 1) + fib(n - 2);
+        }
+        fn sum(n: int, acc: int) -> int {
+            if n == 0 { return acc; }
+            return sum(n - 1, acc + n);
+        }
+        fn outer(n: int) -> int {
+            fn inner(x: int) -> int { return x * 2; }
+            return inner(n) + fib(5);
+        }
+        fn apply(f: int, x: int) -> int { return f(x); }
+        print(fib(15), calls, sum(5000, 0), outer(3), apply(outer, 4), apply(fib, 10));
+    )";
+    std::string trace;
+    for (uint32_t threshold : {1u, 2u, 50u}) {
+        auto output = run_tiered(calls, threshold, &trace);
+        assert(output == "610 1973 12502500 11 13 55\n");
+        if (threshold == 1) {
+            assert(trace.find("[tiering] fn outer: stays in the tree walker (not compilable)\n") != std::string::npos);
+        }
+    }
+    assert(trace.find("[tiering] fn fib: tree walker -> bytecode after 50 calls\n") != std::string::npos);
+
+    // Loops switch tiers mid-flight, at the top level and inside functions,
+    // and keep their variables
+    const std::string loops = R"(
+        fn count(n: int) -> int {
+            let i = 0;
+            let total = 0;
+            while i < n {
+                let step = i * 2;
+                total = total + step;
+                i = i + 1;
+                if i == 700 { return total; }
+            }
+            return total - 1;
+        }
+        let i = 0;
+        let text = "";
+        while i < 300 {
+            let j = 0;
+            while j < 3 { j = j + 1; }
+            if i / 100 * 100 == i { text = text + "x"; }
+            i = i + j - 2;
+        }
+        print(count(10), count(1000), i, text);
+        while true {
+            i = i + 1;
+            if i == 400 { return; }
+        }
+        print("not reached");
+    )";
+    auto output = run_tiered(loops, 5, &trace);
+    assert(output == "89 489300 300 xxx\n");
+    assert(trace.find("[tiering] loop in fn count: tree walker -> bytecode (on-stack replacement) after 5 iterations\n") !=
+           std::string::npos);
+    assert(trace.find("[tiering] top-level loop: tree walker -> bytecode (on-stack replacement)") != std::string::npos);
+    run_tiered(loops, 1);
+
+    // A for loop resumes in the VM from its counter slot
+    const std::string ranges = R"(
+        fn sum(n: int) -> int {
+            let total = 0;
+            for i in 0..n { total = total + i; i = 0; }
+            return total;
+        }
+        let text = "";
+        for i in 0..40 {
+            if i / 10 * 10 == i { text = text + "x"; }
+        }
+        print(sum(100), sum(3), text);
+    )";
+    output = run_tiered(ranges, 5, &trace);
+    assert(output == "4950 3 xxxx\n");
+    assert(trace.find("[tiering] loop in fn sum: tree walker -> bytecode (on-stack replacement) after 5 iterations\n") !=
+           std::string::npos);
+    assert(trace.find("[tiering] top-level loop: tree walker -> bytecode (on-stack replacement)") != std::string::npos);
+
+    // Errors and the call depth limit cover both tiers
+    assert(run_tiered("fn d(a: int) -> int { return 10 / a; } print(d(5)); print(d(2)); print(d(0));", 2) ==
+           "2\n5\nerror: Division by zero\n");
+    assert(run_tiered("fn down(n: int) -> int { return 1 + down(n + 1); } down(0);", 100) == "error: Stack overflow\n");
+    assert(run_tiered("fn f(a: int) -> int { return 1 + g(a); } fn g(a: int) -> int { return 1 + f(a); } f(1);", 3) ==
+           "error: Stack overflow\n");
+    assert(run_tiered("fn f(a: int) -> int { return a; } let i = 0; while i < 5 { f(i); i = i + 1; } f(1, 2);", 2) ==
+           "error: Function 'f' expects 1 arguments but got 2\n");
+
+    // Each program compiles its own loops, even one whose nodes reuse the
+    // addresses of an earlier, freed program's
+    {
+        TieringOptions options;
+        options.threshold = 5;
+        options.jitThreshold = 0;
+        Interpreter interpreter(NativeRegistry::builtins(), true, options);
+        std::string outputs;
+        for (const char* step : {"1", "3"}) {
+            auto program = parse("let i = 0; let total = 0; while i < 20 { total = total + " + std::string(step) +
+                                 "; i = i + 1; } print(total);");
+            Capture capture;
+            interpreter.execute(*program);
+            outputs += capture.restore();
+        }
+        assert(outputs == "20\n60\n");
+    }
+
+    // The counters live on the nodes
+    auto program = parse("fn f() {} let i = 0; while i < 3 { f(); i = i + 1; }");
+    TieringOptions options;
+    options.threshold = 100;
+    Interpreter interpreter(NativeRegistry::builtins(), true, options);
+    interpreter.execute(*program);
+    const auto& function = program->node<FunctionDefinition>(program->statements()[0]);
+    const auto& loop = program->node<WhileStatement>(program->statements()[2]);
+    assert(function.invocations == 3);
+    assert(loop.backedges == 3);
+
+    std::cout << "✓ Tiered execution test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Myndra VM Tests..." << std::endl;
+    std::cout << "==========================" << std::endl;
+    
+    try {
+        test_arithmetic();
+        test_value_encoding();
+        test_control_flow();
+        test_for_loops();
+        test_scopes_and_builtins();
+        test_runtime_errors();
+        test_functions();
+        test_call_errors();
+        test_native_registry();
+        test_persistent_globals();
+        test_quickening();
+        test_jit();
+        test_tiering();
+        
+        std::cout << std::endl;
+        std::cout << "✓ All VM tests passed!" << std::endl;
+        return 0;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}